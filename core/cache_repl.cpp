@@ -0,0 +1,445 @@
+// See LICENSE for details.
+
+#include "cache_repl.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "iassert.hpp"
+
+bool Cache_repl::is_policy(const std::string &name) {
+  return name == k_SRRIP || name == k_BRRIP || name == k_DRRIP || name == k_HAWKEYE || name == k_MOCKINGJAY;
+}
+
+std::unique_ptr<Cache_repl> Cache_repl::create(const std::string &name, uint32_t sets, uint32_t assoc) {
+  if (name == k_SRRIP) {
+    return std::make_unique<Repl_rrip>(sets, assoc, Repl_rrip::Mode::SRRIP);
+  }
+  if (name == k_BRRIP) {
+    return std::make_unique<Repl_rrip>(sets, assoc, Repl_rrip::Mode::BRRIP);
+  }
+  if (name == k_DRRIP) {
+    return std::make_unique<Repl_rrip>(sets, assoc, Repl_rrip::Mode::DRRIP);
+  }
+  if (name == k_HAWKEYE) {
+    return std::make_unique<Repl_hawkeye>(sets, assoc);
+  }
+  if (name == k_MOCKINGJAY) {
+    return std::make_unique<Repl_mockingjay>(sets, assoc);
+  }
+  return nullptr;
+}
+
+/*********************************************************
+ *  Set_dueling
+ *********************************************************/
+
+Set_dueling::Set_dueling(uint32_t sets, uint32_t nleaders, uint32_t psel_bits)
+    : stride(std::max<uint32_t>(4, sets / std::max<uint32_t>(1, nleaders))), psel_max((1 << psel_bits) - 1) {
+  psel = psel_max / 2;
+}
+
+void Set_dueling::miss(uint32_t set) {
+  if (is_leader_a(set)) {
+    psel = std::min(psel + 1, psel_max);
+  } else if (is_leader_b(set)) {
+    psel = std::max(psel - 1, 0);
+  }
+}
+
+bool Set_dueling::use_b(uint32_t set) const {
+  if (is_leader_a(set)) {
+    return false;
+  }
+  if (is_leader_b(set)) {
+    return true;
+  }
+  return psel > (psel_max / 2);  // A misses more
+}
+
+/*********************************************************
+ *  Repl_rrip
+ *********************************************************/
+
+Repl_rrip::Repl_rrip(uint32_t s, uint32_t a, Mode m) : Cache_repl(s, a), mode(m), duel(s) {
+  rrpv.resize(static_cast<size_t>(sets) * assoc, RRPV_MAX);
+  brrip_cntr = 0;
+}
+
+uint8_t Repl_rrip::brrip_insert() {
+  brrip_cntr = (brrip_cntr + 1) % BRRIP_THROTTLE;
+  return brrip_cntr == 0 ? RRPV_MAX - 1 : RRPV_MAX;
+}
+
+void Repl_rrip::hit(uint32_t set, uint32_t way, uint64_t line_addr, uint64_t pc, bool prefetch) {
+  (void)line_addr;
+  (void)pc;
+  if (prefetch) {
+    return;  // prefetch hits do not promote
+  }
+  rrpv[pos(set, way)] = 0;
+}
+
+void Repl_rrip::fill(uint32_t set, uint32_t way, uint64_t line_addr, uint64_t pc, bool prefetch) {
+  (void)line_addr;
+  (void)pc;
+
+  uint8_t insert;
+  switch (mode) {
+    case Mode::SRRIP: insert = RRPV_MAX - 1; break;
+    case Mode::BRRIP: insert = brrip_insert(); break;
+    case Mode::DRRIP:
+    default:
+      duel.miss(set);
+      insert = duel.use_b(set) ? brrip_insert() : RRPV_MAX - 1;
+      break;
+  }
+  if (prefetch) {
+    insert = RRPV_MAX;
+  }
+
+  rrpv[pos(set, way)] = insert;
+}
+
+uint32_t Repl_rrip::victim(uint32_t set, uint64_t pc) {
+  (void)pc;
+  uint8_t *meta = &rrpv[pos(set, 0)];
+
+  uint8_t max = *std::max_element(meta, meta + assoc);
+  if (max < RRPV_MAX) {
+    for (uint32_t w = 0; w < assoc; w++) {
+      meta[w] += RRPV_MAX - max;
+    }
+  }
+  for (uint32_t w = 0; w < assoc; w++) {
+    if (meta[w] == RRPV_MAX) {
+      return w;
+    }
+  }
+  I(0);
+  return 0;
+}
+
+uint32_t Repl_rrip::victim_among(uint32_t set, uint64_t pc, uint64_t candidates) {
+  (void)pc;
+  I(candidates);
+
+  // The highest RRPV is the one victim() would reach after aging the set
+  uint32_t best = assoc;
+  for (uint32_t w = 0; w < assoc; w++) {
+    if ((candidates >> w & 1) && (best == assoc || rrpv[pos(set, w)] > rrpv[pos(set, best)])) {
+      best = w;
+    }
+  }
+
+  return best;
+}
+
+/*********************************************************
+ *  Repl_sampler
+ *********************************************************/
+
+Repl_sampler::Repl_sampler(uint32_t sets, uint32_t assoc, uint32_t nsampled)
+    : stride(std::max<uint32_t>(1, sets / std::max<uint32_t>(1, nsampled))), window(8 * assoc) {
+  uint32_t n = (sets + stride - 1) / stride;
+  clock.resize(n, 0);
+  history.resize(n);
+}
+
+void Repl_sampler::prune(uint32_t id) {
+  auto &h = history[id];
+  if (h.size() <= window) {
+    return;
+  }
+
+  uint64_t now = clock[id];
+  for (auto it = h.begin(); it != h.end();) {
+    if ((now - it->second.time) >= window) {
+      expired.emplace_back(it->second);
+      h.erase(it++);
+    } else {
+      ++it;
+    }
+  }
+}
+
+bool Repl_sampler::access(uint32_t set, uint64_t line_addr, uint16_t sig, uint64_t &now, Access &prev) {
+  I(is_sampled(set));
+  uint32_t id = get_id(set);
+
+  now = ++clock[id];
+
+  auto &h  = history[id];
+  auto  it = h.find(line_addr);
+  if (it == h.end()) {
+    h.emplace(line_addr, Access{now, sig});
+    prune(id);
+    return false;
+  }
+
+  prev       = it->second;
+  it->second = Access{now, sig};
+  if ((now - prev.time) >= window) {
+    expired.emplace_back(prev);
+    return false;
+  }
+
+  return true;
+}
+
+/*********************************************************
+ *  Repl_hawkeye
+ *********************************************************/
+
+Repl_hawkeye::Repl_hawkeye(uint32_t s, uint32_t a) : Cache_repl(s, a), sampler(s, a) {
+  rrpv.resize(static_cast<size_t>(sets) * assoc, RRPV_MAX);
+  line_sig.resize(static_cast<size_t>(sets) * assoc, 0);
+  pred.resize(PRED_SIZE, (PRED_MAX + 1) / 2);  // weakly friendly
+
+  occupancy.resize(sampler.get_nsampled());
+  for (auto &o : occupancy) {
+    o.resize(sampler.get_window(), 0);
+  }
+}
+
+uint16_t Repl_hawkeye::signature(uint64_t pc, bool prefetch) {
+  uint64_t h = (pc >> 2) ^ (pc >> 13) ^ (pc >> 24);
+  return (h & (PRED_SIZE / 2 - 1)) | (prefetch ? PRED_SIZE / 2 : 0);
+}
+
+void Repl_hawkeye::train(uint16_t sig, bool opt_hit) {
+  if (opt_hit) {
+    if (pred[sig] < PRED_MAX) {
+      pred[sig]++;
+    }
+  } else if (pred[sig] > 0) {
+    pred[sig]--;
+  }
+}
+
+void Repl_hawkeye::optgen(uint32_t set, uint64_t line_addr, uint16_t sig) {
+  if (!sampler.is_sampled(set)) {
+    return;
+  }
+
+  uint64_t             now;
+  Repl_sampler::Access prev;
+  auto                &occ    = occupancy[sampler.get_id(set)];
+  const uint32_t       window = sampler.get_window();
+
+  bool reuse        = sampler.access(set, line_addr, sig, now, prev);
+  occ[now % window] = 0;
+
+  if (reuse) {
+    bool opt_hit = true;
+    for (uint64_t t = prev.time; t < now; t++) {
+      if (occ[t % window] >= assoc) {
+        opt_hit = false;
+        break;
+      }
+    }
+    if (opt_hit) {
+      for (uint64_t t = prev.time; t < now; t++) {
+        occ[t % window]++;
+      }
+    }
+    train(prev.sig, opt_hit);
+  }
+
+  auto &expired = sampler.get_expired();
+  for (const auto &e : expired) {
+    train(e.sig, false);
+  }
+  expired.clear();
+}
+
+void Repl_hawkeye::update(uint32_t set, uint32_t way, uint16_t sig, bool fill) {
+  line_sig[pos(set, way)] = sig;
+
+  if (!is_friendly(sig)) {
+    rrpv[pos(set, way)] = RRPV_MAX;
+    return;
+  }
+
+  if (fill) {
+    for (uint32_t w = 0; w < assoc; w++) {
+      if (w != way && rrpv[pos(set, w)] < RRPV_MAX - 1) {
+        rrpv[pos(set, w)]++;
+      }
+    }
+  }
+  rrpv[pos(set, way)] = 0;
+}
+
+void Repl_hawkeye::hit(uint32_t set, uint32_t way, uint64_t line_addr, uint64_t pc, bool prefetch) {
+  uint16_t sig = signature(pc, prefetch);
+  optgen(set, line_addr, sig);
+  update(set, way, sig, false);
+}
+
+void Repl_hawkeye::fill(uint32_t set, uint32_t way, uint64_t line_addr, uint64_t pc, bool prefetch) {
+  uint16_t sig = signature(pc, prefetch);
+  optgen(set, line_addr, sig);
+  update(set, way, sig, true);
+}
+
+uint32_t Repl_hawkeye::victim(uint32_t set, uint64_t pc) {
+  (void)pc;
+
+  uint32_t best = 0;
+  for (uint32_t w = 0; w < assoc; w++) {
+    if (rrpv[pos(set, w)] == RRPV_MAX) {
+      return w;  // cache-averse line
+    }
+    if (rrpv[pos(set, w)] > rrpv[pos(set, best)]) {
+      best = w;
+    }
+  }
+
+  // Evicting a cache-friendly line: the predictor was wrong
+  train(line_sig[pos(set, best)], false);
+
+  return best;
+}
+
+uint32_t Repl_hawkeye::victim_among(uint32_t set, uint64_t pc, uint64_t candidates) {
+  (void)pc;
+  I(candidates);
+
+  uint32_t best = assoc;
+  for (uint32_t w = 0; w < assoc; w++) {
+    if ((candidates >> w & 1) && (best == assoc || rrpv[pos(set, w)] > rrpv[pos(set, best)])) {
+      best = w;
+    }
+  }
+
+  if (rrpv[pos(set, best)] != RRPV_MAX) {
+    train(line_sig[pos(set, best)], false);
+  }
+
+  return best;
+}
+
+/*********************************************************
+ *  Repl_mockingjay
+ *********************************************************/
+
+Repl_mockingjay::Repl_mockingjay(uint32_t s, uint32_t a) : Cache_repl(s, a), sampler(s, a) {
+  etr.resize(static_cast<size_t>(sets) * assoc, 0);
+  set_tick.resize(sets, 0);
+  rdp.resize(RDP_SIZE, -1);
+}
+
+uint16_t Repl_mockingjay::signature(uint64_t pc, bool prefetch) {
+  uint64_t h = (pc >> 2) ^ (pc >> 13) ^ (pc >> 24);
+  return (h & (RDP_SIZE / 2 - 1)) | (prefetch ? RDP_SIZE / 2 : 0);
+}
+
+int8_t Repl_mockingjay::predict(uint16_t sig) const {
+  const int32_t max_rd = sampler.get_window() / GRANULARITY;
+
+  if (rdp[sig] < 0) {
+    return static_cast<int8_t>(std::min<int32_t>(max_rd / 2, ETR_INF - 1));  // not trained
+  }
+  if (rdp[sig] > max_rd) {
+    return ETR_INF;
+  }
+  return static_cast<int8_t>(std::min<int32_t>(rdp[sig], ETR_INF - 1));
+}
+
+void Repl_mockingjay::train(int16_t &entry, int32_t distance) {
+  if (entry < 0) {
+    entry = distance;
+    return;
+  }
+  // Temporal difference update towards the observed distance
+  int32_t diff = distance - entry;
+  int32_t step = std::max<int32_t>(1, std::abs(diff) / 4);
+  if (diff > 0) {
+    entry = std::min<int32_t>(entry + step, distance);
+  } else if (diff < 0) {
+    entry = std::max<int32_t>(entry - step, distance);
+  }
+}
+
+void Repl_mockingjay::sample(uint32_t set, uint64_t line_addr, uint16_t sig) {
+  if (!sampler.is_sampled(set)) {
+    return;
+  }
+
+  const int32_t max_rd = sampler.get_window() / GRANULARITY;
+
+  uint64_t             now;
+  Repl_sampler::Access prev;
+  if (sampler.access(set, line_addr, sig, now, prev)) {
+    train(rdp[prev.sig], (now - prev.time) / GRANULARITY);
+  }
+
+  auto &expired = sampler.get_expired();
+  for (const auto &e : expired) {
+    train(rdp[e.sig], max_rd + 1);
+  }
+  expired.clear();
+}
+
+void Repl_mockingjay::age(uint32_t set) {
+  if (++set_tick[set] < GRANULARITY) {
+    return;
+  }
+  set_tick[set] = 0;
+
+  for (uint32_t w = 0; w < assoc; w++) {
+    int8_t &e = etr[pos(set, w)];
+    if (e > -ETR_INF && e != ETR_INF) {
+      e--;
+    }
+  }
+}
+
+void Repl_mockingjay::hit(uint32_t set, uint32_t way, uint64_t line_addr, uint64_t pc, bool prefetch) {
+  uint16_t sig = signature(pc, prefetch);
+  sample(set, line_addr, sig);
+  age(set);
+  etr[pos(set, way)] = predict(sig);
+}
+
+void Repl_mockingjay::fill(uint32_t set, uint32_t way, uint64_t line_addr, uint64_t pc, bool prefetch) {
+  uint16_t sig = signature(pc, prefetch);
+  sample(set, line_addr, sig);
+  age(set);
+  etr[pos(set, way)] = predict(sig);
+}
+
+uint32_t Repl_mockingjay::victim(uint32_t set, uint64_t pc) {
+  (void)pc;
+
+  // Furthest in the future, or overdue for the longest time
+  uint32_t best     = 0;
+  int32_t  best_abs = -1;
+  for (uint32_t w = 0; w < assoc; w++) {
+    int32_t a = std::abs(static_cast<int32_t>(etr[pos(set, w)]));
+    if (a > best_abs) {
+      best     = w;
+      best_abs = a;
+    }
+  }
+
+  return best;
+}
+
+uint32_t Repl_mockingjay::victim_among(uint32_t set, uint64_t pc, uint64_t candidates) {
+  (void)pc;
+  I(candidates);
+
+  uint32_t best     = 0;
+  int32_t  best_abs = -1;
+  for (uint32_t w = 0; w < assoc; w++) {
+    int32_t a = std::abs(static_cast<int32_t>(etr[pos(set, w)]));
+    if ((candidates >> w & 1) && a > best_abs) {
+      best     = w;
+      best_abs = a;
+    }
+  }
+
+  return best;
+}
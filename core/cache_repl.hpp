@@ -0,0 +1,187 @@
+// See LICENSE for details.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+
+// Replacement policies for CacheRepl. The cache never reorders its ways, and
+// each policy keeps its own per-set metadata arrays indexed by set*assoc+way.
+//
+// The cache handles invalid ways itself, so victim() is only called when all
+// the ways in the set are valid. victim_among() picks among the ways set in
+// the candidates mask (compressed caches evicting to make data room).
+
+inline constexpr std::string_view k_SRRIP      = "srrip";
+inline constexpr std::string_view k_BRRIP      = "brrip";
+inline constexpr std::string_view k_DRRIP      = "drrip";
+inline constexpr std::string_view k_HAWKEYE    = "hawkeye";
+inline constexpr std::string_view k_MOCKINGJAY = "mockingjay";
+
+class Cache_repl {
+protected:
+  const uint32_t sets;
+  const uint32_t assoc;
+
+  size_t pos(uint32_t set, uint32_t way) const { return static_cast<size_t>(set) * assoc + way; }
+
+public:
+  Cache_repl(uint32_t s, uint32_t a) : sets(s), assoc(a) {}
+  virtual ~Cache_repl() = default;
+
+  virtual void     hit(uint32_t set, uint32_t way, uint64_t line_addr, uint64_t pc, bool prefetch)  = 0;
+  virtual void     fill(uint32_t set, uint32_t way, uint64_t line_addr, uint64_t pc, bool prefetch) = 0;
+  virtual uint32_t victim(uint32_t set, uint64_t pc)                                                 = 0;
+  virtual uint32_t victim_among(uint32_t set, uint64_t pc, uint64_t candidates)                      = 0;
+
+  static bool                        is_policy(const std::string &name);
+  static std::unique_ptr<Cache_repl> create(const std::string &name, uint32_t sets, uint32_t assoc);
+};
+
+// Set dueling monitor: a few leader sets always use policy A or B, and the
+// misses in the leaders train a saturating PSEL counter used by the followers.
+class Set_dueling {
+private:
+  const uint32_t stride;
+  const int32_t  psel_max;
+  int32_t        psel;
+
+public:
+  Set_dueling(uint32_t sets, uint32_t nleaders = 32, uint32_t psel_bits = 10);
+
+  bool is_leader_a(uint32_t set) const { return (set % stride) == 0; }
+  bool is_leader_b(uint32_t set) const { return (set % stride) == (stride / 2); }
+
+  void miss(uint32_t set);
+  bool use_b(uint32_t set) const;  // true if the set should follow policy B
+
+  int32_t get_psel() const { return psel; }
+};
+
+class Repl_rrip : public Cache_repl {
+public:
+  enum class Mode { SRRIP, BRRIP, DRRIP };
+
+  static constexpr uint8_t RRPV_MAX       = 3;   // 2-bit RRPV
+  static constexpr uint8_t BRRIP_THROTTLE = 32;  // 1 in 32 BRRIP fills are long instead of distant
+
+protected:
+  const Mode           mode;
+  std::vector<uint8_t> rrpv;
+  Set_dueling          duel;
+  uint8_t              brrip_cntr;
+
+  uint8_t brrip_insert();
+
+public:
+  Repl_rrip(uint32_t s, uint32_t a, Mode m);
+
+  void     hit(uint32_t set, uint32_t way, uint64_t line_addr, uint64_t pc, bool prefetch) override;
+  void     fill(uint32_t set, uint32_t way, uint64_t line_addr, uint64_t pc, bool prefetch) override;
+  uint32_t victim(uint32_t set, uint64_t pc) override;
+  uint32_t victim_among(uint32_t set, uint64_t pc, uint64_t candidates) override;
+
+  uint8_t get_rrpv(uint32_t set, uint32_t way) const { return rrpv[pos(set, way)]; }
+  const Set_dueling &get_duel() const { return duel; }
+};
+
+// Sampled sets shared by Hawkeye (OPTgen) and Mockingjay (reuse distances).
+// Time is the number of accesses to the sampled set.
+class Repl_sampler {
+public:
+  struct Access {
+    uint64_t time;
+    uint16_t sig;
+  };
+
+protected:
+  const uint32_t stride;
+  const uint32_t window;  // accesses tracked per sampled set
+
+  std::vector<uint64_t>                               clock;
+  std::vector<absl::flat_hash_map<uint64_t, Access>> history;
+  std::vector<Access>                                 expired;
+
+  void prune(uint32_t id);
+
+public:
+  Repl_sampler(uint32_t sets, uint32_t assoc, uint32_t nsampled = 64);
+
+  bool     is_sampled(uint32_t set) const { return (set % stride) == 0; }
+  uint32_t get_id(uint32_t set) const { return set / stride; }
+  uint32_t get_nsampled() const { return clock.size(); }
+  uint32_t get_window() const { return window; }
+
+  // Records the access. Returns true (and the previous access) if line_addr
+  // was accessed within the window.
+  bool access(uint32_t set, uint64_t line_addr, uint16_t sig, uint64_t &now, Access &prev);
+
+  // Accesses that left the window without a reuse, drained by the policy
+  std::vector<Access> &get_expired() { return expired; }
+};
+
+class Repl_hawkeye : public Cache_repl {
+public:
+  static constexpr uint8_t  RRPV_MAX  = 7;  // 3-bit RRPV
+  static constexpr uint8_t  PRED_MAX  = 7;  // 3-bit PC counters
+  static constexpr uint32_t PRED_SIZE = 2048;
+
+protected:
+  std::vector<uint8_t>  rrpv;
+  std::vector<uint16_t> line_sig;
+  std::vector<uint8_t>  pred;
+
+  Repl_sampler                      sampler;
+  std::vector<std::vector<uint8_t>> occupancy;  // OPTgen occupancy vector per sampled set
+
+  static uint16_t signature(uint64_t pc, bool prefetch);
+  bool            is_friendly(uint16_t sig) const { return pred[sig] > (PRED_MAX / 2); }
+  void            train(uint16_t sig, bool opt_hit);
+  void            optgen(uint32_t set, uint64_t line_addr, uint16_t sig);
+  void            update(uint32_t set, uint32_t way, uint16_t sig, bool fill);
+
+public:
+  Repl_hawkeye(uint32_t s, uint32_t a);
+
+  void     hit(uint32_t set, uint32_t way, uint64_t line_addr, uint64_t pc, bool prefetch) override;
+  void     fill(uint32_t set, uint32_t way, uint64_t line_addr, uint64_t pc, bool prefetch) override;
+  uint32_t victim(uint32_t set, uint64_t pc) override;
+  uint32_t victim_among(uint32_t set, uint64_t pc, uint64_t candidates) override;
+
+  bool predict_friendly(uint64_t pc, bool prefetch = false) const { return is_friendly(signature(pc, prefetch)); }
+};
+
+class Repl_mockingjay : public Cache_repl {
+public:
+  static constexpr int8_t   ETR_INF     = 127;  // not expected to be reused
+  static constexpr uint32_t RDP_SIZE    = 2048;
+  static constexpr uint32_t GRANULARITY = 8;  // set accesses per ETR tick
+
+protected:
+  std::vector<int8_t>  etr;       // estimated time remaining per line
+  std::vector<uint8_t> set_tick;  // accesses since the last aging per set
+  std::vector<int16_t> rdp;       // reuse distance predictor, -1 if not trained
+
+  Repl_sampler sampler;
+
+  static uint16_t signature(uint64_t pc, bool prefetch);
+  int8_t          predict(uint16_t sig) const;
+  void            train(int16_t &entry, int32_t distance);
+  void            sample(uint32_t set, uint64_t line_addr, uint16_t sig);
+  void            age(uint32_t set);
+
+public:
+  Repl_mockingjay(uint32_t s, uint32_t a);
+
+  void     hit(uint32_t set, uint32_t way, uint64_t line_addr, uint64_t pc, bool prefetch) override;
+  void     fill(uint32_t set, uint32_t way, uint64_t line_addr, uint64_t pc, bool prefetch) override;
+  uint32_t victim(uint32_t set, uint64_t pc) override;
+  uint32_t victim_among(uint32_t set, uint64_t pc, uint64_t candidates) override;
+
+  int8_t get_etr(uint32_t set, uint32_t way) const { return etr[pos(set, way)]; }
+};
@@ -0,0 +1,146 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include "cache_repl.hpp"
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+class Cache_repl_test : public ::testing::Test {
+protected:
+  static constexpr uint32_t sets  = 64;
+  static constexpr uint32_t assoc = 4;
+
+  // Fills all the ways in set with consecutive lines
+  void fill_set(Cache_repl &repl, uint32_t set, uint64_t pc) {
+    for (uint32_t w = 0; w < assoc; w++) {
+      repl.fill(set, w, (set + sets * w), pc, false);
+    }
+  }
+};
+
+TEST_F(Cache_repl_test, create) {
+  for (const auto &name : {"srrip", "brrip", "drrip", "hawkeye", "mockingjay"}) {
+    EXPECT_TRUE(Cache_repl::is_policy(name));
+    EXPECT_NE(Cache_repl::create(name, sets, assoc), nullptr);
+  }
+  EXPECT_FALSE(Cache_repl::is_policy("lru"));
+  EXPECT_EQ(Cache_repl::create("lru", sets, assoc), nullptr);
+}
+
+TEST_F(Cache_repl_test, srrip_hit_protects) {
+  Repl_rrip repl(sets, assoc, Repl_rrip::Mode::SRRIP);
+  fill_set(repl, 3, 0x400);
+
+  repl.hit(3, 2, 3 + sets * 2, 0x400, false);
+  EXPECT_EQ(repl.get_rrpv(3, 2), 0);
+
+  for (int i = 0; i < 3; i++) {
+    uint32_t way = repl.victim(3, 0x400);
+    EXPECT_NE(way, 2);
+    repl.fill(3, way, 1000 + i, 0x400, false);
+  }
+}
+
+TEST_F(Cache_repl_test, dueling) {
+  Set_dueling duel(sets);
+
+  uint32_t leader_a = 0;
+  uint32_t leader_b = 0;
+  uint32_t follower = 0;
+  for (uint32_t s = 0; s < sets; s++) {
+    if (duel.is_leader_a(s)) {
+      leader_a = s;
+    } else if (duel.is_leader_b(s)) {
+      leader_b = s;
+    } else {
+      follower = s;
+    }
+  }
+
+  EXPECT_FALSE(duel.use_b(leader_a));
+  EXPECT_TRUE(duel.use_b(leader_b));
+
+  for (int i = 0; i < 100; i++) {
+    duel.miss(leader_a);
+  }
+  EXPECT_TRUE(duel.use_b(follower));
+
+  for (int i = 0; i < 200; i++) {
+    duel.miss(leader_b);
+  }
+  EXPECT_FALSE(duel.use_b(follower));
+}
+
+TEST_F(Cache_repl_test, hawkeye_learns) {
+  Repl_hawkeye repl(sets, assoc);
+
+  const uint64_t stream_pc = 0x1000;
+  const uint64_t reuse_pc  = 0x2040;
+
+  // Set 0 is sampled. Streaming PC never reuses, the other PC reuses 2 lines.
+  uint64_t addr = 1 << 20;
+  for (int i = 0; i < 2000; i++) {
+    repl.fill(0, 0, addr++, stream_pc, false);
+    repl.hit(0, 1, 7, reuse_pc, false);
+    repl.hit(0, 2, 9, reuse_pc, false);
+  }
+
+  EXPECT_FALSE(repl.predict_friendly(stream_pc));
+  EXPECT_TRUE(repl.predict_friendly(reuse_pc));
+
+  // Averse lines are evicted first
+  repl.fill(5, 0, 5, reuse_pc, false);
+  repl.fill(5, 1, 5 + sets, stream_pc, false);
+  repl.fill(5, 2, 5 + 2 * sets, reuse_pc, false);
+  repl.fill(5, 3, 5 + 3 * sets, reuse_pc, false);
+  EXPECT_EQ(repl.victim(5, reuse_pc), 1);
+}
+
+TEST_F(Cache_repl_test, mockingjay_evicts_scan) {
+  Repl_mockingjay repl(sets, assoc);
+
+  const uint64_t stream_pc = 0x1000;
+  const uint64_t reuse_pc  = 0x2040;
+
+  uint64_t addr = 1 << 20;
+  for (int i = 0; i < 2000; i++) {
+    repl.fill(0, 0, addr++, stream_pc, false);
+    repl.hit(0, 1, 7, reuse_pc, false);
+  }
+
+  repl.fill(9, 0, 9, reuse_pc, false);
+  repl.fill(9, 1, 9 + sets, reuse_pc, false);
+  repl.fill(9, 2, 9 + 2 * sets, stream_pc, false);
+  repl.fill(9, 3, 9 + 3 * sets, reuse_pc, false);
+
+  EXPECT_EQ(repl.get_etr(9, 2), Repl_mockingjay::ETR_INF);
+  EXPECT_EQ(repl.victim(9, reuse_pc), 2);
+}
+
+// Compressed caches evict among some ways only, with the policy order
+TEST_F(Cache_repl_test, victim_among) {
+  Repl_rrip rrip(sets, assoc, Repl_rrip::Mode::SRRIP);
+  fill_set(rrip, 5, 0x400);
+  rrip.hit(5, 0, 5, 0x400, false);
+  rrip.hit(5, 1, 5 + sets, 0x400, false);
+  EXPECT_EQ(rrip.victim_among(5, 0x400, 0b0011), 0);  // both recent, first one
+  EXPECT_EQ(rrip.victim_among(5, 0x400, 0b0110), 2);
+  EXPECT_EQ(rrip.victim_among(5, 0x400, 0b1000), 3);
+  EXPECT_EQ(rrip.get_rrpv(5, 0), 0);  // no aging
+
+  Repl_mockingjay mj(sets, assoc);
+  fill_set(mj, 5, 0x400);
+  for (uint64_t c : {0b0001, 0b0100, 0b1010}) {
+    uint32_t w = mj.victim_among(5, 0x400, c);
+    EXPECT_TRUE(c >> w & 1);
+  }
+
+  Repl_hawkeye hk(sets, assoc);
+  fill_set(hk, 5, 0x400);
+  for (uint64_t c : {0b0010, 0b1100}) {
+    uint32_t w = hk.victim_among(5, 0x400, c);
+    EXPECT_TRUE(c >> w & 1);
+  }
+}
@@ -9,24 +9,17 @@
 #include <string>
 #include <string_view>
 
+#include "cache_repl.hpp"
 #include "config.hpp"
 #include "iassert.hpp"
 #include "snippets.hpp"
 #include "stats.hpp"
 
-//-------------------------------------------------------------
-#define RRIP_M 4  // max value = 2^M   | 4 | 8   | 16   |
-//-------------------------------------------------------------
-#define DISTANT_REF  3  // 2^M - 1           | 3 | 7   | 15  |
-#define IMM_REF      1  // nearimm<imm<dist  | 1 | 1-6 | 1-14|
-#define NEAR_IMM_REF 0  // 0                 | 0 | 0   | 0   |
-#define LONG_REF     1  // 2^M - 2           | 1 | 6   | 14  |
-//-------------------------------------------------------------
+inline constexpr uint8_t RRIP_M        = 4;   // SHIP RRPV values [0..RRIP_M-1]
+inline constexpr uint8_t RRIP_MAX      = 15;  // PAR/UAR
+inline constexpr uint8_t RRIP_PREF_MAX = 2;
 
-enum ReplacementPolicy { LRU, LRUp, RANDOM, SHIP, PAR, UAR, HAWKEYE };  // SHIP is RRIP with SHIP (ISCA 2010)
-
-#define RRIP_MAX      15
-#define RRIP_PREF_MAX 2
+enum ReplacementPolicy { LRU, LRUp, RANDOM, SHIP, PAR, UAR };  // SHIP is RRIP with SHIP (ISCA 2010)
 
 template <class State, class Addr_t>
 class CacheGeneric {
@@ -70,9 +63,8 @@ protected:
 public:
   class CacheLine : public State {
   public:
-    bool    recent;  // used by skew cache
-    uint8_t rrip;    // used by hawkeye and PAR
-    CacheLine(int32_t lineSize) : State(lineSize) {}
+    uint8_t nSegments;  // used by compressed caches (data segments used by the line)
+    CacheLine(int32_t lineSize) : State(lineSize) { nSegments = 0; }
     // Pure virtual class defines interface
     //
     // Tag included in state. Accessed through:
@@ -121,6 +113,12 @@ public:
 
   virtual CacheLine *findLine2Replace(Addr_t addr, Addr_t pc, bool prefetch) = 0;
 
+  // Data array way of a line (0 for direct mapped caches)
+  virtual uint32_t getWay(const CacheLine *l) const {
+    (void)l;
+    return 0;
+  }
+
   // TO DELETE if flush from Cache.cpp is cleared.  At least it should have a
   // cleaner interface so that Cache.cpp does not touch the internals.
   //
@@ -261,68 +259,43 @@ public:
   }
 
   Addr_t calcAddr4Tag(Addr_t tag) const { return (tag << log2AddrLs); }
-};
-
-template <class State, class Addr_t>
-class HawkCache : public CacheGeneric<State, Addr_t> {
-  using CacheGeneric<State, Addr_t>::numLines;
-  using CacheGeneric<State, Addr_t>::assoc;
-  using CacheGeneric<State, Addr_t>::maskAssoc;
-  using CacheGeneric<State, Addr_t>::goodInterface;
-
-private:
-public:
-  typedef typename CacheGeneric<State, Addr_t>::CacheLine Line;
 
-protected:
-  std::vector<Line> mem;
-  Line            **content;
-  uint16_t          irand;
-  ReplacementPolicy policy;
-  // hawkeye
-  std::vector<uint8_t> prediction;
-  uint32_t             predictionMask;
-
-  std::vector<uint8_t> usageInterval;
-  uint32_t             usageIntervalMask;
-
-  std::vector<uint8_t> occupancyVector;
-  size_t               trackedAddresses_ptr;
-  std::vector<Addr_t>  trackedAddresses;
-
-  int occVectIterator;
-
-  int getUsageIntervalHash(Addr_t addr) const {
-    addr = addr >> CacheGeneric<State, Addr_t>::log2AddrLs;  // Drop lower bits (line size)
-    addr = (addr >> 5) ^ (addr);
-    return addr & (numLines - 1);
+  // Compressed caches have more tags than data. Each valid line uses
+  // nSegments of the data array segments shared by the set.
+  uint32_t getSetSegments(Addr_t addr) {
+    Addr_t   index = calcIndex4Tag(calcTag(addr));
+    uint32_t n     = 0;
+    for (uint32_t i = 0; i < assoc; i++) {
+      CacheLine *l = getPLine(index + i);
+      if (l->isValid()) {
+        n += l->nSegments;
+      }
+    }
+    return n;
   }
 
-  int getPredictionHash(Addr_t pc) const {
-    pc = pc >> 2;  // psudo-PC works, no need lower 2 bit
-
-    pc = (pc >> 17) ^ (pc);
-
-    return pc & predictionMask;
-  };
-
-  friend class CacheGeneric<State, Addr_t>;
-  HawkCache(int32_t size, int32_t assoc, int32_t blksize, int32_t addrUnit, const std::string &pStr, bool xr);
-
-  Line *findLineNoEffectPrivate(Addr_t addr);
-  Line *findLinePrivate(Addr_t addr, Addr_t pc = 0);
-
-public:
-  virtual ~HawkCache() { delete[] content; }
-
-  // TODO: do an iterator. not this junk!!
-  Line *getPLine(uint32_t l) {
-    // Lines [l..l+assoc] belong to the same set
-    I(l < numLines);
-    return content[l];
+  uint32_t getSetValidLines(Addr_t addr) {
+    Addr_t   index = calcIndex4Tag(calcTag(addr));
+    uint32_t n     = 0;
+    for (uint32_t i = 0; i < assoc; i++) {
+      n += getPLine(index + i)->isValid() ? 1 : 0;
+    }
+    return n;
+  }
+
+  // Valid line (not keep) to evict when the set runs out of data segments.
+  // The caches that keep the MRU in the first position pick the last valid
+  // line, CacheRepl asks its policy.
+  virtual CacheLine *findLine2Compact(Addr_t addr, const CacheLine *keep) {
+    Addr_t index = calcIndex4Tag(calcTag(addr));
+    for (int32_t i = assoc - 1; i >= 0; i--) {
+      CacheLine *l = getPLine(index + i);
+      if (l != keep && l->isValid()) {
+        return l;
+      }
+    }
+    return nullptr;
   }
-
-  Line *findLine2Replace(Addr_t addr, Addr_t pc, bool prefetch);
 };
 
 template <class State, class Addr_t>
@@ -357,6 +330,10 @@ protected:
   uint16_t          irand;
   ReplacementPolicy policy;
 
+  std::vector<uint8_t> rrip;  // PAR/UAR per line (indexed like mem)
+
+  uint8_t &rripOf(const Line *l) { return rrip[l - mem.data()]; }
+
   struct Tracker {
     int demand_trend;
     int conf;
@@ -389,25 +366,25 @@ protected:
   CacheAssoc(int32_t size, int32_t assoc, int32_t blksize, int32_t addrUnit, const std::string &pStr, bool xr);
 
   void adjustRRIP(Line **theSet, Line **setEnd, Line *change_line, uint16_t next_rrip) {
-    if ((change_line)->rrip == next_rrip) {
+    if (rripOf(change_line) == next_rrip) {
       return;
     }
 
-    if ((change_line)->rrip > next_rrip) {
-      change_line->rrip = next_rrip;
+    if (rripOf(change_line) > next_rrip) {
+      rripOf(change_line) = next_rrip;
       Line **l          = setEnd - 1;
       while (l >= theSet) {
-        if ((*l)->rrip < change_line->rrip && (*l)->rrip >= next_rrip) {
-          (*l)->rrip++;
+        if (rripOf(*l) < rripOf(change_line) && rripOf(*l) >= next_rrip) {
+          rripOf(*l)++;
         }
         l--;
       }
     } else {
-      change_line->rrip = next_rrip;
+      rripOf(change_line) = next_rrip;
       Line **l          = setEnd - 1;
       while (l >= theSet) {
-        if ((*l)->rrip > change_line->rrip && (*l)->rrip <= next_rrip) {
-          (*l)->rrip--;
+        if (rripOf(*l) > rripOf(change_line) && rripOf(*l) <= next_rrip) {
+          rripOf(*l)--;
         }
         l--;
       }
@@ -427,9 +404,60 @@ public:
     return content[l];
   }
 
+  // Lines are reordered through content, mem keeps the data array position
+  uint32_t getWay(const Line *l) const { return (l - mem.data()) & maskAssoc; }
+
   Line *findLine2Replace(Addr_t addr, Addr_t pc, bool prefetch);
 };
 
+// Set associative cache with a pluggable replacement policy (Cache_repl).
+// Ways are not reordered, the policy keeps the per-set metadata.
+template <class State, class Addr_t>
+class CacheRepl : public CacheGeneric<State, Addr_t> {
+  using CacheGeneric<State, Addr_t>::numLines;
+  using CacheGeneric<State, Addr_t>::assoc;
+  using CacheGeneric<State, Addr_t>::log2Assoc;
+  using CacheGeneric<State, Addr_t>::goodInterface;
+
+private:
+public:
+  typedef typename CacheGeneric<State, Addr_t>::CacheLine Line;
+
+protected:
+  std::vector<Line>           mem;
+  Line                      **content;
+  std::unique_ptr<Cache_repl> policy;
+
+  friend class CacheGeneric<State, Addr_t>;
+  CacheRepl(int32_t size, int32_t assoc, int32_t blksize, int32_t addrUnit, const std::string &pStr, bool xr);
+
+  int32_t findWay(Addr_t index, Addr_t tag) const {
+    for (uint32_t w = 0; w < assoc; w++) {
+      if (content[index + w]->getTag() == tag) {
+        return w;
+      }
+    }
+    return -1;
+  }
+
+  Line *findLineNoEffectPrivate(Addr_t addr);
+  Line *findLinePrivate(Addr_t addr, Addr_t pc = 0);
+
+public:
+  virtual ~CacheRepl() { delete[] content; }
+
+  Line *getPLine(uint32_t l) {
+    // Lines [l..l+assoc] belong to the same set
+    I(l < numLines);
+    return content[l];
+  }
+
+  uint32_t getWay(const Line *l) const { return (l - mem.data()) & (assoc - 1); }
+
+  Line *findLine2Replace(Addr_t addr, Addr_t pc, bool prefetch);
+  Line *findLine2Compact(Addr_t addr, const Line *keep);
+};
+
 template <class State, class Addr_t>
 class CacheDM : public CacheGeneric<State, Addr_t> {
   using CacheGeneric<State, Addr_t>::numLines;
@@ -472,8 +500,11 @@ public:
   typedef typename CacheGeneric<State, Addr_t>::CacheLine Line;
 
 protected:
-  std::vector<Line> mem;
-  Line            **content;
+  std::vector<Line>    mem;
+  Line               **content;
+  std::vector<uint8_t> recent;  // per line (indexed like mem)
+
+  uint8_t &recentOf(const Line *l) { return recent[l - mem.data()]; }
 
   friend class CacheGeneric<State, Addr_t>;
   CacheDMSkew(int32_t size, int32_t blksize, int32_t addrUnit, const std::string &pStr);
@@ -536,6 +567,8 @@ public:
     return content[l];
   }
 
+  uint32_t getWay(const Line *l) const { return (l - mem.data()) & maskAssoc; }
+
   Line *findLine2Replace(Addr_t addr, Addr_t pc, bool prefetch);
 };
 
@@ -675,7 +708,6 @@ inline constexpr std::string_view k_RANDOM  = "random";
 inline constexpr std::string_view k_LRU     = "lru";
 inline constexpr std::string_view k_LRUp    = "lrup";
 inline constexpr std::string_view k_SHIP    = "ship";
-inline constexpr std::string_view k_HAWKEYE = "hawkeye";
 inline constexpr std::string_view k_PAR     = "par";
 inline constexpr std::string_view k_UAR     = "uar";
 
@@ -712,16 +744,16 @@ CacheGeneric<State, Addr_t> *CacheGeneric<State, Addr_t>::create(int32_t size, i
     // FA
     if (pStr_lc == k_SHIP) {
       cache = new CacheSHIP<State, Addr_t>(size, assoc, bsize, addrUnit, pStr_lc, shct_size);
-    } else if (pStr_lc == k_HAWKEYE) {
-      cache = new HawkCache<State, Addr_t>(size, assoc, bsize, addrUnit, pStr_lc, xr);
+    } else if (Cache_repl::is_policy(pStr_lc)) {
+      cache = new CacheRepl<State, Addr_t>(size, assoc, bsize, addrUnit, pStr_lc, xr);
     } else {
       cache = new CacheAssoc<State, Addr_t>(size, assoc, bsize, addrUnit, pStr_lc, xr);
     }
   } else {
     if (pStr_lc == k_SHIP) {
       cache = new CacheSHIP<State, Addr_t>(size, assoc, bsize, addrUnit, pStr_lc, shct_size);
-    } else if (pStr_lc == k_HAWKEYE) {
-      cache = new HawkCache<State, Addr_t>(size, assoc, bsize, addrUnit, pStr_lc, xr);
+    } else if (Cache_repl::is_policy(pStr_lc)) {
+      cache = new CacheRepl<State, Addr_t>(size, assoc, bsize, addrUnit, pStr_lc, xr);
     } else {
       cache = new CacheAssoc<State, Addr_t>(size, assoc, bsize, addrUnit, pStr_lc, xr);
     }
@@ -779,6 +811,8 @@ CacheGeneric<State, Addr_t> *CacheGeneric<State, Addr_t>::create(const std::stri
   auto skew_sec        = fmt::format("{}skew", fmt_append);
   auto xor_sec         = fmt::format("{}xor", fmt_append);
   auto ship_sec        = fmt::format("{}ship_sign_bits", fmt_append);
+  auto compress_sec    = fmt::format("{}compression", fmt_append);
+  auto tag_ratio_sec   = fmt::format("{}compression_tag_ratio", fmt_append);
 
   int32_t s  = Config::get_power2(section, size_sec);
   int32_t a  = Config::get_power2(section, assoc_sec);
@@ -802,9 +836,13 @@ CacheGeneric<State, Addr_t> *CacheGeneric<State, Addr_t>::create(const std::stri
                                       std::string(k_LRU),
                                       std::string(k_SHIP),
                                       std::string(k_LRUp),
-                                      std::string(k_HAWKEYE),
                                       std::string(k_PAR),
-                                      std::string(k_UAR)};
+                                      std::string(k_UAR),
+                                      std::string(k_SRRIP),
+                                      std::string(k_BRRIP),
+                                      std::string(k_DRRIP),
+                                      std::string(k_HAWKEYE),
+                                      std::string(k_MOCKINGJAY)};
   auto                     pStr_lc = Config::get_string(section, repl_policy_sec, allowed);
 
   // SHIP
@@ -813,6 +851,17 @@ CacheGeneric<State, Addr_t> *CacheGeneric<State, Addr_t>::create(const std::stri
     shct_size = Config::get_integer(section, ship_sec);
   }
 
+  // Compressed caches keep size as the data capacity, and add tags (ways)
+  // with the same number of sets
+  if (Config::has_entry(section, compress_sec) && Config::get_string(section, compress_sec) != "none") {
+    int32_t tag_ratio = 2;
+    if (Config::has_entry(section, tag_ratio_sec)) {
+      tag_ratio = Config::get_power2(section, tag_ratio_sec, 1, 8);
+    }
+    s *= tag_ratio;
+    a *= tag_ratio;
+  }
+
   if (Config::has_errors()) {
     cache = new CacheAssoc<State, Addr_t>(2, 1, 1, 1, pStr_lc, xr);
   } else {
@@ -849,8 +898,6 @@ CacheAssoc<State, Addr_t>::CacheAssoc(int32_t size, int32_t assoc, int32_t blksi
     policy = PAR;
   } else if (pStr_lc == k_UAR) {
     policy = UAR;
-  } else if (pStr_lc == k_HAWKEYE) {
-    Config::add_error(fmt::format("Invalid cache policy. HawkCache should be used [{}]", pStr_lc));
   } else {
     Config::add_error(fmt::format("Invalid cache policy [{}]", pStr_lc));
   }
@@ -858,9 +905,9 @@ CacheAssoc<State, Addr_t>::CacheAssoc(int32_t size, int32_t assoc, int32_t blksi
   Line zero_line(blksize);
   zero_line.initialize(this);
   zero_line.invalidate();
-  zero_line.rrip = 0;
 
   mem.resize(numLines + 1, zero_line);
+  rrip.resize(numLines + 1, 0);
   content = new Line *[numLines + 1];
 
   for (uint32_t i = 0; i < numLines; i++) {
@@ -916,10 +963,10 @@ typename CacheAssoc<State, Addr_t>::Line *CacheAssoc<State, Addr_t>::findLinePri
     // JustDirectory can break this I((*theSet)->isValid());
 
     if (policy == PAR || policy == UAR) {
-      uint16_t next_rrip = (*theSet)->rrip;
+      uint16_t next_rrip = rripOf(*theSet);
       if (tag) {
         next_rrip = RRIP_MAX;
-      } else if ((*theSet)->rrip < RRIP_PREF_MAX) {
+      } else if (rripOf(*theSet) < RRIP_PREF_MAX) {
         next_rrip = RRIP_PREF_MAX;
       }
       if (policy == UAR) {
@@ -971,10 +1018,10 @@ typename CacheAssoc<State, Addr_t>::Line *CacheAssoc<State, Addr_t>::findLinePri
     *theSet = tmp;
   }
 
-  uint16_t next_rrip = tmp->rrip;
+  uint16_t next_rrip = rripOf(tmp);
   if (tag) {
     next_rrip = RRIP_MAX;
-  } else if ((tmp)->rrip < RRIP_PREF_MAX) {
+  } else if (rripOf(tmp) < RRIP_PREF_MAX) {
     next_rrip = RRIP_PREF_MAX;
   }
   if (policy == UAR) {
@@ -994,7 +1041,7 @@ typename CacheAssoc<State, Addr_t>::Line *CacheAssoc<State, Addr_t>::findLinePri
     Line **l = setEnd -1;
     int conta = 0;
     while(l >= theSet) {
-      printf(" %d:%d", conta,(*l)->rrip);
+      printf(" %d:%d", conta,rripOf(*l));
       l--;
       conta++;
     }
@@ -1024,10 +1071,10 @@ typename CacheAssoc<State, Addr_t>::Line *CacheAssoc<State, Addr_t>::findLine2Re
         I(tag == 0);
       }
 
-      uint16_t next_rrip = (*theSet)->rrip;
+      uint16_t next_rrip = rripOf(*theSet);
       if (tag) {
         next_rrip = RRIP_MAX;
-      } else if ((*theSet)->rrip < RRIP_PREF_MAX) {
+      } else if (rripOf(*theSet) < RRIP_PREF_MAX) {
         if (prefetch) {
           next_rrip = RRIP_PREF_MAX;
         } else {
@@ -1055,9 +1102,9 @@ typename CacheAssoc<State, Addr_t>::Line *CacheAssoc<State, Addr_t>::findLine2Re
         lineFree = l;
       } else if (lineFree == 0) {
         lineFree = l;
-      } else if ((*l)->rrip < (*lineFree)->rrip) {  // == too to add a bit of LRU order between same RIPs
+      } else if (rripOf(*l) < rripOf(*lineFree)) {  // == too to add a bit of LRU order between same RIPs
         lineFree = l;
-      } else if (policy == UAR && ((*l)->rrip == (*lineFree)->rrip)) {
+      } else if (policy == UAR && (rripOf(*l) == rripOf(*lineFree))) {
         if (pc2tracker[(*l)->getPC()].demand_trend < pc2tracker[(*lineFree)->getPC()].demand_trend) {
           lineFree = l;
         }
@@ -1164,7 +1211,7 @@ typename CacheAssoc<State, Addr_t>::Line *CacheAssoc<State, Addr_t>::findLine2Re
     *theSet = tmp;
   }
 
-  // tmp->rrip = RRIP_MAX;
+  // rripOf(tmp) = RRIP_MAX;
 
 #if 0
   if (policy == UAR) {
@@ -1172,7 +1219,7 @@ typename CacheAssoc<State, Addr_t>::Line *CacheAssoc<State, Addr_t>::findLine2Re
     Line **l = setEnd -1;
     int conta = 0;
     while(l >= theSet) {
-      printf(" %d:%d", conta,(*l)->rrip);
+      printf(" %d:%d", conta,rripOf(*l));
       l--;
       conta++;
     }
@@ -1183,20 +1230,18 @@ typename CacheAssoc<State, Addr_t>::Line *CacheAssoc<State, Addr_t>::findLine2Re
   return tmp;
 }
 /*********************************************************
- *  HawkCache
+ *  CacheRepl
  *********************************************************/
 
 template <class State, class Addr_t>
-HawkCache<State, Addr_t>::HawkCache(int32_t size, int32_t assoc, int32_t blksize, int32_t addrUnit, const std::string &pStr,
+CacheRepl<State, Addr_t>::CacheRepl(int32_t size, int32_t assoc, int32_t blksize, int32_t addrUnit, const std::string &pStr,
                                     bool xr)
     : CacheGeneric<State, Addr_t>(size, assoc, blksize, addrUnit, xr) {
   I(numLines > 0);
 
-  std::string pStr_lc{pStr};
-  std::transform(pStr_lc.begin(), pStr_lc.end(), pStr_lc.begin(), [](unsigned char c) { return std::tolower(c); });
-
-  if (pStr_lc != k_HAWKEYE) {
-    Config::add_error(fmt::format("Invalid cache policy. Cache should be used [{}]", pStr_lc));
+  policy = Cache_repl::create(pStr, this->sets, assoc);
+  if (!policy) {
+    Config::add_error(fmt::format("Invalid cache policy [{}]", pStr));
   }
 
   Line zero_line(blksize);
@@ -1209,269 +1254,84 @@ HawkCache<State, Addr_t>::HawkCache(int32_t size, int32_t assoc, int32_t blksize
   for (uint32_t i = 0; i < numLines; i++) {
     content[i] = &mem[i];
   }
-
-  irand = 0;
-
-  // hawkeye
-  prediction.resize(512);
-  predictionMask = prediction.size() - 1;
-
-  usageInterval.resize(8192);
-  usageIntervalMask = usageInterval.size() - 1;
-
-  trackedAddresses.resize(8192);
-  trackedAddresses_ptr = 0;
-
-  occupancyVector.resize(8192);
-  occVectIterator = 0;
 }
 
 template <class State, class Addr_t>
-typename HawkCache<State, Addr_t>::Line *HawkCache<State, Addr_t>::findLineNoEffectPrivate(Addr_t addr) {
-  Addr_t tag = this->calcTag(addr);
-
-  Line **theSet = &content[this->calcIndex4Tag(tag)];
-
-  // Check most typical case
-  if ((*theSet)->getTag() == tag) {
-    // JustDirectory can break this I((*theSet)->isValid());
-    return *theSet;
-  }
-
-  Line **lineHit = 0;
-  Line **setEnd  = theSet + assoc;
-
-  // For sure that position 0 is not (short-cut)
-  {
-    Line **l = theSet + 1;
-    while (l < setEnd) {
-      if ((*l)->getTag() == tag) {
-        lineHit = l;
-        break;
-      }
-      l++;
-    }
-  }
+typename CacheRepl<State, Addr_t>::Line *CacheRepl<State, Addr_t>::findLineNoEffectPrivate(Addr_t addr) {
+  Addr_t tag   = this->calcTag(addr);
+  Addr_t index = this->calcIndex4Tag(tag);
 
-  if (lineHit == 0) {
+  int32_t way = findWay(index, tag);
+  if (way < 0) {
     return 0;
   }
 
-  return *lineHit;
+  return content[index + way];
 }
 
 template <class State, class Addr_t>
-typename HawkCache<State, Addr_t>::Line *HawkCache<State, Addr_t>::findLinePrivate(Addr_t addr, Addr_t pc) {
-  Addr_t tag = this->calcTag(addr);
-
-  Line **theSet = &content[this->calcIndex4Tag(tag)];
-
-  // Check most typical case
-  if ((*theSet)->getTag() == tag) {
-    // JustDirectory can break this I((*theSet)->isValid());
-    return *theSet;
-  }
-
-  Line **lineHit = 0;
-  Line **setEnd  = theSet + assoc;
-
-  // For sure that position 0 is not (short-cut)
-  {
-    Line **l = theSet + 1;
-    while (l < setEnd) {
-      if ((*l)->getTag() == tag) {
-        lineHit = l;
-        break;
-      }
-      l++;
-    }
-  }
+typename CacheRepl<State, Addr_t>::Line *CacheRepl<State, Addr_t>::findLinePrivate(Addr_t addr, Addr_t pc) {
+  Addr_t tag   = this->calcTag(addr);
+  Addr_t index = this->calcIndex4Tag(tag);
 
-  // hawkeye
-  uint8_t OPToutcome  = 0;
-  uint8_t missFlag    = 0;
-  int     occVectSize = 8192;
-  int     trAddSize   = 8192;
-  int     curAddr     = 0;
-
-  int hashAddr = getUsageIntervalHash(addr);
-
-  int predHPC = getPredictionHash(pc);
-
-  // OPTgen -----------------
-  occVectIterator++;
-  if (occVectIterator >= occVectSize) {
-    occVectIterator = 0;
-    for (int i = 0; i < occVectSize; i++) {
-      occupancyVector[i] = 0;
-    }
-  }
-  for (int i = 0; i < trAddSize; i++) {  // Update usage interval for all tracked addresses
-    if (trackedAddresses[i] == 0) {
-      continue;
-    }
-    if (trackedAddresses[i] == tag) {
-      curAddr = i;
-    }
-
-    if (usageInterval[getUsageIntervalHash(trackedAddresses[i])] < 255) {
-      usageInterval[getUsageIntervalHash(trackedAddresses[i])]++;
-    }
-  }
-
-  if (usageInterval[hashAddr] > 0) {  // Address has been loaded before
-    int limit = occVectIterator - usageInterval[hashAddr];
-    if (limit < 0) {
-      limit = 0;
-    } else if (limit >= occVectSize) {
-      limit = occVectSize - 1;
-    }
-    for (int i = limit; i < occVectIterator; i++) {
-      if (occupancyVector[i] >= numLines) {
-        missFlag = 1;
-        break;  // If cache is full during usage interval, then it will miss
-      }
-    }
-
-    // If it doesn't miss, increase occupancy vector during liveness interval
-    if (missFlag != 1) {
-      for (int i = limit; i < occVectIterator; i++) {
-        if (occupancyVector[i] < 255) {
-          occupancyVector[i]++;
-        }
-      }
-      usageInterval[hashAddr]   = 0;
-      trackedAddresses[curAddr] = 0;
-    }
-  } else {  // Current address hasn't been loaded yet
-    usageInterval[hashAddr] = 1;
-
-    // Start tracking current address;
-    bool found = false;
-    for (int i = 0; i < trAddSize; i++) {
-      if (trackedAddresses[i] == tag || trackedAddresses[i] == 0) {
-        found               = true;
-        trackedAddresses[i] = tag;
-        break;
-      }
-    }
-    if (!found) {
-      trackedAddresses[trackedAddresses_ptr++] = tag;
-      if (trackedAddresses_ptr >= trackedAddresses.size()) {
-        trackedAddresses_ptr = 0;
-      }
-    }
-  }
-
-  // 0 means it predicts a miss, 1 means it predicts a hit
-  if (missFlag == 1) {
-    OPToutcome = 0;
-  } else {
-    OPToutcome = 1;
-  }
-
-  // Hawkeye prediction ---------------
-  if (OPToutcome == 1) {
-    if (prediction[predHPC] < 7) {
-      prediction[predHPC]++;
-    }
-  } else {
-    if (prediction[predHPC] > 0) {
-      prediction[predHPC]--;
-    }
-  }
-
-  // A prediction of 0 is cache-averse, 1 is friendly
-  uint8_t hawkPrediction = prediction[predHPC] >> 2;
-
-  if (lineHit == 0) {
-    if (hawkPrediction == 1) {  // if predict friendly and cache miss, age all lines;
-      Line **l = theSet + 1;
-      while (l < setEnd) {
-        if ((*l)->isValid() && (*l)->rrip < 6) {
-          (*l)->rrip++;
-        }
-        l++;
-      }
-    }
+  int32_t way = findWay(index, tag);
+  if (way < 0) {
     return 0;
   }
 
-  if ((*lineHit)->isValid()) {
-    // Setting RRIPs
-    if (hawkPrediction == 0) {
-      (*lineHit)->rrip = 7;
-    } else {
-      (*lineHit)->rrip = 0;
-    }
-  }
-
-  I((*lineHit)->isValid());
+  I(content[index + way]->isValid());
+  policy->hit(index >> log2Assoc, way, tag, pc, false);
 
-  return *lineHit;
+  return content[index + way];
 }
 
 template <class State, class Addr_t>
-typename HawkCache<State, Addr_t>::Line *HawkCache<State, Addr_t>::findLine2Replace(Addr_t addr, Addr_t pc, bool prefetch) {
+typename CacheRepl<State, Addr_t>::Line *CacheRepl<State, Addr_t>::findLine2Replace(Addr_t addr, Addr_t pc, bool prefetch) {
   Addr_t tag = this->calcTag(addr);
   I(tag);
-  Line **theSet = &content[this->calcIndex4Tag(tag)];
+  Addr_t   index = this->calcIndex4Tag(tag);
+  uint32_t set   = index >> log2Assoc;
 
-  // Check most typical case
-  if ((*theSet)->getTag() == tag) {
-    GI(tag, (*theSet)->isValid());
-    return *theSet;
+  int32_t way = findWay(index, tag);
+  if (way >= 0) {
+    GI(tag, content[index + way]->isValid());
+    policy->hit(set, way, tag, pc, prefetch);
+    return content[index + way];
   }
 
-  Line **lineHit  = 0;
-  Line **lineFree = 0;  // Order of preference, invalid
-  Line **setEnd   = theSet + assoc;
-
-  {
-    Line **l = setEnd - 1;
-    while (l >= theSet) {
-      if ((*l)->getTag() == tag) {
-        lineHit = l;
-        break;
-      }
-      if (!(*l)->isValid()) {
-        lineFree = l;
-      } else if (lineFree == 0) {
-        lineFree = l;
-      }
-
-      l--;
+  for (uint32_t w = 0; w < assoc; w++) {
+    if (!content[index + w]->isValid()) {
+      way = w;
+      break;
     }
   }
-
-  if (lineHit) {
-    return *lineHit;
+  if (way < 0) {
+    way = policy->victim(set, pc);
   }
+  I(way >= 0 && static_cast<uint32_t>(way) < assoc);
 
-  I(lineFree);
+  policy->fill(set, way, tag, pc, prefetch);
 
-  Line **l   = setEnd - 1;
-  Line **tmp = lineFree;
-  // iterate through each cacheline and free the first one with rrip of 7
-  while (l >= theSet) {
-    if ((*l)->isValid() && (*l)->rrip == 7) {
-      lineFree = l;
-      break;
-    }
-    l--;
-  }
+  return content[index + way];
+}
 
-  // if no lines have rrip == 7, revert to LRU and detrain hawk prediction
-  if (lineFree == tmp && (*lineFree)->rrip != 7) {
-    lineFree = setEnd - 1;
-    if (prediction[getPredictionHash(pc)] > 0) {
-      prediction[getPredictionHash(pc)]--;
+template <class State, class Addr_t>
+typename CacheRepl<State, Addr_t>::Line *CacheRepl<State, Addr_t>::findLine2Compact(Addr_t addr, const Line *keep) {
+  Addr_t   index = this->calcIndex4Tag(this->calcTag(addr));
+  uint32_t set   = index >> log2Assoc;
+  I(assoc <= 64);
+
+  uint64_t candidates = 0;
+  for (uint32_t w = 0; w < assoc; w++) {
+    if (content[index + w] != keep && content[index + w]->isValid()) {
+      candidates |= static_cast<uint64_t>(1) << w;
     }
   }
+  if (candidates == 0) {
+    return nullptr;
+  }
 
-  I(lineFree);
-
-  return *lineFree;
+  return content[index + policy->victim_among(set, 0, candidates)];
 }
 
 /*********************************************************
@@ -1537,6 +1397,7 @@ CacheDMSkew<State, Addr_t>::CacheDMSkew(int32_t size, int32_t blksize, int32_t a
   zero_line.invalidate();
 
   mem.resize(numLines + 1, zero_line);
+  recent.resize(numLines + 1, 0);
   content = new Line *[numLines + 1];
 
   for (uint32_t i = 0; i < numLines; i++) {
@@ -1553,7 +1414,7 @@ typename CacheDMSkew<State, Addr_t>::Line *CacheDMSkew<State, Addr_t>::findLineN
 
   if (line->getTag() == tag1) {
     I(line->isValid());
-    line->recent = true;
+    recentOf(line) = true;
     return line;
   }
   Line *line0 = line;
@@ -1567,7 +1428,7 @@ typename CacheDMSkew<State, Addr_t>::Line *CacheDMSkew<State, Addr_t>::findLineN
 
   if (line->getTag() == tag1) {  // FIRST TAG, tag2 is JUST used for indexing the table
     I(line->isValid());
-    line->recent = true;
+    recentOf(line) = true;
     return line;
   }
   Line *line1 = line;
@@ -1581,15 +1442,15 @@ typename CacheDMSkew<State, Addr_t>::Line *CacheDMSkew<State, Addr_t>::findLineN
 
   if (line->getTag() == tag1) {  // FIRST TAG, tag2 is JUST used for indexing the table
     I(line->isValid());
-    line->recent = true;
+    recentOf(line) = true;
     return line;
   }
   Line *line3 = line;
 
-  line3->recent = false;
+  recentOf(line3) = false;
 #endif
-  line1->recent = false;
-  line0->recent = false;
+  recentOf(line1) = false;
+  recentOf(line0) = false;
 
   return 0;
 }
@@ -1640,31 +1501,31 @@ typename CacheDMSkew<State, Addr_t>::Line *CacheDMSkew<State, Addr_t>::findLine2
     }
 
     if (rand_number == 0) {
-      if (line1->recent) {
-        line1->recent = false;
+      if (recentOf(line1)) {
+        recentOf(line1) = false;
       } else {
-        line1->recent = true;
-        line2->recent = false;
-        line3->recent = false;
+        recentOf(line1) = true;
+        recentOf(line2) = false;
+        recentOf(line3) = false;
         return line1;
       }
     }
     if (rand_number == 1) {
-      if (line2->recent) {
-        line2->recent = false;
+      if (recentOf(line2)) {
+        recentOf(line2) = false;
       } else {
-        line1->recent = false;
-        line2->recent = true;
-        line3->recent = false;
+        recentOf(line1) = false;
+        recentOf(line2) = true;
+        recentOf(line3) = false;
         return line2;
       }
     } else {
-      if (line3->recent) {
-        line3->recent = false;
+      if (recentOf(line3)) {
+        recentOf(line3) = false;
       } else {
-        line1->recent = false;
-        line2->recent = false;
-        line3->recent = true;
+        recentOf(line1) = false;
+        recentOf(line2) = false;
+        recentOf(line3) = true;
         return line3;
       }
     }
@@ -4,7 +4,57 @@
 
 #include <unistd.h>
 
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string_view>
+
 #include "fmt/format.h"
+#include "report.hpp"
+
+extern char **environ;
+
+static constexpr uint32_t cache_magic   = 0x46435344;  // "DSCF"
+static constexpr uint32_t cache_version = 1;
+
+// FNV-1a, stable across runs (unlike absl::Hash)
+static uint64_t hash_bytes(const std::string &s) {
+  uint64_t h = 0xcbf29ce484222325ULL;
+  for (unsigned char c : s) {
+    h = (h ^ c) * 0x100000001b3ULL;
+  }
+  return h;
+}
+
+template <typename T>
+static void put(std::string &out, T v) {
+  out.append(reinterpret_cast<const char *>(&v), sizeof(T));
+}
+
+static void put(std::string &out, const std::string &v) {
+  put<uint64_t>(out, v.size());
+  out.append(v);
+}
+
+template <typename T>
+static bool get(const std::string &buf, size_t &pos, T &v) {
+  if (buf.size() - pos < sizeof(T)) {
+    return false;
+  }
+  memcpy(&v, buf.data() + pos, sizeof(T));
+  pos += sizeof(T);
+  return true;
+}
+
+static bool get(const std::string &buf, size_t &pos, std::string &v) {
+  uint64_t sz;
+  if (!get(buf, pos, sz) || buf.size() - pos < sz) {
+    return false;
+  }
+  v.assign(buf.data() + pos, sz);
+  pos += sz;
+  return true;
+}
 
 void Config::init(const std::string f) {
   filename = f;
@@ -19,7 +69,216 @@ void Config::init(const std::string f) {
     exit_on_error();
   }
 
-  data = toml::parse(filename);
+  table.clear();
+
+  std::string cache_file;
+  uint64_t    hash      = 0;
+  const char *cache_dir = getenv("DESESCCONF_CACHE");
+  if (cache_dir) {
+    std::ifstream      file(filename, std::ios::binary);
+    std::ostringstream contents;
+    contents << file.rdbuf();
+
+    hash       = hash_bytes(contents.str());
+    cache_file = fmt::format("{}/desesc_conf_{:016x}.bin", cache_dir, hash);
+  }
+
+  if (cache_file.empty() || !load_cache(cache_file, hash)) {
+    auto data = toml::parse(filename);
+    for (const auto &sec : data.as_table()) {
+      if (!sec.second.is_table()) {
+        continue;
+      }
+      auto &fields = table[sec.first];
+      for (const auto &ent : sec.second.as_table()) {
+        fields[ent.first] = flatten(ent.second);
+      }
+    }
+
+    if (!cache_file.empty()) {
+      save_cache(cache_file, hash);
+    }
+  }
+
+  apply_env();
+}
+
+Config::Value Config::flatten(const toml::value &v) {
+  Value val;
+
+  if (v.is_string()) {
+    val.type = Value::Type::String;
+    val.str  = v.as_string();
+  } else if (v.is_integer()) {
+    val.type    = Value::Type::Integer;
+    val.integer = v.as_integer();
+  } else if (v.is_floating()) {
+    val.type     = Value::Type::Floating;
+    val.floating = v.as_floating();
+  } else if (v.is_boolean()) {
+    val.type    = Value::Type::Boolean;
+    val.integer = v.as_boolean();
+  } else if (v.is_array()) {
+    val.type = Value::Type::Array;
+    for (const auto &a : v.as_array()) {
+      val.array.emplace_back(flatten(a));
+    }
+  }
+
+  return val;
+}
+
+void Config::apply_env() {
+  absl::flat_hash_map<std::string, std::string> env_vars;
+  for (char **env = environ; env && *env; ++env) {
+    std::string_view str{*env};
+    if (str.substr(0, 7) != "DESESC_") {
+      continue;
+    }
+    auto eq = str.find('=');
+    if (eq == std::string_view::npos) {
+      continue;
+    }
+    env_vars.emplace(str.substr(7, eq - 7), str.substr(eq + 1));
+  }
+
+  if (env_vars.empty()) {
+    return;
+  }
+
+  for (auto &sec : table) {
+    for (auto &ent : sec.second) {
+      auto it = env_vars.find(fmt::format("{}_{}", sec.first, ent.first));
+      if (it != env_vars.end()) {
+        ent.second.has_env = true;
+        ent.second.env     = it->second;
+      }
+    }
+  }
+}
+
+void Config::put_value(std::string &out, const Value &v) {
+  put(out, static_cast<uint8_t>(v.type));
+  switch (v.type) {
+    case Value::Type::String: put(out, v.str); break;
+    case Value::Type::Integer:
+    case Value::Type::Boolean: put(out, v.integer); break;
+    case Value::Type::Floating: put(out, v.floating); break;
+    case Value::Type::Array:
+      put<uint64_t>(out, v.array.size());
+      for (const auto &a : v.array) {
+        put_value(out, a);
+      }
+      break;
+    default: break;
+  }
+}
+
+bool Config::get_value(const std::string &buf, size_t &pos, Value &v) {
+  uint8_t type;
+  if (!get(buf, pos, type) || type > static_cast<uint8_t>(Value::Type::Other)) {
+    return false;
+  }
+
+  v.type = static_cast<Value::Type>(type);
+  switch (v.type) {
+    case Value::Type::String: return get(buf, pos, v.str);
+    case Value::Type::Integer:
+    case Value::Type::Boolean: return get(buf, pos, v.integer);
+    case Value::Type::Floating: return get(buf, pos, v.floating);
+    case Value::Type::Array: {
+      uint64_t sz;
+      if (!get(buf, pos, sz) || sz > buf.size() - pos) {
+        return false;
+      }
+      v.array.resize(sz);
+      for (auto &a : v.array) {
+        if (!get_value(buf, pos, a)) {
+          return false;
+        }
+      }
+      return true;
+    }
+    default: return true;
+  }
+}
+
+bool Config::load_cache(const std::string &cache_file, uint64_t hash) {
+  std::ifstream file(cache_file, std::ios::binary);
+  if (!file) {
+    return false;
+  }
+  std::ostringstream contents;
+  contents << file.rdbuf();
+  const std::string buf = contents.str();
+
+  size_t   pos = 0;
+  uint32_t magic, version;
+  uint64_t file_hash, nsections;
+  bool     ok = get(buf, pos, magic) && get(buf, pos, version) && get(buf, pos, file_hash) && get(buf, pos, nsections)
+            && magic == cache_magic && version == cache_version && file_hash == hash;
+
+  for (uint64_t i = 0; ok && i < nsections; ++i) {
+    std::string block;
+    uint64_t    nfields;
+    ok = get(buf, pos, block) && get(buf, pos, nfields);
+
+    auto &fields = table[block];
+    for (uint64_t j = 0; ok && j < nfields; ++j) {
+      std::string name;
+      ok = get(buf, pos, name) && get_value(buf, pos, fields[name]);
+    }
+  }
+
+  if (!ok || pos != buf.size()) {
+    table.clear();  // stale or corrupted, parse the TOML again
+    return false;
+  }
+
+  return true;
+}
+
+void Config::save_cache(const std::string &cache_file, uint64_t hash) {
+  std::string buf;
+  put(buf, cache_magic);
+  put(buf, cache_version);
+  put(buf, hash);
+  put<uint64_t>(buf, table.size());
+  for (const auto &sec : table) {
+    put(buf, sec.first);
+    put<uint64_t>(buf, sec.second.size());
+    for (const auto &ent : sec.second) {
+      put(buf, ent.first);
+      put_value(buf, ent.second);
+    }
+  }
+
+  // Write and rename, concurrent runs never see a partial cache
+  std::string tmp = cache_file + ".XXXXXX";
+  int         fd  = mkstemp(tmp.data());
+  if (fd == -1) {
+    return;
+  }
+  auto sz = ::write(fd, buf.data(), buf.size());
+  close(fd);
+
+  if (sz != static_cast<ssize_t>(buf.size()) || rename(tmp.c_str(), cache_file.c_str()) != 0) {
+    unlink(tmp.c_str());
+  }
+}
+
+const Config::Value *Config::find(const std::string &block, const std::string &name) {
+  auto sec = table.find(block);
+  if (sec == table.end()) {
+    return nullptr;
+  }
+
+  auto ent = sec->second.find(name);
+  if (ent == sec->second.end()) {
+    return nullptr;
+  }
+
+  return &ent->second;
 }
 
 void Config::exit_on_error() {
@@ -41,13 +300,13 @@ bool Config::check(const std::string &block, const std::string &name) {
     return false;
   }
 
-  if (!data.contains(block)) {
+  auto sec = table.find(block);
+  if (sec == table.end()) {
     errors.emplace_back(fmt::format("section:{} does not exist in configuration:{}\n", block, filename));
     return false;
   }
 
-  auto sec = toml::find(data, block);
-  if (!sec.contains(name)) {
+  if (!sec->second.contains(name)) {
     errors.emplace_back(fmt::format("section:{} does not have field named {} in configuration:{}\n", block, name, filename));
     return false;
   }
@@ -60,25 +319,20 @@ std::string Config::get_string(const std::string &block, const std::string &name
     return "INVALID";
   }
 
-  {
-    std::string env_var = fmt::format("DESESC_{}_{}", block, name);
+  const auto *ent = find(block, name);
+  if (ent->has_env) {
+    std::string v{ent->env};
 
-    const char *e = getenv(env_var.c_str());
-    if (e) {
-      std::string v{e};
-
-      std::transform(v.begin(), v.end(), v.begin(), [](unsigned char c) { return std::tolower(c); });
-      return v;
-    }
+    std::transform(v.begin(), v.end(), v.begin(), [](unsigned char c) { return std::tolower(c); });
+    return v;
   }
 
-  auto ent = toml::find(data, block, name);
-  if (!ent.is_string()) {
+  if (ent->type != Value::Type::String) {
     errors.emplace_back(fmt::format("conf:{} section:{} field:{} is not a string\n", filename, block, name));
     return "INVALID";
   }
 
-  std::string val{ent.as_string()};
+  std::string val{ent->str};
   if (!allowed.empty()) {
     for (auto e : allowed) {
       auto same = std::equal(e.cbegin(), e.cend(), val.cbegin(), val.cend(), [](auto c1, auto c2) {
@@ -130,26 +384,24 @@ std::string Config::get_string(const std::string &block, const std::string &name
 std::string Config::get_string(const std::string &block, const std::string &name, size_t pos, const std::string &name2,
                                const std::vector<std::string> allowed) {
   auto block2 = get_block2(block, name, pos);
+  if (!check(block2, name2)) {
+    return "INVALID";
+  }
 
-  {
-    std::string env_var = fmt::format("DESESC_{}_{}", block2, name2);
-
-    const char *e = getenv(env_var.c_str());
-    if (e) {
-      std::string v{e};
+  const auto *ent = find(block2, name2);
+  if (ent->has_env) {
+    std::string v{ent->env};
 
-      std::transform(v.begin(), v.end(), v.begin(), [](unsigned char c) { return std::tolower(c); });
-      return v;
-    }
+    std::transform(v.begin(), v.end(), v.begin(), [](unsigned char c) { return std::tolower(c); });
+    return v;
   }
 
-  auto ent = toml::find(data, block2, name2);
-  if (!ent.is_string()) {
+  if (ent->type != Value::Type::String) {
     errors.emplace_back(fmt::format("conf:{} section:{} field:{} is not a string\n", filename, block, name));
     return "INVALID";
   }
 
-  std::string val{ent.as_string()};
+  std::string val{ent->str};
   if (!allowed.empty()) {
     for (auto e : allowed) {
       auto same = std::equal(e.cbegin(), e.cend(), val.cbegin(), val.cend(), [](auto c1, auto c2) {
@@ -177,27 +429,19 @@ int Config::get_integer(const std::string &block, const std::string &name, int f
     return 0;
   }
 
-  int val = 0;
-
-  {
-    std::string env_var = fmt::format("DESESC_{}_{}", block, name);
-
-    const char *e = getenv(env_var.c_str());
-    if (e) {
-      val = std::atoi(e);
-    }
-  }
-
-  auto ent = toml::find(data, block, name);
-  if (!ent.is_integer() && !ent.is_floating()) {
+  const auto *ent = find(block, name);
+  if (ent->type != Value::Type::Integer && ent->type != Value::Type::Floating) {
     errors.emplace_back(fmt::format("conf:{} section:{} field:{} is not a integer\n", filename, block, name));
     return 0;
   }
 
-  if (ent.is_integer()) {
-    val = ent.as_integer();
+  int val;
+  if (ent->has_env) {
+    val = std::atoi(ent->env.c_str());
+  } else if (ent->type == Value::Type::Integer) {
+    val = ent->integer;
   } else {
-    val = ent.as_floating();
+    val = ent->floating;
   }
 
   if (val < from || val > to) {
@@ -218,30 +462,23 @@ int Config::get_integer(const std::string &block, const std::string &name, int f
 
 int Config::get_integer(const std::string &block, const std::string &name, size_t pos, const std::string &name2, int from, int to) {
   auto block2 = get_block2(block, name, pos);
-  if (block2.empty()) {
+  if (block2.empty() || !check(block2, name2)) {
     return 0;
   }
 
-  int val = 0;
-  {
-    std::string env_var = fmt::format("DESESC_{}_{}", block2, name2);
-
-    const char *e = getenv(env_var.c_str());
-    if (e) {
-      val = std::atoi(e);
-    }
-  }
-
-  auto ent2 = toml::find(data, block2, name2);
-  if (!ent2.is_integer() && !ent2.is_floating()) {
+  const auto *ent2 = find(block2, name2);
+  if (ent2->type != Value::Type::Integer && ent2->type != Value::Type::Floating) {
     errors.emplace_back(fmt::format("conf:{} section:{} field:{} is not a integer\n", filename, block2, name2));
     return 0;
   }
 
-  if (ent2.is_integer()) {
-    val = ent2.as_integer();
+  int val;
+  if (ent2->has_env) {
+    val = std::atoi(ent2->env.c_str());
+  } else if (ent2->type == Value::Type::Integer) {
+    val = ent2->integer;
   } else {
-    val = ent2.as_floating();
+    val = ent2->floating;
   }
 
   if (val < from || val > to) {
@@ -265,13 +502,13 @@ size_t Config::get_array_size(const std::string &block, const std::string &name,
     return 0;
   }
 
-  auto ent = toml::find(data, block, name);
-  if (!ent.is_array()) {
+  const auto *ent = find(block, name);
+  if (ent->type != Value::Type::Array) {
     errors.emplace_back(fmt::format("conf:{} section:{} field:{} is not an array\n", filename, block, name));
     return 0;
   }
 
-  auto i = ent.as_array().size();
+  auto i = ent->array.size();
   if (i > max_size) {
     errors.emplace_back(fmt::format("conf:{} section:{} field:{} has too many entries\n", filename, block, name));
     return max_size;
@@ -285,30 +522,29 @@ int Config::get_array_integer(const std::string &block, const std::string &name,
     return 0;
   }
 
-  auto ent = toml::find(data, block, name);
-  if (!ent.is_array()) {
+  const auto *ent = find(block, name);
+  if (ent->type != Value::Type::Array) {
     errors.emplace_back(fmt::format("conf:{} section:{} field:{} is not an array\n", filename, block, name));
     return 0;
   }
 
-  if (ent.as_array().size() <= pos) {
+  const auto &arr = ent->array;
+  if (arr.size() <= pos) {
     errors.emplace_back(
-        fmt::format("conf:{} section:{} out of bounds {} array of size {}\n", filename, block, name, ent.as_array().size(), pos));
+        fmt::format("conf:{} section:{} out of bounds {} array of size {}\n", filename, block, name, arr.size(), pos));
     return 0;
   }
 
-  auto arr = ent.as_array();
-
-  if (!arr[pos].is_integer() && !arr[pos].is_floating()) {
+  if (arr[pos].type != Value::Type::Integer && arr[pos].type != Value::Type::Floating) {
     errors.emplace_back(fmt::format("conf:{} section:{} array entry is not integer\n", filename, block, name));
     return 0;
   }
 
   int val;
-  if (arr[pos].is_integer()) {
-    val = arr[pos].as_integer();
+  if (arr[pos].type == Value::Type::Integer) {
+    val = arr[pos].integer;
   } else {
-    val = arr[pos].as_floating();
+    val = arr[pos].floating;
   }
 
   add_used(block, name, pos, fmt::format("{}", val));
@@ -320,26 +556,25 @@ std::string Config::get_array_string(const std::string &block, const std::string
     return "INVALID";
   }
 
-  auto ent = toml::find(data, block, name);
-  if (!ent.is_array()) {
+  const auto *ent = find(block, name);
+  if (ent->type != Value::Type::Array) {
     errors.emplace_back(fmt::format("conf:{} section:{} field:{} is not an array\n", filename, block, name));
     return "INVALID";
   }
 
-  if (ent.as_array().size() <= pos) {
+  const auto &arr = ent->array;
+  if (arr.size() <= pos) {
     errors.emplace_back(
-        fmt::format("conf:{} section:{} out of bounds {} array of size {}\n", filename, block, name, ent.as_array().size(), pos));
+        fmt::format("conf:{} section:{} out of bounds {} array of size {}\n", filename, block, name, arr.size(), pos));
     return "INVALID";
   }
 
-  auto arr = ent.as_array();
-
-  if (!arr[pos].is_string()) {
+  if (arr[pos].type != Value::Type::String) {
     errors.emplace_back(fmt::format("conf:{} section:{} array entry is not string\n", filename, block, name));
     return "INVALID";
   }
 
-  std::string val = arr[pos].as_string();
+  std::string val = arr[pos].str;
   std::transform(val.begin(), val.end(), val.begin(), [](unsigned char c) { return std::tolower(c); });
 
   add_used(block, name, pos, val);
@@ -349,42 +584,24 @@ std::string Config::get_array_string(const std::string &block, const std::string
 
 void Config::add_error(const std::string &err) { errors.emplace_back(err); }
 
-bool Config::has_entry(const std::string &block, const std::string &name) {
-  if (block.empty()) {
-    return false;
-  }
-
-  if (!data.contains(block)) {
-    return false;
-  }
-
-  auto sec = toml::find(data, block);
-  return sec.contains(name);
-}
+bool Config::has_entry(const std::string &block, const std::string &name) { return find(block, name) != nullptr; }
 
 bool Config::has_entry(const std::string &block, const std::string &name, size_t pos, const std::string &name2) {
-  if (!has_entry(block, name)) {
-    return false;
-  }
-
-  auto ent = toml::find(data, block, name);
-  if (!ent.is_array()) {
+  const auto *ent = find(block, name);
+  if (ent == nullptr || ent->type != Value::Type::Array) {
     return false;
   }
 
-  auto ent_array = ent.as_array();
-  if (ent_array.size() <= pos) {
+  if (ent->array.size() <= pos) {
     return false;
   }
 
-  const auto t_block2 = ent_array[pos];
-  if (!t_block2.is_string()) {
+  const auto &t_block2 = ent->array[pos];
+  if (t_block2.type != Value::Type::String) {
     return false;
   }
 
-  auto ent2 = toml::find(data, t_block2.as_string());
-
-  return ent2.contains(name2);
+  return find(t_block2.str, name2) != nullptr;
 }
 
 bool Config::get_bool(const std::string &block, const std::string &name) {
@@ -392,22 +609,17 @@ bool Config::get_bool(const std::string &block, const std::string &name) {
     return false;
   }
 
-  {
-    std::string env_var = fmt::format("DESESC_{}_{}", block, name);
-
-    const char *e = getenv(env_var.c_str());
-    if (e) {
-      return strcasecmp(e, "true") == 0;
-    }
+  const auto *ent = find(block, name);
+  if (ent->has_env) {
+    return strcasecmp(ent->env.c_str(), "true") == 0;
   }
 
-  auto ent = toml::find(data, block, name);
-  if (!ent.is_boolean()) {
+  if (ent->type != Value::Type::Boolean) {
     errors.emplace_back(fmt::format("conf:{} section:{} field:{} is not a boolean\n", filename, block, name));
     return false;
   }
 
-  auto val = ent.as_boolean();
+  bool val = ent->integer;
 
   add_used(block, name, 0, val ? "true" : "false");
 
@@ -419,43 +631,40 @@ bool Config::get_bool(const std::string &block, const std::string &name, size_t
     return false;
   }
 
-  auto ent = toml::find(data, block, name);
-  if (!ent.is_array()) {
+  const auto *ent = find(block, name);
+  if (ent->type != Value::Type::Array) {
     errors.emplace_back(
         fmt::format("conf:{} section:{} field:{} is not a array needed to chain to {}\n", filename, block, name, name2));
     return false;
   }
 
-  auto ent_array = ent.as_array();
-
-  if (ent_array.size() <= pos) {
+  if (ent->array.size() <= pos) {
     errors.emplace_back(fmt::format("conf:{} section:{} field:{} out-of-bounds array access {}\n", filename, block, name, pos));
     return false;
   }
 
-  const auto t_block2 = ent_array[pos];
-  if (!t_block2.is_string()) {
+  const auto &t_block2 = ent->array[pos];
+  if (t_block2.type != Value::Type::String) {
     errors.emplace_back(fmt::format("conf:{} section:{} field:{} should point to a section\n", filename, block, name));
     return false;
   }
 
-  std::string block2{t_block2.as_string()};
-  {
-    std::string env_var = fmt::format("DESESC_{}_{}", block, name);
+  const std::string &block2 = t_block2.str;
+  if (!check(block2, name2)) {
+    return false;
+  }
 
-    const char *e = getenv(env_var.c_str());
-    if (e) {
-      return strcasecmp(e, "true") == 0;
-    }
+  const auto *ent2 = find(block2, name2);
+  if (ent2->has_env) {
+    return strcasecmp(ent2->env.c_str(), "true") == 0;
   }
 
-  auto ent2 = toml::find(data, block2, name2);
-  if (!ent2.is_boolean()) {
+  if (ent2->type != Value::Type::Boolean) {
     errors.emplace_back(fmt::format("conf:{} section:{} field:{} is not a boolean\n", filename, block2, name2));
     return false;
   }
 
-  auto val = ent2.as_boolean();
+  bool val = ent2->integer;
 
   add_used(block2, name2, pos, val ? "true" : "false");
 
@@ -484,26 +693,24 @@ std::string Config::get_block2(const std::string &block, const std::string &name
     return "";
   }
 
-  auto ent = toml::find(data, block, name);
-  if (!ent.is_array()) {
+  const auto *ent = find(block, name);
+  if (ent->type != Value::Type::Array) {
     errors.emplace_back(fmt::format("conf:{} section:{} field:{} is not a array needed to chain\n", filename, block, name));
     return "";
   }
 
-  auto ent_array = ent.as_array();
-
-  if (ent_array.size() <= pos) {
+  if (ent->array.size() <= pos) {
     errors.emplace_back(fmt::format("conf:{} section:{} field:{} out-of-bounds array access {}\n", filename, block, name, pos));
     return "";
   }
 
-  const auto t_block2 = ent_array[pos];
-  if (!t_block2.is_string()) {
+  const auto &t_block2 = ent->array[pos];
+  if (t_block2.type != Value::Type::String) {
     errors.emplace_back(fmt::format("conf:{} section:{} field:{} should point to a section\n", filename, block, name));
     return "";
   }
 
-  auto val = t_block2.as_string();
+  auto val = t_block2.str;
 
   add_used(block, name, pos, val);
 
@@ -520,6 +727,10 @@ void Config::add_used(const std::string &block, const std::string &name, size_t
 
 void Config::dump(int fd) {
   for (const auto &u : used) {
+    for (size_t pos = 0; pos < u.second.second.size(); ++pos) {
+      Report::config(u.first, u.second.first, pos, u.second.second[pos]);
+    }
+
     auto str = fmt::format("[{}]\n", u.first);
     auto sz  = ::write(fd, str.c_str(), str.size());
     (void)sz;
@@ -2,7 +2,9 @@
 
 #pragma once
 
+#include <cstdint>
 #include <limits>
+#include <string>
 #include <vector>
 
 #include "absl/container/flat_hash_map.h"
@@ -10,8 +12,23 @@
 
 class Config {
 private:
-  static inline std::string filename;
-  static inline toml::value data;
+  // One configuration field. The TOML document is flattened once at init,
+  // and the DESESC_<block>_<name> environment overrides are attached to it.
+  struct Value {
+    enum class Type : uint8_t { String, Integer, Floating, Boolean, Array, Other };
+
+    Type               type     = Type::Other;
+    bool               has_env  = false;
+    int64_t            integer  = 0;  // integer and boolean
+    double             floating = 0;
+    std::string        str;
+    std::string        env;
+    std::vector<Value> array;
+  };
+  using Section = absl::flat_hash_map<std::string, Value>;
+
+  static inline std::string                               filename;
+  static inline absl::flat_hash_map<std::string, Section> table;
 
   static inline std::vector<std::string>                                                           errors;
   static inline absl::flat_hash_map<std::string, std::pair<std::string, std::vector<std::string>>> used;
@@ -24,12 +41,26 @@ private:
 
   static std::string get_block2(const std::string &block, const std::string &name, size_t pos);
 
+  static const Value *find(const std::string &block, const std::string &name);
+
+  static Value flatten(const toml::value &v);
+  static void  apply_env();
+
+  static void put_value(std::string &out, const Value &v);
+  static bool get_value(const std::string &buf, size_t &pos, Value &v);
+  static bool load_cache(const std::string &cache_file, uint64_t hash);
+  static void save_cache(const std::string &cache_file, uint64_t hash);
+
 protected:
 public:
   Config() = delete;  // No object instance. All methods are static
 
   static void exit_on_error();
 
+  // Parse the configuration (DESESCCONF overrides the file name). When
+  // DESESCCONF_CACHE names a directory, the flattened configuration is kept
+  // there as a binary file keyed by the hash of the TOML contents, and later
+  // runs with the same TOML skip the parsing.
   static void init(const std::string f = "desesc.toml");
 
   static std::string get_string(const std::string &block, const std::string &name,
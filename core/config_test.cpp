@@ -2,6 +2,10 @@
 
 #include "config.hpp"
 
+#include <dirent.h>
+#include <stdlib.h>
+
+#include <fstream>
 #include <random>
 #include <string>
 #include <vector>
@@ -81,3 +85,63 @@ TEST_F(Config_test, indirect) {
   EXPECT_EQ(Config::get_string("base", "a", 0, "str"), "foo");
   EXPECT_EQ(Config::get_string("base", "a", 1, "str"), "bar");
 }
+
+TEST_F(Config_test, env_override) {
+  setenv("DESESC_int_test_b", "7", 1);
+  setenv("DESESC_sec1_foo", "OTHER", 1);
+  setenv("DESESC_leaf2_v", "9", 1);
+  Config::init("config_test_sample.toml");
+  unsetenv("DESESC_int_test_b");
+  unsetenv("DESESC_sec1_foo");
+  unsetenv("DESESC_leaf2_v");
+
+  EXPECT_EQ(Config::get_integer("int_test", "a"), -33);
+  EXPECT_EQ(Config::get_integer("int_test", "b"), 7);
+  EXPECT_EQ(Config::get_string("sec1", "foo"), "other");
+  EXPECT_EQ(Config::get_integer("base", "a", 0, "v"), 3);
+  EXPECT_EQ(Config::get_integer("base", "a", 1, "v"), 9);
+}
+
+static int count_cache_files(const std::string &dir) {
+  int  n = 0;
+  auto d = opendir(dir.c_str());
+  while (auto ent = readdir(d)) {
+    n += std::string(ent->d_name).rfind("desesc_conf_", 0) == 0;
+  }
+  closedir(d);
+  return n;
+}
+
+TEST_F(Config_test, binary_cache) {
+  char dir_template[] = "/tmp/desesc_conf_test.XXXXXX";
+  auto dir            = mkdtemp(dir_template);
+  ASSERT_NE(dir, nullptr);
+  setenv("DESESCCONF_CACHE", dir, 1);
+
+  for (int i = 0; i < 2; ++i) {  // first fills the cache, second reads it
+    Config::init("config_test_sample.toml");
+    EXPECT_EQ(count_cache_files(dir), 1);
+
+    EXPECT_EQ(Config::get_string("sec1", "foo"), "mytxt");
+    EXPECT_EQ(Config::get_array_size("sec2", "vfoo1"), 3);
+    EXPECT_EQ(Config::get_array_integer("sec2", "vfoo1", 2), 3);
+    EXPECT_EQ(Config::get_array_string("sec2", "vfoo2", 1), "b");
+    EXPECT_EQ(Config::get_integer("int_test", "a"), -33);
+    EXPECT_EQ(Config::get_integer("base", "a", 1, "v"), 4);
+    EXPECT_EQ(Config::get_string("base", "a", 0, "str"), "foo");
+    EXPECT_TRUE(Config::has_entry("base", "a", 1, "str"));
+    EXPECT_FALSE(Config::has_entry("sec3", "vfoo_not"));
+  }
+
+  // A different TOML gets its own cache entry
+  std::ofstream file("config_test_sample.toml", std::ios::app);
+  file << "[sec4]\n";
+  file << "b = true\n";
+  file.close();
+
+  Config::init("config_test_sample.toml");
+  EXPECT_EQ(count_cache_files(dir), 2);
+  EXPECT_TRUE(Config::get_bool("sec4", "b"));
+
+  unsetenv("DESESCCONF_CACHE");
+}
@@ -57,6 +57,18 @@ public:
     start = (start + 1) & pipeMask;
   }
 
+  // Youngest element, removed by pop_back (squashes)
+  Data back() const {
+    I(nElems);
+    return pipe[(end - 1) & pipeMask];
+  }
+
+  void pop_back() {
+    I(nElems);
+    nElems--;
+    end = (end - 1) & pipeMask;
+  }
+
   uint32_t getIDFromTop(uint32_t i) const {
     I(nElems > i);
     return (start + i) & pipeMask;
@@ -7,6 +7,7 @@
 
 #include "absl/strings/str_cat.h"
 #include "config.hpp"
+#include "fmt/format.h"
 #include "iassert.hpp"
 
 void Report::init() {
@@ -32,6 +33,14 @@ void Report::init() {
   }
 
   report_file = f;
+
+  if (getenv("REPORTBIN")) {
+    if (bin.open(report_file + ".drep")) {
+      bin.run(report_file);
+    } else {
+      perror("Report::init could not create the structured report:");
+    }
+  }
 }
 
 const std::string Report::get_extension() {
@@ -51,7 +60,19 @@ void Report::reinit() {
   init();
 }
 
-void Report::close() { ::close(fd); }
+void Report::close() {
+  ::close(fd);
+  bin.close();
+}
+
+void Report::meta(const std::string &key, const std::string &value) {
+  field(fmt::format("OSSim:{}={}", key, value));
+
+  if (bin.is_open()) {
+    auto end = value.find_last_not_of('\n');
+    bin.meta(key, end == std::string::npos ? "" : value.substr(0, end + 1));
+  }
+}
 
 void Report::field(const std::string &msg) {
   auto sz = write(fd, msg.data(), msg.size());
@@ -2,12 +2,16 @@
 
 #pragma once
 
+#include <cstdint>
 #include <string>
 
+#include "report_bin.hpp"
+
 class Report {
 private:
-  static inline std::string report_file;
-  static inline int         fd = -1;
+  static inline std::string       report_file;
+  static inline int               fd = -1;
+  static inline Report_bin_writer bin;  // structured report, only with REPORTBIN set
 
 public:
   static void init();
@@ -15,6 +19,17 @@ public:
   static void field(const std::string &msg);
   static void close();
 
+  // Run metadata, written as OSSim:key=value too
+  static void meta(const std::string &key, const std::string &value);
+
+  // Structured report only
+  static bool has_bin() { return bin.is_open(); }
+  static void config(const std::string &section, const std::string &name, uint32_t pos, const std::string &value) {
+    bin.config(section, name, pos, value);
+  }
+  static void window() { bin.window(); }
+  static void stat(const std::string &name, double value) { bin.stat(name, value); }
+
   static const std::string get_extension();
 
   static int raw_file_descriptor() { return fd; }
@@ -0,0 +1,310 @@
+// See LICENSE for details.
+
+#include "report_bin.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+static constexpr uint32_t report_bin_magic   = 0x50455244;  // "DREP"
+static constexpr uint32_t report_bin_version = 1;
+
+template <typename T>
+static void put(std::string &out, T v) {
+  out.append(reinterpret_cast<const char *>(&v), sizeof(T));
+}
+
+template <typename T>
+static bool get(const std::string &buf, size_t &pos, size_t end, T &v) {
+  if (end - pos < sizeof(T)) {
+    return false;
+  }
+  memcpy(&v, buf.data() + pos, sizeof(T));
+  pos += sizeof(T);
+  return true;
+}
+
+/*********************** Report_bin_writer */
+
+bool Report_bin_writer::open(const std::string &fname) {
+  close();
+
+  fd = ::open(fname.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    return false;
+  }
+
+  strings.clear();
+  buffer.clear();
+  put(buffer, report_bin_magic);
+  put(buffer, report_bin_version);
+
+  return true;
+}
+
+void Report_bin_writer::flush() {
+  size_t done = 0;
+  while (fd >= 0 && done < buffer.size()) {
+    auto sz = ::write(fd, buffer.data() + done, buffer.size() - done);
+    if (sz <= 0) {
+      break;
+    }
+    done += sz;
+  }
+  buffer.clear();
+}
+
+void Report_bin_writer::close() {
+  if (fd < 0) {
+    return;
+  }
+
+  flush();
+  ::close(fd);
+  fd = -1;
+}
+
+uint32_t Report_bin_writer::intern(const std::string &str) {
+  auto it = strings.find(str);
+  if (it != strings.end()) {
+    return it->second;
+  }
+
+  uint32_t id = strings.size();
+  strings.emplace(str, id);
+
+  std::string payload;
+  put(payload, id);
+  payload.append(str);
+  add_record(Report_bin_type::String, payload);
+
+  return id;
+}
+
+void Report_bin_writer::add_record(Report_bin_type type, const std::string &payload) {
+  put(buffer, static_cast<uint8_t>(type));
+  put(buffer, static_cast<uint32_t>(payload.size()));
+  buffer.append(payload);
+
+  if (buffer.size() >= 64 * 1024) {
+    flush();
+  }
+}
+
+void Report_bin_writer::run(const std::string &name) {
+  if (fd < 0) {
+    return;
+  }
+
+  std::string payload;
+  put(payload, intern(name));
+  add_record(Report_bin_type::Run, payload);
+}
+
+void Report_bin_writer::meta(const std::string &key, const std::string &value) {
+  if (fd < 0) {
+    return;
+  }
+
+  std::string payload;
+  put(payload, intern(key));
+  put(payload, intern(value));
+  add_record(Report_bin_type::Meta, payload);
+}
+
+void Report_bin_writer::config(const std::string &section, const std::string &field, uint32_t pos, const std::string &value) {
+  if (fd < 0) {
+    return;
+  }
+
+  std::string payload;
+  put(payload, intern(section));
+  put(payload, intern(field));
+  put(payload, pos);
+  put(payload, intern(value));
+  add_record(Report_bin_type::Config, payload);
+}
+
+void Report_bin_writer::window() {
+  if (fd < 0) {
+    return;
+  }
+
+  add_record(Report_bin_type::Window, "");
+}
+
+void Report_bin_writer::stat(const std::string &name, double value) {
+  if (fd < 0) {
+    return;
+  }
+
+  std::string payload;
+  put(payload, intern(name));
+  put(payload, value);
+  add_record(Report_bin_type::Stat, payload);
+}
+
+/*********************** Report_bin_reader */
+
+uint32_t Report_bin_reader::intern(const std::string &str) {
+  auto it = string_ids.find(str);
+  if (it != string_ids.end()) {
+    return it->second;
+  }
+
+  uint32_t id = strings.size();
+  strings.emplace_back(str);
+  string_ids.emplace(str, id);
+
+  return id;
+}
+
+bool Report_bin_reader::open(const std::string &fname) {
+  std::ifstream file(fname, std::ios::binary);
+  if (!file) {
+    return false;
+  }
+  std::ostringstream contents;
+  contents << file.rdbuf();
+  const std::string buf = contents.str();
+
+  size_t   pos = 0;
+  uint32_t magic, version;
+  if (!get(buf, pos, buf.size(), magic) || !get(buf, pos, buf.size(), version) || magic != report_bin_magic
+      || version != report_bin_version) {
+    return false;
+  }
+
+  std::vector<uint32_t> ids;  // file string id to reader string id
+
+  auto map_id = [&](uint32_t local, uint32_t &id) {
+    if (local >= ids.size()) {
+      return false;
+    }
+    id = ids[local];
+    return true;
+  };
+
+  Run *run = nullptr;
+  auto cur_run = [&]() {
+    if (run == nullptr) {  // records before any Run record
+      runs.emplace_back();
+      run       = &runs.back();
+      run->name = intern(fname);
+      run->file = fname;
+    }
+    return run;
+  };
+
+  while (true) {
+    uint8_t  type;
+    uint32_t size;
+    if (!get(buf, pos, buf.size(), type) || !get(buf, pos, buf.size(), size) || buf.size() - pos < size) {
+      break;  // end of file, or truncated record
+    }
+    size_t   end = pos + size;
+    bool     ok  = true;
+    uint32_t a, b, c, d;
+
+    switch (static_cast<Report_bin_type>(type)) {
+      case Report_bin_type::String:
+        ok = get(buf, pos, end, a) && a == ids.size();
+        if (ok) {
+          ids.emplace_back(intern(buf.substr(pos, end - pos)));
+        }
+        break;
+      case Report_bin_type::Run:
+        ok = get(buf, pos, end, a) && map_id(a, b);
+        if (ok) {
+          runs.emplace_back();
+          run       = &runs.back();
+          run->name = b;
+          run->file = fname;
+        }
+        break;
+      case Report_bin_type::Meta:
+        ok = get(buf, pos, end, a) && get(buf, pos, end, b) && map_id(a, a) && map_id(b, b);
+        if (ok) {
+          cur_run()->meta.emplace_back(a, b);
+        }
+        break;
+      case Report_bin_type::Config:
+        ok = get(buf, pos, end, a) && get(buf, pos, end, b) && get(buf, pos, end, c) && get(buf, pos, end, d) && map_id(a, a)
+             && map_id(b, b) && map_id(d, d);
+        if (ok) {
+          cur_run()->config.emplace_back(Config_entry{a, b, c, d});
+        }
+        break;
+      case Report_bin_type::Window: cur_run()->windows.emplace_back(); break;
+      case Report_bin_type::Stat: {
+        double v;
+        ok = get(buf, pos, end, a) && get(buf, pos, end, v) && map_id(a, a);
+        if (ok) {
+          if (cur_run()->windows.empty()) {
+            run->windows.emplace_back();
+          }
+          run->windows.back()[a] = v;
+        }
+        break;
+      }
+      default: break;  // unknown record, skipped
+    }
+
+    if (!ok) {
+      break;  // corrupted, keep what was read
+    }
+    pos = end;
+  }
+
+  return true;
+}
+
+bool Report_bin_reader::find_string(const std::string &str, uint32_t &id) const {
+  auto it = string_ids.find(str);
+  if (it == string_ids.end()) {
+    return false;
+  }
+  id = it->second;
+  return true;
+}
+
+std::string Report_bin_reader::get_meta(size_t r, const std::string &key) const {
+  uint32_t id;
+  if (r >= runs.size() || !find_string(key, id)) {
+    return "";
+  }
+
+  for (const auto &m : runs[r].meta) {
+    if (m.first == id) {
+      return strings[m.second];
+    }
+  }
+
+  return "";
+}
+
+bool Report_bin_reader::get_stat(size_t r, const std::string &name, double &value, int window) const {
+  uint32_t id;
+  if (r >= runs.size() || runs[r].windows.empty() || !find_string(name, id)) {
+    return false;
+  }
+
+  const auto &windows = runs[r].windows;
+  if (window < 0) {
+    window = windows.size() - 1;
+  }
+  if (static_cast<size_t>(window) >= windows.size()) {
+    return false;
+  }
+
+  auto it = windows[window].find(id);
+  if (it == windows[window].end()) {
+    return false;
+  }
+  value = it->second;
+
+  return true;
+}
@@ -0,0 +1,98 @@
+// See LICENSE for details.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+
+// Structured report file. After an 8 byte header ("DREP" and the version),
+// the file is a sequence of length prefixed records:
+//
+//   u8 type, u32 payload size, payload
+//
+// Strings (stat names, config fields, values) are stored once in String
+// records and referenced by id. A Run record starts the report of one
+// simulation, a Window record starts a new set of stats of the run. A
+// desesc run writes one file with one run, a merged file has many. Records
+// are appended as they are produced, so a report cut by a crash can still
+// be read up to its last complete record.
+enum class Report_bin_type : uint8_t {
+  String = 1,  // u32 id, bytes
+  Run    = 2,  // u32 name
+  Meta   = 3,  // u32 key, u32 value
+  Config = 4,  // u32 section, u32 field, u32 pos, u32 value
+  Window = 5,  // (empty)
+  Stat   = 6   // u32 name, f64 value
+};
+
+class Report_bin_writer {
+private:
+  int         fd = -1;
+  std::string buffer;
+
+  absl::flat_hash_map<std::string, uint32_t> strings;
+
+  uint32_t intern(const std::string &str);
+  void     add_record(Report_bin_type type, const std::string &payload);
+
+public:
+  ~Report_bin_writer() { close(); }
+
+  bool open(const std::string &fname);
+  bool is_open() const { return fd >= 0; }
+  void flush();
+  void close();
+
+  void run(const std::string &name);
+  void meta(const std::string &key, const std::string &value);
+  void config(const std::string &section, const std::string &field, uint32_t pos, const std::string &value);
+  void window();
+  void stat(const std::string &name, double value);
+};
+
+// Loads structured reports into memory. Every file opened adds its runs,
+// and the string ids of all the files are merged in a single table, so
+// that thousands of reports can be queried (or merged) together.
+class Report_bin_reader {
+public:
+  struct Config_entry {
+    uint32_t section;
+    uint32_t field;
+    uint32_t pos;
+    uint32_t value;
+  };
+
+  struct Run {
+    uint32_t                                           name;
+    std::string                                        file;
+    std::vector<std::pair<uint32_t, uint32_t>>         meta;
+    std::vector<Config_entry>                          config;
+    std::vector<absl::flat_hash_map<uint32_t, double>> windows;  // stats by name
+  };
+
+private:
+  std::vector<std::string>                   strings;
+  absl::flat_hash_map<std::string, uint32_t> string_ids;
+  std::vector<Run>                           runs;
+
+  uint32_t intern(const std::string &str);
+
+public:
+  // False when the file is not a report. A truncated report keeps the
+  // records before the cut.
+  bool open(const std::string &fname);
+
+  size_t     get_nruns() const { return runs.size(); }
+  const Run &get_run(size_t r) const { return runs[r]; }
+
+  const std::string &get_string(uint32_t id) const { return strings[id]; }
+  // False when the string is in no report, so no stat/meta can have it
+  bool find_string(const std::string &str, uint32_t &id) const;
+
+  std::string get_meta(size_t r, const std::string &key) const;
+  // Window -1 is the last one of the run
+  bool get_stat(size_t r, const std::string &name, double &value, int window = -1) const;
+};
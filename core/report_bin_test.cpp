@@ -0,0 +1,130 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include "report_bin.hpp"
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <filesystem>
+
+#include "gtest/gtest.h"
+#include "report.hpp"
+#include "stats.hpp"
+
+static void write_run(const std::string &fname, const std::string &run, double v) {
+  Report_bin_writer writer;
+  ASSERT_TRUE(writer.open(fname));
+
+  writer.run(run);
+  writer.meta("reportName", run);
+  writer.config("soc", "core", 0, "c0");
+  writer.window();
+  writer.stat("P(0)_nInst", v);
+  writer.window();
+  writer.stat("P(0)_nInst", 2 * v);
+  writer.stat("P(0)_nCycles", 3 * v);
+  writer.close();
+}
+
+TEST(Report_bin_test, write_read) {
+  write_run("report_bin_test1.drep", "run1", 10);
+
+  Report_bin_reader reader;
+  ASSERT_TRUE(reader.open("report_bin_test1.drep"));
+  ASSERT_EQ(reader.get_nruns(), 1);
+
+  const auto &run = reader.get_run(0);
+  EXPECT_EQ(reader.get_string(run.name), "run1");
+  EXPECT_EQ(reader.get_meta(0, "reportName"), "run1");
+  EXPECT_EQ(reader.get_meta(0, "missing"), "");
+  ASSERT_EQ(run.config.size(), 1);
+  EXPECT_EQ(reader.get_string(run.config[0].value), "c0");
+  ASSERT_EQ(run.windows.size(), 2);
+
+  double v;
+  EXPECT_TRUE(reader.get_stat(0, "P(0)_nInst", v, 0));
+  EXPECT_EQ(v, 10);
+  EXPECT_TRUE(reader.get_stat(0, "P(0)_nInst", v));
+  EXPECT_EQ(v, 20);
+  EXPECT_FALSE(reader.get_stat(0, "P(0)_nCycles", v, 0));
+  EXPECT_TRUE(reader.get_stat(0, "P(0)_nCycles", v));
+  EXPECT_EQ(v, 30);
+  EXPECT_FALSE(reader.get_stat(0, "P(1)_nInst", v));
+}
+
+TEST(Report_bin_test, merge_and_truncate) {
+  write_run("report_bin_test1.drep", "run1", 10);
+  write_run("report_bin_test2.drep", "run2", 100);
+
+  // A run cut in the middle of a record keeps the complete records
+  auto size = std::filesystem::file_size("report_bin_test2.drep");
+  std::filesystem::resize_file("report_bin_test2.drep", size - 4);
+
+  Report_bin_reader reader;
+  ASSERT_TRUE(reader.open("report_bin_test1.drep"));
+  ASSERT_TRUE(reader.open("report_bin_test2.drep"));
+  ASSERT_EQ(reader.get_nruns(), 2);
+
+  double v;
+  EXPECT_TRUE(reader.get_stat(1, "P(0)_nInst", v));
+  EXPECT_EQ(v, 200);
+  EXPECT_FALSE(reader.get_stat(1, "P(0)_nCycles", v));
+
+  Report_bin_writer writer;
+  ASSERT_TRUE(writer.open("report_bin_merged.drep"));
+  for (size_t r = 0; r < reader.get_nruns(); ++r) {
+    const auto &run = reader.get_run(r);
+    writer.run(reader.get_string(run.name));
+    for (const auto &w : run.windows) {
+      writer.window();
+      for (const auto &s : w) {
+        writer.stat(reader.get_string(s.first), s.second);
+      }
+    }
+  }
+  writer.close();
+
+  Report_bin_reader merged;
+  ASSERT_TRUE(merged.open("report_bin_merged.drep"));
+  ASSERT_EQ(merged.get_nruns(), 2);
+  EXPECT_EQ(merged.get_string(merged.get_run(1).name), "run2");
+  EXPECT_TRUE(merged.get_stat(0, "P(0)_nCycles", v));
+  EXPECT_EQ(v, 30);
+
+  EXPECT_FALSE(merged.open("report_bin_missing.drep"));
+}
+
+TEST(Report_bin_test, report) {
+  setenv("REPORTBIN", "1", 1);
+  Report::init();
+  unsetenv("REPORTBIN");
+  ASSERT_TRUE(Report::has_bin());
+
+  Stats_cntr cntr("report_bin_test:cntr");
+  Stats_avg  avg("report_bin_test:avg");
+  cntr.add(5);
+  avg.sample(2, true);
+  avg.sample(4, true);
+
+  Report::meta("reportName", "test\n");
+  Stats::report_all();
+  Report::close();
+
+  auto fname = "desesc." + Report::get_extension() + ".drep";
+
+  Report_bin_reader reader;
+  ASSERT_TRUE(reader.open(fname));
+  ASSERT_EQ(reader.get_nruns(), 1);
+  EXPECT_EQ(reader.get_meta(0, "reportName"), "test");
+
+  double v;
+  EXPECT_TRUE(reader.get_stat(0, "report_bin_test:cntr", v));
+  EXPECT_EQ(v, 5);
+  EXPECT_TRUE(reader.get_stat(0, "report_bin_test:avg:n", v));
+  EXPECT_EQ(v, 2);
+  EXPECT_TRUE(reader.get_stat(0, "report_bin_test:avg:v", v));
+  EXPECT_EQ(v, 3);
+
+  unlink(fname.c_str());
+  unlink(fname.substr(0, fname.size() - 5).c_str());
+}
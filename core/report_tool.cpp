@@ -0,0 +1,187 @@
+// See LICENSE for details.
+
+// Structured report (REPORTBIN) tool.
+//
+//   report_tool dump <report>...
+//     prints the runs, metadata, configuration and stats of the reports.
+//
+//   report_tool query [-w window] <stat>[,<stat>...] <report>...
+//     one line per run with the value of each stat (last window by
+//     default), or of the run metadata with that name. A stat ending in *
+//     selects all the stats with that prefix.
+//
+//   report_tool merge <out.drep> <report>...
+//     writes all the runs of the reports in a single file.
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_split.h"
+#include "fmt/format.h"
+#include "report_bin.hpp"
+
+static bool load(Report_bin_reader &reader, const std::vector<std::string> &files) {
+  bool ok = true;
+  for (const auto &f : files) {
+    if (!reader.open(f)) {
+      fmt::print(stderr, "ERROR: {} is not a structured report\n", f);
+      ok = false;
+    }
+  }
+  return ok;
+}
+
+static int dump(const Report_bin_reader &reader) {
+  for (size_t r = 0; r < reader.get_nruns(); ++r) {
+    const auto &run = reader.get_run(r);
+    fmt::print("#BEGIN:run {} ({})\n", reader.get_string(run.name), run.file);
+
+    for (const auto &m : run.meta) {
+      fmt::print("OSSim:{}={}\n", reader.get_string(m.first), reader.get_string(m.second));
+    }
+    for (const auto &c : run.config) {
+      fmt::print("[{}] {}[{}] = {}\n",
+                 reader.get_string(c.section),
+                 reader.get_string(c.field),
+                 c.pos,
+                 reader.get_string(c.value));
+    }
+    for (size_t w = 0; w < run.windows.size(); ++w) {
+      fmt::print("#BEGIN:window {}\n", w);
+      for (const auto &s : run.windows[w]) {
+        fmt::print("{}={}\n", reader.get_string(s.first), s.second);
+      }
+    }
+
+    fmt::print("#END:run {}\n", reader.get_string(run.name));
+  }
+
+  return 0;
+}
+
+static int query(const Report_bin_reader &reader, const std::string &stats, int window) {
+  std::vector<std::string> names;
+  for (const auto &s : absl::StrSplit(stats, ',', absl::SkipEmpty())) {
+    std::string name{s.data(), s.size()};
+    if (name.back() != '*') {
+      names.emplace_back(name);
+      continue;
+    }
+
+    // Prefix: every stat name of the runs
+    name.pop_back();
+    std::vector<std::string> found;
+    for (size_t r = 0; r < reader.get_nruns(); ++r) {
+      for (const auto &w : reader.get_run(r).windows) {
+        for (const auto &e : w) {
+          const auto &str = reader.get_string(e.first);
+          if (str.compare(0, name.size(), name) == 0) {
+            found.emplace_back(str);
+          }
+        }
+      }
+    }
+    std::sort(found.begin(), found.end());
+    found.erase(std::unique(found.begin(), found.end()), found.end());
+    names.insert(names.end(), found.begin(), found.end());
+  }
+
+  std::string line = "run";
+  for (const auto &name : names) {
+    line += fmt::format("\t{}", name);
+  }
+  fmt::print("{}\n", line);
+
+  for (size_t r = 0; r < reader.get_nruns(); ++r) {
+    line = reader.get_string(reader.get_run(r).name);
+    for (const auto &name : names) {
+      double v;
+      if (reader.get_stat(r, name, v, window)) {
+        line += fmt::format("\t{}", v);
+        continue;
+      }
+      auto meta = reader.get_meta(r, name);
+      line += meta.empty() ? "\t-" : fmt::format("\t{}", meta);
+    }
+    fmt::print("{}\n", line);
+  }
+
+  return 0;
+}
+
+static int merge(const Report_bin_reader &reader, const std::string &out) {
+  Report_bin_writer writer;
+  if (!writer.open(out)) {
+    fmt::print(stderr, "ERROR: could not create {}\n", out);
+    return 1;
+  }
+
+  for (size_t r = 0; r < reader.get_nruns(); ++r) {
+    const auto &run = reader.get_run(r);
+    writer.run(reader.get_string(run.name));
+
+    for (const auto &m : run.meta) {
+      writer.meta(reader.get_string(m.first), reader.get_string(m.second));
+    }
+    for (const auto &c : run.config) {
+      writer.config(reader.get_string(c.section), reader.get_string(c.field), c.pos, reader.get_string(c.value));
+    }
+    for (const auto &w : run.windows) {
+      writer.window();
+      for (const auto &s : w) {
+        writer.stat(reader.get_string(s.first), s.second);
+      }
+    }
+  }
+  writer.close();
+
+  return 0;
+}
+
+static void usage() {
+  fmt::print("usage: report_tool dump <report>...\n");
+  fmt::print("       report_tool query [-w window] <stat>[,<stat>...] <report>...\n");
+  fmt::print("       report_tool merge <out.drep> <report>...\n");
+}
+
+int main(int argc, const char **argv) {
+  std::vector<std::string> args(argv + 1, argv + argc);
+  if (args.size() < 2) {
+    usage();
+    return 3;
+  }
+
+  auto cmd = args[0];
+  args.erase(args.begin());
+
+  Report_bin_reader reader;
+  if (cmd == "dump") {
+    return load(reader, args) ? dump(reader) : 1;
+  }
+
+  if (cmd == "query") {
+    int window = -1;
+    if (args[0] == "-w" && args.size() > 1) {
+      window = std::atoi(args[1].c_str());
+      args.erase(args.begin(), args.begin() + 2);
+    }
+    if (args.size() < 2) {
+      usage();
+      return 3;
+    }
+    auto stats = args[0];
+    args.erase(args.begin());
+    return load(reader, args) ? query(reader, stats, window) : 1;
+  }
+
+  if (cmd == "merge" && args.size() >= 2) {
+    auto out = args[0];
+    args.erase(args.begin());
+    return load(reader, args) ? merge(reader, out) : 1;
+  }
+
+  usage();
+  return 3;
+}
@@ -31,6 +31,7 @@ void Stats::unsubscribe() {
 
 void Stats::report_all() {
   Report::field(fmt::format("#BEGIN Stats"));
+  Report::window();
 
   for (const auto &e : store) {
     e.second->report();
@@ -53,7 +54,10 @@ Stats_cntr::Stats_cntr(const std::string &str) : Stats(str) {
   subscribe();
 }
 
-void Stats_cntr::report() const { Report::field(fmt::format("{}={}\n", name, data)); }
+void Stats_cntr::report() const {
+  Report::field(fmt::format("{}={}\n", name, data));
+  Report::stat(name, data);
+}
 
 void Stats_cntr::reset() { data = 0; }
 
@@ -75,6 +79,11 @@ void Stats_avg::report() const {
   auto v = data / nData;
 
   Report::field(fmt::format("{}:n={}::v={}\n", name, nData, v));  // n first for power
+
+  if (Report::has_bin()) {
+    Report::stat(name + ":n", nData);
+    Report::stat(name + ":v", v);
+  }
 }
 
 void Stats_avg::reset() {
@@ -91,7 +100,14 @@ Stats_max::Stats_max(const std::string &str) : Stats(str) {
   subscribe();
 }
 
-void Stats_max::report() const { Report::field(fmt::format("{}:max={}:n={}\n", name, maxValue, nData)); }
+void Stats_max::report() const {
+  Report::field(fmt::format("{}:max={}:n={}\n", name, maxValue, nData));
+
+  if (Report::has_bin()) {
+    Report::stat(name + ":max", maxValue);
+    Report::stat(name + ":n", nData);
+  }
+}
 
 void Stats_max::sample(const double v, bool en) {
   if (!en) {
@@ -120,6 +136,9 @@ void Stats_hist::report() const {
 
   for (const auto &e : hist) {
     Report::field(fmt::format("{}({})={}\n", name, e.first, e.second));
+    if (Report::has_bin()) {
+      Report::stat(fmt::format("{}({})", name, e.first), e.second);
+    }
     if (e.first > maxKey) {
       maxKey = e.first;
     }
@@ -130,6 +149,12 @@ void Stats_hist::report() const {
   Report::field(fmt::format("{}:max={}\n", name, maxKey));
   Report::field(fmt::format("{}:v={}\n", name, div));
   Report::field(fmt::format("{}:n={}\n", name, numSample));
+
+  if (Report::has_bin()) {
+    Report::stat(name + ":max", maxKey);
+    Report::stat(name + ":v", static_cast<double>(div));
+    Report::stat(name + ":n", numSample);
+  }
 }
 
 void Stats_hist::sample(bool enable, int32_t key, double weight) {
@@ -49,6 +49,8 @@ public:
 
   void dec(bool en) { data -= en ? 1 : 0; }
 
+  double get() const { return data; }
+
   void report() const final;
   void reset() final;
 };
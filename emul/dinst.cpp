@@ -176,15 +176,20 @@ DataSign Dinst::calcDataSign(int64_t _data) {
 }
 
 void Dinst::setDataSign(int64_t _data, Addr_t _ldpc) {
+  auto &c = get_cold();
   /// data = _data;
-  ldpc = _ldpc;
+  c.ldpc = _ldpc;
 
-  data_sign = calcDataSign(_data);
+  c.data_sign = calcDataSign(_data);
   // br_ld_chain_predictable = true; //FIXME - LDBP does prediction only if this flag is set(when load is predictable)
 }
 
 void Dinst::addDataSign(int ds, int64_t _data, Addr_t _ldpc) {
-  ldpc = (ldpc << 4) ^ _ldpc;
+  auto   &c         = get_cold();
+  Data_t &data      = c.data;
+  auto   &data_sign = c.data_sign;
+
+  c.ldpc = (c.ldpc << 4) ^ _ldpc;
 
   if (ds == 0) {
     /*if (_data == data)
@@ -218,6 +223,36 @@ void Dinst::addDataSign(int ds, int64_t _data, Addr_t _ldpc) {
 }
 #endif
 
+void Dinst::unlinkDeps() {
+  for (auto &n : pend) {
+    Dinst *parent = n.getParentDinst();
+    if (parent == 0) {
+      continue;
+    }
+
+    DinstNext *prev = 0;
+    for (DinstNext *it = parent->first; it; it = it->nextDep) {
+      if (it != &n) {
+        prev = it;
+        continue;
+      }
+      if (prev) {
+        prev->nextDep = it->nextDep;
+      } else {
+        parent->first = it->nextDep;
+      }
+      if (parent->last == it) {
+        parent->last = prev;
+      }
+      break;
+    }
+
+    n.setParentDinst(0);
+    nDeps--;
+  }
+  I(nDeps == 0);
+}
+
 void Dinst::scrap() {
   I(nDeps == 0);  // No deps src
   I(first == 0);  // no dependent instructions
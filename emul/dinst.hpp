@@ -27,13 +27,14 @@ class DinstNext {
 private:
   Dinst *dinst;
 #ifdef DINST_PARENT
-  Dinst *parentDinst;
+  Dinst *parentDinst;  // set while non-satisfied RAW dependence
+#else
+  bool used;
 #endif
 public:
   DinstNext() { dinst = 0; }
 
   DinstNext *nextDep;
-  bool       isUsed;  // true while non-satisfied RAW dependence
 
   const DinstNext *getNext() const { return nextDep; }
   DinstNext       *getNext() { return nextDep; }
@@ -47,14 +48,14 @@ public:
 
   Dinst *getDinst() const { return dinst; }
 
+  // The parent doubles as the used flag, so an entry is 3 pointers
 #ifdef DINST_PARENT
   Dinst *getParentDinst() const { return parentDinst; }
-  void   setParentDinst(Dinst *d) {
-    GI(d, isUsed);
-    parentDinst = d;
-  }
+  void   setParentDinst(Dinst *d) { parentDinst = d; }
+  bool   isUsed() const { return parentDinst != 0; }
 #else
-  void            setParentDinst(Dinst *d) {}
+  void            setParentDinst(Dinst *d) { used = d != 0; }
+  bool            isUsed() const { return used; }
 #endif
 };
 
@@ -102,105 +103,155 @@ enum DataSign {
   DS_OPos   = 40
 };
 
-class Dinst {
+// Rename-time idioms detected at decode (see OoOProcessor::rename)
+enum class Dinst_idiom : uint8_t {
+  None  = 0,
+  Move  = 1,  // copies its only source register
+  Zero  = 2,  // result is zero, independent of the sources
+  Const = 3   // result is an immediate
+};
+
+// Fields off the pipeline path: multi-level predictor and LDBP bookkeeping
+// used only by statistics, and the ESESC_TRACE_DATA values. A Dinst gets its
+// record on the first write, getters on a missing or stale record return the
+// defaults, so Dinst::create does not touch any of them.
+struct Dinst_cold {
+  Time_t   id = -1;  // owner ID, the record is stale if it does not match
+  uint64_t inflight = 0;
+  uint32_t branch_signature = 0;
+  int      trig_ld_status   = -1;  // TL timeliness, (-1)->no LDBP; 0->on time; 1->late
+
+  bool use_level3          = false;  // use level3 bpred or not?
+  bool branch_hit2_miss3   = false;  // coorect pred by level 2 BP but misprediction by level 3 BP
+  bool branch_hit3_miss2   = false;  // coorect pred by level 3 BP but misprediction by level 2 BP
+  bool branchHit_level1    = false;
+  bool branchHit_level2    = false;
+  bool branchHit_level3    = false;
+  bool branchMiss_level1   = false;
+  bool branchMiss_level2   = false;
+  bool branchMiss_level3   = false;
+  bool level3_NoPrediction = false;
+  bool trig_ld1_pred       = false;
+  bool trig_ld1_unpred     = false;
+  bool trig_ld2_pred       = false;
+  bool trig_ld2_unpred     = false;
+  bool imli_highconf       = false;
+
+#ifdef ESESC_TRACE_DATA
+  Addr_t   ldpc           = 0;
+  Addr_t   ld_addr        = 0;
+  Addr_t   base_pref_addr = 0;
+  Data_t   data           = 0;
+  Data_t   data2          = 0;
+  DataSign data_sign      = DS_NoData;
+  Data_t   br_data1       = 0;
+  Data_t   br_data2       = 0;
+  int      ld_br_type     = 0;
+  int      dep_depth      = 0;
+  int      chained        = 0;
+  // BR stats
+  Addr_t   brpc                    = 0;
+  uint64_t delta                   = 0;
+  uint64_t br_op_type              = -1;
+  int      ret_br_count            = 0;
+  bool     br_ld_chain_predictable = false;
+  bool     br_ld_chain             = false;
+#endif
+};
+
+// Pipeline record. The fields touched by rename, wakeup and select come
+// first so that most instructions only touch the first cache line.
+class alignas(64) Dinst {
 private:
   // In a typical RISC processor MAX_PENDING_SOURCES should be 2
   static const int32_t MAX_PENDING_SOURCES = 3;
 
   static pool<Dinst> dInstPool;
 
-  DinstNext  pend[MAX_PENDING_SOURCES];
+  Time_t        ID;  // static ID, increased every create (currentID). pointer to the
+  static Time_t currentID;
+
+  Instruction inst;
+  Hartid_t    fid;
+  Addr_t      pc;    // PC for the dinst
+  Addr_t      addr;  // Either load/store address or jump/branch address
+
   DinstNext *last;
   DinstNext *first;
-
-  Hartid_t fid;
+  char       nDeps;  // 0, 1 or 2 for RISC processors
 
   // BEGIN Boolean flags
+  bool retired : 1;
+  bool loadForwarded : 1;
+  bool replay : 1;
+  bool branchMiss : 1;
+  bool performed : 1;
+  bool interCluster : 1;
+  bool keep_stats : 1;
+  bool biasBranch : 1;
+  bool prefetch : 1;
+  bool dispatched : 1;
+  bool fullMiss : 1;  // Only for DL1
+  bool speculative : 1;
+  bool eliminated : 1;  // removed at rename, never executes
+  bool checkpointed : 1;  // branch holding a rename checkpoint, recovers at execute
+  bool squashed : 1;      // removed by a branch recovery while an event was pending
+  // END Boolean flags
+
+  uint8_t idiom : 2;
+
+  // Physical registers when the core models a register file (prf_size)
+  int16_t preg_src1;
+  int16_t preg_src2;
+  int16_t preg_dst;
+  int16_t preg_old;  // previous mapping of the destination
+
+  SSID_t SSID;
+
+  Cluster  *cluster;   // not owned, Cluster::create keeps clusters and resources alive
+  Resource *resource;  // not owned
+
   Time_t fetched;
   Time_t renamed;
   Time_t issued;
   Time_t executing;
   Time_t executed;
 
-  bool retired;
-
-  bool loadForwarded;
-  bool replay;
-  bool branchMiss;
-  bool use_level3;         // use level3 bpred or not?
-  bool branch_hit2_miss3;  // coorect pred by level 2 BP but misprediction by level 3 BP
-  bool branch_hit3_miss2;  // coorect pred by level 3 BP but misprediction by level 2 BP
-  bool branchHit_level1;
-  bool branchHit_level2;
-  bool branchHit_level3;
-  bool branchMiss_level1;
-  bool branchMiss_level2;
-  bool branchMiss_level3;
-  bool level3_NoPrediction;
-  int  trig_ld_status;  // TL timeliness, (-1)->no LDBP; 0->on time; 1->late
-  bool trig_ld1_pred;
-  bool trig_ld1_unpred;
-  bool trig_ld2_pred;
-  bool trig_ld2_unpred;
-
-  bool performed;
-
-  bool     interCluster;
-  bool     keep_stats;
-  bool     biasBranch;
-  uint32_t branch_signature;
-  bool     imli_highconf;
-
-  bool prefetch;
-  bool dispatched;
-  bool fullMiss;  // Only for DL1
-  bool speculative;
+  Dinst      **RAT1Entry;
+  Dinst      **RAT2Entry;
+  Dinst      **serializeEntry;
+  FetchEngine *fetch;
+  GProcessor  *gproc;
+  Addr_t       conflictStorePC;
 
-  // END Boolean flags
+  DinstNext pend[MAX_PENDING_SOURCES];
 
-  SSID_t      SSID;
-  Addr_t      conflictStorePC;
-  Instruction inst;
-  Addr_t      pc;    // PC for the dinst
-  Addr_t      addr;  // Either load/store address or jump/branch address
-  uint64_t    inflight;
+  std::unique_ptr<Dinst_cold> cold;  // reused across pool recycles
 
-#ifdef ESESC_TRACE_DATA
-  Addr_t   ldpc;
-  Addr_t   ld_addr;
-  Addr_t   base_pref_addr;
-  Data_t   data;
-  Data_t   data2;
-  DataSign data_sign;
-  Data_t   br_data1;
-  Data_t   br_data2;
-  int      ld_br_type;
-  int      dep_depth;
-  int      chained;
-  // BR stats
-  Addr_t   brpc;
-  uint64_t delta;
-  uint64_t br_op_type;
-  int      ret_br_count;
-  bool     br_ld_chain_predictable;
-  bool     br_ld_chain;
+#ifndef NDEBUG
+  uint64_t mreq_id;
 #endif
 
-  std::shared_ptr<Cluster>  cluster;
-  std::shared_ptr<Resource> resource;
-  Dinst                   **RAT1Entry;
-  Dinst                   **RAT2Entry;
-  Dinst                   **serializeEntry;
-  FetchEngine              *fetch;
-  GProcessor               *gproc;
+  bool has_cold() const { return cold && cold->id == ID; }
+
+  // Cold record of this instance, reset when it belonged to an older Dinst
+  Dinst_cold &get_cold() {
+    if (!cold) {
+      cold = std::make_unique<Dinst_cold>();
+    }
+    if (cold->id != ID) {
+      *cold    = Dinst_cold();
+      cold->id = ID;
+    }
+    return *cold;
+  }
 
-  char nDeps;  // 0, 1 or 2 for RISC processors
+  static const Dinst_cold &cold_default() {
+    static const Dinst_cold def;
+    return def;
+  }
+  const Dinst_cold &read_cold() const { return has_cold() ? *cold : cold_default(); }
 
-  static Time_t currentID;
-  Time_t        ID;  // static ID, increased every create (currentID). pointer to the
-#ifndef NDEBUG
-  uint64_t mreq_id;
-#endif
   void setup() {
     ID = currentID++;
 #ifndef NDEBUG
@@ -208,32 +259,16 @@ private:
 #endif
     first = 0;
 
-    RAT1Entry           = 0;
-    RAT2Entry           = 0;
-    serializeEntry      = 0;
-    fetch               = 0;
-    cluster             = nullptr;
-    resource            = nullptr;
-    branchMiss          = false;
-    use_level3          = false;
-    trig_ld1_pred       = false;
-    trig_ld1_unpred     = false;
-    trig_ld2_pred       = false;
-    trig_ld2_unpred     = false;
-    branch_hit2_miss3   = false;
-    branch_hit3_miss2   = false;
-    branchHit_level1    = false;
-    branchHit_level2    = false;
-    branchHit_level3    = false;
-    branchMiss_level1   = false;
-    branchMiss_level2   = false;
-    branchMiss_level3   = false;
-    level3_NoPrediction = false;
-    trig_ld_status      = -1;
-    imli_highconf       = false;
-    gproc               = 0;
-    SSID                = -1;
-    conflictStorePC     = 0;
+    RAT1Entry       = 0;
+    RAT2Entry       = 0;
+    serializeEntry  = 0;
+    fetch           = 0;
+    cluster         = nullptr;
+    resource        = nullptr;
+    branchMiss      = false;
+    gproc           = 0;
+    SSID            = -1;
+    conflictStorePC = 0;
 
     fetched   = 0;
     renamed   = 0;
@@ -251,16 +286,19 @@ private:
     dispatched   = false;
     fullMiss     = false;
     speculative  = true;
+    eliminated   = false;
+    checkpointed = false;
+    squashed     = false;
+    idiom        = 0;
+
+    preg_src1 = -1;
+    preg_src2 = -1;
+    preg_dst  = -1;
+    preg_old  = -1;
 
-#ifdef DINST_PARENT
     pend[0].setParentDinst(0);
     pend[1].setParentDinst(0);
     pend[2].setParentDinst(0);
-#endif
-
-    pend[0].isUsed = false;
-    pend[1].isUsed = false;
-    pend[2].isUsed = false;
   }
 
 protected:
@@ -300,30 +338,10 @@ public:
     Dinst *i = dInstPool.out();
     I(inst.getOpcode()!=iOpInvalid);
 
-    i->fid      = fid;
-    i->inst     = std::move(inst);
-    i->pc       = pc;
-    i->addr     = address;
-    i->inflight = 0;
-#ifdef ESESC_TRACE_DATA
-    i->data           = 0;
-    i->data2          = 0;
-    i->br_data1       = 0;
-    i->br_data2       = 0;
-    i->ld_br_type     = 0;
-    i->dep_depth      = 0;
-    i->ldpc           = 0;
-    i->ld_addr        = 0;
-    i->base_pref_addr = 0;
-    i->data_sign      = DS_NoData;
-    i->chained        = 0;
-    // BR stats
-    i->brpc        = 0;
-    i->delta       = 0;
-    i->br_ld_chain = false;
-    i->br_op_type  = -1;
-#endif
-    i->fetched    = 0;
+    i->fid        = fid;
+    i->inst       = std::move(inst);
+    i->pc         = pc;
+    i->addr       = address;
     i->keep_stats = keep_stats;
 
     i->setup();
@@ -332,75 +350,75 @@ public:
     return i;
   }
 #ifdef ESESC_TRACE_DATA
-  uint64_t getDelta() const { return delta; }
+  uint64_t getDelta() const { return read_cold().delta; }
 
-  void setDelta(uint64_t _delta) { delta = _delta; }
+  void setDelta(uint64_t _delta) { get_cold().delta = _delta; }
 
-  int getRetireBrCount() const { return ret_br_count; }
+  int getRetireBrCount() const { return read_cold().ret_br_count; }
 
-  void setRetireBrCount(int _cnt) { ret_br_count = _cnt; }
+  void setRetireBrCount(int _cnt) { get_cold().ret_br_count = _cnt; }
 
-  bool is_br_ld_chain() const { return br_ld_chain; }
+  bool is_br_ld_chain() const { return read_cold().br_ld_chain; }
 
-  void set_br_ld_chain() { br_ld_chain = true; }
+  void set_br_ld_chain() { get_cold().br_ld_chain = true; }
 
-  bool is_br_ld_chain_predictable() { return br_ld_chain_predictable; }
+  bool is_br_ld_chain_predictable() const { return read_cold().br_ld_chain_predictable; }
 
-  void set_br_ld_chain_predictable() { br_ld_chain_predictable = true; }
+  void set_br_ld_chain_predictable() { get_cold().br_ld_chain_predictable = true; }
 
-  Addr_t getBasePrefAddr() const { return base_pref_addr; }
+  Addr_t getBasePrefAddr() const { return read_cold().base_pref_addr; }
 
-  void setBasePrefAddr(Addr_t _base_addr) { base_pref_addr = _base_addr; }
+  void setBasePrefAddr(Addr_t _base_addr) { get_cold().base_pref_addr = _base_addr; }
 
-  Addr_t getLdAddr() const { return ld_addr; }
+  Addr_t getLdAddr() const { return read_cold().ld_addr; }
 
-  void setLdAddr(Addr_t _ld_addr) { ld_addr = _ld_addr; }
+  void setLdAddr(Addr_t _ld_addr) { get_cold().ld_addr = _ld_addr; }
 
-  Addr_t getBrPC() const { return brpc; }
+  Addr_t getBrPC() const { return read_cold().brpc; }
 
-  void setBrPC(Addr_t _brpc) { brpc = _brpc; }
+  void setBrPC(Addr_t _brpc) { get_cold().brpc = _brpc; }
 
   static DataSign calcDataSign(int64_t data);
 
-  int getDepDepth() const { return dep_depth; }
+  int getDepDepth() const { return read_cold().dep_depth; }
 
-  void setDepDepth(int d) { dep_depth = d; }
+  void setDepDepth(int d) { get_cold().dep_depth = d; }
 
-  int getLBType() const { return ld_br_type; }
+  int getLBType() const { return read_cold().ld_br_type; }
 
-  void setLBType(int lb) { ld_br_type = lb; }
+  void setLBType(int lb) { get_cold().ld_br_type = lb; }
 
-  Data_t getBrData1() const { return br_data1; }
+  Data_t getBrData1() const { return read_cold().br_data1; }
 
-  Data_t getBrData2() const { return br_data2; }
+  Data_t getBrData2() const { return read_cold().br_data2; }
 
-  Data_t getData() const { return data; }
+  Data_t getData() const { return read_cold().data; }
 
-  Data_t getData2() const { return data2; }
+  Data_t getData2() const { return read_cold().data2; }
 
-  DataSign getDataSign() const { return (DataSign)(int(data_sign) & 0x1FF); }  // FIXME:}
+  DataSign getDataSign() const { return (DataSign)(int(read_cold().data_sign) & 0x1FF); }  // FIXME:}
 
   // DataSign getDataSign() const { return data_sign; }
   void setDataSign(int64_t _data, Addr_t ldpc);
   void addDataSign(int ds, int64_t _data, Addr_t ldpc);
 
-  void setBrData1(Data_t _data) { br_data1 = _data; }
+  void setBrData1(Data_t _data) { get_cold().br_data1 = _data; }
 
-  void setBrData2(Data_t _data) { br_data2 = _data; }
+  void setBrData2(Data_t _data) { get_cold().br_data2 = _data; }
 
-  void setData(uint64_t _data) { data = _data; }
+  void setData(uint64_t _data) { get_cold().data = _data; }
 
-  void setData2(uint64_t _data) { data2 = _data; }
+  void setData2(uint64_t _data) { get_cold().data2 = _data; }
 
-  Addr_t getLDPC() const { return ldpc; }
+  Addr_t getLDPC() const { return read_cold().ldpc; }
   void   setChain(FetchEngine *fe, int c) {
     I(fetch == 0);
     I(c);
     I(fe);
-    fetch   = fe;
-    chained = c;
+    fetch              = fe;
+    get_cold().chained = c;
   }
-  int getChained() const { return chained; }
+  int getChained() const { return read_cold().chained; }
 #else
   static DataSign calcDataSign(int64_t data) {
     (void)data;
@@ -438,14 +456,16 @@ public:
 #endif
 
   void scrap();  // Destroys the instruction without any other effects
+  // Leaves the consumer lists of the producers it still waits on (squash)
+  void unlinkDeps();
   void destroy();
 
-  void set(std::shared_ptr<Cluster> cls, std::shared_ptr<Resource> res) {
+  void set(Cluster *cls, Resource *res) {
     cluster  = cls;
     resource = res;
   }
-  std::shared_ptr<Cluster>  getCluster() const { return cluster; }
-  std::shared_ptr<Resource> getClusterResource() const { return resource; }
+  Cluster  *getCluster() const { return cluster; }
+  Resource *getClusterResource() const { return resource; }
 
   void clearRATEntry();
   void setRAT1Entry(Dinst **rentry) {
@@ -473,19 +493,19 @@ public:
 
 #ifdef DINST_PARENT
   Dinst *getParentSrc1() const {
-    if (pend[0].isUsed) {
+    if (pend[0].isUsed()) {
       return pend[0].getParentDinst();
     }
     return 0;
   }
   Dinst *getParentSrc2() const {
-    if (pend[1].isUsed) {
+    if (pend[1].isUsed()) {
       return pend[1].getParentDinst();
     }
     return 0;
   }
   Dinst *getParentSrc3() const {
-    if (pend[2].isUsed) {
+    if (pend[2].isUsed()) {
       return pend[2].getParentDinst();
     }
     return 0;
@@ -502,7 +522,7 @@ public:
 
   void setFetchTime() {
 #ifdef ESESC_TRACE_DATA
-    I(fetch == 0 || chained);
+    I(fetch == 0 || getChained());
 #else
     I(fetch == 0);
 #endif
@@ -510,79 +530,80 @@ public:
     fetched = globalClock;
   }
 
-  uint64_t getInflight() const { return inflight; }
+  uint64_t getInflight() const { return read_cold().inflight; }
 
-  void setInflight(uint64_t _inf) { inflight = _inf; }
+  void setInflight(uint64_t _inf) { get_cold().inflight = _inf; }
 
-  void setUseLevel3() { use_level3 = true; }
+  void setUseLevel3() { get_cold().use_level3 = true; }
 
-  bool isUseLevel3() const { return use_level3; }
+  bool isUseLevel3() const { return read_cold().use_level3; }
 
-  void setTrig_ld1_pred() { trig_ld1_pred = true; }
+  void setTrig_ld1_pred() { get_cold().trig_ld1_pred = true; }
 
-  bool isTrig_ld1_pred() const { return trig_ld1_pred; }
+  bool isTrig_ld1_pred() const { return read_cold().trig_ld1_pred; }
 
-  void setTrig_ld1_unpred() { trig_ld1_unpred = true; }
+  void setTrig_ld1_unpred() { get_cold().trig_ld1_unpred = true; }
 
-  bool isTrig_ld1_unpred() const { return trig_ld1_unpred; }
+  bool isTrig_ld1_unpred() const { return read_cold().trig_ld1_unpred; }
 
-  void setTrig_ld2_pred() { trig_ld2_pred = true; }
+  void setTrig_ld2_pred() { get_cold().trig_ld2_pred = true; }
 
-  bool isTrig_ld2_pred() const { return trig_ld2_pred; }
+  bool isTrig_ld2_pred() const { return read_cold().trig_ld2_pred; }
 
-  void setTrig_ld2_unpred() { trig_ld2_unpred = true; }
+  void setTrig_ld2_unpred() { get_cold().trig_ld2_unpred = true; }
 
-  bool isTrig_ld2_unpred() const { return trig_ld2_unpred; }
+  bool isTrig_ld2_unpred() const { return read_cold().trig_ld2_unpred; }
 
-  void setBranch_hit2_miss3() { branch_hit2_miss3 = true; }
+  void setBranch_hit2_miss3() { get_cold().branch_hit2_miss3 = true; }
 
-  bool isBranch_hit2_miss3() const { return branch_hit2_miss3; }
+  bool isBranch_hit2_miss3() const { return read_cold().branch_hit2_miss3; }
 
-  void setBranch_hit3_miss2() { branch_hit3_miss2 = true; }
+  void setBranch_hit3_miss2() { get_cold().branch_hit3_miss2 = true; }
 
-  bool isBranch_hit3_miss2() const { return branch_hit3_miss2; }
+  bool isBranch_hit3_miss2() const { return read_cold().branch_hit3_miss2; }
 
-  void setBranchHit_level1() { branchHit_level1 = true; }
+  void setBranchHit_level1() { get_cold().branchHit_level1 = true; }
 
-  bool isBranchHit_level1() const { return branchHit_level1; }
+  bool isBranchHit_level1() const { return read_cold().branchHit_level1; }
 
-  void setBranchHit_level2() { branchHit_level2 = true; }
+  void setBranchHit_level2() { get_cold().branchHit_level2 = true; }
 
-  bool isBranchHit_level2() const { return branchHit_level2; }
+  bool isBranchHit_level2() const { return read_cold().branchHit_level2; }
 
-  void setBranchHit_level3() { branchHit_level3 = true; }
+  void setBranchHit_level3() { get_cold().branchHit_level3 = true; }
 
-  bool isBranchHit_level3() const { return branchHit_level3; }
+  bool isBranchHit_level3() const { return read_cold().branchHit_level3; }
 
-  void setBranchMiss_level1() { branchMiss_level1 = true; }
+  void setBranchMiss_level1() { get_cold().branchMiss_level1 = true; }
 
-  bool isBranchMiss_level1() const { return branchMiss_level1; }
+  bool isBranchMiss_level1() const { return read_cold().branchMiss_level1; }
 
-  void setBranchMiss_level2() { branchMiss_level2 = true; }
+  void setBranchMiss_level2() { get_cold().branchMiss_level2 = true; }
 
-  bool isBranchMiss_level2() const { return branchMiss_level2; }
+  bool isBranchMiss_level2() const { return read_cold().branchMiss_level2; }
 
-  void setBranchMiss_level3() { branchMiss_level3 = true; }
+  void setBranchMiss_level3() { get_cold().branchMiss_level3 = true; }
 
-  bool isBranchMiss_level3() const { return branchMiss_level3; }
+  bool isBranchMiss_level3() const { return read_cold().branchMiss_level3; }
 
   void set_trig_ld_status() {  // set to 0
-    if (trig_ld_status == -1) {
-      trig_ld_status = 0;
+    auto &c = get_cold();
+    if (c.trig_ld_status == -1) {
+      c.trig_ld_status = 0;
     }
   }
 
   void inc_trig_ld_status() {  // inc on late TL
-    if (trig_ld_status == 0) {
-      trig_ld_status = 1;
+    if (get_trig_ld_status() == 0) {
+      get_cold().trig_ld_status = 1;
     }
   }
 
-  int get_trig_ld_status() const { return trig_ld_status; }
+  int get_trig_ld_status() const { return read_cold().trig_ld_status; }
 
-  void setLevel3_NoPrediction() { level3_NoPrediction = true; }
+  void setLevel3_NoPrediction() { get_cold().level3_NoPrediction = true; }
 
-  bool isLevel3_NoPrediction() const { return level3_NoPrediction; }
+  bool isLevel3_NoPrediction() const { return read_cold().level3_NoPrediction; }
 
   bool         isBranchMiss() const { return branchMiss; }
   FetchEngine *getFetchEngine() const { return fetch; }
@@ -608,7 +629,6 @@ public:
     I(n->nDeps > 0);
     n->nDeps--;
 
-    first->isUsed = false;
     first->setParentDinst(0);
     first = first->getNext();
 
@@ -622,8 +642,7 @@ public:
     I(executed == 0);
     I(d->executed == 0);
     DinstNext *n = &d->pend[0];
-    I(!n->isUsed);
-    n->isUsed = true;
+    I(!n->isUsed());
     n->setParentDinst(this);
 
     I(n->getDinst() == d);
@@ -643,8 +662,7 @@ public:
     I(d->executed == 0);
 
     DinstNext *n = &d->pend[1];
-    I(!n->isUsed);
-    n->isUsed = true;
+    I(!n->isUsed());
     n->setParentDinst(this);
 
     I(n->getDinst() == d);
@@ -664,8 +682,7 @@ public:
     I(d->executed == 0);
 
     DinstNext *n = &d->pend[2];
-    I(!n->isUsed);
-    n->isUsed = true;
+    I(!n->isUsed());
     n->setParentDinst(this);
 
     I(n->getDinst() == d);
@@ -689,13 +706,13 @@ public:
   Hartid_t getFlowId() const { return fid; }
 
   char getnDeps() const { return nDeps; }
-  bool isSrc1Ready() const { return !pend[0].isUsed; }
-  bool isSrc2Ready() const { return !pend[1].isUsed; }
-  bool isSrc3Ready() const { return !pend[2].isUsed; }
+  bool isSrc1Ready() const { return !pend[0].isUsed(); }
+  bool isSrc2Ready() const { return !pend[1].isUsed(); }
+  bool isSrc3Ready() const { return !pend[2].isUsed(); }
   bool hasPending() const { return first != 0; }
 
   bool hasDeps() const {
-    GI(!pend[0].isUsed && !pend[1].isUsed && !pend[2].isUsed, nDeps == 0);
+    GI(!pend[0].isUsed() && !pend[1].isUsed() && !pend[2].isUsed(), nDeps == 0);
     return nDeps != 0;
   }
 
@@ -744,18 +761,47 @@ public:
     executing = globalClock;
   }
 
+  void        setIdiom(Dinst_idiom i) { idiom = static_cast<uint8_t>(i); }
+  Dinst_idiom getIdiom() const { return static_cast<Dinst_idiom>(idiom); }
+  bool        isEliminated() const { return eliminated; }
+  void        markEliminated() {
+    I(idiom != 0);
+    I(issued == 0);
+    eliminated = true;
+    issued     = globalClock;
+    executed   = globalClock;
+    performed  = true;
+  }
+
+  void setPhysRegs(int16_t src1, int16_t src2, int16_t dst, int16_t old) {
+    preg_src1 = src1;
+    preg_src2 = src2;
+    preg_dst  = dst;
+    preg_old  = old;
+  }
+  int16_t getPhysSrc1() const { return preg_src1; }
+  int16_t getPhysSrc2() const { return preg_src2; }
+  int16_t getPhysDst() const { return preg_dst; }
+  int16_t getPhysOld() const { return preg_old; }
+
+  bool hasCheckpoint() const { return checkpointed; }
+  void markCheckpoint() { checkpointed = true; }
+
+  bool isSquashed() const { return squashed; }
+  void markSquashed() { squashed = true; }
+
   bool isReplay() const { return replay; }
   void markReplay() { replay = true; }
 
   void setBiasBranch(bool b) { biasBranch = b; }
   bool isBiasBranch() const { return biasBranch; }
 
-  void setImliHighConf() { imli_highconf = true; }
+  void setImliHighConf() { get_cold().imli_highconf = true; }
 
-  bool getImliHighconf() const { return imli_highconf; }
+  bool getImliHighconf() const { return read_cold().imli_highconf; }
 
-  void     setBranchSignature(uint32_t s) { branch_signature = s; }
-  uint32_t getBranchSignature() const { return branch_signature; }
+  void     setBranchSignature(uint32_t s) { get_cold().branch_signature = s; }
+  uint32_t getBranchSignature() const { return read_cold().branch_signature; }
 
   bool isTaken() const {
     I(getInst()->isControl());
@@ -0,0 +1,54 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "dinst.hpp"
+#include "instruction.hpp"
+
+// Keeps a ROB-like window of in-flight instructions. Each iteration retires the
+// oldest one, creates a new one that depends on its predecessor and wakes it up.
+static void BM_DinstWindow(benchmark::State& state) {
+  const size_t window = state.range(0);
+
+  globalClock = 1;
+
+  std::vector<Dinst*> rob(window, nullptr);
+  size_t              pos  = 0;
+  Dinst*              prev = nullptr;
+
+  for (auto _ : state) {
+    if (rob[pos]) {
+      rob[pos]->destroy();
+    }
+
+    auto* dinst = Dinst::create(Instruction(iAALU, LREG_R1, LREG_R2, LREG_R3, LREG_InvalidOutput), 0x1000 + pos * 4, 0, 0, true);
+    if (prev) {
+      prev->addSrc1(dinst);
+      prev->markIssued();
+      prev->markExecuted();
+      prev->getNextPending();
+    }
+
+    rob[pos] = dinst;
+    prev     = dinst;
+    pos      = (pos + 1) % window;
+  }
+
+  if (prev) {
+    prev->markIssued();
+    prev->markExecuted();
+  }
+  for (auto* d : rob) {
+    if (d) {
+      d->destroy();
+    }
+  }
+
+  state.counters["bytes_per_inst"]      = sizeof(Dinst);
+  state.counters["window_bytes"]        = sizeof(Dinst) * window;
+  state.counters["cold_bytes_per_inst"] = sizeof(Dinst_cold);
+}
+BENCHMARK(BM_DinstWindow)->Arg(256)->Arg(1024)->Arg(16384);
+
+BENCHMARK_MAIN();
@@ -8,6 +8,7 @@
 #include "config.hpp"
 #include "dinst.hpp"
 #include "iassert.hpp"
+#include "wrong_path.hpp"
 
 class Emul_base {
 protected:
@@ -26,6 +27,25 @@ public:
 
   virtual void skip_rabbit(Hartid_t fid, size_t ninst) = 0;
 
+  // Wrong path. fork_wrong_path starts ctx on the direction not taken by the
+  // conditional branch that fid just executed (false when not supported).
+  // peek_wrong_path/execute_wrong_path walk ctx without changing the hart
+  virtual bool fork_wrong_path(Hartid_t fid, const Dinst *branch, Wrong_path_context &ctx) {
+    (void)fid;
+    (void)branch;
+    (void)ctx;
+    return false;
+  }
+  virtual Dinst *peek_wrong_path(Hartid_t fid, Wrong_path_context &ctx) {
+    (void)fid;
+    (void)ctx;
+    return nullptr;
+  }
+  virtual void execute_wrong_path(Hartid_t fid, Wrong_path_context &ctx) {
+    (void)fid;
+    ctx.step();
+  }
+
   const std::string &get_type() const { return type; }
   const std::string &get_section() const { return section; }
 };
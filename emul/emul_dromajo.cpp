@@ -2,6 +2,8 @@
 
 #include "emul_dromajo.hpp"
 
+#include <algorithm>
+#include <cstring>
 #include <filesystem>
 
 #include "absl/strings/str_split.h"
@@ -135,9 +137,36 @@ static inline Addr_t C2_swsp_addr_decode(uint16_t insn_raw) {
 }
 
 Dinst *Emul_dromajo::peek(Hartid_t fid) {
+  bool keep_stats;
+  if (detail > 0) {
+    --detail;
+    keep_stats = false;
+  } else if (time > 0) {
+    --time;
+    keep_stats = true;
+  } else {
+    return nullptr;
+  }
+
   uint64_t last_pc  = virt_machine_get_pc(machine, fid);
   uint32_t insn_raw = -1;
   (void)riscv_read_insn(machine->cpu_state[fid], &insn_raw, last_pc);
+
+  pc_lo = std::min(pc_lo, last_pc);
+  pc_hi = std::max(pc_hi, last_pc);
+
+  return decode(fid, last_pc, insn_raw, keep_stats);
+}
+
+uint64_t Emul_dromajo::get_reg(Hartid_t fid, uint32_t r) {
+  if (wp) {
+    wp->addr_known = wp->addr_known && wp->known(r);
+    return wp->get(r);
+  }
+  return virt_machine_get_reg(machine, fid, r);
+}
+
+Dinst *Emul_dromajo::decode(Hartid_t fid, Addr_t last_pc, uint32_t insn_raw, bool keep_stats) {
   // Assume compressed, default to 32-bit insn
   uint32_t funct7  = 0;
   uint32_t rs1     = 0;
@@ -150,12 +179,13 @@ Dinst *Emul_dromajo::peek(Hartid_t fid) {
   RegType  dst1    = LREG_INVALID;
   RegType  dst2    = LREG_InvalidOutput;
   Addr_t   address = 0;
+  auto     idiom   = Dinst_idiom::None;
   switch (insn_raw & 0x3) {  // compressed
     case 0x0:                // C0
       rs1     = C_reg_decode((insn_raw >> 7) & 0x7);
       rd      = C_reg_decode((insn_raw >> 2) & 0x7);
       src1    = (RegType)(rs1);
-      address = C0_addr_decode(insn_raw, funct3) + virt_machine_get_reg(machine, fid, rs1);
+      address = C0_addr_decode(insn_raw, funct3) + get_reg(fid, rs1);
 
       if (funct3 == 1 || funct3 == 5) {  // FP LD/ST
         rd += 32;
@@ -186,6 +216,10 @@ Dinst *Emul_dromajo::peek(Hartid_t fid) {
         rs1  = (insn_raw >> 7) & 0x1F;
         src1 = (RegType)(rs1);
         dst1 = src1;
+        if (rs1 && (funct3 == 2 || (funct3 == 3 && rs1 != 2))) {  // C.LI, C.LUI
+          bool zero = ((insn_raw >> 12) & 0x1) == 0 && ((insn_raw >> 2) & 0x1F) == 0;
+          idiom     = zero ? Dinst_idiom::Zero : Dinst_idiom::Const;
+        }
       } else {
         rs1    = C_reg_decode((insn_raw >> 7) & 0x7);
         src1   = (RegType)(rs1);
@@ -224,7 +258,7 @@ Dinst *Emul_dromajo::peek(Hartid_t fid) {
         if (funct3 != 0) {
           src1    = (RegType)(2);
           opcode  = iLALU_LD;
-          address = virt_machine_get_reg(machine, fid, 2);
+          address = get_reg(fid, 2);
 
           if (funct3 == 2) {
             address += C2_lwsp_addr_decode(insn_raw);
@@ -239,7 +273,7 @@ Dinst *Emul_dromajo::peek(Hartid_t fid) {
         dst1    = LREG_InvalidOutput;
         src1    = (RegType)(2);
         opcode  = iSALU_ST;
-        address = virt_machine_get_reg(machine, fid, 2);
+        address = get_reg(fid, 2);
 
         if (funct3 == 6) {
           address += C2_swsp_addr_decode(insn_raw);
@@ -255,7 +289,7 @@ Dinst *Emul_dromajo::peek(Hartid_t fid) {
           src2    = LREG_NoDependence;
           dst1    = (RegType)(0);
           opcode  = iBALU_RJUMP;
-          address = virt_machine_get_reg(machine, fid, rs1);
+          address = get_reg(fid, rs1);
 
           if (src1 == LREG_R1) {
             opcode = iBALU_RET;
@@ -264,10 +298,13 @@ Dinst *Emul_dromajo::peek(Hartid_t fid) {
           src2    = LREG_NoDependence;
           dst1    = (RegType)(1);
           opcode  = iBALU_RJUMP;
-          address = virt_machine_get_reg(machine, fid, rs1);
+          address = get_reg(fid, rs1);
         } else {
           if (funct7 == 0) {
             src1 = (RegType)(0);
+            if (rd) {
+              idiom = Dinst_idiom::Move;  // C.MV
+            }
           }
           src2 = (RegType)(rs2);
           dst1 = (RegType)(rd);
@@ -288,7 +325,7 @@ Dinst *Emul_dromajo::peek(Hartid_t fid) {
             src1    = (RegType)(rs1);
             src2    = LREG_NoDependence;
             dst1    = (RegType)(rs1);
-            address = I_type_addr_decode(insn_raw) + virt_machine_get_reg(machine, fid, rs1);
+            address = I_type_addr_decode(insn_raw) + get_reg(fid, rs1);
           }
           break;
         case 0x07:  //   FP Load
@@ -297,7 +334,7 @@ Dinst *Emul_dromajo::peek(Hartid_t fid) {
             src1    = (RegType)(rs1);
             src2    = LREG_NoDependence;
             dst1    = (RegType)(rd + 32);
-            address = I_type_addr_decode(insn_raw) + virt_machine_get_reg(machine, fid, rs1);
+            address = I_type_addr_decode(insn_raw) + get_reg(fid, rs1);
           }
           break;
         case 0x0F:
@@ -310,6 +347,14 @@ Dinst *Emul_dromajo::peek(Hartid_t fid) {
           src1 = (RegType)(rs1);
           src2 = LREG_NoDependence;
           dst1 = (RegType)(rd);
+          if (funct3 == 0 && rd) {  // ADDI: MV, LI
+            uint32_t imm = insn_raw >> 20;
+            if (rs1 == 0) {
+              idiom = imm ? Dinst_idiom::Const : Dinst_idiom::Zero;
+            } else if (imm == 0) {
+              idiom = Dinst_idiom::Move;
+            }
+          }
           break;
         case 0x17:
           src1 = LREG_NoDependence;
@@ -327,7 +372,7 @@ Dinst *Emul_dromajo::peek(Hartid_t fid) {
             src1    = (RegType)(rs1);
             src2    = (RegType)(rs2);
             dst1    = LREG_InvalidOutput;
-            address = S_type_addr_decode(funct7, rd) + virt_machine_get_reg(machine, fid, rs1);
+            address = S_type_addr_decode(funct7, rd) + get_reg(fid, rs1);
           }
           break;
         case 0x2F:
@@ -350,6 +395,9 @@ Dinst *Emul_dromajo::peek(Hartid_t fid) {
           src1 = (RegType)(rs1);
           src2 = (RegType)(rs2);
           dst1 = (RegType)(rd);
+          if (rd && rs1 == rs2 && ((funct7 == 0 && funct3 == 4) || (funct7 == 0x20 && funct3 == 0))) {  // XOR, SUB
+            idiom = Dinst_idiom::Zero;
+          }
           break;
         case 0x3b:
           if (funct7 == 1) {
@@ -368,7 +416,7 @@ Dinst *Emul_dromajo::peek(Hartid_t fid) {
           src1    = (RegType)(rs1);
           src2    = (RegType)(rs2 + 32);
           dst1    = LREG_InvalidOutput;
-          address = S_type_addr_decode(funct7, rd) + virt_machine_get_reg(machine, fid, rs1);
+          address = S_type_addr_decode(funct7, rd) + get_reg(fid, rs1);
           break;
         case 0x53:  // XXX - this should prob be its own function FP decode
           opcode = iCALU_FPALU;
@@ -417,7 +465,7 @@ Dinst *Emul_dromajo::peek(Hartid_t fid) {
               opcode = iBALU_RCALL;
             }
 
-            address += virt_machine_get_reg(machine, fid, rs1);
+            address += get_reg(fid, rs1);
           }
           break;
         case 0x6F:
@@ -454,20 +502,84 @@ Dinst *Emul_dromajo::peek(Hartid_t fid) {
   I(src2 != LREG_INVALID);
   I(dst1 != LREG_INVALID);
 
-  if (detail > 0) {
-    --detail;
-    return Dinst::create(
-      Instruction(opcode, src1, src2, dst1, dst2)
-      , last_pc, address, fid, false);
+  Dinst *dinst = Dinst::create(Instruction(opcode, src1, src2, dst1, dst2), last_pc, address, fid, keep_stats);
+  if (idiom != Dinst_idiom::None) {
+    dinst->setIdiom(idiom);
   }
-  if (time > 0) {
-    --time;
-    return Dinst::create(
-      Instruction(opcode, src1, src2, dst1, dst2)
-      , last_pc, address, fid, true);
+
+  return dinst;
+}
+
+bool Emul_dromajo::fork_wrong_path(Hartid_t fid, const Dinst *branch, Wrong_path_context &ctx) {
+  if (branch->getInst()->getOpcode() != iBALU_LBRANCH) {
+    return false;  // the wrong target of a jump is not known
   }
 
-  return nullptr;
+  uint32_t insn_raw = -1;
+  (void)riscv_read_insn(machine->cpu_state[fid], &insn_raw, branch->getPC());
+  Addr_t fallthru = branch->getPC() + ((insn_raw & 0x3) == 0x3 ? 4 : 2);
+
+  Addr_t next  = virt_machine_get_pc(machine, fid);
+  Addr_t wrong = next == branch->getAddr() ? fallthru : branch->getAddr();
+  if (wrong == next) {
+    return false;
+  }
+
+  uint64_t regs[32];
+  for (int r = 1; r < 32; ++r) {
+    regs[r] = virt_machine_get_reg(machine, fid, r);
+  }
+  ctx.fork(wrong, regs);
+
+  return true;
+}
+
+Dinst *Emul_dromajo::peek_wrong_path(Hartid_t fid, Wrong_path_context &ctx) {
+  // Stay in the code seen so far, reading other addresses could fault in dromajo
+  if (ctx.done || ctx.pc < pc_lo || ctx.pc > pc_hi || (detail == 0 && time == 0)) {
+    ctx.done = true;
+    return nullptr;
+  }
+
+  ctx.insn = -1;
+  if (riscv_read_insn(machine->cpu_state[fid], &ctx.insn, ctx.pc)) {
+    ctx.done = true;
+    return nullptr;
+  }
+
+  ctx.addr_known = true;
+  wp             = &ctx;
+  Dinst *dinst   = decode(fid, ctx.pc, ctx.insn, detail == 0);
+  wp             = nullptr;
+
+  return dinst;
+}
+
+Addr_t Emul_dromajo::get_pc(Hartid_t fid) const { return virt_machine_get_pc(machine, fid); }
+
+bool Emul_dromajo::read_mem(Addr_t addr, uint8_t *data, size_t size) const {
+  if (machine == nullptr || size == 0) {
+    return false;
+  }
+
+  // The caches see the virtual addresses of the instructions. They are the
+  // physical ones unless a hart translates (satp mode set below machine
+  // mode): then the line is not read and counts as incompressible
+  for (int i = 0; i < machine->ncpus; ++i) {
+    RISCVCPUState *cpu = machine->cpu_state[i];
+    if (riscv_get_priv_level(cpu) != PRV_M && (cpu->satp >> 60) != 0) {
+      return false;
+    }
+  }
+
+  const uint8_t *first = phys_mem_get_ram_ptr(machine->mem_map, addr, false);
+  const uint8_t *last  = phys_mem_get_ram_ptr(machine->mem_map, addr + size - 1, false);
+  if (first == nullptr || last != first + size - 1) {
+    return false;
+  }
+
+  memcpy(data, first, size);
+  return true;
 }
 
 void Emul_dromajo::execute(Hartid_t fid) {
@@ -15,8 +15,17 @@ protected:
 
   std::string bench;
 
+  // Code footprint seen by peek, the wrong path stays inside it
+  Addr_t pc_lo = ~static_cast<Addr_t>(0);
+  Addr_t pc_hi = 0;
+
+  Wrong_path_context *wp = nullptr;  // decode reads its registers when set
+
   void init_dromajo_machine();
 
+  uint64_t get_reg(Hartid_t fid, uint32_t r);
+  Dinst   *decode(Hartid_t fid, Addr_t last_pc, uint32_t insn_raw, bool keep_stats);
+
 public:
   Emul_dromajo();
   virtual ~Emul_dromajo();
@@ -36,6 +45,17 @@ public:
     }
   }
 
+  virtual bool   fork_wrong_path(Hartid_t fid, const Dinst *branch, Wrong_path_context &ctx) final;
+  virtual Dinst *peek_wrong_path(Hartid_t fid, Wrong_path_context &ctx) final;
+
+  // PC of the next instruction of fid (the outcome of the last executed branch)
+  Addr_t get_pc(Hartid_t fid) const;
+
+  // Copies size bytes of guest memory at addr (no side effects). addr is
+  // used as a physical address, so it is false while paging is on, or if
+  // the range is not all RAM
+  bool read_mem(Addr_t addr, uint8_t *data, size_t size) const;
+
   void set_detail(uint64_t ninst) { detail = ninst; }
   void set_time(uint64_t ninst) { time = ninst; }
 };
@@ -28,9 +28,15 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
+// Exposes the decoder to check single encodings
+class Emul_dromajo_decoder : public Emul_dromajo {
+public:
+  using Emul_dromajo::decode;
+};
+
 class Emul_Dromajo_test : public ::testing::Test {
 protected:
-  std::shared_ptr<Emul_dromajo> dromajo_ptr;
+  std::shared_ptr<Emul_dromajo_decoder> dromajo_ptr;
 
   void SetUp() override {
     std::ofstream file;
@@ -50,7 +56,7 @@ protected:
 
     Config::init("emul_dromajo_test.toml");
 
-    dromajo_ptr = std::make_shared<Emul_dromajo>();
+    dromajo_ptr = std::make_shared<Emul_dromajo_decoder>();
   }
 
   void TearDown() override {
@@ -146,3 +152,48 @@ TEST_F(Emul_Dromajo_test, dhrystone_test) {
   EXPECT_TRUE(inst->isStore());
   dinst->scrap();
 }
+
+TEST_F(Emul_Dromajo_test, idioms) {
+  struct Encoding {
+    uint32_t    insn;
+    Dinst_idiom idiom;
+    const char *name;
+  };
+  const Encoding encodings[] = {
+      {0x00030293, Dinst_idiom::Move, "addi x5, x6, 0"},
+      {0x00000293, Dinst_idiom::Zero, "addi x5, x0, 0"},
+      {0x02a00293, Dinst_idiom::Const, "addi x5, x0, 42"},
+      {0x00130293, Dinst_idiom::None, "addi x5, x6, 1"},
+      {0x00030013, Dinst_idiom::None, "addi x0, x6, 0"},
+      {0x00004515, Dinst_idiom::Const, "c.li x10, 5"},
+      {0x0000557d, Dinst_idiom::Const, "c.li x10, -1"},
+      {0x00004501, Dinst_idiom::Zero, "c.li x10, 0"},
+      {0x00006505, Dinst_idiom::Const, "c.lui x10, 1"},
+      {0x00006105, Dinst_idiom::None, "c.addi16sp 16"},
+      {0x0000852e, Dinst_idiom::Move, "c.mv x10, x11"},
+      {0x0000952e, Dinst_idiom::None, "c.add x10, x11"},
+      {0x006342b3, Dinst_idiom::Zero, "xor x5, x6, x6"},
+      {0x406302b3, Dinst_idiom::Zero, "sub x5, x6, x6"},
+      {0x007342b3, Dinst_idiom::None, "xor x5, x6, x7"},
+      {0x006302b3, Dinst_idiom::None, "add x5, x6, x6"},
+      {0x00634033, Dinst_idiom::None, "xor x0, x6, x6"},
+  };
+
+  for (const auto &e : encodings) {
+    Dinst *dinst = dromajo_ptr->decode(0, 0x80000000, e.insn, false);
+    EXPECT_EQ(dinst->getIdiom(), e.idiom) << e.name;
+    dinst->scrap();
+  }
+
+  // The move source is the register the rename stage aliases
+  Dinst *dinst = dromajo_ptr->decode(0, 0x80000000, 0x0000852e, false);  // c.mv x10, x11
+  EXPECT_EQ(dinst->getInst()->getDst1(), LREG_R10);
+  EXPECT_EQ(dinst->getInst()->getSrc1(), LREG_R0);
+  EXPECT_EQ(dinst->getInst()->getSrc2(), LREG_R11);
+  dinst->scrap();
+
+  dinst = dromajo_ptr->decode(0, 0x80000000, 0x00030293, false);  // addi x5, x6, 0
+  EXPECT_EQ(dinst->getInst()->getDst1(), LREG_R5);
+  EXPECT_EQ(dinst->getInst()->getSrc1(), LREG_R6);
+  dinst->scrap();
+}
@@ -0,0 +1,153 @@
+// See LICENSE for details.
+
+#include "emul_stream.hpp"
+
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <limits>
+#include <new>
+#include <thread>
+
+Stream_record Stream_record::encode(const Dinst *dinst) {
+  const Instruction *inst = dinst->getInst();
+
+  Stream_record rec{};
+  rec.pc     = dinst->getPC();
+  rec.addr   = dinst->getAddr();
+  rec.fid    = dinst->getFlowId();
+  rec.opcode = inst->getOpcode();
+  rec.src1   = inst->getSrc1();
+  rec.src2   = inst->getSrc2();
+  rec.dst1   = inst->getDst1();
+  rec.dst2   = inst->getDst2();
+  rec.idiom  = static_cast<uint8_t>(dinst->getIdiom());
+  rec.stats  = dinst->has_stats();
+
+  return rec;
+}
+
+Dinst *Stream_record::decode() const {
+  Dinst *dinst = Dinst::create(Instruction(static_cast<Opcode>(opcode),
+                                           static_cast<RegType>(src1),
+                                           static_cast<RegType>(src2),
+                                           static_cast<RegType>(dst1),
+                                           static_cast<RegType>(dst2)),
+                               pc,
+                               addr,
+                               fid,
+                               stats);
+  if (idiom != static_cast<uint8_t>(Dinst_idiom::None)) {
+    dinst->setIdiom(static_cast<Dinst_idiom>(idiom));
+  }
+
+  return dinst;
+}
+
+Stream_ring::Stream_ring(size_t _capacity, size_t _nconsumers) : capacity(_capacity), nconsumers(_nconsumers), min_tail(0) {
+  I((capacity & (capacity - 1)) == 0);
+
+  map_size  = sizeof(Header) + nconsumers * sizeof(Cursor) + capacity * sizeof(Stream_record);
+  void *ptr = mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (ptr == MAP_FAILED) {
+    header  = nullptr;
+    tails   = nullptr;
+    records = nullptr;
+    return;
+  }
+
+  header = new (ptr) Header;
+  header->head.pos.store(0);
+  header->closed.pos.store(0);
+
+  tails = reinterpret_cast<Cursor *>(header + 1);
+  for (size_t c = 0; c < nconsumers; ++c) {
+    new (&tails[c]) Cursor;
+    tails[c].pos.store(0);
+  }
+
+  records = reinterpret_cast<Stream_record *>(tails + nconsumers);
+}
+
+Stream_ring::~Stream_ring() {
+  if (header) {
+    munmap(header, map_size);
+  }
+}
+
+bool Stream_ring::try_push(const Stream_record &rec) {
+  uint64_t head = header->head.pos.load(std::memory_order_relaxed);
+
+  if (head - min_tail >= capacity) {
+    min_tail = std::numeric_limits<uint64_t>::max();
+    for (size_t c = 0; c < nconsumers; ++c) {
+      min_tail = std::min(min_tail, tails[c].pos.load(std::memory_order_acquire));
+    }
+    if (min_tail == std::numeric_limits<uint64_t>::max()) {
+      min_tail = head;  // all consumers dropped
+    }
+    if (head - min_tail >= capacity) {
+      return false;
+    }
+  }
+
+  records[head & (capacity - 1)] = rec;
+  header->head.pos.store(head + 1, std::memory_order_release);
+
+  return true;
+}
+
+void Stream_ring::close() { header->closed.pos.store(1, std::memory_order_release); }
+
+void Stream_ring::drop(size_t c) {
+  I(c < nconsumers);
+  tails[c].pos.store(std::numeric_limits<uint64_t>::max(), std::memory_order_release);
+}
+
+const Stream_record *Stream_ring::front(size_t c) {
+  I(c < nconsumers);
+  uint64_t tail = tails[c].pos.load(std::memory_order_relaxed);
+
+  while (header->head.pos.load(std::memory_order_acquire) == tail) {
+    if (header->closed.pos.load(std::memory_order_acquire)) {
+      // close is after the last push, check the head again
+      if (header->head.pos.load(std::memory_order_acquire) == tail) {
+        return nullptr;
+      }
+      break;
+    }
+    std::this_thread::yield();
+  }
+
+  return &records[tail & (capacity - 1)];
+}
+
+void Stream_ring::pop(size_t c) {
+  I(c < nconsumers);
+  tails[c].pos.fetch_add(1, std::memory_order_release);
+}
+
+Emul_stream::Emul_stream(Stream_ring &r, size_t c) : Emul_base(), ring(r), consumer(c) { type = "stream"; }
+
+Dinst *Emul_stream::peek(Hartid_t fid) {
+  const Stream_record *rec = ring.front(consumer);
+  if (rec == nullptr) {
+    return nullptr;
+  }
+  I(rec->fid == fid);
+  (void)fid;
+
+  return rec->decode();
+}
+
+void Emul_stream::execute(Hartid_t fid) {
+  (void)fid;
+  ring.pop(consumer);
+}
+
+void Emul_stream::skip_rabbit(Hartid_t fid, size_t ninst) {
+  (void)fid;
+  for (size_t i = 0; i < ninst && ring.front(consumer); ++i) {
+    ring.pop(consumer);
+  }
+}
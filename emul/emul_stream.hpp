@@ -0,0 +1,95 @@
+// See LICENSE for details.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "emul_base.hpp"
+
+// Decoded instruction of a stream, what Emul_dromajo::peek passes to
+// Dinst::create.
+struct Stream_record {
+  Addr_t   pc;
+  Addr_t   addr;
+  uint16_t fid;
+  uint8_t  opcode;
+  uint8_t  src1;
+  uint8_t  src2;
+  uint8_t  dst1;
+  uint8_t  dst2;
+  uint8_t  idiom;
+  uint8_t  stats;
+  uint8_t  pad[7];
+
+  static Stream_record encode(const Dinst *dinst);
+  Dinst               *decode() const;
+};
+static_assert(sizeof(Stream_record) == 32, "Stream_record is shared between processes");
+
+// Single producer, multiple consumer ring of Stream_records in a shared
+// anonymous mapping. Create it before forking: the producer (emulator) and
+// the consumers (timing models) can then live in different processes. The
+// producer stalls when the slowest consumer is a full ring behind.
+class Stream_ring {
+private:
+  struct alignas(64) Cursor {
+    std::atomic<uint64_t> pos;
+  };
+
+  struct Header {
+    Cursor head;    // records pushed
+    Cursor closed;  // no more records after head
+  };
+
+  const size_t capacity;  // power of 2
+  const size_t nconsumers;
+
+  size_t         map_size;
+  Header        *header;
+  Cursor        *tails;  // records popped by each consumer, UINT64_MAX when dropped
+  Stream_record *records;
+
+  uint64_t min_tail;  // producer cache of the slowest consumer
+
+public:
+  Stream_ring(size_t capacity, size_t nconsumers);
+  ~Stream_ring();
+
+  bool is_valid() const { return header != nullptr; }
+
+  size_t get_nconsumers() const { return nconsumers; }
+
+  // Producer. try_push is false when the ring is full
+  bool try_push(const Stream_record &rec);
+  void close();
+
+  // A consumer that will not pop anymore (e.g. its process died)
+  void drop(size_t c);
+
+  // Consumer c. front waits for the next record, nullptr after close
+  const Stream_record *front(size_t c);
+  void                 pop(size_t c);
+};
+
+// Emul that replays the stream of a Stream_ring consumer. Wrong path
+// fetch is not supported.
+class Emul_stream : public Emul_base {
+protected:
+  Stream_ring &ring;
+  const size_t consumer;
+
+public:
+  Emul_stream(Stream_ring &r, size_t c);
+
+  virtual Dinst *peek(Hartid_t fid) final;
+  virtual void   execute(Hartid_t fid) final;
+
+  virtual Hartid_t get_num() const final { return 1; }
+  virtual bool     is_sleeping(Hartid_t fid) const final {
+    (void)fid;
+    return false;
+  }
+
+  virtual void skip_rabbit(Hartid_t fid, size_t ninst) final;
+};
@@ -0,0 +1,120 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include "emul_stream.hpp"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "gtest/gtest.h"
+
+static Stream_record make_record(Addr_t pc) {
+  Stream_record rec{};
+  rec.pc     = pc;
+  rec.addr   = pc + 0x100;
+  rec.opcode = iAALU;
+  rec.src1   = LREG_R1;
+  rec.src2   = LREG_NoDependence;
+  rec.dst1   = LREG_R5;
+  rec.dst2   = LREG_InvalidOutput;
+  rec.stats  = 1;
+  return rec;
+}
+
+TEST(Emul_stream_test, full_ring) {
+  Stream_ring ring(4, 2);
+  ASSERT_TRUE(ring.is_valid());
+
+  for (Addr_t pc = 0; pc < 4; ++pc) {
+    EXPECT_TRUE(ring.try_push(make_record(0x1000 + 4 * pc)));
+  }
+  EXPECT_FALSE(ring.try_push(make_record(0x2000)));
+
+  // The slowest consumer sets the free space
+  for (int i = 0; i < 3; ++i) {
+    ring.pop(0);
+  }
+  EXPECT_FALSE(ring.try_push(make_record(0x2000)));
+  EXPECT_EQ(ring.front(1)->pc, 0x1000);
+  ring.pop(1);
+  EXPECT_TRUE(ring.try_push(make_record(0x2000)));
+  EXPECT_FALSE(ring.try_push(make_record(0x2004)));
+
+  // A dropped consumer does not stall the producer
+  ring.drop(1);
+  EXPECT_TRUE(ring.try_push(make_record(0x2004)));
+  EXPECT_TRUE(ring.try_push(make_record(0x2008)));
+
+  ring.close();
+  EXPECT_EQ(ring.front(0)->pc, 0x100C);
+  int n = 0;
+  while (ring.front(0)) {
+    ring.pop(0);
+    ++n;
+  }
+  EXPECT_EQ(n, 4);
+}
+
+TEST(Emul_stream_test, decode) {
+  Stream_ring ring(16, 1);
+  Emul_stream emul(ring, 0);
+
+  auto rec  = make_record(0x1000);
+  rec.idiom = static_cast<uint8_t>(Dinst_idiom::Move);
+  ring.try_push(rec);
+  ring.close();
+
+  Dinst *dinst = emul.peek(0);
+  ASSERT_NE(dinst, nullptr);
+  EXPECT_EQ(dinst->getPC(), 0x1000);
+  EXPECT_EQ(dinst->getAddr(), 0x1100);
+  EXPECT_EQ(dinst->getInst()->getOpcode(), iAALU);
+  EXPECT_EQ(dinst->getInst()->getSrc1(), LREG_R1);
+  EXPECT_EQ(dinst->getInst()->getDst1(), LREG_R5);
+  EXPECT_EQ(dinst->getIdiom(), Dinst_idiom::Move);
+  EXPECT_TRUE(dinst->has_stats());
+
+  auto rec2 = Stream_record::encode(dinst);
+  EXPECT_EQ(memcmp(&rec, &rec2, sizeof(rec)), 0);
+  dinst->scrap();
+
+  emul.execute(0);
+  EXPECT_EQ(emul.peek(0), nullptr);
+}
+
+TEST(Emul_stream_test, forked_consumers) {
+  const int   nconsumers = 3;
+  const int   ninst      = 10000;
+  Stream_ring ring(64, nconsumers);
+
+  pid_t pids[nconsumers];
+  for (int c = 0; c < nconsumers; ++c) {
+    pids[c] = fork();
+    if (pids[c] == 0) {
+      Emul_stream emul(ring, c);
+      Addr_t      expected = 0;
+      while (Dinst *dinst = emul.peek(0)) {
+        if (dinst->getPC() != expected) {
+          _exit(1);
+        }
+        dinst->scrap();
+        emul.execute(0);
+        expected += 4;
+      }
+      _exit(expected == 4 * ninst ? 0 : 2);
+    }
+  }
+
+  for (int i = 0; i < ninst; ++i) {
+    while (!ring.try_push(make_record(4 * i))) {
+      ;
+    }
+  }
+  ring.close();
+
+  for (int c = 0; c < nconsumers; ++c) {
+    int status;
+    waitpid(pids[c], &status, 0);
+    EXPECT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+  }
+}
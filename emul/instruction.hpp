@@ -61,6 +61,8 @@ public:
   bool isBranch() const { return opcode == iBALU_RBRANCH || opcode == iBALU_LBRANCH; }
   // All the unconditional but function return are jumps
   bool isJump() const { return opcode == iBALU_RJUMP || opcode == iBALU_LJUMP || isFuncCall(); }
+  // Register jumps and calls, the returns use the RAS
+  bool isIndirect() const { return opcode == iBALU_RJUMP || opcode == iBALU_RCALL; }
 
   bool isControl() const {
     GI(opcode >= iBALU_LBRANCH && opcode <= iBALU_RET, isJump() || isBranch() || isFuncCall() || isFuncRet());
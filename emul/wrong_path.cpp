@@ -0,0 +1,282 @@
+// See LICENSE for details.
+
+#include "wrong_path.hpp"
+
+static inline int64_t sext(uint64_t v, int bits) { return static_cast<int64_t>(v << (64 - bits)) >> (64 - bits); }
+
+static inline uint64_t sext32(uint64_t v) { return static_cast<uint64_t>(static_cast<int64_t>(static_cast<int32_t>(v))); }
+
+void Wrong_path_context::fork(Addr_t start_pc, const uint64_t *hart_regs) {
+  reg[0] = 0;
+  for (int r = 1; r < 32; ++r) {
+    reg[r] = hart_regs[r];
+  }
+  unknown    = 0;
+  pc         = start_pc;
+  insn       = 0;
+  addr_known = true;
+  done       = false;
+}
+
+void Wrong_path_context::step() {
+  if (done) {
+    return;
+  }
+
+  if ((insn & 0x3) == 0x3) {
+    step32(insn);
+  } else {
+    step16(insn & 0xFFFF);
+  }
+}
+
+void Wrong_path_context::step32(uint32_t i) {
+  uint32_t rd     = (i >> 7) & 0x1F;
+  uint32_t funct3 = (i >> 12) & 0x7;
+  uint32_t rs1    = (i >> 15) & 0x1F;
+  uint32_t rs2    = (i >> 20) & 0x1F;
+  uint32_t funct7 = i >> 25;
+
+  uint64_t a      = get(rs1);
+  uint64_t b      = get(rs2);
+  bool     ok1    = known(rs1);
+  bool     ok2    = ok1 && known(rs2);
+  uint64_t imm    = sext(i >> 20, 12);
+  Addr_t   next   = pc + 4;
+
+  switch (i & 0x7F) {
+    case 0x13:  // OP-IMM
+      switch (funct3) {
+        case 0: set(rd, ok1, a + imm); break;
+        case 1: set(rd, ok1, a << (imm & 63)); break;
+        case 2: set(rd, ok1, static_cast<int64_t>(a) < static_cast<int64_t>(imm)); break;
+        case 3: set(rd, ok1, a < imm); break;
+        case 4: set(rd, ok1, a ^ imm); break;
+        case 5: set(rd, ok1, (i >> 30) & 1 ? static_cast<int64_t>(a) >> (imm & 63) : a >> (imm & 63)); break;
+        case 6: set(rd, ok1, a | imm); break;
+        default: set(rd, ok1, a & imm); break;
+      }
+      break;
+    case 0x1B:  // OP-IMM-32
+      if (funct3 == 0) {
+        set(rd, ok1, sext32(a + imm));
+      } else if (funct3 == 1) {
+        set(rd, ok1, sext32(a << (imm & 31)));
+      } else {
+        uint32_t w = a;
+        set(rd, ok1, sext32((i >> 30) & 1 ? static_cast<int32_t>(w) >> (imm & 31) : w >> (imm & 31)));
+      }
+      break;
+    case 0x33:  // OP
+      if (funct7 == 1) {
+        set(rd, ok2 && funct3 == 0, a * b);  // MUL, the rest of M is not modeled
+        break;
+      }
+      switch (funct3) {
+        case 0: set(rd, ok2, funct7 ? a - b : a + b); break;
+        case 1: set(rd, ok2, a << (b & 63)); break;
+        case 2: set(rd, ok2, static_cast<int64_t>(a) < static_cast<int64_t>(b)); break;
+        case 3: set(rd, ok2, a < b); break;
+        case 4: set(rd, ok2, a ^ b); break;
+        case 5: set(rd, ok2, funct7 ? static_cast<int64_t>(a) >> (b & 63) : a >> (b & 63)); break;
+        case 6: set(rd, ok2, a | b); break;
+        default: set(rd, ok2, a & b); break;
+      }
+      break;
+    case 0x3B:  // OP-32
+      if (funct7 == 1) {
+        set(rd, ok2 && funct3 == 0, sext32(a * b));  // MULW
+      } else if (funct3 == 0) {
+        set(rd, ok2, sext32(funct7 ? a - b : a + b));
+      } else if (funct3 == 1) {
+        set(rd, ok2, sext32(a << (b & 31)));
+      } else {
+        uint32_t w = a;
+        set(rd, ok2, sext32(funct7 ? static_cast<int32_t>(w) >> (b & 31) : w >> (b & 31)));
+      }
+      break;
+    case 0x37:  // LUI
+      set(rd, sext32(i & 0xFFFFF000));
+      break;
+    case 0x17:  // AUIPC
+      set(rd, pc + sext32(i & 0xFFFFF000));
+      break;
+    case 0x6F: {  // JAL
+      uint64_t off = ((i >> 31) & 1) << 20 | ((i >> 12) & 0xFF) << 12 | ((i >> 20) & 1) << 11 | ((i >> 21) & 0x3FF) << 1;
+      set(rd, pc + 4);
+      next = pc + sext(off, 21);
+      break;
+    }
+    case 0x67:  // JALR
+      if (!ok1) {
+        done = true;
+        return;
+      }
+      set(rd, pc + 4);
+      next = (a + imm) & ~static_cast<uint64_t>(1);
+      break;
+    case 0x63: {  // BRANCH
+      if (!ok2) {
+        done = true;
+        return;
+      }
+      bool taken;
+      switch (funct3) {
+        case 0: taken = a == b; break;
+        case 1: taken = a != b; break;
+        case 4: taken = static_cast<int64_t>(a) < static_cast<int64_t>(b); break;
+        case 5: taken = static_cast<int64_t>(a) >= static_cast<int64_t>(b); break;
+        case 6: taken = a < b; break;
+        default: taken = a >= b; break;
+      }
+      if (taken) {
+        uint64_t off = ((i >> 31) & 1) << 12 | ((i >> 7) & 1) << 11 | ((i >> 25) & 0x3F) << 5 | ((i >> 8) & 0xF) << 1;
+        next         = pc + sext(off, 13);
+      }
+      break;
+    }
+    case 0x03:  // loads
+    case 0x2F:  // AMO
+      set_unknown(rd);
+      break;
+    case 0x53:  // FP compares, conversions and moves to an integer register
+      if (funct7 == 0x50 || funct7 == 0x51 || funct7 == 0x60 || funct7 == 0x61 || funct7 == 0x70 || funct7 == 0x71) {
+        set_unknown(rd);
+      }
+      break;
+    case 0x73:  // SYSTEM
+      if (funct3 == 0) {  // ecall, ebreak, xret, wfi
+        done = true;
+        return;
+      }
+      set_unknown(rd);  // CSR
+      break;
+    case 0x07:  // FP loads/stores/FMA, stores and fences do not write integer registers
+    case 0x27:
+    case 0x23:
+    case 0x0F:
+    case 0x43:
+    case 0x47:
+    case 0x4B:
+    case 0x4F: break;
+    default: done = true; return;
+  }
+
+  pc = next;
+}
+
+void Wrong_path_context::step16(uint32_t i) {
+  uint32_t funct3 = (i >> 13) & 0x7;
+  uint32_t rd     = (i >> 7) & 0x1F;
+  uint32_t rs2    = (i >> 2) & 0x1F;
+  uint32_t rdp    = ((i >> 7) & 0x7) + 8;  // rd'/rs1'
+  uint32_t rs2p   = ((i >> 2) & 0x7) + 8;
+  uint64_t imm6   = sext(((i >> 12) & 1) << 5 | ((i >> 2) & 0x1F), 6);
+  Addr_t   next   = pc + 2;
+
+  switch (i & 0x3) {
+    case 0x0:
+      if (funct3 == 0) {  // C.ADDI4SPN
+        if (i == 0) {
+          done = true;  // illegal
+          return;
+        }
+        uint64_t uimm = ((i >> 11) & 3) << 4 | ((i >> 7) & 0xF) << 6 | ((i >> 6) & 1) << 2 | ((i >> 5) & 1) << 3;
+        set(rs2p, known(2), get(2) + uimm);
+      } else if (funct3 == 2 || funct3 == 3) {  // C.LW, C.LD
+        set_unknown(rs2p);
+      } else if (funct3 == 4) {
+        done = true;
+        return;
+      }
+      break;
+    case 0x1:
+      switch (funct3) {
+        case 0: set(rd, known(rd), get(rd) + imm6); break;          // C.ADDI
+        case 1: set(rd, known(rd), sext32(get(rd) + imm6)); break;  // C.ADDIW
+        case 2: set(rd, imm6); break;                               // C.LI
+        case 3:
+          if (rd == 2) {  // C.ADDI16SP
+            uint64_t off = ((i >> 12) & 1) << 9 | ((i >> 6) & 1) << 4 | ((i >> 5) & 1) << 6 | ((i >> 3) & 3) << 7
+                           | ((i >> 2) & 1) << 5;
+            set(2, known(2), get(2) + sext(off, 10));
+          } else {  // C.LUI
+            set(rd, imm6 << 12);
+          }
+          break;
+        case 4: {
+          uint64_t a  = get(rdp);
+          uint64_t b  = get(rs2p);
+          bool     ok = known(rdp);
+          switch ((i >> 10) & 3) {
+            case 0: set(rdp, ok, a >> (imm6 & 63)); break;                        // C.SRLI
+            case 1: set(rdp, ok, static_cast<int64_t>(a) >> (imm6 & 63)); break;  // C.SRAI
+            case 2: set(rdp, ok, a & imm6); break;                                // C.ANDI
+            default:
+              ok = ok && known(rs2p);
+              if ((i >> 12) & 1) {
+                uint32_t op = (i >> 5) & 3;
+                if (op > 1) {
+                  done = true;
+                  return;
+                }
+                set(rdp, ok, sext32(op ? a + b : a - b));  // C.ADDW, C.SUBW
+              } else {
+                switch ((i >> 5) & 3) {
+                  case 0: set(rdp, ok, a - b); break;
+                  case 1: set(rdp, ok, a ^ b); break;
+                  case 2: set(rdp, ok, a | b); break;
+                  default: set(rdp, ok, a & b); break;
+                }
+              }
+              break;
+          }
+          break;
+        }
+        case 5: {  // C.J
+          uint64_t off = ((i >> 12) & 1) << 11 | ((i >> 11) & 1) << 4 | ((i >> 9) & 3) << 8 | ((i >> 8) & 1) << 10
+                         | ((i >> 7) & 1) << 6 | ((i >> 6) & 1) << 7 | ((i >> 3) & 7) << 1 | ((i >> 2) & 1) << 5;
+          next = pc + sext(off, 12);
+          break;
+        }
+        default: {  // C.BEQZ, C.BNEZ
+          if (!known(rdp)) {
+            done = true;
+            return;
+          }
+          if ((get(rdp) == 0) == (funct3 == 6)) {
+            uint64_t off = ((i >> 12) & 1) << 8 | ((i >> 10) & 3) << 3 | ((i >> 5) & 3) << 6 | ((i >> 3) & 3) << 1
+                           | ((i >> 2) & 1) << 5;
+            next = pc + sext(off, 9);
+          }
+          break;
+        }
+      }
+      break;
+    default:
+      if (funct3 == 0) {  // C.SLLI
+        set(rd, known(rd), get(rd) << (imm6 & 63));
+      } else if (funct3 == 2 || funct3 == 3) {  // C.LWSP, C.LDSP
+        set_unknown(rd);
+      } else if (funct3 == 4) {
+        bool bit12 = (i >> 12) & 1;
+        if (rs2 == 0) {
+          if (rd == 0 || !known(rd)) {  // C.EBREAK, or an unknown target
+            done = true;
+            return;
+          }
+          next = get(rd) & ~static_cast<uint64_t>(1);
+          if (bit12) {  // C.JALR
+            set(1, pc + 2);
+          }
+        } else if (bit12) {  // C.ADD
+          set(rd, known(rd) && known(rs2), get(rd) + get(rs2));
+        } else {  // C.MV
+          set(rd, known(rs2), get(rs2));
+        }
+      }
+      break;
+  }
+
+  pc = next;
+}
@@ -0,0 +1,56 @@
+// See LICENSE for details.
+
+#pragma once
+
+#include <cstdint>
+
+#include "dinst.hpp"  // Addr_t
+
+// Register/PC context of a wrong path: the direction that a mispredicted
+// conditional branch did not take. It starts as a copy of the integer
+// registers of the hart, and step() evaluates the RV64IC integer
+// instructions on it. Loads, CSRs, AMOs, divisions and FP to integer moves
+// leave their destination unknown. A control instruction that depends on an
+// unknown value ends the path. Stores are not performed.
+class Wrong_path_context {
+private:
+  uint64_t reg[32];
+  uint32_t unknown;  // bit r: the value of reg[r] is not modeled
+
+  void set(uint32_t r, uint64_t v) {
+    if (r) {
+      reg[r] = v;
+      unknown &= ~(1u << r);
+    }
+  }
+  void set_unknown(uint32_t r) {
+    if (r) {
+      unknown |= 1u << r;
+    }
+  }
+  void set(uint32_t r, bool ok, uint64_t v) {
+    if (ok) {
+      set(r, v);
+    } else {
+      set_unknown(r);
+    }
+  }
+
+  void step16(uint32_t insn);
+  void step32(uint32_t insn);
+
+public:
+  Addr_t   pc         = 0;
+  uint32_t insn       = 0;     // raw instruction at pc, set by the emulator
+  bool     addr_known = true;  // the memory address of insn does not use unknown registers
+  bool     done       = true;  // nothing left to follow
+
+  // hart_regs[1..31] are the integer registers after the branch
+  void fork(Addr_t start_pc, const uint64_t *hart_regs);
+
+  bool     known(uint32_t r) const { return r == 0 || ((unknown >> r) & 1) == 0; }
+  uint64_t get(uint32_t r) const { return r ? reg[r] : 0; }
+
+  // Execute insn at pc, move pc to the next instruction
+  void step();
+};
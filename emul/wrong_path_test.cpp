@@ -0,0 +1,88 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include "wrong_path.hpp"
+
+#include "gtest/gtest.h"
+
+static uint32_t i_type(uint32_t op, uint32_t rd, uint32_t f3, uint32_t rs1, int32_t imm) {
+  return (static_cast<uint32_t>(imm) << 20) | (rs1 << 15) | (f3 << 12) | (rd << 7) | op;
+}
+
+static uint32_t b_type(uint32_t f3, uint32_t rs1, uint32_t rs2, int32_t off) {
+  uint32_t o = off;
+  return ((o >> 12) & 1) << 31 | ((o >> 5) & 0x3F) << 25 | (rs2 << 20) | (rs1 << 15) | (f3 << 12) | ((o >> 1) & 0xF) << 8
+         | ((o >> 11) & 1) << 7 | 0x63;
+}
+
+class Wrong_path_test : public ::testing::Test {
+protected:
+  Wrong_path_context ctx;
+
+  void SetUp() override {
+    uint64_t regs[32] = {0};
+    regs[2]           = 0x8000;  // sp
+    regs[10]          = 5;
+    ctx.fork(0x1000, regs);
+  }
+
+  void run(uint32_t insn) {
+    ctx.insn = insn;
+    ctx.step();
+  }
+};
+
+TEST_F(Wrong_path_test, integer_ops) {
+  run(i_type(0x13, 11, 0, 10, 7));  // addi a1, a0, 7
+  EXPECT_EQ(ctx.get(11), 12);
+  EXPECT_EQ(ctx.pc, 0x1004);
+
+  run(0x000125B7);  // lui a1, 0x12
+  EXPECT_EQ(ctx.get(11), 0x12000);
+
+  run(0x4505);  // c.li a0, 1
+  EXPECT_EQ(ctx.get(10), 1);
+  EXPECT_EQ(ctx.pc, 0x100A);
+
+  run(0x1141);  // c.addi sp, -16
+  EXPECT_EQ(ctx.get(2), 0x8000 - 16);
+
+  run(i_type(0x13, 0, 0, 10, 9));  // x0 stays zero
+  EXPECT_EQ(ctx.get(0), 0);
+}
+
+TEST_F(Wrong_path_test, branches) {
+  run(b_type(0, 10, 0, 0x40));  // beq a0, zero: not taken
+  EXPECT_EQ(ctx.pc, 0x1004);
+
+  run(b_type(1, 10, 0, -4));  // bne a0, zero: taken
+  EXPECT_EQ(ctx.pc, 0x1000);
+
+  run(0xA011);  // c.j +4
+  EXPECT_EQ(ctx.pc, 0x1004);
+
+  run(i_type(0x67, 1, 0, 2, 8));  // jalr ra, 8(sp)
+  EXPECT_EQ(ctx.pc, 0x8008);
+  EXPECT_EQ(ctx.get(1), 0x1008);
+  EXPECT_FALSE(ctx.done);
+}
+
+TEST_F(Wrong_path_test, unknown_values) {
+  run(i_type(0x03, 10, 3, 2, 0));  // ld a0, 0(sp)
+  EXPECT_FALSE(ctx.known(10));
+  EXPECT_TRUE(ctx.known(2));
+
+  run(i_type(0x13, 11, 0, 10, 1));  // addi a1, a0, 1
+  EXPECT_FALSE(ctx.known(11));
+
+  run(i_type(0x13, 10, 0, 0, 3));  // li a0, 3
+  EXPECT_TRUE(ctx.known(10));
+  EXPECT_EQ(ctx.get(10), 3);
+
+  // A branch on an unknown value ends the path
+  run(b_type(0, 11, 0, 0x40));
+  EXPECT_TRUE(ctx.done);
+  Addr_t pc = ctx.pc;
+  run(i_type(0x13, 10, 0, 0, 4));
+  EXPECT_EQ(ctx.pc, pc);
+  EXPECT_EQ(ctx.get(10), 3);
+}
@@ -13,6 +13,7 @@
 #include "inorderprocessor.hpp"
 #include "oooprocessor.hpp"
 #include "bootloader.hpp"
+#include "cache_compressor.hpp"
 #include "config.hpp"
 #include "emul_dromajo.hpp"
 #include "report.hpp"
@@ -72,15 +73,15 @@ void BootLoader::report(const std::string &str) {
   gettimeofday(&endTime, 0);
 
   Report::field(fmt::format("#BEGIN:report {}", str));
-  Report::field(fmt::format("OSSim:reportName={}", str));
-  Report::field(fmt::format("OSSim:beginTime={}", ctime(&stTime.tv_sec)));
-  Report::field(fmt::format("OSSim:endTime={}", ctime(&endTime.tv_sec)));
+  Report::meta("reportName", str);
+  Report::meta("beginTime", ctime(&stTime.tv_sec));
+  Report::meta("endTime", ctime(&endTime.tv_sec));
 
   double msecs = (endTime.tv_sec - stTime.tv_sec) * 1000 + (endTime.tv_usec - stTime.tv_usec) / 1000;
 
   TaskHandler::report();
 
-  Report::field(fmt::format("OSSim:msecs={}", (double)msecs / 1000));
+  Report::meta("msecs", fmt::format("{}", (double)msecs / 1000));
 
   Stats::report_all();
 
@@ -98,6 +99,9 @@ void BootLoader::plug_emuls() {
     if (type == "dromajo") {
       if (dromajo == nullptr) {
         dromajo = std::make_shared<Emul_dromajo>();
+        // Compressed caches size the lines with the guest memory values
+        Cache_compressor::set_line_reader(
+            [dromajo](Addr_t addr, uint8_t *data, size_t size) { return dromajo->read_mem(addr, data, size); });
       }
       if (dromajo) {  // Invalid dromahor otherwise
         TaskHandler::add_emul(dromajo, i);
@@ -135,6 +139,37 @@ void BootLoader::plug_simus() {
   }
 }
 
+void BootLoader::plug_soc() {
+  auto ncores = Config::get_array_size("soc", "core");
+  auto nemuls = Config::get_array_size("soc", "emul");
+
+  if (ncores != nemuls) {
+    Config::add_error(fmt::format("soc number of cores should match the numbers of emuls ({} vs {})", ncores, nemuls));
+  } else if (ncores == 0) {
+    Config::add_error("soc should have at least one core in [soc] core");
+  } else {
+    TaskHandler::plugBegin();
+    plug_simus();
+
+    Config::exit_on_error();
+  }
+}
+
+void BootLoader::plug_stream(const std::string &conf_file, std::shared_ptr<Emul_base> emul) {
+  Config::init(conf_file);
+
+  plug_soc();
+
+  if (Config::get_array_size("soc", "core") != 1) {
+    Config::add_error("a stream drives a single core, [soc] core should have one entry");
+  }
+  TaskHandler::add_emul(emul, 0);
+
+  Config::exit_on_error();
+
+  TaskHandler::plugEnd();
+}
+
 void BootLoader::plug(int argc, const char **argv) {
   // Before boot
 
@@ -158,19 +193,7 @@ void BootLoader::plug(int argc, const char **argv) {
   }
   Config::init(conf_file);
 
-  auto ncores = Config::get_array_size("soc", "core");
-  auto nemuls = Config::get_array_size("soc", "emul");
-
-  if (ncores != nemuls) {
-    Config::add_error(fmt::format("soc number of cores should match the numbers of emuls ({} vs {})", ncores, nemuls));
-  } else if (ncores == 0) {
-    Config::add_error("soc should have at least one core in [soc] core");
-  } else {
-    TaskHandler::plugBegin();
-    plug_simus();
-
-    Config::exit_on_error();
-  }
+  plug_soc();
 
   if (just_check) {
     fmt::print("check success\n");
@@ -4,12 +4,15 @@
 
 #include <sys/time.h>
 
+#include <memory>
 #include <string>
 
 // #include "power_model.hpp"
 #include "iassert.hpp"
 #include "opcode.hpp"
 
+class Emul_base;
+
 class BootLoader {
 private:
   static timeval stTime;
@@ -21,11 +24,14 @@ private:
 protected:
   static void plug_emuls();
   static void plug_simus();
+  static void plug_soc();
 
 public:
   static int64_t sample_count;
 
   static void plug(int argc, const char **argv);
+  // Plug the single core of conf_file to an emul created by the caller
+  static void plug_stream(const std::string &conf_file, std::shared_ptr<Emul_base> emul);
   static void boot();
   static void report(const std::string &str);
   static void unboot();
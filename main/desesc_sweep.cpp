@@ -0,0 +1,221 @@
+// See LICENSE for details.
+
+// Parameter sweep sharing one emulation.
+//
+//   desesc_sweep [-c desesc.toml] [-j N] [-f sweep.txt] [config]...
+//
+// A config is a list of overrides of the base TOML, separated by commas or
+// spaces: "bpred:type=tage,ooo:fetch_width=8" is the same as running desesc
+// with DESESC_bpred_type=tage DESESC_ooo_fetch_width=8. sweep.txt has one
+// config per line (# starts a comment).
+//
+// The dromajo emul of the base TOML boots once (rabbit included), and its
+// instruction stream feeds N timing models at the same time through a
+// shared memory ring. The emulation runs ahead of the slowest model by at
+// most the ring size. Config, the stats, the TaskHandler and the Dinst pool
+// are process wide, so each timing model is a forked process with its own
+// report file (desesc_sweep<N>.XXXXXX). With -j smaller than the number of
+// configs, the configs run in groups and each group boots dromajo again.
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "absl/strings/str_split.h"
+#include "bootloader.hpp"
+#include "config.hpp"
+#include "emul_dromajo.hpp"
+#include "emul_stream.hpp"
+#include "fmt/format.h"
+
+struct Sweep_config {
+  std::string              name;
+  std::vector<std::string> env_vars;  // DESESC_<section>_<field>=<value>
+};
+
+static bool parse_config(const std::string &line, Sweep_config &conf) {
+  conf.name = line;
+  conf.env_vars.clear();
+
+  std::vector<std::string> overrides = absl::StrSplit(line, absl::ByAnyChar(", \t"), absl::SkipEmpty());
+  for (const auto &ovr : overrides) {
+    auto colon = ovr.find(':');
+    auto eq    = ovr.find('=');
+    if (colon == std::string::npos || eq == std::string::npos || colon == 0 || eq < colon + 2) {
+      fmt::print("ERROR: override {} should be section:field=value\n", ovr);
+      return false;
+    }
+    conf.env_vars.emplace_back(
+        fmt::format("DESESC_{}_{}={}", ovr.substr(0, colon), ovr.substr(colon + 1, eq - colon - 1), ovr.substr(eq + 1)));
+  }
+
+  return true;
+}
+
+static void run_model(const std::string &conf_file, const Sweep_config &conf, Stream_ring &ring, size_t c, size_t id) {
+  for (const auto &var : conf.env_vars) {
+    auto eq = var.find('=');
+    setenv(var.substr(0, eq).c_str(), var.substr(eq + 1).c_str(), 1);
+  }
+  setenv("REPORTFILE2", fmt::format("sweep{}", id).c_str(), 1);
+
+  BootLoader::plug_stream(conf_file, std::make_shared<Emul_stream>(ring, c));
+  BootLoader::boot();
+  BootLoader::report(conf.name.empty() ? "base" : conf.name);
+  BootLoader::unboot();
+  BootLoader::unplug();
+}
+
+// Runs confs[first..first+n) on one emulation. Returns the number of failed models
+static int run_group(const std::string &conf_file, const std::vector<Sweep_config> &confs, size_t first, size_t n) {
+  Config::init(conf_file);
+  if (Config::get_array_size("soc", "core") != 1) {
+    Config::add_error("desesc_sweep drives a single core, [soc] core should have one entry");
+  }
+  Config::exit_on_error();
+
+  Emul_dromajo emul;  // boots and runs rabbit before the fork, once for the group
+  if (emul.get_num() != 1) {
+    fmt::print("ERROR: desesc_sweep needs a single dromajo hart\n");
+    return n;
+  }
+
+  Stream_ring ring(1 << 16, n);
+  if (!ring.is_valid()) {
+    fmt::print("ERROR: could not map the stream ring\n");
+    return n;
+  }
+
+  std::vector<pid_t> pids(n, -1);
+  std::vector<bool>  ok(n, false);
+  fflush(stdout);  // the children would print it again
+  for (size_t c = 0; c < n; ++c) {
+    pids[c] = fork();
+    if (pids[c] == 0) {
+      run_model(conf_file, confs[first + c], ring, c, first + c);
+      fflush(stdout);
+      _exit(0);
+    }
+    if (pids[c] < 0) {
+      fmt::print("ERROR: could not fork for {}\n", confs[first + c].name);
+      ring.drop(c);
+    }
+  }
+
+  size_t running = 0;
+  for (auto pid : pids) {
+    running += pid > 0 ? 1 : 0;
+  }
+
+  auto reap = [&](int options) {
+    int   status;
+    pid_t pid;
+    while (running && (pid = waitpid(-1, &status, options)) > 0) {
+      for (size_t c = 0; c < n; ++c) {
+        if (pids[c] == pid) {
+          ok[c]   = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+          pids[c] = -1;
+          ring.drop(c);  // a model that died must not stall the stream
+          --running;
+        }
+      }
+    }
+  };
+
+  while (running) {
+    Dinst *dinst = emul.peek(0);
+    if (dinst == nullptr) {
+      break;
+    }
+    auto rec = Stream_record::encode(dinst);
+    dinst->scrap();
+    emul.execute(0);
+
+    while (running && !ring.try_push(rec)) {
+      reap(WNOHANG);
+      std::this_thread::yield();
+    }
+  }
+  ring.close();
+  reap(0);
+
+  emul.destroy_machine();
+
+  int errors = 0;
+  for (size_t c = 0; c < n; ++c) {
+    if (!ok[c]) {
+      fmt::print("sweep{} {} failed\n", first + c, confs[first + c].name);
+      ++errors;
+    }
+  }
+
+  return errors;
+}
+
+static void usage() { fmt::print("usage: desesc_sweep [-c desesc.toml] [-j N] [-f sweep.txt] [config]...\n"); }
+
+int main(int argc, const char **argv) {
+  unsetenv("DESESCCONF");  // the base configuration is an explicit argument
+
+  std::string               conf_file = "desesc.toml";
+  size_t                    njobs     = 0;
+  std::vector<Sweep_config> confs;
+
+  for (auto i = 1; i < argc; ++i) {
+    std::string arg{argv[i]};
+    if ((arg == "-c" || arg == "-j" || arg == "-f") && i + 1 >= argc) {
+      usage();
+      return 3;
+    }
+
+    if (arg == "-c") {
+      conf_file = argv[++i];
+    } else if (arg == "-j") {
+      njobs = std::atoi(argv[++i]);
+    } else if (arg == "-f") {
+      std::ifstream file(argv[++i]);
+      if (!file) {
+        fmt::print("ERROR: could not open sweep file {}\n", argv[i]);
+        return 3;
+      }
+      std::string line;
+      while (std::getline(file, line)) {
+        line = line.substr(0, line.find('#'));
+        if (line.find_first_not_of(" \t") == std::string::npos) {
+          continue;
+        }
+        confs.emplace_back();
+        if (!parse_config(line, confs.back())) {
+          return 3;
+        }
+      }
+    } else {
+      confs.emplace_back();
+      if (!parse_config(arg, confs.back())) {
+        return 3;
+      }
+    }
+  }
+
+  if (confs.empty()) {
+    usage();
+    return 3;
+  }
+  if (njobs == 0 || njobs > confs.size()) {
+    njobs = confs.size();
+  }
+
+  int errors = 0;
+  for (size_t first = 0; first < confs.size(); first += njobs) {
+    errors += run_group(conf_file, confs, first, std::min(njobs, confs.size() - first));
+  }
+
+  fmt::print("desesc_sweep: {} configs, {} failed\n", confs.size(), errors);
+
+  return errors ? 1 : 0;
+}
@@ -0,0 +1,185 @@
+// See LICENSE for details.
+
+#include "cache_compressor.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "iassert.hpp"
+
+Cache_compressor::Cache_compressor(Compression_type t, uint32_t lsize, uint32_t ssize)
+    : type(t), line_size(lsize), segment_size(ssize) {
+  I(line_size >= 8);
+  I(segment_size && (line_size % segment_size) == 0);
+
+  line_buffer.resize(line_size);
+}
+
+Compression_type Cache_compressor::get_type(const std::string &str) {
+  if (str == "bdi") {
+    return Compression_type::BDI;
+  }
+  if (str == "fpc") {
+    return Compression_type::FPC;
+  }
+  return Compression_type::None;
+}
+
+static int64_t read_value(const uint8_t *data, uint32_t size) {
+  switch (size) {
+    case 8: {
+      int64_t v;
+      memcpy(&v, data, 8);
+      return v;
+    }
+    case 4: {
+      int32_t v;
+      memcpy(&v, data, 4);
+      return v;
+    }
+    case 2: {
+      int16_t v;
+      memcpy(&v, data, 2);
+      return v;
+    }
+    default: I(0);
+  }
+  return 0;
+}
+
+static bool fits_signed(int64_t v, uint32_t bytes) {
+  if (bytes >= 8) {
+    return true;
+  }
+  int64_t lim = int64_t(1) << (bytes * 8 - 1);
+  return v >= -lim && v < lim;
+}
+
+uint32_t Cache_compressor::bdi_base_delta_size(const uint8_t *data, uint32_t base_size, uint32_t delta_size) const {
+  // Two bases: an implicit zero base, and the first value that does not fit
+  // as an immediate. One bit per value selects the base.
+  const uint32_t nvalues  = line_size / base_size;
+  bool           has_base = false;
+  int64_t        base     = 0;
+
+  for (uint32_t i = 0; i < nvalues; ++i) {
+    int64_t v = read_value(&data[i * base_size], base_size);
+    if (fits_signed(v, delta_size)) {
+      continue;
+    }
+    if (!has_base) {
+      has_base = true;
+      base     = v;
+      continue;
+    }
+    if (!fits_signed(v - base, delta_size)) {
+      return line_size;
+    }
+  }
+
+  return base_size + nvalues * delta_size + (nvalues + 7) / 8;
+}
+
+uint32_t Cache_compressor::bdi_size(const uint8_t *data) const {
+  bool all_zero = true;
+  bool repeated = true;
+
+  int64_t first = read_value(data, 8);
+  for (uint32_t i = 0; i < line_size; i += 8) {
+    int64_t v = read_value(&data[i], 8);
+    all_zero  = all_zero && v == 0;
+    repeated  = repeated && v == first;
+  }
+  if (all_zero) {
+    return 1;
+  }
+  if (repeated) {
+    return 8;
+  }
+
+  static constexpr uint32_t encodings[][2] = {
+      {8, 1},
+      {8, 2},
+      {8, 4},
+      {4, 1},
+      {4, 2},
+      {2, 1},
+  };
+
+  uint32_t best = line_size;
+  for (const auto &enc : encodings) {
+    best = std::min(best, bdi_base_delta_size(data, enc[0], enc[1]));
+  }
+
+  return best;
+}
+
+uint32_t Cache_compressor::fpc_size(const uint8_t *data) const {
+  // Frequent pattern compression: 3-bit prefix per 32-bit word plus the
+  // pattern payload. Runs of up to 8 zero words share one prefix.
+  uint32_t bits     = 0;
+  uint32_t zero_run = 0;
+
+  for (uint32_t i = 0; i < line_size; i += 4) {
+    int32_t w = static_cast<int32_t>(read_value(&data[i], 4));
+
+    if (w == 0) {
+      if (zero_run == 0) {
+        bits += 3 + 3;
+      }
+      zero_run = (zero_run + 1) & 7;
+      continue;
+    }
+    zero_run = 0;
+
+    int16_t  lo    = static_cast<int16_t>(w & 0xFFFF);
+    int16_t  hi    = static_cast<int16_t>(w >> 16);
+    uint32_t bytes = static_cast<uint32_t>(w);
+    bool     rep   = ((bytes >> 8) & 0xFF) == (bytes & 0xFF) && ((bytes >> 16) & 0xFF) == (bytes & 0xFF)
+               && ((bytes >> 24) & 0xFF) == (bytes & 0xFF);
+
+    if (w >= -8 && w < 8) {
+      bits += 3 + 4;
+    } else if (fits_signed(w, 1)) {
+      bits += 3 + 8;
+    } else if (fits_signed(w, 2)) {
+      bits += 3 + 16;
+    } else if (lo == 0) {
+      bits += 3 + 16;
+    } else if (fits_signed(lo, 1) && fits_signed(hi, 1)) {
+      bits += 3 + 16;
+    } else if (rep) {
+      bits += 3 + 8;
+    } else {
+      bits += 3 + 32;
+    }
+  }
+
+  return std::min(line_size, (bits + 7) / 8);
+}
+
+uint32_t Cache_compressor::compressed_size(const uint8_t *data) const {
+  switch (type) {
+    case Compression_type::BDI: return bdi_size(data);
+    case Compression_type::FPC: return fpc_size(data);
+    case Compression_type::None: break;
+  }
+  return line_size;
+}
+
+uint32_t Cache_compressor::calc_segments(Addr_t addr) const {
+  const uint32_t nsegs = get_line_segments();
+
+  if (type == Compression_type::None || !reader) {
+    return nsegs;
+  }
+
+  Addr_t line_addr = addr - (addr % line_size);
+  if (!reader(line_addr, line_buffer.data(), line_size)) {
+    return nsegs;
+  }
+
+  auto sz = compressed_size(line_buffer.data());
+
+  return std::max<uint32_t>(1, (sz + segment_size - 1) / segment_size);
+}
@@ -0,0 +1,56 @@
+// See LICENSE for details.
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "opcode.hpp"
+
+// Line compression model for compressed caches. It only computes the
+// compressed size of a line (BDI or FPC); the cache tracks how many segments
+// each line occupies in its set.
+//
+// Line values come from a reader hook, BootLoader::plug_emuls registers one
+// that reads the dromajo guest memory when the line is filled. Without a
+// reader, lines are incompressible and a compressed cache behaves like the
+// uncompressed one (but with extra tags).
+
+enum class Compression_type { None, BDI, FPC };
+
+class Cache_compressor {
+public:
+  using Line_reader = std::function<bool(Addr_t addr, uint8_t *data, size_t size)>;
+
+private:
+  static inline Line_reader reader;
+
+  const Compression_type type;
+  const uint32_t         line_size;
+  const uint32_t         segment_size;
+
+  mutable std::vector<uint8_t> line_buffer;
+
+  uint32_t bdi_size(const uint8_t *data) const;
+  uint32_t bdi_base_delta_size(const uint8_t *data, uint32_t base_size, uint32_t delta_size) const;
+  uint32_t fpc_size(const uint8_t *data) const;
+
+public:
+  Cache_compressor(Compression_type t, uint32_t lsize, uint32_t ssize);
+
+  static void set_line_reader(Line_reader r) { reader = std::move(r); }
+  static bool has_line_reader() { return static_cast<bool>(reader); }
+
+  static Compression_type get_type(const std::string &str);
+
+  // Compressed size in bytes of line_size bytes starting at data
+  uint32_t compressed_size(const uint8_t *data) const;
+
+  uint32_t get_line_segments() const { return line_size / segment_size; }
+  uint32_t get_segment_size() const { return segment_size; }
+
+  // Segments used by the line holding addr (reads the line through the reader)
+  uint32_t calc_segments(Addr_t addr) const;
+};
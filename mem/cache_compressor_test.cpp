@@ -0,0 +1,216 @@
+// See LICENSE for details.
+
+#include "cache_compressor.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <vector>
+
+#include "callback.hpp"
+#include "ccache.hpp"
+#include "config.hpp"
+#include "dinst.hpp"
+#include "gtest/gtest.h"
+#include "memory_system.hpp"
+#include "memrequest.hpp"
+#include "report.hpp"
+
+class Cache_compressor_test : public ::testing::Test {
+protected:
+  std::vector<uint8_t> line;
+
+  void SetUp() override { line.resize(64, 0); }
+
+  void fill64(const std::vector<uint64_t> &vals) {
+    for (size_t i = 0; i < 8; ++i) {
+      uint64_t v = vals[i % vals.size()];
+      memcpy(&line[i * 8], &v, 8);
+    }
+  }
+};
+
+TEST_F(Cache_compressor_test, zeros) {
+  Cache_compressor bdi(Compression_type::BDI, 64, 8);
+  Cache_compressor fpc(Compression_type::FPC, 64, 8);
+
+  EXPECT_EQ(bdi.compressed_size(line.data()), 1);
+  EXPECT_LE(fpc.compressed_size(line.data()), 2);
+}
+
+TEST_F(Cache_compressor_test, repeated) {
+  fill64({0x1234567890abcdefULL});
+
+  Cache_compressor bdi(Compression_type::BDI, 64, 8);
+  EXPECT_EQ(bdi.compressed_size(line.data()), 8);
+}
+
+TEST_F(Cache_compressor_test, pointers) {
+  // Pointers into the same region compress with base8-delta1
+  fill64({0x7fff00001000ULL, 0x7fff00001008ULL, 0x7fff00001010ULL, 0x7fff00001040ULL});
+
+  Cache_compressor bdi(Compression_type::BDI, 64, 8);
+  EXPECT_EQ(bdi.compressed_size(line.data()), 8 + 8 * 1 + 1);
+}
+
+TEST_F(Cache_compressor_test, small_ints) {
+  for (int i = 0; i < 16; ++i) {
+    int32_t v = (i % 2) ? 3 : -2;
+    memcpy(&line[i * 4], &v, 4);
+  }
+
+  Cache_compressor fpc(Compression_type::FPC, 64, 8);
+  EXPECT_EQ(fpc.compressed_size(line.data()), (16 * (3 + 4) + 7) / 8);
+}
+
+TEST_F(Cache_compressor_test, random_data) {
+  std::mt19937_64 rng(3);
+  fill64({rng(), rng(), rng(), rng(), rng(), rng(), rng(), rng()});
+
+  Cache_compressor bdi(Compression_type::BDI, 64, 8);
+  Cache_compressor fpc(Compression_type::FPC, 64, 8);
+
+  EXPECT_EQ(bdi.compressed_size(line.data()), 64);
+  EXPECT_EQ(fpc.compressed_size(line.data()), 64);
+}
+
+TEST_F(Cache_compressor_test, segments) {
+  Cache_compressor bdi(Compression_type::BDI, 64, 8);
+  EXPECT_EQ(bdi.get_line_segments(), 8);
+
+  // No line reader, lines are not compressible
+  EXPECT_EQ(bdi.calc_segments(0x1000), 8);
+
+  Cache_compressor::set_line_reader([](Addr_t addr, uint8_t *data, size_t size) {
+    memset(data, 0, size);
+    return addr < 0x2000;
+  });
+  EXPECT_EQ(bdi.calc_segments(0x1000), 1);
+  EXPECT_EQ(bdi.calc_segments(0x4000), 8);
+
+  Cache_compressor::set_line_reader(nullptr);
+}
+
+static int rd_pending = 0;
+
+static void rdDone(Dinst *dinst) {
+  rd_pending--;
+  dinst->scrap();
+}
+
+typedef CallbackFunction1<Dinst *, &rdDone> rdDoneCB;
+
+// A compressed DL1 sizes its lines with the reader: a set holds as many
+// lines as its data segments allow, zero lines take one segment
+TEST_F(Cache_compressor_test, ccache_fill) {
+  std::ofstream file("cache_compressor_test.toml");
+  file << "[soc]\n"
+          "core = [\"c0\"]\n"
+          "[c0]\n"
+          "type   = \"ooo\"\n"
+          "caches = true\n"
+          "dl1    = \"dl1_cache DL1\"\n"
+          "il1    = \"dl1_cache IL1\"\n"
+          "[dl1_cache]\n"
+          "type          = \"cache\"\n"
+          "cold_misses   = true\n"
+          "size          = 32768\n"
+          "line_size     = 64\n"
+          "delay         = 5\n"
+          "miss_delay    = 2\n"
+          "assoc         = 4\n"
+          "repl_policy   = \"lru\"\n"
+          "port_occ      = 1\n"
+          "port_num      = 1\n"
+          "port_banks    = 32\n"
+          "send_port_occ = 1\n"
+          "send_port_num = 1\n"
+          "max_requests  = 32\n"
+          "allocate_miss = true\n"
+          "victim        = false\n"
+          "coherent      = true\n"
+          "inclusive     = true\n"
+          "directory     = false\n"
+          "nlp_distance  = 2\n"
+          "nlp_degree    = 0\n"
+          "nlp_stride    = 1\n"
+          "drop_prefetch = true\n"
+          "prefetch_degree = 0\n"
+          "mega_lines1K  = 8\n"
+          "compression   = \"bdi\"\n"
+          "compression_tag_ratio = 2\n"
+          "lower_level   = \"mem mem shared\"\n"
+          "[mem]\n"
+          "type        = \"nice\"\n"
+          "line_size   = 64\n"
+          "delay       = 31\n"
+          "cold_misses = false\n"
+          "lower_level = \"\"\n";
+  file.close();
+
+  Report::init();
+  Config::init("cache_compressor_test.toml");
+  auto *gms = new Memory_system(0);
+  Config::exit_on_error();
+
+  auto *dl1 = static_cast<CCache *>(gms->getDL1());
+  ASSERT_EQ(dl1->get_type(), "cache");
+
+  // Zeros below 0x100000, incompressible values above
+  Cache_compressor::set_line_reader([](Addr_t addr, uint8_t *data, size_t size) {
+    std::mt19937_64 rng(addr);
+    for (size_t i = 0; i < size; ++i) {
+      data[i] = addr < 0x100000 ? 0 : rng();
+    }
+    return true;
+  });
+
+  auto read = [&](Addr_t addr) {
+    while (dl1->isBusy(addr)) {
+      EventScheduler::advanceClock();
+    }
+    auto *ld = Dinst::create(Instruction(iLALU_LD, LREG_R1, LREG_R2, LREG_R3, LREG_InvalidOutput), 0x400, addr, 0, true);
+    MemRequest::sendReqRead(dl1, true, addr, ld->getPC(), rdDoneCB::create(ld));
+    rd_pending++;
+    while (rd_pending) {
+      EventScheduler::advanceClock();
+    }
+  };
+
+  // 128 sets with 4 ways of data and 8 tags (compression_tag_ratio 2), both
+  // groups map to set 0
+  const Addr_t set_stride = 32768 / 4;
+  const Addr_t zero_base  = 0x80000;
+  const Addr_t rand_base  = 0x200000;
+  auto         count      = [&](Addr_t base, int n) {
+    int valid = 0;
+    for (int i = 0; i < n; ++i) {
+      valid += dl1->Invalid(base + i * set_stride) ? 0 : 1;
+    }
+    return valid;
+  };
+
+  const int line_seg = 64 / 8;
+  const int set_seg  = dl1->getSetSegments();
+  ASSERT_EQ(set_seg, 4 * line_seg);
+  EventScheduler::advanceClock();  // a request needs a nonzero start clock
+
+  // Incompressible lines: the data segments of the set, not its tags, limit them
+  const int nrandom = 6;
+  for (int i = 0; i < nrandom; ++i) {
+    read(rand_base + i * set_stride);
+  }
+  EXPECT_EQ(count(rand_base, nrandom), std::min(nrandom, set_seg / line_seg));
+  EXPECT_FALSE(dl1->Invalid(rand_base + (nrandom - 1) * set_stride));  // the last fill stays
+
+  // Zero lines take one segment each, what is left holds the random lines
+  const int nzero = 2;
+  for (int i = 0; i < nzero; ++i) {
+    read(zero_base + i * set_stride);
+  }
+  EXPECT_EQ(count(zero_base, nzero), nzero);
+  EXPECT_EQ(count(rand_base, nrandom), (set_seg - nzero) / line_seg);
+
+  Cache_compressor::set_line_reader(nullptr);
+}
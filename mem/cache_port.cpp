@@ -2,9 +2,15 @@
 
 #include "cache_port.hpp"
 
+#include <algorithm>
+
 #include "config.hpp"
 
-Cache_port::Cache_port(const std::string &section, const std::string &name) {
+Cache_port::Cache_port(const std::string &section, const std::string &name)
+    : bankConflict(fmt::format("{}:bankConflict", name))
+    , dataArrayRead(fmt::format("{}:dataArrayRead", name))
+    , wayPredHit(fmt::format("{}:wayPredHit", name))
+    , wayPredMiss(fmt::format("{}:wayPredMiss", name)) {
   int numPorts = Config::get_integer(section, "port_num");
   int portOccp = Config::get_integer(section, "port_occ");
 
@@ -20,6 +26,11 @@ Cache_port::Cache_port(const std::string &section, const std::string &name) {
   dataDelay = hitDelay - missDelay;
   tagDelay  = hitDelay - dataDelay;
 
+  decompressDelay = 0;
+  if (Config::has_entry(section, "decompression_delay")) {
+    decompressDelay = Config::get_integer(section, "decompression_delay", 0, 1024);
+  }
+
   I(hitDelay>=missDelay);
   I(hitDelay>=dataDelay);
 
@@ -37,6 +48,56 @@ Cache_port::Cache_port(const std::string &section, const std::string &name) {
     I(bkPort[i]);
   }
   I(bkPort[0]);
+
+  tagDataMode = Tag_data_mode::Parallel;
+  if (Config::has_entry(section, "tag_data_access")) {
+    auto mode = Config::get_string(section, "tag_data_access", {"parallel", "sequential", "way_predict"});
+    if (mode == "sequential") {
+      tagDataMode = Tag_data_mode::Sequential;
+    } else if (mode == "way_predict") {
+      tagDataMode = Tag_data_mode::Way_predict;
+    }
+  }
+
+  assoc = Config::get_power2(section, "assoc", 1, 1024);
+
+  bkDataPort = nullptr;
+  if (tagDataMode != Tag_data_mode::Parallel) {
+    int dataPortOccp = portOccp;
+    if (Config::has_entry(section, "data_port_occ")) {
+      dataPortOccp = Config::get_integer(section, "data_port_occ", 1, 1024);
+    }
+    bkDataPort = new PortGeneric *[numBanks];
+    for (uint32_t i = 0; i < numBanks; i++) {
+      bkDataPort[i] = PortGeneric::create(fmt::format("{}_bkData({})", name, i), numPorts, dataPortOccp);
+    }
+  }
+
+  if (tagDataMode == Tag_data_mode::Sequential) {
+    // The data read starts after the tag check (tagDelay). Without data_delay
+    // a hit still costs delay, only the data bank port and energy change.
+    if (Config::has_entry(section, "data_delay")) {
+      dataDelay = Config::get_integer(section, "data_delay", 0, 1024);
+    }
+  }
+
+  wayPredMask     = 0;
+  wayMispredDelay = 0;
+  if (tagDataMode == Tag_data_mode::Way_predict) {
+    uint32_t nsets = Config::get_integer(section, "size") / (Config::get_power2(section, "line_size") * assoc);
+    if (Config::has_entry(section, "way_predict_entries")) {
+      nsets = Config::get_power2(section, "way_predict_entries", 1, 1 << 20);
+    }
+    nsets = roundUpPower2(nsets ? nsets : 1);
+    wayPred.resize(nsets, 0);
+    wayPredMask = nsets - 1;
+
+    wayMispredDelay = dataDelay ? dataDelay : 1;
+    if (Config::has_entry(section, "way_mispredict_delay")) {
+      wayMispredDelay = Config::get_integer(section, "way_mispredict_delay", 0, 1024);
+    }
+  }
+
   {
     int send_port_occ = 1;
     int send_port_num = 1;
@@ -87,6 +148,22 @@ Time_t Cache_port::nextBankSlot(Addr_t addr, bool en) {
   return bkPort[bank]->nextSlot(en);
 }
 
+Time_t Cache_port::nextDataBankSlot(Addr_t addr, bool en) {
+  I(bkDataPort);
+  int32_t bank = (addr >> bankShift) & numBanksMask;
+
+  return bkDataPort[bank]->nextSlot(en);
+}
+
+bool Cache_port::predictWay(Addr_t addr, uint32_t way) {
+  uint32_t pos = (addr / lineSize) & wayPredMask;
+
+  bool hit     = wayPred[pos] == way;
+  wayPred[pos] = way;
+
+  return hit;
+}
+
 Time_t Cache_port::calcNextBankSlot(Addr_t addr) {
   int32_t bank = (addr >> bankShift) & numBanksMask;
 
@@ -100,7 +177,7 @@ void Cache_port::nextBankSlotUntil(Addr_t addr, Time_t until, bool en) {
   bkPort[bank]->occupyUntil(until);
 }
 
-Time_t Cache_port::reqDone(MemRequest *mreq, bool retrying) {
+Time_t Cache_port::reqDone(MemRequest *mreq, bool retrying, uint32_t way, bool compressed) {
   if (mreq->isWarmup() || mreq->isDropped()) {
     return globalClock + 1;
   }
@@ -113,7 +190,30 @@ Time_t Cache_port::reqDone(MemRequest *mreq, bool retrying) {
   Time_t when = sendFillPort->nextSlot(mreq->has_stats());
 
   if (!retrying && !mreq->isNonCacheable()) {
-    when += dataDelay;
+    switch (tagDataMode) {
+      case Tag_data_mode::Parallel: when += dataDelay; break;
+      case Tag_data_mode::Sequential: {
+        dataArrayRead.inc(mreq->has_stats());
+        Time_t dataWhen = nextDataBankSlot(mreq->getAddr(), mreq->has_stats());
+        when            = std::max(when, dataWhen) + dataDelay;
+        break;
+      }
+      case Tag_data_mode::Way_predict: {
+        when += dataDelay;
+        if (predictWay(mreq->getAddr(), way)) {
+          wayPredHit.inc(mreq->has_stats());
+        } else {
+          wayPredMiss.inc(mreq->has_stats());
+          dataArrayRead.inc(mreq->has_stats());
+          Time_t dataWhen = nextDataBankSlot(mreq->getAddr(), mreq->has_stats());
+          when            = std::max(when, dataWhen) + wayMispredDelay;
+        }
+        break;
+      }
+    }
+  }
+  if (compressed) {
+    when += decompressDelay;
   }
 
   return when;
@@ -196,7 +296,16 @@ void Cache_port::req2(MemRequest *mreq) {
   } else if (mreq->isNonCacheable()) {
     mreq->redoReqAbs(globalClock + ncDelay);
   } else {
-    mreq->redoReqAbs(nextBankSlot(mreq->getAddr(), mreq->has_stats()) + tagDelay);
+    Time_t when = nextBankSlot(mreq->getAddr(), mreq->has_stats());
+    if (when > globalClock) {
+      bankConflict.inc(mreq->has_stats());
+    }
+    if (tagDataMode == Tag_data_mode::Parallel) {
+      dataArrayRead.add(assoc, mreq->has_stats());
+    } else if (tagDataMode == Tag_data_mode::Way_predict) {
+      dataArrayRead.inc(mreq->has_stats());
+    }
+    mreq->redoReqAbs(when + tagDelay);
   }
 }
 void Cache_port::req(MemRequest *mreq)
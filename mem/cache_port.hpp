@@ -2,17 +2,35 @@
 
 #pragma once
 
+#include <vector>
+
 #include "iassert.hpp"
 #include "memobj.hpp"
 #include "memrequest.hpp"
 #include "port.hpp"
+#include "stats.hpp"
+
+// How the data array is accessed on a lookup:
+//  Parallel:    tag and all data ways are read in the same bank slot
+//  Sequential:  the hit way is read from the data bank after the tag check, a
+//               hit costs miss_delay (tag) + data_delay (data)
+//  Way_predict: only the predicted way is read with the tag, mispredicts re-read the data bank
+enum class Tag_data_mode { Parallel, Sequential, Way_predict };
 
 class Cache_port {
 private:
 protected:
   PortGeneric **bkPort;
+  PortGeneric **bkDataPort;  // nullptr in Parallel mode (bkPort covers tag and data)
   PortGeneric  *sendFillPort;
 
+  Tag_data_mode tagDataMode;
+
+  std::vector<uint16_t> wayPred;  // MRU way per entry, indexed by the line address
+  uint32_t              wayPredMask;
+  TimeDelta_t           wayMispredDelay;
+  uint32_t              assoc;
+
   bool    dupPrefetchTag;
   bool    dropPrefetchFill;
   int32_t maxPrefetch;  // 0 means share with maxRequest
@@ -27,6 +45,7 @@ protected:
 
   TimeDelta_t tagDelay;
   TimeDelta_t dataDelay;
+  TimeDelta_t decompressDelay;  // extra hit latency for compressed lines
 
   uint32_t numBanks;
   int32_t  numBanksMask;
@@ -40,10 +59,17 @@ protected:
 
   std::list<MemRequest *> overflow;
 
+  Stats_cntr bankConflict;
+  Stats_cntr dataArrayRead;  // data ways read (energy)
+  Stats_cntr wayPredHit;
+  Stats_cntr wayPredMiss;
+
   Time_t snoopFillBankUse(MemRequest *mreq);
 
   Time_t calcNextBankSlot(Addr_t addr);
   Time_t nextBankSlot(Addr_t addr, bool en);
+  Time_t nextDataBankSlot(Addr_t addr, bool en);
+  bool   predictWay(Addr_t addr, uint32_t way);
   void   nextBankSlotUntil(Addr_t addr, Time_t until, bool en);
   void   req2(MemRequest *mreq);
 
@@ -54,7 +80,7 @@ public:
   void   blockFill(MemRequest *mreq);
   void   req(MemRequest *mreq);
   void   startPrefetch(MemRequest *mreq);
-  Time_t reqDone(MemRequest *mreq, bool retrying);
+  Time_t reqDone(MemRequest *mreq, bool retrying, uint32_t way, bool compressed = false);
   Time_t reqAckDone(MemRequest *mreq);
   void   reqRetire(MemRequest *mreq);
 
@@ -64,4 +90,7 @@ public:
   void disp(MemRequest *mreq);
 
   bool isBusy(Addr_t addr) const;
+
+  double getWayPredHit() const { return wayPredHit.get(); }
+  double getWayPredMiss() const { return wayPredMiss.get(); }
 };
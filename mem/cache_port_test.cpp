@@ -0,0 +1,145 @@
+// See LICENSE for details.
+
+#include "cache_port.hpp"
+
+#include <fstream>
+#include <string>
+
+#include "callback.hpp"
+#include "ccache.hpp"
+#include "config.hpp"
+#include "dinst.hpp"
+#include "gtest/gtest.h"
+#include "memory_system.hpp"
+#include "memrequest.hpp"
+#include "report.hpp"
+
+static int rd_pending = 0;
+
+static void rdDone(Dinst *dinst) {
+  rd_pending--;
+  dinst->scrap();
+}
+
+typedef CallbackFunction1<Dinst *, &rdDone> rdDoneCB;
+
+class Cache_port_test : public ::testing::Test {
+protected:
+  // DL1 with delay 5 and miss_delay 2 (3 cycles of data after the tag
+  // check). Each cache needs its own name, the stats can not be added twice.
+  CCache *create_dl1(const std::string &name, const std::string &mode, const std::string &extra) {
+    std::ofstream file("cache_port_test.toml");
+    file << "[soc]\n"
+            "core = [\"c0\"]\n"
+            "[c0]\n"
+            "type   = \"ooo\"\n"
+            "caches = true\n"
+         << "dl1    = \"dl1_cache DL1" << name << "\"\n"
+         << "il1    = \"dl1_cache IL1" << name << "\"\n"
+         << "[dl1_cache]\n"
+            "type          = \"cache\"\n"
+            "cold_misses   = true\n"
+            "size          = 32768\n"
+            "line_size     = 64\n"
+            "delay         = 5\n"
+            "miss_delay    = 2\n"
+            "assoc         = 4\n"
+            "repl_policy   = \"lru\"\n"
+            "port_occ      = 1\n"
+            "port_num      = 1\n"
+            "port_banks    = 32\n"
+            "send_port_occ = 1\n"
+            "send_port_num = 1\n"
+            "max_requests  = 32\n"
+            "allocate_miss = true\n"
+            "victim        = false\n"
+            "coherent      = true\n"
+            "inclusive     = true\n"
+            "directory     = false\n"
+            "nlp_distance  = 2\n"
+            "nlp_degree    = 0\n"
+            "nlp_stride    = 1\n"
+            "drop_prefetch = true\n"
+            "prefetch_degree = 0\n"
+            "mega_lines1K  = 8\n"
+         << "tag_data_access = \"" << mode << "\"\n"
+         << extra << "lower_level   = \"mem MEM" << name << " shared\"\n"
+         << "[mem]\n"
+            "type        = \"nice\"\n"
+            "line_size   = 64\n"
+            "delay       = 31\n"
+            "cold_misses = false\n"
+            "lower_level = \"\"\n";
+    file.close();
+
+    Report::init();
+    Config::init("cache_port_test.toml");
+    auto *gms = new Memory_system(0);
+    Config::exit_on_error();
+    EventScheduler::advanceClock();
+
+    auto *dl1 = static_cast<CCache *>(gms->getDL1());
+    EXPECT_EQ(dl1->get_type(), "cache");
+    return dl1;
+  }
+
+  // Cycles from the request to the answer, the ports are idle again after it
+  static Time_t read(CCache *dl1, Addr_t addr) {
+    auto  *ld    = Dinst::create(Instruction(iLALU_LD, LREG_R1, LREG_R2, LREG_R3, LREG_InvalidOutput), 0x400, addr, 0, true);
+    Time_t start = globalClock;
+    MemRequest::sendReqRead(dl1, true, addr, ld->getPC(), rdDoneCB::create(ld));
+    rd_pending++;
+    while (rd_pending) {
+      EventScheduler::advanceClock();
+    }
+    Time_t lat = globalClock - start;
+    for (int i = 0; i < 8; ++i) {
+      EventScheduler::advanceClock();
+    }
+    return lat;
+  }
+};
+
+// Lines 0x10000 and 0x12000 map to the same set and fill different ways
+static const Addr_t line_a = 0x10000;
+static const Addr_t line_b = 0x12000;
+
+TEST_F(Cache_port_test, hit_latency) {
+  auto *par = create_dl1("par", "parallel", "");
+  read(par, line_a);
+  Time_t par_hit = read(par, line_a);
+
+  // Without data_delay a sequential hit still costs delay
+  auto *seq = create_dl1("seq", "sequential", "");
+  read(seq, line_a);
+  EXPECT_EQ(read(seq, line_a), par_hit);
+
+  // Tag (miss_delay 2) then data (data_delay 6), 3 cycles more than delay 5
+  auto *seq6 = create_dl1("seq6", "sequential", "data_delay = 6\n");
+  read(seq6, line_b);
+  EXPECT_EQ(read(seq6, line_b), par_hit + 3);
+}
+
+TEST_F(Cache_port_test, way_predict) {
+  auto *dl1 = create_dl1("wp", "way_predict", "way_mispredict_delay = 2\n");
+  read(dl1, line_a);
+  read(dl1, line_b);
+  read(dl1, line_a);  // trains the entry on the way of line_a
+
+  const auto &port = dl1->getPort();
+  double      hit  = port.getWayPredHit();
+  double      miss = port.getWayPredMiss();
+
+  Time_t pred_hit = read(dl1, line_a);
+  EXPECT_EQ(port.getWayPredHit(), hit + 1);
+
+  // Same entry, another way: the data bank is read again
+  Time_t pred_miss = read(dl1, line_b);
+  EXPECT_EQ(port.getWayPredMiss(), miss + 1);
+  EXPECT_EQ(pred_miss, pred_hit + 2);
+
+  EXPECT_EQ(read(dl1, line_b), pred_hit);
+  EXPECT_EQ(read(dl1, line_a), pred_miss);
+  EXPECT_EQ(port.getWayPredHit(), hit + 2);
+  EXPECT_EQ(port.getWayPredMiss(), miss + 2);
+}
@@ -0,0 +1,509 @@
+// See LICENSE for details.
+
+#include "cache_prefetcher.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "config.hpp"
+#include "fmt/format.h"
+#include "memobj.hpp"
+#include "snippets.hpp"
+
+std::unique_ptr<Prefetch_engine> Prefetch_engine::create(const std::string &section, int32_t line_size) {
+  auto type = Config::get_string(section, "type", {"stream", "bop", "spp", "ipcp"});
+
+  if (type == "stream") {
+    int nstreams = Config::has_entry(section, "streams") ? Config::get_integer(section, "streams", 1, 256) : 16;
+    int dist     = Config::has_entry(section, "distance") ? Config::get_integer(section, "distance", 1, 64) : 1;
+    return std::make_unique<Stream_prefetcher>(nstreams, dist);
+  }
+  if (type == "bop") {
+    int rr_size    = Config::has_entry(section, "rr_size") ? Config::get_power2(section, "rr_size", 16, 4096) : 256;
+    int max_offset = Config::has_entry(section, "max_offset") ? Config::get_integer(section, "max_offset", 2, 256) : 64;
+    return std::make_unique<Bop_prefetcher>(rr_size, max_offset);
+  }
+  if (type == "spp") {
+    int st_size = Config::has_entry(section, "st_size") ? Config::get_power2(section, "st_size", 16, 4096) : 256;
+    return std::make_unique<Spp_prefetcher>(st_size, line_size);
+  }
+  if (type == "ipcp") {
+    int ipt_size = Config::has_entry(section, "ipt_size") ? Config::get_power2(section, "ipt_size", 16, 4096) : 64;
+    return std::make_unique<Ipcp_prefetcher>(ipt_size);
+  }
+
+  return nullptr;  // Config already reported the error
+}
+
+/************************************************
+ * Stream
+ ************************************************/
+
+Stream_prefetcher::Stream_prefetcher(int nstreams, int dist) : streams(nstreams), distance(dist), lru_clock(0) {
+  for (auto &s : streams) {
+    s = {0, 0, 0, 0};
+  }
+}
+
+void Stream_prefetcher::access(const Access &acc, int degree, std::vector<Addr_t> &pref) {
+  if (acc.hit && !acc.prefetch_hit) {
+    return;  // only misses and first uses of prefetched lines move the streams
+  }
+
+  lru_clock++;
+
+  Stream *lru = &streams[0];
+  for (auto &s : streams) {
+    if (s.lru && s.last != acc.line) {
+      int64_t delta = static_cast<int64_t>(acc.line - s.last);
+      if (std::abs(delta) <= WINDOW) {
+        int dir = delta > 0 ? 1 : -1;
+        if (dir == s.dir) {
+          s.conf = std::min(s.conf + 1, CONF_MIN);
+        } else {
+          s.dir  = dir;
+          s.conf = 1;
+        }
+        s.last = acc.line;
+        s.lru  = lru_clock;
+
+        if (s.conf >= CONF_MIN) {
+          for (int i = 0; i < degree; i++) {
+            pref.push_back(acc.line + s.dir * (distance + i));
+          }
+        }
+        return;
+      }
+    }
+    if (s.lru < lru->lru) {
+      lru = &s;
+    }
+  }
+
+  *lru = {acc.line, 0, 0, lru_clock};
+}
+
+/************************************************
+ * Best-Offset
+ ************************************************/
+
+Bop_prefetcher::Bop_prefetcher(int rr_size, int max_offset)
+    : rr(rr_size, 0), rr_mask(rr_size - 1), test_pos(0), round(0), best_offset(1), enabled(true) {
+  I((rr_size & (rr_size - 1)) == 0);
+
+  // Offsets with no prime factor other than 2, 3, and 5
+  for (int i = 1; i <= max_offset; i++) {
+    int n = i;
+    for (int f : {2, 3, 5}) {
+      while (n % f == 0) {
+        n /= f;
+      }
+    }
+    if (n == 1) {
+      offsets.push_back(i);
+    }
+  }
+  scores.resize(offsets.size(), 0);
+}
+
+void Bop_prefetcher::learn(Addr_t line) {
+  if (rr_hit(line - offsets[test_pos])) {
+    scores[test_pos]++;
+  }
+
+  bool end_phase = scores[test_pos] >= SCORE_MAX;
+
+  test_pos++;
+  if (test_pos == offsets.size()) {
+    test_pos = 0;
+    round++;
+    end_phase = end_phase || round >= ROUND_MAX;
+  }
+
+  if (!end_phase) {
+    return;
+  }
+
+  auto best   = std::max_element(scores.begin(), scores.end()) - scores.begin();
+  best_offset = offsets[best];
+  enabled     = scores[best] > BAD_SCORE;
+
+  std::fill(scores.begin(), scores.end(), 0);
+  test_pos = 0;
+  round    = 0;
+}
+
+void Bop_prefetcher::access(const Access &acc, int degree, std::vector<Addr_t> &pref) {
+  if (acc.hit && !acc.prefetch_hit) {
+    return;
+  }
+
+  learn(acc.line);
+
+  if (!enabled) {
+    return;
+  }
+
+  for (int i = 1; i <= degree; i++) {
+    pref.push_back(acc.line + best_offset * i);
+  }
+}
+
+void Bop_prefetcher::fill(Addr_t line, bool prefetch) {
+  // A prefetch for X was triggered by X-D, record the base so that the offsets
+  // that would have been timely score.
+  if (prefetch) {
+    rr_insert(line - best_offset);
+  } else if (!enabled) {
+    rr_insert(line);
+  }
+}
+
+/************************************************
+ * Signature Path
+ ************************************************/
+
+Spp_prefetcher::Spp_prefetcher(int st_size, int line_size, int page_size)
+    : st(st_size), pt(1 << SIG_BITS), page_lines(page_size / line_size), page_bits(log2i(page_size / line_size)) {
+  I((st_size & (st_size - 1)) == 0);
+  I(page_size > line_size);
+
+  for (auto &e : st) {
+    e = {0, 0, 0};
+  }
+  for (auto &e : pt) {
+    e = {};
+  }
+}
+
+uint16_t Spp_prefetcher::next_sig(uint16_t sig, int delta) {
+  // 7-bit sign and magnitude delta
+  uint16_t d = delta < 0 ? (((-delta) & 0x3F) | 0x40) : (delta & 0x3F);
+  return ((sig << 3) ^ d) & ((1 << SIG_BITS) - 1);
+}
+
+void Spp_prefetcher::update_pt(uint16_t sig, int delta) {
+  auto &e = pt[sig];
+
+  if (e.c_sig >= CNTR_MAX) {
+    e.c_sig >>= 1;
+    for (int i = 0; i < PT_DELTAS; i++) {
+      e.c_delta[i] >>= 1;
+    }
+  }
+  e.c_sig++;
+
+  int victim = 0;
+  for (int i = 0; i < PT_DELTAS; i++) {
+    if (e.c_delta[i] && e.delta[i] == delta) {
+      e.c_delta[i]++;
+      return;
+    }
+    if (e.c_delta[i] < e.c_delta[victim]) {
+      victim = i;
+    }
+  }
+
+  e.delta[victim]   = delta;
+  e.c_delta[victim] = 1;
+}
+
+void Spp_prefetcher::access(const Access &acc, int degree, std::vector<Addr_t> &pref) {
+  Addr_t page   = acc.line >> page_bits;
+  int    offset = acc.line & (page_lines - 1);
+
+  auto &e = st[page & (st.size() - 1)];
+  if (e.page != page) {
+    e = {page, offset, 0};
+    return;
+  }
+
+  int delta = offset - e.last_offset;
+  if (delta == 0) {
+    return;
+  }
+
+  update_pt(e.sig, delta);
+  e.sig         = next_sig(e.sig, delta);
+  e.last_offset = offset;
+
+  // Lookahead following the most likely delta while the path confidence holds
+  uint16_t sig  = e.sig;
+  double   conf = 1.0;
+  int      base = offset;
+  for (int d = 0; d < degree; d++) {
+    const auto &p = pt[sig];
+    if (p.c_sig == 0) {
+      break;
+    }
+
+    int best = 0;
+    for (int i = 1; i < PT_DELTAS; i++) {
+      if (p.c_delta[i] > p.c_delta[best]) {
+        best = i;
+      }
+    }
+
+    conf *= static_cast<double>(p.c_delta[best]) / p.c_sig;
+    if (conf < CONF_MIN) {
+      break;
+    }
+
+    base += p.delta[best];
+    if (base < 0 || base >= page_lines) {
+      break;  // do not cross the page
+    }
+
+    pref.push_back((page << page_bits) | base);
+    sig = next_sig(sig, p.delta[best]);
+  }
+}
+
+/************************************************
+ * IP Classifier
+ ************************************************/
+
+Ipcp_prefetcher::Ipcp_prefetcher(int ipt_size, int rst_size) : ipt(ipt_size), cspt(ipt_size * 2), rst(rst_size), rst_pos(0) {
+  I((ipt_size & (ipt_size - 1)) == 0);
+
+  for (auto &e : ipt) {
+    e = {0, 0, 0, 0, 0};
+  }
+  for (auto &e : cspt) {
+    e = {0, 0};
+  }
+  for (auto &r : rst) {
+    r = {0, 0, 0, 1};
+  }
+}
+
+Ipcp_prefetcher::Region *Ipcp_prefetcher::find_region(Addr_t line) {
+  Addr_t region = line >> REGION_BITS;
+  for (auto &r : rst) {
+    if (r.region == region) {
+      return &r;
+    }
+  }
+
+  auto &r = rst[rst_pos];
+  rst_pos = (rst_pos + 1) % rst.size();
+  r       = {region, 0, static_cast<int>(line & ((1 << REGION_BITS) - 1)), 1};
+  return &r;
+}
+
+void Ipcp_prefetcher::access(const Access &acc, int degree, std::vector<Addr_t> &pref) {
+  bool trigger = !acc.hit || acc.prefetch_hit;
+
+  auto *r      = find_region(acc.line);
+  int   offset = acc.line & ((1 << REGION_BITS) - 1);
+  if (offset != r->last_offset) {
+    r->dir = offset > r->last_offset ? 1 : -1;
+  }
+  r->last_offset = offset;
+  r->bitmap |= 1U << offset;
+
+  auto &ip = ipt[(acc.pc >> 2) & (ipt.size() - 1)];
+  if (ip.tag != acc.pc) {
+    ip = {acc.pc, acc.line, 0, 0, 0};
+    if (trigger) {
+      pref.push_back(acc.line + 1);
+    }
+    return;
+  }
+
+  int stride = static_cast<int>(acc.line - ip.last_line);
+  if (stride == 0) {
+    return;
+  }
+
+  // Constant stride
+  if (stride == ip.stride) {
+    ip.conf = std::min(ip.conf + 1, CONF_MAX);
+  } else if (ip.conf > 0) {
+    ip.conf--;
+  } else {
+    ip.stride = stride;
+  }
+
+  // Complex stride, indexed by the signature of the previous strides of the IP
+  auto &cs = cspt[ip.sig];
+  if (cs.stride == stride) {
+    cs.conf = std::min(cs.conf + 1, CONF_MAX);
+  } else if (cs.conf > 0) {
+    cs.conf--;
+  } else {
+    cs.stride = stride;
+  }
+  ip.sig       = ((ip.sig << 1) ^ (stride & 0x3F)) & (cspt.size() - 1);
+  ip.last_line = acc.line;
+
+  if (!trigger) {
+    return;
+  }
+
+  if (__builtin_popcount(r->bitmap) >= REGION_DENSE) {
+    for (int i = 1; i <= degree; i++) {
+      pref.push_back(acc.line + r->dir * i);
+    }
+    return;
+  }
+
+  if (ip.conf >= CONF_MAX - 1) {
+    for (int i = 1; i <= degree; i++) {
+      pref.push_back(acc.line + ip.stride * i);
+    }
+    return;
+  }
+
+  uint16_t sig  = ip.sig;
+  Addr_t   line = acc.line;
+  for (int i = 0; i < degree; i++) {
+    const auto &c = cspt[sig];
+    if (c.conf == 0 || c.stride == 0) {
+      break;
+    }
+    line += c.stride;
+    pref.push_back(line);
+    sig = ((sig << 1) ^ (c.stride & 0x3F)) & (cspt.size() - 1);
+  }
+
+  if (pref.empty()) {
+    pref.push_back(acc.line + 1);
+  }
+}
+
+/************************************************
+ * Cache_prefetcher
+ ************************************************/
+
+static constexpr int32_t DEGREE_PCT[Cache_prefetcher::MAX_LEVEL] = {25, 50, 100, 150, 200};
+
+Cache_prefetcher::Cache_prefetcher(MemObj *_owner, const std::string &section, const std::string &name, uint32_t lineSize,
+                                   int32_t _maxOutstanding)
+    : owner(_owner)
+    , engine(Prefetch_engine::create(section, lineSize))
+    , lineSizeBits(log2i(lineSize))
+    , maxOutstanding(_maxOutstanding)
+    , level(3)
+    , intIssued(0)
+    , intUseful(0)
+    , intLate(0)
+    , intMisses(0)
+    , intPollution(0)
+    , nCandidates(fmt::format("{}:nEngineCandidates", name))
+    , nIssued(fmt::format("{}:nEngineIssued", name))
+    , nUseful(fmt::format("{}:nEngineUseful", name))
+    , nLate(fmt::format("{}:nEngineLate", name))
+    , nPollution(fmt::format("{}:nEnginePollution", name))
+    , nMSHRThrottled(fmt::format("{}:nEngineMSHRThrottled", name))
+    , avgLevel(fmt::format("{}_avgEngineLevel", name)) {
+  degree = Config::get_integer(section, "degree", 1, 16);
+
+  throttle         = Config::has_entry(section, "throttle") ? Config::get_bool(section, "throttle") : true;
+  throttleInterval = Config::has_entry(section, "throttle_interval") ? Config::get_integer(section, "throttle_interval", 16, 65536)
+                                                                     : 256;
+  mshrPressure     = Config::has_entry(section, "mshr_pressure") ? Config::get_integer(section, "mshr_pressure", 1, 100) : 75;
+
+  inflight.resize(256, 0);
+  polluted.resize(256, 0);
+  inflightMask = inflight.size() - 1;
+}
+
+void Cache_prefetcher::adjustLevel() {
+  double accuracy = static_cast<double>(intUseful) / intIssued;
+  double lateness  = intUseful ? static_cast<double>(intLate) / intUseful : 0;
+  double pollution = intMisses ? static_cast<double>(intPollution) / intMisses : 0;
+
+  // Back off when prefetches are useless or push out useful lines, push
+  // harder when they are accurate or arrive late, else keep the level
+  if (accuracy < ACCURACY_LOW || pollution > POLLUTION_MAX) {
+    level = std::max(level - 1, 1);
+  } else if (accuracy >= ACCURACY_HIGH || lateness > LATENESS_MAX) {
+    level = std::min(level + 1, MAX_LEVEL);
+  }
+
+  intIssued    = 0;
+  intUseful    = 0;
+  intLate      = 0;
+  intMisses    = 0;
+  intPollution = 0;
+}
+
+void Cache_prefetcher::access(Addr_t addr, Addr_t pc, bool hit, bool prefetchHit, int32_t nUsed, bool doStats) {
+  if (!engine) {
+    return;
+  }
+
+  Addr_t line = addr >> lineSizeBits;
+
+  if (!hit) {
+    intMisses++;
+    auto &e = inflight[inflightPos(line)];
+    auto &p = polluted[inflightPos(line)];
+    if (e == line) {  // demand arrived before the prefetch fill
+      nLate.inc(doStats);
+      intLate++;
+      prefetchHit = true;
+      e           = 0;
+    } else if (p == line) {  // miss caused by a prefetch displacing the line
+      nPollution.inc(doStats);
+      intPollution++;
+      p = 0;
+    }
+  }
+
+  avgLevel.sample(level, doStats);
+
+  candidates.clear();
+  int32_t d = std::max(1, degree * DEGREE_PCT[level - 1] / 100);
+  engine->access({line, pc, hit, prefetchHit}, d, candidates);
+
+  for (auto c : candidates) {
+    if (nUsed * 100 >= mshrPressure * maxOutstanding) {
+      nMSHRThrottled.inc(doStats);
+      break;
+    }
+    nCandidates.inc(doStats);
+    owner->tryPrefetch(c << lineSizeBits, doStats, 0, PSIGN_CACHE, pc);
+    nUsed++;
+  }
+}
+
+void Cache_prefetcher::issued(Addr_t addr, bool doStats) {
+  Addr_t line = addr >> lineSizeBits;
+
+  inflight[inflightPos(line)] = line;
+
+  nIssued.inc(doStats);
+  intIssued++;
+  if (throttle && intIssued >= throttleInterval) {
+    adjustLevel();
+  }
+}
+
+void Cache_prefetcher::fill(Addr_t addr, bool prefetch) {
+  if (!engine) {
+    return;
+  }
+
+  Addr_t line = addr >> lineSizeBits;
+  engine->fill(line, prefetch);
+
+  if (prefetch) {
+    auto &e = inflight[inflightPos(line)];
+    if (e == line) {
+      e = 0;
+    }
+  }
+}
+
+void Cache_prefetcher::displaced(Addr_t addr) {
+  Addr_t line = addr >> lineSizeBits;
+
+  polluted[inflightPos(line)] = line;
+}
+
+void Cache_prefetcher::useful(bool doStats) {
+  nUseful.inc(doStats);
+  intUseful++;
+}
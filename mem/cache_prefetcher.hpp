@@ -0,0 +1,231 @@
+// See LICENSE for details.
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "opcode.hpp"
+#include "stats.hpp"
+
+class MemObj;
+
+// Cache level prefetchers. A Cache_prefetcher is attached to a MemObj, it
+// observes the demand hit/miss stream of the level and issues the requests
+// generated by its engine through MemObj::tryPrefetch.
+//
+// Engines work with line addresses (addr >> log2(line_size)), and return up
+// to degree candidates per access.
+
+class Prefetch_engine {
+public:
+  struct Access {
+    Addr_t line;
+    Addr_t pc;
+    bool   hit;
+    bool   prefetch_hit;  // demand hit on a prefetched line
+  };
+
+  virtual ~Prefetch_engine() = default;
+
+  virtual void access(const Access &acc, int degree, std::vector<Addr_t> &pref) = 0;
+  virtual void fill(Addr_t line, bool prefetch) {
+    (void)line;
+    (void)prefetch;
+  }
+
+  static std::unique_ptr<Prefetch_engine> create(const std::string &section, int32_t line_size);
+};
+
+// Multiple streams tracked on misses, prefetches ahead in the stream direction
+class Stream_prefetcher : public Prefetch_engine {
+private:
+  struct Stream {
+    Addr_t   last;
+    int      dir;
+    int      conf;
+    uint64_t lru;
+  };
+
+  static constexpr int WINDOW   = 16;  // lines from the last access that belong to the stream
+  static constexpr int CONF_MIN = 2;
+
+  std::vector<Stream> streams;
+  int                 distance;
+  uint64_t            lru_clock;
+
+public:
+  Stream_prefetcher(int nstreams, int dist);
+
+  void access(const Access &acc, int degree, std::vector<Addr_t> &pref) override;
+};
+
+// Best-Offset prefetcher (Michaud, HPCA 2016)
+class Bop_prefetcher : public Prefetch_engine {
+private:
+  static constexpr int SCORE_MAX = 31;
+  static constexpr int ROUND_MAX = 100;
+  static constexpr int BAD_SCORE = 1;
+
+  std::vector<int>    offsets;
+  std::vector<int>    scores;
+  std::vector<Addr_t> rr;  // recent requests table
+  uint32_t            rr_mask;
+
+  size_t test_pos;
+  int    round;
+  int    best_offset;
+  bool   enabled;
+
+  uint32_t rr_hash(Addr_t line) const { return (line ^ (line >> 8)) & rr_mask; }
+  void     rr_insert(Addr_t line) { rr[rr_hash(line)] = line; }
+  bool     rr_hit(Addr_t line) const { return rr[rr_hash(line)] == line; }
+  void     learn(Addr_t line);
+
+public:
+  Bop_prefetcher(int rr_size, int max_offset);
+
+  void access(const Access &acc, int degree, std::vector<Addr_t> &pref) override;
+  void fill(Addr_t line, bool prefetch) override;
+
+  int  get_best_offset() const { return best_offset; }
+  bool is_enabled() const { return enabled; }
+};
+
+// Signature Path Prefetcher (Kim et al., MICRO 2016)
+class Spp_prefetcher : public Prefetch_engine {
+private:
+  static constexpr int    SIG_BITS  = 12;
+  static constexpr int    PT_DELTAS = 4;
+  static constexpr int    CNTR_MAX  = 15;
+  static constexpr double CONF_MIN  = 0.25;  // path confidence to keep looking ahead
+
+  struct St_entry {
+    Addr_t   page;
+    int      last_offset;
+    uint16_t sig;
+  };
+  struct Pt_entry {
+    int delta[PT_DELTAS];
+    int c_delta[PT_DELTAS];
+    int c_sig;
+  };
+
+  std::vector<St_entry> st;
+  std::vector<Pt_entry> pt;
+  const int             page_lines;
+  const int             page_bits;
+
+  static uint16_t next_sig(uint16_t sig, int delta);
+  void            update_pt(uint16_t sig, int delta);
+
+public:
+  Spp_prefetcher(int st_size, int line_size, int page_size = 4096);
+
+  void access(const Access &acc, int degree, std::vector<Addr_t> &pref) override;
+};
+
+// Instruction Pointer Classifier Prefetcher (Pakalapati and Panda, ISCA 2020).
+// Each IP is classified as constant stride, complex stride or global stream,
+// falling back to next line.
+class Ipcp_prefetcher : public Prefetch_engine {
+private:
+  static constexpr int CONF_MAX     = 3;
+  static constexpr int REGION_BITS  = 5;   // 32 lines per region
+  static constexpr int REGION_DENSE = 24;  // lines touched to classify the region as a global stream
+
+  struct Ip_entry {
+    Addr_t   tag;
+    Addr_t   last_line;
+    int      stride;
+    int      conf;
+    uint16_t sig;
+  };
+  struct Cspt_entry {
+    int stride;
+    int conf;
+  };
+  struct Region {
+    Addr_t   region;
+    uint32_t bitmap;
+    int      last_offset;
+    int      dir;
+  };
+
+  std::vector<Ip_entry>   ipt;
+  std::vector<Cspt_entry> cspt;
+  std::vector<Region>     rst;
+  size_t                  rst_pos;
+
+  Region *find_region(Addr_t line);
+
+public:
+  explicit Ipcp_prefetcher(int ipt_size, int rst_size = 8);
+
+  void access(const Access &acc, int degree, std::vector<Addr_t> &pref) override;
+};
+
+class Cache_prefetcher {
+private:
+  MemObj                          *owner;
+  std::unique_ptr<Prefetch_engine> engine;
+
+  const uint32_t lineSizeBits;
+  const int32_t  maxOutstanding;  // MSHR entries of the owner
+
+  int32_t degree;
+  int32_t level;  // aggressiveness [1..MAX_LEVEL], scales the degree
+
+  bool    throttle;
+  int32_t throttleInterval;
+  int32_t mshrPressure;  // % of maxOutstanding above which no prefetch is issued
+
+  int32_t intIssued;  // per throttle interval
+  int32_t intUseful;
+  int32_t intLate;
+  int32_t intMisses;
+  int32_t intPollution;
+
+  std::vector<Addr_t> inflight;  // recently issued prefetch lines (lateness)
+  std::vector<Addr_t> polluted;  // lines displaced by prefetch fills (pollution)
+  uint32_t            inflightMask;
+
+  std::vector<Addr_t> candidates;
+
+  Stats_cntr nCandidates;
+  Stats_cntr nIssued;
+  Stats_cntr nUseful;
+  Stats_cntr nLate;
+  Stats_cntr nPollution;
+  Stats_cntr nMSHRThrottled;
+  Stats_avg  avgLevel;
+
+  uint32_t inflightPos(Addr_t line) const { return (line ^ (line >> 10)) & inflightMask; }
+  void     adjustLevel();
+
+public:
+  static constexpr int32_t MAX_LEVEL = 5;
+
+  static constexpr double ACCURACY_LOW  = 0.40;  // FDP thresholds
+  static constexpr double ACCURACY_HIGH = 0.75;
+  static constexpr double LATENESS_MAX  = 0.01;
+  static constexpr double POLLUTION_MAX = 0.05;
+
+  Cache_prefetcher(MemObj *owner, const std::string &section, const std::string &name, uint32_t lineSize, int32_t maxOutstanding);
+
+  // Demand access observed by the owner (a miss includes a hit on a pending
+  // line). nUsed is the current MSHR occupancy of the owner.
+  void access(Addr_t addr, Addr_t pc, bool hit, bool prefetchHit, int32_t nUsed, bool doStats);
+  // Prefetch request created by the owner (not dropped or forwarded)
+  void issued(Addr_t addr, bool doStats);
+  // Line filled in the owner
+  void fill(Addr_t addr, bool prefetch);
+  // Valid line displaced from the owner by a prefetch fill
+  void displaced(Addr_t addr);
+  // Demand hit on a line brought by this prefetcher
+  void useful(bool doStats);
+
+  int32_t getLevel() const { return level; }
+};
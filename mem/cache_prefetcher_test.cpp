@@ -0,0 +1,147 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include "cache_prefetcher.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <vector>
+
+#include "config.hpp"
+#include "gtest/gtest.h"
+
+class Cache_prefetcher_test : public ::testing::Test {
+protected:
+  std::vector<Addr_t> pref;
+
+  // Demand misses on base, base+stride, ... Returns the candidates of the last access
+  std::vector<Addr_t> run(Prefetch_engine &engine, Addr_t base, int stride, int n, int degree, Addr_t pc = 0x400) {
+    for (int i = 0; i < n; i++) {
+      pref.clear();
+      engine.access({base + i * stride, pc, false, false}, degree, pref);
+    }
+    return pref;
+  }
+
+  bool has(Addr_t line) const { return std::find(pref.begin(), pref.end(), line) != pref.end(); }
+};
+
+TEST_F(Cache_prefetcher_test, stream) {
+  Stream_prefetcher engine(4, 1);
+
+  auto out = run(engine, 1000, 1, 8, 2);
+  ASSERT_EQ(out.size(), 2);
+  EXPECT_EQ(out[0], 1008);
+  EXPECT_EQ(out[1], 1009);
+
+  out = run(engine, 5000, -1, 8, 1);
+  ASSERT_EQ(out.size(), 1);
+  EXPECT_EQ(out[0], 4992);
+}
+
+TEST_F(Cache_prefetcher_test, bop_learns_offset) {
+  Bop_prefetcher engine(256, 32);
+
+  // Stride 3 misses, each line filled right after the miss
+  Addr_t line = 1 << 20;
+  for (int i = 0; i < 4000; i++) {
+    pref.clear();
+    engine.access({line, 0x400, false, false}, 1, pref);
+    engine.fill(line, false);
+    for (auto p : pref) {
+      engine.fill(p, true);
+    }
+    line += 3;
+  }
+
+  EXPECT_TRUE(engine.is_enabled());
+  EXPECT_EQ(engine.get_best_offset() % 3, 0);
+}
+
+TEST_F(Cache_prefetcher_test, spp_lookahead) {
+  Spp_prefetcher engine(256, 64);
+
+  // Repeated +2 deltas inside a page build a confident path
+  for (int page = 0; page < 8; page++) {
+    run(engine, (page + 16) * 64, 2, 16, 4);
+  }
+
+  run(engine, 40 * 64, 2, 4, 4);
+  EXPECT_EQ(pref.size(), 4);
+  EXPECT_TRUE(has(40 * 64 + 8));
+  EXPECT_TRUE(has(40 * 64 + 14));
+}
+
+TEST_F(Cache_prefetcher_test, ipcp_constant_stride) {
+  Ipcp_prefetcher engine(64);
+
+  auto out = run(engine, 1 << 20, 7, 8, 2, 0x1234);
+  ASSERT_EQ(out.size(), 2);
+  EXPECT_EQ(out[0], (1 << 20) + 7 * 8);
+  EXPECT_EQ(out[1], (1 << 20) + 7 * 9);
+
+  // Unknown IP falls back to next line
+  pref.clear();
+  engine.access({4000, 0x8888, false, false}, 2, pref);
+  ASSERT_EQ(pref.size(), 1);
+  EXPECT_EQ(pref[0], 4001);
+}
+
+TEST_F(Cache_prefetcher_test, throttle_feedback) {
+  std::ofstream file("cache_prefetcher_test.toml");
+  file << "[pref_test]\n";
+  file << "type              = \"stream\"\n";
+  file << "degree            = 4\n";
+  file << "throttle_interval = 16\n";
+  file.close();
+
+  Config::init("cache_prefetcher_test.toml");
+
+  // No owner: access() below is always MSHR throttled, so no request is sent
+  Cache_prefetcher pref(nullptr, "pref_test", "pref_test", 64, 16);
+  ASSERT_EQ(pref.getLevel(), 3);
+
+  auto interval = [&](int nUseful, Addr_t base) {
+    for (int i = 0; i < 16; i++) {
+      if (i < nUseful) {
+        pref.useful(false);
+      }
+      pref.issued((base + i) << 6, false);
+    }
+  };
+
+  // Accurate and timely: more aggressive, up to MAX_LEVEL
+  interval(16, 0x1000);
+  EXPECT_EQ(pref.getLevel(), 4);
+  interval(14, 0x2000);
+  EXPECT_EQ(pref.getLevel(), 5);
+  interval(16, 0x3000);
+  EXPECT_EQ(pref.getLevel(), Cache_prefetcher::MAX_LEVEL);
+
+  // Middle band keeps the level
+  interval(8, 0x4000);
+  EXPECT_EQ(pref.getLevel(), 5);
+
+  // Inaccurate: back off
+  interval(2, 0x5000);
+  EXPECT_EQ(pref.getLevel(), 4);
+
+  // Accurate, but prefetches displace lines that demand misses then need
+  for (Addr_t i = 0; i < 4; i++) {
+    pref.displaced((0x9000 + i) << 6);
+    pref.access((0x9000 + i) << 6, 0x400, false, false, 16, false);
+  }
+  interval(16, 0x6000);
+  EXPECT_EQ(pref.getLevel(), 3);
+
+  // Late but only moderately accurate: raise again
+  for (Addr_t i = 0; i < 16; i++) {
+    if (i < 8) {
+      pref.useful(false);
+    }
+    pref.issued((0x7000 + i) << 6, false);
+    if (i < 4) {
+      pref.access((0x7000 + i) << 6, 0x400, false, false, 16, false);
+    }
+  }
+  EXPECT_EQ(pref.getLevel(), 4);
+}
@@ -65,6 +65,10 @@ CCache::CCache(Memory_system *gms, const std::string &sec, const std::string &n)
     , nPrefetchHitPending(fmt::format("{}:nPrefetchHitPending", n))
     , nPrefetchHitBusy(fmt::format("{}:nPrefetchHitBusy", n))
     , nPrefetchDropped(fmt::format("{}:nPrefetchDropped", n))
+    , nCompressedFill(fmt::format("{}:nCompressedFill", n))
+    , nCompactionEvict(fmt::format("{}:nCompactionEvict", n))
+    , avgCompressRatio(fmt::format("{}_avgCompressRatio", n))
+    , avgEffectiveCapacity(fmt::format("{}_avgEffectiveCapacity", n))
     , cleanupCB(this)
     , port(sec, n) {
   s_reqHit[ma_setInvalid]   = new Stats_cntr(fmt::format("{}:setInvalidHit", name));
@@ -149,6 +153,27 @@ CCache::CCache(Memory_system *gms, const std::string &sec, const std::string &n)
   lineSize     = cacheBank->getLineSize();
   lineSizeBits = log2i(lineSize);
 
+  setSegments = 0;
+  if (Config::has_entry(section, "compression")) {
+    auto ctype = Cache_compressor::get_type(Config::get_string(section, "compression", {"none", "bdi", "fpc"}));
+    if (ctype != Compression_type::None) {
+      int32_t segSize = 8;
+      if (Config::has_entry(section, "compression_segment_size")) {
+        segSize = Config::get_power2(section, "compression_segment_size", 1, lineSize);
+      }
+      int32_t tagRatio = 2;
+      if (Config::has_entry(section, "compression_tag_ratio")) {
+        tagRatio = Config::get_power2(section, "compression_tag_ratio", 1, 8);
+      }
+      if (cacheBank->getAssoc() <= 1 || cacheBank->getAssoc() > 64 || lineSize < 8) {
+        Config::add_error(fmt::format("{} CCache compression needs an associative cache (up to 64 ways)", section));
+        return;
+      }
+      compressor  = std::make_unique<Cache_compressor>(ctype, lineSize, segSize);
+      setSegments = (cacheBank->getAssoc() / tagRatio) * compressor->get_line_segments();
+    }
+  }
+
   prefetch_degree = Config::get_integer(section, "prefetch_degree", 0, 32);
 
   auto mega_lines1K  = Config::get_integer(section, "mega_lines1K", 0, 32);  // number of lines touched in 1K to trigger mega
@@ -171,6 +196,30 @@ CCache::CCache(Memory_system *gms, const std::string &sec, const std::string &n)
 
     mshr  = new MSHR(name, 128 * MaxRequests, lineSize2, MaxRequests);
     pmshr = new MSHR(name + "sp", 128 * MaxRequests, lineSize2, MaxRequests);
+
+    if (Config::has_entry(section, "mshr_size")) {
+      int32_t size    = Config::get_integer(section, "mshr_size", 1, 128 * MaxRequests);
+      int32_t reserve = 0;
+      int32_t prefMax = size;
+      if (Config::has_entry(section, "mshr_demand_reserve")) {
+        reserve = Config::get_integer(section, "mshr_demand_reserve", 0, size - 1);
+      }
+      if (Config::has_entry(section, "mshr_prefetch_max")) {
+        prefMax = Config::get_integer(section, "mshr_prefetch_max", 0, size);
+      }
+      mshr->setPartition(size, reserve, prefMax);
+    }
+    if (Config::has_entry(section, "mshr_demand_subentries")) {
+      mshr->setSubEntries(Mshr_type::Demand, Config::get_integer(section, "mshr_demand_subentries", 0, 1024));
+    }
+    if (Config::has_entry(section, "mshr_prefetch_subentries")) {
+      mshr->setSubEntries(Mshr_type::Prefetch, Config::get_integer(section, "mshr_prefetch_subentries", 0, 1024));
+    }
+
+    if (Config::has_entry(section, "prefetch_engine")) {
+      auto psection = Config::get_string(section, "prefetch_engine");
+      prefetcher    = std::make_unique<Cache_prefetcher>(this, psection, name, lineSize, MaxRequests);
+    }
   }
 
   I(getLineSize() < 4096);  // To avoid bank selection conflict (insane CCache line)
@@ -325,6 +374,9 @@ CCache::Line *CCache::allocateLine(Addr_t addr, MemRequest *mreq) {
     if (l->isPrefetch() && !mreq->isPrefetch()) {
       nPrefetchWasteful.inc(mreq->has_stats());
     }
+    if (prefetcher && mreq->isPrefetch()) {
+      prefetcher->displaced(rpl_addr);
+    }
 
     // TODO: add a port for evictions. Schedule the displaceLine accordingly
     displaceLine(rpl_addr, mreq, l);
@@ -332,10 +384,18 @@ CCache::Line *CCache::allocateLine(Addr_t addr, MemRequest *mreq) {
 
   l->set(mreq);
 
+  if (compressor) {
+    compactSet(addr, mreq, l);
+  }
+
   if (mreq->isPrefetch()) {
     nPrefetchLineFill.inc(mreq->has_stats());
   }
 
+  if (prefetcher) {
+    prefetcher->fill(addr, mreq->isPrefetch());
+  }
+
 #if 1
   if (prefetch_megaratio < 1) {
     static int conta = 0;
@@ -387,6 +447,35 @@ CCache::Line *CCache::allocateLine(Addr_t addr, MemRequest *mreq) {
   return l;
 }
 
+void CCache::compactSet(Addr_t addr, MemRequest *mreq, Line *l) {
+  bool doStats = mreq->has_stats();
+
+  l->nSegments = compressor->calc_segments(addr);
+  if (l->nSegments < compressor->get_line_segments()) {
+    nCompressedFill.inc(doStats);
+  }
+  avgCompressRatio.sample(static_cast<double>(compressor->get_line_segments()) / l->nSegments, doStats);
+
+  // Evict until the set data fits. The tags alone may still have room. A
+  // line being filled is not valid yet, its segments are added here
+  const uint32_t fill = l->isValid() ? 0 : l->nSegments;
+  while (cacheBank->getSetSegments(addr) + fill > setSegments) {
+    Line *victimLine = cacheBank->findLine2Compact(addr, l);
+    I(victimLine);
+
+    Addr_t victimAddr = cacheBank->calcAddr4Tag(victimLine->getTag());
+    if (victimLine->isPrefetch() && !mreq->isPrefetch()) {
+      nPrefetchWasteful.inc(doStats);
+    }
+    displaceLine(victimAddr, mreq, victimLine);
+    victimLine->invalidate();
+    nCompactionEvict.inc(doStats);
+  }
+
+  double nLines = cacheBank->getSetValidLines(addr) + (fill ? 1 : 0);
+  avgEffectiveCapacity.sample(nLines * compressor->get_line_segments() / setSegments, doStats);
+}
+
 void CCache::mustForwardReqDown(MemRequest *mreq, bool miss) {
   if (!mreq->isPrefetch()) {
     s_reqMissLine[mreq->getAction()]->inc(miss && mreq->has_stats());
@@ -720,12 +809,26 @@ void CCache::doReq(MemRequest *mreq) {
 
       if (mreq->isPrefetch()) {
         dropPrefetch(mreq);
+      } else if (!mshr->canCoalesce(addr)) {
+        mshr->addOverflow(addr, mreq);
       } else {
+        if (prefetcher) {
+          prefetcher->access(addr, mreq->getPC(), false, false, mshr->getUsedEntries(), mreq->has_stats());
+        }
         mreq->setRetrying();
         mshr->addEntry(addr, &mreq->redoReqCB, mreq);
       }
       return;
     }
+    bool doStats = mreq->has_stats() && !mreq->isMSHRRetry();  // a woken overflow was already counted
+    if (!mshr->canAllocate(mreq->isPrefetch() ? Mshr_type::Prefetch : Mshr_type::Demand, doStats)) {
+      if (mreq->isPrefetch()) {
+        dropPrefetch(mreq);
+      } else {
+        mshr->addOverflow(addr, mreq);
+      }
+      return;
+    }
     mshr->blockEntry(addr, mreq);
   }
 
@@ -772,6 +875,11 @@ void CCache::doReq(MemRequest *mreq) {
     }
   }
 
+  if (prefetcher && !retrying && !mreq->isPrefetch()) {
+    bool prefetchHit = l && l->isPrefetch() && l->getSign() == PSIGN_CACHE;
+    prefetcher->access(addr, mreq->getPC(), l != 0, prefetchHit, mshr->getUsedEntries(), mreq->has_stats());
+  }
+
   if (l && mreq->isPrefetch() && mreq->isHomeNode()) {
     nPrefetchDropped.inc(mreq->has_stats());
     mreq->setDropped();  // useless prefetch, already a hit
@@ -790,6 +898,9 @@ void CCache::doReq(MemRequest *mreq) {
   if (l->isPrefetch() && !mreq->isPrefetch()) {
     nPrefetchUseful.inc(mreq->has_stats());
     I(!victim);  // Victim should not have prefetch lines
+    if (prefetcher && l->getSign() == PSIGN_CACHE) {
+      prefetcher->useful(mreq->has_stats());
+    }
   }
 
   if (l->isPrefetch() && mreq->isPrefetch()) {
@@ -828,7 +939,8 @@ void CCache::doReq(MemRequest *mreq) {
   GI(portid < 0, mreq->isTopCoherentNode());
   l->adjustState(mreq, portid);
 
-  Time_t when = port.reqDone(mreq, retrying);
+  Time_t when
+      = port.reqDone(mreq, retrying, cacheBank->getWay(l), compressor && l->nSegments < compressor->get_line_segments());
   if (when == 0) {
     // I(0);
     MTRACE("doReq restartReq");
@@ -914,6 +1026,9 @@ void CCache::doDisp(MemRequest *mreq) {
   if (l) {
     int16_t portid = router->getCreatorPort(mreq);
     l->adjustState(mreq, portid);
+    if (compressor && l->isValid() && mreq->getAction() == ma_setDirty) {
+      compactSet(addr, mreq, l);  // dirty data may compress differently
+    }
   }
   if (justDirectory) {  // Directory info kept, invalid line to trigger misses
     // router->sendDirtyDisp(addr, mreq->has_stats(), 1);
@@ -1235,6 +1350,13 @@ void CCache::tryPrefetch(Addr_t paddr, bool doStats, int degree, Addr_t pref_sig
     return;
   }
 
+  if (!mshr->canAllocate(Mshr_type::Prefetch, doStats)) {
+    if (cb) {
+      cb->destroy();
+    }
+    return;
+  }
+
   if (!allocateMiss) {
     Addr_t page_addr = (paddr >> 10) << 10;
     if (pref_sign != PSIGN_MEGA || page_addr != paddr) {
@@ -1255,6 +1377,9 @@ void CCache::tryPrefetch(Addr_t paddr, bool doStats, int degree, Addr_t pref_sig
     // I(pref_sign==PSIGN_STRIDE);
     // static_cast<IndirectAddressPredictor::performedCB *>(cb)->setParam1(this);
   }
+  if (prefetcher && pref_sign == PSIGN_CACHE) {
+    prefetcher->issued(paddr, doStats);
+  }
   MemRequest *preq = MemRequest::createReqReadPrefetch(this, doStats, paddr, pref_sign, degree, pc, cb);
   preq->trySetTopCoherentNode(this);
   port.startPrefetch(preq);
@@ -1282,6 +1407,9 @@ TimeDelta_t CCache::ffread(Addr_t addr) {
 
   l = cacheBank->fillLine_replace(addr, addr_r, 0xbeefbeef);
   l->setExclusive();  // WARNING, can create random inconsistencies (no inv others)
+  if (compressor) {
+    l->nSegments = compressor->calc_segments(addr);  // no set compaction during warmup
+  }
 
   return router->ffread(addr) + 1;
 }
@@ -1293,6 +1421,9 @@ TimeDelta_t CCache::ffwrite(Addr_t addr) {
   if (l == 0) {
     l = cacheBank->fillLine_replace(addr, addr_r, 0xbeefbeef);
   }
+  if (compressor) {
+    l->nSegments = compressor->calc_segments(addr);  // no set compaction during warmup
+  }
   if (router->isTopLevel()) {
     l->setModified();  // WARNING, can create random inconsistencies (no inv others)
   } else {
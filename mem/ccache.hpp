@@ -4,7 +4,9 @@
 
 #include <vector>
 
+#include "cache_compressor.hpp"
 #include "cache_port.hpp"
+#include "cache_prefetcher.hpp"
 #include "cachecore.hpp"
 #include "estl.hpp"
 #include "gprocessor.hpp"
@@ -167,6 +169,11 @@ protected:
   bool allocateMiss;
   bool justDirectory;
 
+  std::unique_ptr<Cache_compressor> compressor;  // nullptr if not a compressed cache
+  uint32_t                          setSegments;  // data segments per set
+
+  std::unique_ptr<Cache_prefetcher> prefetcher;  // nullptr if no prefetch_engine
+
   // BEGIN Statistics
   Stats_cntr nTryPrefetch;
   Stats_cntr nSendPrefetch;
@@ -203,6 +210,11 @@ protected:
   Stats_cntr nPrefetchHitBusy;
   Stats_cntr nPrefetchDropped;
 
+  Stats_cntr nCompressedFill;
+  Stats_cntr nCompactionEvict;
+  Stats_avg  avgCompressRatio;
+  Stats_avg  avgEffectiveCapacity;
+
   Stats_cntr *s_reqHit[ma_MAX];
   Stats_cntr *s_reqMissLine[ma_MAX];
   Stats_cntr *s_reqMissState[ma_MAX];
@@ -219,6 +231,7 @@ protected:
   // END Statistics
   void  displaceLine(Addr_t addr, MemRequest *mreq, Line *l);
   Line *allocateLine(Addr_t addr, MemRequest *mreq);
+  void  compactSet(Addr_t addr, MemRequest *mreq, Line *l);
   void  mustForwardReqDown(MemRequest *mreq, bool miss);
 
   bool notifyLowerLevels(Line *l, MemRequest *mreq);
@@ -235,7 +248,10 @@ public:
   CCache(Memory_system *gms, const std::string &descr_section, const std::string &name);
   virtual ~CCache();
 
-  int32_t getLineSize() const { return lineSize; }
+  int32_t           getLineSize() const { return lineSize; }
+  uint32_t          getSetSegments() const { return setSegments; }  // 0 without compression
+  const MSHR       *getMSHR() const { return mshr; }
+  const Cache_port &getPort() const { return port; }
 
   // Entry points to schedule that may schedule a do?? if needed
   void req(MemRequest *req);
@@ -16,22 +16,59 @@ MSHR::MSHR(const std::string &n, int32_t size, int16_t lineSize, int16_t nsub)
     , avgUse(fmt::format("{}_MSHR_avgUse", n))
     , avgSubUse(fmt::format("{}_MSHR_avgSubUse", n))
     , nStallConflict(fmt::format("{}_MSHR:nStallConflict", name))
+    , nStallFull(fmt::format("{}_MSHR:nStallFull", name))
+    , nStallSubEntries(fmt::format("{}_MSHR:nStallSubEntries", name))
+    , nPrefetchDenied(fmt::format("{}_MSHR:nPrefetchDenied", name))
+    , occupancy(fmt::format("{}_MSHR_occupancy", name))
     , MSHRSize(roundUpPower2(size) * 4)
     , MSHRMask(MSHRSize - 1) {
   I(size > 0 && size < 1024 * 32 * 32);
 
   nFreeEntries = size;
 
+  capacity      = size;
+  demandReserve = 0;
+  prefetchMax   = size;
+
+  subEntriesMax[static_cast<int>(Mshr_type::Demand)]   = nsub;
+  subEntriesMax[static_cast<int>(Mshr_type::Prefetch)] = nsub;
+
+  nPrimary[static_cast<int>(Mshr_type::Demand)]   = 0;
+  nPrimary[static_cast<int>(Mshr_type::Prefetch)] = 0;
+  lastOccupancyChange                             = 0;
+
   I(lineSize >= 0 && Log2LineSize < (8 * sizeof(Addr_t) - 1));
 
   entry.resize(MSHRSize);
 
   for (int32_t i = 0; i < MSHRSize; i++) {
     entry[i].nUse = 0;
+    entry[i].type = Mshr_type::Demand;
     I(entry[i].cc.empty());
   }
 }
 
+Mshr_type MSHR::typeOf(const MemRequest *mreq) { return mreq->isPrefetch() ? Mshr_type::Prefetch : Mshr_type::Demand; }
+
+void MSHR::setPartition(int32_t _capacity, int32_t _demandReserve, int32_t _prefetchMax) {
+  I(_capacity > 0 && _capacity <= nEntries);
+  I(_demandReserve < _capacity);
+
+  capacity      = _capacity;
+  demandReserve = _demandReserve;
+  prefetchMax   = _prefetchMax;
+}
+
+void MSHR::setSubEntries(Mshr_type type, int32_t n) {
+  I(n >= 0);
+  subEntriesMax[static_cast<int>(type)] = n;
+}
+
+void MSHR::sampleOccupancy(bool doStats) {
+  occupancy.sample(doStats, nPrimary[0] + nPrimary[1], globalClock - lastOccupancyChange);
+  lastOccupancyChange = globalClock;
+}
+
 bool MSHR::canAccept(Addr_t addr) const {
   if (nFreeEntries <= 0) {
     return false;
@@ -56,6 +93,44 @@ bool MSHR::canIssue(Addr_t addr) const {
   return true;
 }
 
+bool MSHR::canAllocate(Mshr_type type, bool doStats) {
+  int32_t used = nPrimary[0] + nPrimary[1];
+
+  if (type == Mshr_type::Demand) {
+    if (used < capacity) {
+      return true;
+    }
+    nStallFull.inc(doStats);
+    return false;
+  }
+
+  if (used < capacity - demandReserve && nPrimary[static_cast<int>(Mshr_type::Prefetch)] < prefetchMax) {
+    return true;
+  }
+  nPrefetchDenied.inc(doStats);
+  return false;
+}
+
+bool MSHR::canCoalesce(Addr_t addr) const {
+  const auto &e = entry[calcEntry(addr)];
+  I(e.nUse);
+
+  return (e.nUse - 1) < subEntriesMax[static_cast<int>(e.type)];
+}
+
+void MSHR::addOverflow(Addr_t addr, MemRequest *mreq) {
+  I(!mreq->isPrefetch());
+  I(!mreq->isRetrying());
+
+  // A full partition was already counted by canAllocate, and a woken request
+  // was counted when it first overflowed
+  if (!canIssue(addr) && !mreq->isMSHRRetry()) {
+    nStallSubEntries.inc(mreq->has_stats());
+  }
+
+  overflow.push_back(mreq);
+}
+
 void MSHR::addEntry(Addr_t addr, CallbackBase *c, MemRequest *mreq) {
   I(mreq->isRetrying());
   I(nFreeEntries <= nEntries);
@@ -94,6 +169,10 @@ void MSHR::blockEntry(Addr_t addr, MemRequest *mreq) {
 
   I(entry[pos].nUse == 0);
   entry[pos].nUse++;
+  entry[pos].type = typeOf(mreq);
+
+  sampleOccupancy(mreq->has_stats());
+  nPrimary[static_cast<int>(entry[pos].type)]++;
   avgSubUse.sample(entry[pos].nUse, mreq->has_stats());
 
 #ifndef NDEBUG
@@ -135,6 +214,20 @@ bool MSHR::retire(Addr_t addr, MemRequest *mreq) {
 
   GI(entry[pos].nUse == 0, entry[pos].cc.empty());
 
+  // Only a freed primary entry can take an overflow request (a freed
+  // sub-entry is handed to the next coalesced request below)
+  if (entry[pos].nUse == 0) {
+    sampleOccupancy(mreq->has_stats());
+    nPrimary[static_cast<int>(entry[pos].type)]--;
+
+    if (!overflow.empty()) {
+      MemRequest *oreq = overflow.front();
+      overflow.pop_front();
+      oreq->setMSHRRetry();
+      oreq->redoReqCB.schedule(1);  // retries the whole doReq, it may overflow again
+    }
+  }
+
   if (!entry[pos].cc.empty()) {
     entry[pos].cc.callNext();
     return true;
@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include <deque>
 #include <queue>
 
 #include "callback.hpp"
@@ -14,6 +15,10 @@
 
 class MemRequest;
 
+// Prefetches never coalesce (they are dropped if the line is pending), so the
+// type of an entry is the type of its primary request.
+enum class Mshr_type { Demand, Prefetch };
+
 class MSHR {
 private:
 protected:
@@ -30,6 +35,26 @@ protected:
   Addr_t calcLineAddr(Addr_t addr) const { return addr >> Log2LineSize; }
 
   Stats_cntr nStallConflict;
+  Stats_cntr nStallFull;        // demand waiting for a free entry
+  Stats_cntr nStallSubEntries;  // demand waiting for a free sub-entry
+  Stats_cntr nPrefetchDenied;   // prefetch over the partition
+
+  Stats_hist occupancy;  // cycles spent with N entries in use
+
+  // Partitions. Defaults keep the unbounded behavior, and the per-type
+  // coalescing limits default to nSubEntries.
+  int32_t capacity;
+  int32_t demandReserve;  // entries that prefetches can not use
+  int32_t prefetchMax;
+  int32_t subEntriesMax[2];
+
+  int32_t nPrimary[2];
+  Time_t  lastOccupancyChange;
+
+  std::deque<MemRequest *> overflow;  // demands waiting for an entry or sub-entry
+
+  static Mshr_type typeOf(const MemRequest *mreq);
+  void             sampleOccupancy(bool doStats);  // call before nPrimary changes
 
   const int32_t MSHRSize;
   const int32_t MSHRMask;
@@ -49,6 +74,7 @@ protected:
   public:
     CallbackContainer cc;
     int32_t           nUse;
+    Mshr_type         type;
 #ifndef NDEBUG
     std::deque<MemRequest *> pending_mreq;
     MemRequest              *block_mreq;
@@ -60,10 +86,24 @@ protected:
 public:
   MSHR(const std::string &name, int32_t size, int16_t lineSize, int16_t nSubEntries);
   virtual ~MSHR() {}
-  bool hasFreeEntries() const { return (nFreeEntries > 0); }
+  bool    hasFreeEntries() const { return (nFreeEntries > 0); }
+  int32_t getUsedEntries() const { return nEntries - nFreeEntries; }
+  int32_t getPrimary(Mshr_type type) const { return nPrimary[static_cast<int>(type)]; }
+  size_t  getOverflowSize() const { return overflow.size(); }
+  double  getnStallFull() const { return nStallFull.get(); }
+  double  getnStallSubEntries() const { return nStallSubEntries.get(); }
+
+  void setPartition(int32_t capacity, int32_t demandReserve, int32_t prefetchMax);
+  void setSubEntries(Mshr_type type, int32_t n);
 
   bool canAccept(Addr_t paddr) const;
   bool canIssue(Addr_t addr) const;
+  // Called when canIssue: false (and counted) if the partition of the type is full
+  bool canAllocate(Mshr_type type, bool doStats);
+  // Called when !canIssue: false if the pending entry has no free sub-entry for a demand
+  bool canCoalesce(Addr_t addr) const;
+  // Demand retried (not coalesced) when an entry retires
+  void addOverflow(Addr_t addr, MemRequest *mreq);
   void addEntry(Addr_t addr, CallbackBase *c, MemRequest *mreq);
   void blockEntry(Addr_t addr, MemRequest *mreq);
   bool retire(Addr_t addr, MemRequest *mreq);
@@ -1,6 +1,19 @@
 // This file is distributed under the BSD 3-Clause License. See LICENSE for details.
 
+#include "mshr.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <vector>
+
+#include "callback.hpp"
+#include "ccache.hpp"
 #include "config.hpp"
+#include "dinst.hpp"
+#include "memobj.hpp"
+#include "memory_system.hpp"
+#include "memrequest.hpp"
+#include "report.hpp"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
@@ -14,3 +27,220 @@ protected:
 };
 
 TEST_F(MSHR_test, trivial) { EXPECT_EQ(true, true); }
+
+TEST_F(MSHR_test, partition) {
+  MSHR mshr("mshr_test", 64, 64, 8);
+
+  EXPECT_TRUE(mshr.canAllocate(Mshr_type::Demand, false));
+  EXPECT_TRUE(mshr.canAllocate(Mshr_type::Prefetch, false));
+
+  // One entry left for prefetches
+  mshr.setPartition(4, 3, 4);
+  EXPECT_TRUE(mshr.canAllocate(Mshr_type::Demand, false));
+  EXPECT_TRUE(mshr.canAllocate(Mshr_type::Prefetch, false));
+
+  // No prefetch entries
+  mshr.setPartition(4, 0, 0);
+  EXPECT_TRUE(mshr.canAllocate(Mshr_type::Demand, false));
+  EXPECT_FALSE(mshr.canAllocate(Mshr_type::Prefetch, false));
+}
+
+// Records the requests retried by the MSHR
+class MSHR_test_mem : public DummyMemObj {
+public:
+  std::vector<MemRequest *> redone;
+
+  MSHR_test_mem() : DummyMemObj("mshr_test_mem", "mshrTestMem") {}
+  void doReq(MemRequest *mreq) override { redone.push_back(mreq); }
+};
+
+TEST_F(MSHR_test, occupancy_overflow) {
+  std::ofstream file("mshr_test.toml");
+  file << "[mshr_test_mem]\n";
+  file << "type        = \"dummy\"\n";
+  file << "lower_level = \"\"\n";
+  file.close();
+  Config::init("mshr_test.toml");
+
+  MSHR_test_mem mem;
+  MSHR          mshr("mshr_occ", 8, 64, 2);
+  mshr.setPartition(4, 1, 2);  // 4 primaries, 1 reserved for demands, 2 prefetches at most
+
+  // Same path as CCache::doReq: true if the request got an entry
+  auto issue = [&](MemRequest *mreq) {
+    Addr_t addr = mreq->getAddr();
+    if (!mshr.canIssue(addr)) {
+      if (mreq->isPrefetch() || !mshr.canCoalesce(addr)) {
+        return false;
+      }
+      mreq->setRetrying();
+      mshr.addEntry(addr, &mreq->redoReqCB, mreq);
+      return true;
+    }
+    if (!mshr.canAllocate(mreq->isPrefetch() ? Mshr_type::Prefetch : Mshr_type::Demand, !mreq->isMSHRRetry())) {
+      if (!mreq->isPrefetch()) {
+        mshr.addOverflow(addr, mreq);
+      }
+      return false;
+    }
+    mshr.blockEntry(addr, mreq);
+    return true;
+  };
+  auto demand   = [&](Addr_t addr) { return MemRequest::createReqRead(&mem, true, addr, 0x400); };
+  auto prefetch = [&](Addr_t addr) { return MemRequest::createReqReadPrefetch(&mem, true, addr, 0, 1, 0x400); };
+
+  // Consecutive lines, so every request has its own MSHR slot
+  auto *p0 = prefetch(0x1040);
+  auto *p1 = prefetch(0x1080);
+  EXPECT_TRUE(issue(p0));
+  EXPECT_TRUE(issue(p1));
+  EXPECT_FALSE(issue(prefetch(0x10c0)));  // over prefetchMax
+  EXPECT_EQ(mshr.getPrimary(Mshr_type::Prefetch), 2);
+
+  auto *d0 = demand(0x1100);
+  auto *d1 = demand(0x1140);
+  EXPECT_TRUE(issue(d0));
+  EXPECT_TRUE(issue(d1));
+  EXPECT_EQ(mshr.getPrimary(Mshr_type::Demand), 2);
+  EXPECT_EQ(mshr.getUsedEntries(), 4);
+
+  // Full: the demand waits in the overflow queue, counted once
+  auto *d2 = demand(0x1180);
+  EXPECT_FALSE(issue(d2));
+  EXPECT_EQ(mshr.getOverflowSize(), 1);
+  EXPECT_EQ(mshr.getnStallFull(), 1);
+
+  // A secondary miss coalesces in the pending entry
+  auto *d3 = demand(0x1108);
+  EXPECT_TRUE(issue(d3));
+  EXPECT_EQ(mshr.getPrimary(Mshr_type::Demand), 2);
+
+  // A freed primary wakes up the overflow, but a new demand takes the entry first
+  EXPECT_FALSE(mshr.retire(0x1040, p0));
+  EXPECT_EQ(mshr.getPrimary(Mshr_type::Prefetch), 1);
+  EXPECT_EQ(mshr.getOverflowSize(), 0);
+  auto *d4 = demand(0x11c0);
+  EXPECT_TRUE(issue(d4));
+  EventScheduler::advanceClock();
+  EventScheduler::advanceClock();
+  ASSERT_EQ(mem.redone.size(), 1);
+  EXPECT_EQ(mem.redone[0], d2);
+  EXPECT_TRUE(d2->isMSHRRetry());
+  EXPECT_FALSE(issue(d2));  // overflows again, not counted again
+  EXPECT_EQ(mshr.getOverflowSize(), 1);
+  EXPECT_EQ(mshr.getnStallFull(), 1);
+
+  // A freed sub-entry does not wake up the overflow, the coalesced demand is called next
+  EXPECT_TRUE(mshr.retire(0x1100, d0));
+  EXPECT_EQ(mshr.getOverflowSize(), 1);
+  EventScheduler::advanceClock();
+  EventScheduler::advanceClock();
+  ASSERT_EQ(mem.redone.size(), 2);
+  EXPECT_EQ(mem.redone[1], d3);
+
+  // The last sub-entry frees the primary, and the overflow gets it
+  EXPECT_FALSE(mshr.retire(0x1108, d3));
+  EXPECT_EQ(mshr.getOverflowSize(), 0);
+  EventScheduler::advanceClock();
+  EventScheduler::advanceClock();
+  ASSERT_EQ(mem.redone.size(), 3);
+  EXPECT_EQ(mem.redone[2], d2);
+  EXPECT_TRUE(issue(d2));
+  EXPECT_EQ(mshr.getPrimary(Mshr_type::Demand), 3);
+
+  EXPECT_FALSE(mshr.retire(0x1080, p1));
+  EXPECT_FALSE(mshr.retire(0x1140, d1));
+  EXPECT_FALSE(mshr.retire(0x11c0, d4));
+  EXPECT_FALSE(mshr.retire(0x1180, d2));
+  EXPECT_EQ(mshr.getUsedEntries(), 0);
+  EXPECT_EQ(mshr.getnStallFull(), 1);
+}
+
+static int rd_pending = 0;
+
+static void rdDone(Dinst *dinst) {
+  rd_pending--;
+  dinst->scrap();
+}
+
+typedef CallbackFunction1<Dinst *, &rdDone> rdDoneCB;
+
+TEST_F(MSHR_test, ccache_overflow) {
+  std::ofstream file("mshr_test.toml");
+  file << "[soc]\n"
+          "core = [\"c0\"]\n"
+          "[c0]\n"
+          "type   = \"ooo\"\n"
+          "caches = true\n"
+          "dl1    = \"dl1_cache DL1\"\n"
+          "il1    = \"dl1_cache IL1\"\n"
+          "[dl1_cache]\n"
+          "type          = \"cache\"\n"
+          "cold_misses   = true\n"
+          "size          = 32768\n"
+          "line_size     = 64\n"
+          "delay         = 5\n"
+          "miss_delay    = 2\n"
+          "assoc         = 4\n"
+          "repl_policy   = \"lru\"\n"
+          "port_occ      = 1\n"
+          "port_num      = 1\n"
+          "port_banks    = 32\n"
+          "send_port_occ = 1\n"
+          "send_port_num = 1\n"
+          "max_requests  = 32\n"
+          "mshr_size     = 2\n"
+          "allocate_miss = true\n"
+          "victim        = false\n"
+          "coherent      = true\n"
+          "inclusive     = true\n"
+          "directory     = false\n"
+          "nlp_distance  = 2\n"
+          "nlp_degree    = 0\n"
+          "nlp_stride    = 1\n"
+          "drop_prefetch = true\n"
+          "prefetch_degree = 0\n"
+          "mega_lines1K  = 8\n"
+          "lower_level   = \"mem mem shared\"\n"
+          "[mem]\n"
+          "type        = \"nice\"\n"
+          "line_size   = 64\n"
+          "delay       = 31\n"
+          "cold_misses = false\n"
+          "lower_level = \"\"\n";
+  file.close();
+
+  Report::init();
+  Config::init("mshr_test.toml");
+  auto *gms = new Memory_system(0);
+  Config::exit_on_error();
+  EventScheduler::advanceClock();
+
+  auto *dl1 = static_cast<CCache *>(gms->getDL1());
+  ASSERT_EQ(dl1->get_type(), "cache");
+  const MSHR *mshr = dl1->getMSHR();
+
+  // Two reads per line to six lines in flight with two entries: the reads to
+  // the last four lines overflow, each one counted once however many times it
+  // is woken up (the second read of a line frees only a sub-entry)
+  const int nlines = 6;
+  for (int i = 0; i < 2 * nlines; ++i) {
+    Addr_t addr = 0x10000 + (i / 2) * 64 + (i % 2) * 8;
+    auto  *ld   = Dinst::create(Instruction(iLALU_LD, LREG_R1, LREG_R2, LREG_R3, LREG_InvalidOutput), 0x400, addr, 0, true);
+    MemRequest::sendReqRead(dl1, true, addr, ld->getPC(), rdDoneCB::create(ld));
+    rd_pending++;
+  }
+
+  int max_used = 0;
+  for (int n = 0; rd_pending && n < 10000; ++n) {
+    EventScheduler::advanceClock();
+    max_used = std::max(max_used, mshr->getPrimary(Mshr_type::Demand));
+  }
+
+  EXPECT_EQ(rd_pending, 0);
+  EXPECT_EQ(max_used, 2);
+  EXPECT_EQ(mshr->getnStallFull(), 2 * (nlines - 2));
+  EXPECT_EQ(mshr->getnStallSubEntries(), 0);
+  EXPECT_EQ(mshr->getOverflowSize(), 0);
+  EXPECT_EQ(mshr->getPrimary(Mshr_type::Demand), 0);
+}
@@ -11,6 +11,7 @@
 #include "dinst.hpp"
 #include "memobj.hpp"
 #include "memrequest.hpp"
+#include "tage_simd.hpp"
 
 BimodalStride::BimodalStride(int _size, size_t _width) : size(_size), max_conf(1 << _width) {
   I((size & (size - 1)) == 0);
@@ -152,14 +153,17 @@ Tage_address_predictor::Tage_address_predictor(Hartid_t hartid, const std::strin
     , tagePrefetchBaseNum(fmt::format("P({})_vtage_base", hartid))
     , tagePrefetchHistNum(fmt::format("P({})_vtage_hist", hartid))
     , log2fetchwidth(log2(Config::get_power2("soc", "core", hartid, "fetch_width")))
-    , nhist(Config::get_integer(section, "ntables", 2)) {
+    , nhist(Config::get_integer(section, "ntables", 2, 64)) {  // tag hits are a 64 bit mask
   // auto bwidth         = Config::get_integer(section, "bimodal_width", 1);
   m      = new int[nhist + 1];
   TB     = new int[nhist + 1];
   logg   = new int[nhist + 1];
-  GI     = new Addr_t[nhist + 1];
-  GTAG   = new Addr_t[nhist + 1];
-  gtable = new vtage_gentry *[nhist + 1];
+  GI        = new uint32_t[nhist + 1];
+  GTAG      = new uint32_t[nhist + 1];
+  tag_shift = new uint32_t[nhist + 1];
+  tag_mask  = new uint32_t[nhist + 1];
+  tag_read  = new uint32_t[nhist + 1];
+  gtable    = new vtage_gentry *[nhist + 1];
 
   // geometric history length calculation for tagged tables
   m[0]     = 0;
@@ -176,7 +180,12 @@ Tage_address_predictor::Tage_address_predictor(Hartid_t hartid, const std::strin
     logg[i] = VTAGE_LOGG;
     GI[i]   = 0;
     GTAG[i] = 0;
+
+    tag_shift[i] = logg[i] / 2;
+    tag_mask[i]  = (1 << TB[i]) - 1;
   }
+  logg[0] = VTAGE_LOGG;  // GI[0] (PC bits) feeds the tag of the first table
+  GI[0]   = 0;
 
   for (uint64_t i = 1; i <= nhist; i++) {
     gtable[i] = new vtage_gentry[(1 << (logg[i])) + 1];
@@ -286,16 +295,21 @@ void Tage_address_predictor::setVtageIndex(uint16_t offset) {
 
   GI[0] = (lastBoundaryPC >> 2) & ((1 << (logg[0])) - 1);
   for (uint64_t i = 1; i <= nhist; i++) {
-    GI[i]   = gindex(offset, i);
-    GTAG[i] = ((GI[i - 1] << (logg[i] / 2)) ^ GI[i - 1]) & ((1 << TB[i]) - 1);
+    GI[i] = gindex(offset, i);
   }
+  // GTAG[i] = ((GI[i - 1] << (logg[i] / 2)) ^ GI[i - 1]) & ((1 << TB[i]) - 1)
+  tage_tag_hash(&GI[0], &tag_shift[1], &tag_mask[1], &GTAG[1], nhist);
 }
 
 void Tage_address_predictor::fetchBoundaryLdOffset(Addr_t pc) {
   uint16_t loff = get_offset(pc);
 
   for (uint64_t i = 1; i <= nhist; i++) {
-    gtable[i][GI[i]].select(GTAG[i], loff);
+    tag_read[i] = gtable[i][GI[i]].tag;
+  }
+  uint64_t thit = tage_tag_match(&tag_read[1], &GTAG[1], nhist);
+  for (uint64_t i = 1; i <= nhist; i++) {
+    gtable[i][GI[i]].select_tag((thit >> (i - 1)) & 1, loff);
   }
 }
 
@@ -551,8 +565,10 @@ void vtage_gentry::allocate() {
   tag   = 0;
 }
 
-void vtage_gentry::select(Addr_t t, int b) {
-  if (t != tag) {
+void vtage_gentry::select(Addr_t t, int b) { select_tag(t == tag, b); }
+
+void vtage_gentry::select_tag(bool tag_hit, int b) {
+  if (!tag_hit) {
     hit  = false;
     thit = false;
     return;
@@ -16,6 +16,7 @@
 #include "config.hpp"
 #include "fmt/format.h"
 #include "imlibest.hpp"
+#include "ittage.hpp"
 #include "memobj.hpp"
 #include "report.hpp"
 
@@ -43,6 +44,25 @@ void BPred::fetchBoundaryBegin(Dinst *dinst) {
 
 void BPred::fetchBoundaryEnd() {}
 
+void BPred::save_history(std::vector<uint64_t> &ck) const {
+  auto *btb = const_cast<BPred *>(this)->history_btb();  // only returns a member
+  if (btb) {
+    btb->save_history(ck);
+  }
+}
+
+size_t BPred::restore_history(const std::vector<uint64_t> &ck, size_t pos) {
+  auto *btb = history_btb();
+  return btb ? btb->restore_history(ck, pos) : pos;
+}
+
+void BPred::speculate(Dinst *dinst, bool taken) {
+  auto *btb = history_btb();
+  if (btb) {
+    btb->speculate(dinst, taken);
+  }
+}
+
 /*****************************************
  * RAS
  */
@@ -61,7 +81,7 @@ BPRas::BPRas(int32_t i, const std::string &section, const std::string &sname)
 BPRas::~BPRas() {}
 
 void BPRas::tryPrefetch(MemObj *il1, bool doStats, int degree) {
-  if (rasPrefetch == 0) {
+  if (rasPrefetch == 0 || il1 == nullptr) {
     return;
   }
 
@@ -126,6 +146,33 @@ Outcome BPRas::predict(Dinst *dinst, bool doUpdate, bool doStats) {
   return Outcome::None;
 }
 
+void BPRas::save_history(std::vector<uint64_t> &ck) const {
+  if (RasSize == 0) {
+    return;
+  }
+
+  int32_t top = index == 0 ? RasSize - 1 : index - 1;
+  ck.push_back(index);
+  ck.push_back(stack[top]);
+}
+
+size_t BPRas::restore_history(const std::vector<uint64_t> &ck, size_t pos) {
+  if (RasSize == 0) {
+    return pos;
+  }
+
+  index       = ck[pos];
+  int32_t top = index == 0 ? RasSize - 1 : index - 1;
+  stack[top]  = ck[pos + 1];
+  return pos + 2;
+}
+
+void BPRas::speculate(Dinst *dinst, bool taken) {
+  (void)taken;  // calls and returns
+  // The RAS has no tables, predict only moves the stack
+  predict(dinst, true, false);
+}
+
 /*****************************************
  * BTB
  */
@@ -246,6 +293,25 @@ Outcome BPBTB::predict(Dinst *dinst, bool doUpdate, bool doStats) {
   return Outcome::NoBTB;
 }
 
+void BPBTB::save_history(std::vector<uint64_t> &ck) const {
+  if (dolc) {
+    dolc->save(ck);
+  }
+}
+
+size_t BPBTB::restore_history(const std::vector<uint64_t> &ck, size_t pos) {
+  if (dolc) {
+    pos = dolc->restore(ck, pos);
+  }
+  return pos;
+}
+
+void BPBTB::speculate(Dinst *dinst, bool taken) {
+  if (dolc && taken) {
+    dolc->update(dinst->getPC());
+  }
+}
+
 /*****************************************
  * BPOracle
  */
@@ -512,11 +578,34 @@ BPIMLI::BPIMLI(int32_t i, const std::string &section, const std::string &sname)
   int log2fetchwidth = log2(FetchWidth);
   int blogb          = log2(bimodalSize) - log2(FetchWidth);
 
-  int nhist = Config::get_integer(section, "nhist", 1);
+  Imli_geometry geo;
+  geo.nhist = Config::get_integer(section, "nhist", 1, 64);  // tag hits are a 64 bit mask
+  geo.sc    = Config::get_bool(section, "statcorrector");
 
-  bool statcorrector = Config::get_bool(section, "statcorrector");
+  // Optional geometry, the defaults are the 256Kbits budget
+  if (Config::has_entry(section, "tage_size")) {
+    geo.logg = log2(Config::get_power2(section, "tage_size", 16, 1 << 20));
+  }
+  if (Config::has_entry(section, "tage_tag_bits")) {
+    geo.tbits = Config::get_integer(section, "tage_tag_bits", 4, 28);
+  }
+  if (Config::has_entry(section, "min_history")) {
+    geo.minhist = Config::get_integer(section, "min_history", 1, HISTBUFFERLENGTH / 4);
+  }
+  if (Config::has_entry(section, "max_history")) {
+    geo.maxhist = Config::get_integer(section, "max_history", geo.minhist, HISTBUFFERLENGTH / 4);
+  }
+  auto get_option = [&section](const std::string &key, bool def) {
+    return Config::has_entry(section, key) ? Config::get_bool(section, key) : def;
+  };
+  geo.loop        = get_option("loop_predictor", geo.loop);
+  geo.local       = get_option("local_history", geo.local);
+  geo.imli        = get_option("imli", geo.imli);
+  geo.imli_sic    = get_option("imli_sic", geo.imli_sic);
+  geo.imli_oh     = get_option("imli_oh", geo.imli_oh);
+  geo.postpredict = get_option("post_predict", geo.postpredict);
 
-  imli = std::make_unique<IMLIBest>(log2fetchwidth, blogb, bwidth, nhist, statcorrector);
+  imli = IMLIBest::create(log2fetchwidth, blogb, bwidth, geo);
 }
 
 void BPIMLI::fetchBoundaryBegin(Dinst *dinst) {
@@ -575,6 +664,100 @@ Outcome BPIMLI::predict(Dinst *dinst, bool doUpdate, bool doStats) {
   return ptaken ? btb.predict(dinst, doUpdate, doStats) : Outcome::Correct;
 }
 
+void BPIMLI::save_history(std::vector<uint64_t> &ck) const {
+  btb.save_history(ck);
+  imli->save_history(ck);
+}
+
+size_t BPIMLI::restore_history(const std::vector<uint64_t> &ck, size_t pos) {
+  pos = btb.restore_history(ck, pos);
+  return imli->restore_history(ck, pos);
+}
+
+void BPIMLI::speculate(Dinst *dinst, bool taken) {
+  if (dinst->getInst()->isJump() || dinst->getInst()->isFuncRet()) {
+    imli->TrackOtherInst(dinst->getPC(), dinst->getInst()->getOpcode(), dinst->getAddr());
+  } else {
+    imli->speculate(dinst->getPC(), dinst->getInst()->getOpcode(), taken, dinst->getAddr());
+  }
+
+  if (taken) {
+    btb.speculate(dinst, taken);
+  }
+}
+
+/*****************************************
+ * BPITTAGE: indirect target predictor
+ */
+
+BPITTAGE::BPITTAGE(int32_t i, const std::string &section, const std::string &sname)
+    : BPred(i, section, sname, "ittage")
+    , nIndirectHit(fmt::format("P({})_BPred{}_ittage:nIndirectHit", i, sname))
+    , nIndirectMiss(fmt::format("P({})_BPred{}_ittage:nIndirectMiss", i, sname)) {
+  Ittage_geometry geo;
+
+  // All optional, the defaults are a 64Kbits class predictor
+  if (Config::has_entry(section, "nhist")) {
+    geo.nhist = Config::get_integer(section, "nhist", 1, 64);
+  }
+  if (Config::has_entry(section, "tage_size")) {
+    geo.logg = log2(Config::get_power2(section, "tage_size", 16, 1 << 20));
+  }
+  if (Config::has_entry(section, "tage_tag_bits")) {
+    geo.tbits = Config::get_integer(section, "tage_tag_bits", 4, 28);
+  }
+  if (Config::has_entry(section, "min_history")) {
+    geo.minhist = Config::get_integer(section, "min_history", 1, HISTBUFFERLENGTH / 4);
+  }
+  if (Config::has_entry(section, "max_history")) {
+    geo.maxhist = Config::get_integer(section, "max_history", geo.minhist, HISTBUFFERLENGTH / 4);
+  }
+  if (Config::has_entry(section, "target_btb_size")) {
+    geo.log_btb = log2(Config::get_power2(section, "target_btb_size", 1, 1 << 20));
+  }
+  if (Config::has_entry(section, "target_btb_targets")) {
+    geo.btb_targets = Config::get_integer(section, "target_btb_targets", 1, 16);
+  }
+
+  ittage = std::make_unique<Ittage_predictor>(geo);
+}
+
+BPITTAGE::~BPITTAGE() {}
+
+Outcome BPITTAGE::predict(Dinst *dinst, bool doUpdate, bool doStats) {
+  const Instruction *inst = dinst->getInst();
+  Addr_t             pc   = dinst->getPC();
+
+  if (!inst->isIndirect()) {
+    if (doUpdate) {
+      ittage->track(pc, inst->isBranch(), dinst->isTaken());
+    }
+    return Outcome::None;
+  }
+
+  Addr_t target = ittage->predict(pc);
+  bool   hit    = target == dinst->getAddr();
+
+  nIndirectHit.inc(hit && doUpdate && doStats && dinst->has_stats());
+  nIndirectMiss.inc(!hit && doUpdate && doStats && dinst->has_stats());
+
+  if (doUpdate) {
+    ittage->update(pc, dinst->getAddr());
+    ittage->track(pc, false, true);
+  }
+
+  return hit ? Outcome::Correct : Outcome::Miss;
+}
+
+void BPITTAGE::save_history(std::vector<uint64_t> &ck) const { ittage->save_history(ck); }
+
+size_t BPITTAGE::restore_history(const std::vector<uint64_t> &ck, size_t pos) { return ittage->restore_history(ck, pos); }
+
+void BPITTAGE::speculate(Dinst *dinst, bool taken) {
+  const Instruction *inst = dinst->getInst();
+  ittage->track(dinst->getPC(), inst->isBranch(), inst->isIndirect() || taken);
+}
+
 /*****************************************
  * BP2level
  */
@@ -653,6 +836,35 @@ Outcome BP2level::predict(Dinst *dinst, bool doUpdate, bool doStats) {
   return ptaken ? btb.predict(dinst, doUpdate, doStats) : Outcome::Correct;
 }
 
+void BP2level::save_history(std::vector<uint64_t> &ck) const {
+  btb.save_history(ck);
+  if (useDolc) {
+    dolc.save(ck);
+  }
+}
+
+size_t BP2level::restore_history(const std::vector<uint64_t> &ck, size_t pos) {
+  pos = btb.restore_history(ck, pos);
+  if (useDolc) {
+    pos = dolc.restore(ck, pos);
+  }
+  return pos;
+}
+
+void BP2level::speculate(Dinst *dinst, bool taken) {
+  // The per branch history table is not repaired, only the path history moves
+  if (useDolc) {
+    dolc.update(dinst->getPC());
+    if (taken && !dinst->getInst()->isJump()) {
+      dolc.update(dinst->getAddr());
+    }
+  }
+
+  if (taken) {
+    btb.speculate(dinst, taken);
+  }
+}
+
 /*****************************************
  * BPHybid
  */
@@ -723,6 +935,28 @@ Outcome BPHybrid::predict(Dinst *dinst, bool doUpdate, bool doStats) {
   return ptaken ? btb.predict(dinst, doUpdate, doStats) : Outcome::Correct;
 }
 
+void BPHybrid::save_history(std::vector<uint64_t> &ck) const {
+  btb.save_history(ck);
+  ck.push_back(ghr);
+}
+
+size_t BPHybrid::restore_history(const std::vector<uint64_t> &ck, size_t pos) {
+  pos = btb.restore_history(ck, pos);
+  ghr = ck[pos];
+  return pos + 1;
+}
+
+void BPHybrid::speculate(Dinst *dinst, bool taken) {
+  if (!dinst->getInst()->isJump()) {
+    HistoryType iID = calcHist(dinst->getPC());
+    ghr             = ((ghr << 1) | ((iID >> 2 & 1) ^ (taken ? 1 : 0))) & historyMask;
+  }
+
+  if (taken) {
+    btb.speculate(dinst, taken);
+  }
+}
+
 /*****************************************
  * 2BcgSkew
  *
@@ -831,6 +1065,28 @@ Outcome BP2BcgSkew::predict(Dinst *dinst, bool doUpdate, bool doStats) {
   return ptaken ? btb.predict(dinst, doUpdate, doStats) : Outcome::Correct;
 }
 
+void BP2BcgSkew::save_history(std::vector<uint64_t> &ck) const {
+  btb.save_history(ck);
+  ck.push_back(history);
+}
+
+size_t BP2BcgSkew::restore_history(const std::vector<uint64_t> &ck, size_t pos) {
+  pos = btb.restore_history(ck, pos);
+  history = ck[pos];
+  return pos + 1;
+}
+
+void BP2BcgSkew::speculate(Dinst *dinst, bool taken) {
+  if (!dinst->getInst()->isJump()) {
+    HistoryType iID = calcHist(dinst->getPC());
+    history         = history << 1 | ((iID >> 2 & 1) ^ (taken ? 1 : 0));
+  }
+
+  if (taken) {
+    btb.speculate(dinst, taken);
+  }
+}
+
 /*****************************************
  * YAGS
  *
@@ -952,6 +1208,28 @@ Outcome BPyags::predict(Dinst *dinst, bool doUpdate, bool doStats) {
   return ptaken ? btb.predict(dinst, doUpdate, doStats) : Outcome::Correct;
 }
 
+void BPyags::save_history(std::vector<uint64_t> &ck) const {
+  btb.save_history(ck);
+  ck.push_back(ghr);
+}
+
+size_t BPyags::restore_history(const std::vector<uint64_t> &ck, size_t pos) {
+  pos = btb.restore_history(ck, pos);
+  ghr = ck[pos];
+  return pos + 1;
+}
+
+void BPyags::speculate(Dinst *dinst, bool taken) {
+  if (!dinst->getInst()->isJump()) {
+    HistoryType iID = calcHist(dinst->getPC());
+    ghr             = ((ghr << 1) | ((iID >> 2 & 1) ^ (taken ? 1 : 0))) & historyMask;
+  }
+
+  if (taken) {
+    btb.speculate(dinst, taken);
+  }
+}
+
 /*****************************************
  * BPOgehl
  *
@@ -1138,6 +1416,35 @@ Outcome BPOgehl::predict(Dinst *dinst, bool doUpdate, bool doStats) {
   return ptaken ? btb.predict(dinst, doUpdate, doStats) : Outcome::Correct;
 }
 
+void BPOgehl::save_history(std::vector<uint64_t> &ck) const {
+  btb.save_history(ck);
+  ck.insert(ck.end(), ghist, ghist + (max_history_size >> 6) + 1);
+}
+
+size_t BPOgehl::restore_history(const std::vector<uint64_t> &ck, size_t pos) {
+  pos = btb.restore_history(ck, pos);
+  for (int32_t i = 0; i <= (max_history_size >> 6); i++) {
+    ghist[i] = ck[pos++];
+  }
+  return pos;
+}
+
+void BPOgehl::speculate(Dinst *dinst, bool taken) {
+  if (!dinst->getInst()->isJump()) {
+    for (int32_t i = max_history_size >> 6; i > 0; i--) {
+      ghist[i] = (ghist[i] << 1) + (ghist[i - 1] < 0);
+    }
+    ghist[0] = ghist[0] << 1;
+    if (taken) {
+      ghist[0] = 1;
+    }
+  }
+
+  if (taken) {
+    btb.speculate(dinst, taken);
+  }
+}
+
 int32_t BPOgehl::geoidx(uint64_t Add, int64_t *histo, int32_t m, int32_t funct) {
   uint64_t inter, Hh, Res;
   int32_t  x, i, shift;
@@ -1311,6 +1618,8 @@ std::unique_ptr<BPred> BPredictor::getBPred(int32_t id, const std::string &sec,
     pred = std::make_unique<BPyags>(id, sec, sname);
   } else if (type == "imli") {
     pred = std::make_unique<BPIMLI>(id, sec, sname);
+  } else if (type == "ittage") {
+    pred = std::make_unique<BPITTAGE>(id, sec, sname);
   } else if (type == "tdata") {
     pred = std::make_unique<BPTData>(id, sec, sname);
   } else if (type == "ldbp") {
@@ -1346,7 +1655,14 @@ BPredictor::BPredictor(int32_t i, MemObj *iobj, MemObj *dobj, std::shared_ptr<BP
     , nFixes2(fmt::format("P({})_BPred:nFixes2", id))
     , nFixes3(fmt::format("P({})_BPred:nFixes3", id))
     , nUnFixes(fmt::format("P({})_BPred:nUnFixes", id))
-    , nAgree3(fmt::format("P({})_BPred:nAgree3", id)) {
+    , nAgree3(fmt::format("P({})_BPred:nAgree3", id))
+    , nIndirect(fmt::format("P({})_BPred:nIndirect", id))
+    , nIndirectMiss(fmt::format("P({})_BPred:nIndirectMiss", id))
+    , max_ckpts(Config::has_entry("soc", "core", id, "bpred_checkpoints")
+                    ? Config::get_integer("soc", "core", id, "bpred_checkpoints", 0, 1024)
+                    : 0)
+    , nHistRestore(fmt::format("P({})_BPred:nHistRestore", id))
+    , nHistNoCkpt(fmt::format("P({})_BPred:nHistNoCkpt", id)) {
   auto cpu_section = Config::get_string("soc", "core", id);
   auto ras_section = Config::get_array_string(cpu_section, "bpred", 0);
   ras              = std::make_unique<BPRas>(id, ras_section, "");
@@ -1356,11 +1672,16 @@ BPredictor::BPredictor(int32_t i, MemObj *iobj, MemObj *dobj, std::shared_ptr<BP
     pred1      = bpred->pred1;
     pred2      = bpred->pred2;
     pred3      = bpred->pred3;
+    btb2       = bpred->btb2;
     return;
   }
 
   FetchWidth = Config::get_integer(cpu_section, "fetch_width");
 
+  if (Config::has_entry(cpu_section, "btb_l2")) {
+    btb2 = std::make_shared<Btb_l2>(id, Config::get_string(cpu_section, "btb_l2"));
+  }
+
   pred1 = nullptr;
   pred2 = nullptr;
   pred3 = nullptr;
@@ -1398,6 +1719,10 @@ BPredictor::BPredictor(int32_t i, MemObj *iobj, MemObj *dobj, std::shared_ptr<BP
     Config::add_error("branch predictor should have a delay > 0");
     return;
   }
+  if (dynamic_cast<BPITTAGE *>(pred1.get())) {
+    Config::add_error("ittage only predicts indirect targets, it can not be the first bpred level");
+    return;
+  }
   if (bpredDelay2 == 0) {
     bpredDelay2 = bpredDelay1 + 1;
   }
@@ -1519,6 +1844,20 @@ TimeDelta_t BPredictor::predict(Dinst *dinst, bool *fastfix) {
       outcome3 = predict3(dinst);
     }
   }
+  checkpoint(dinst->getID());
+
+  // A pred1 BTB miss on a taken branch can be covered by the L2 BTB (and
+  // its prefetch buffer) at btb2_delay extra cycles
+  TimeDelta_t btb2_delay = 0;
+  if (btb2 && dinst->isTaken()) {
+    if (outcome1 == Outcome::NoBTB && btb2->predict(dinst->getPC(), dinst->getAddr(), dinst->has_stats(), btb2_delay)) {
+      outcome1 = Outcome::Correct;
+    }
+    btb2->update(dinst->getPC(), dinst->getAddr(), dinst->has_stats());
+  }
+
+  bool indirect = dinst->getInst()->isIndirect() && dinst->has_stats();
+  nIndirect.inc(indirect);
 
   if (dinst->getInst()->isFuncRet() || dinst->getInst()->isFuncCall()) {
     dinst->setBiasBranch(true);
@@ -1571,7 +1910,7 @@ TimeDelta_t BPredictor::predict(Dinst *dinst, bool *fastfix) {
       }
 #endif
 
-      return bpredDelay1;
+      return bpredDelay1 + btb2_delay;
     }
     return 0;
   }
@@ -1589,7 +1928,7 @@ TimeDelta_t BPredictor::predict(Dinst *dinst, bool *fastfix) {
   // outcome == (Outcome::Correct, Outcome::Miss, Outcome::None, Outcome::NoBTB)
   if (outcome1 == Outcome::Correct && outcome2 != Outcome::Miss && outcome3 != Outcome::Miss) {
     nFixes1.inc(dinst->has_stats());
-    bpred_total_delay = bpredDelay1;
+    bpred_total_delay = bpredDelay1 + btb2_delay;
   } else if (outcome1 != Outcome::Correct && outcome2 == Outcome::Correct && outcome3 != Outcome::Miss) {
     nFixes2.inc(dinst->has_stats());
     bpred_total_delay = bpredDelay2;
@@ -1598,6 +1937,7 @@ TimeDelta_t BPredictor::predict(Dinst *dinst, bool *fastfix) {
     bpred_total_delay = bpredDelay3;
   } else {
     nUnFixes.inc(dinst->has_stats());
+    nIndirectMiss.inc(indirect);
     *fastfix          = false;
     bpred_total_delay = 1;  // Anything but zero
   }
@@ -1605,6 +1945,85 @@ TimeDelta_t BPredictor::predict(Dinst *dinst, bool *fastfix) {
   return bpred_total_delay;
 }
 
+void BPredictor::checkpoint(uint64_t inst_id) {
+  if (max_ckpts == 0) {
+    return;
+  }
+  I(ckpts.empty() || ckpts.back().id < inst_id);
+
+  if (ckpts.size() >= max_ckpts) {
+    spare_states.emplace_back(std::move(ckpts.front().state));
+    ckpts.pop_front();
+  }
+
+  std::vector<uint64_t> state;
+  if (!spare_states.empty()) {
+    state = std::move(spare_states.back());
+    spare_states.pop_back();
+  }
+  state.clear();
+  save_history(state);
+
+  ckpts.push_back({inst_id, std::move(state)});
+}
+
+void BPredictor::save_history(std::vector<uint64_t> &state) const {
+  ras->save_history(state);
+  pred1->save_history(state);
+  if (pred2) {
+    pred2->save_history(state);
+  }
+  if (pred3) {
+    pred3->save_history(state);
+  }
+}
+
+void BPredictor::speculate(Dinst *dinst, bool taken) {
+  I(dinst->getInst()->isControl());
+
+  ras->speculate(dinst, taken);
+  if (dinst->getInst()->isFuncRet()) {
+    return;  // predicted by the RAS alone
+  }
+
+  pred1->speculate(dinst, taken);
+  if (pred2) {
+    pred2->speculate(dinst, taken);
+  }
+  if (pred3) {
+    pred3->speculate(dinst, taken);
+  }
+}
+
+void BPredictor::restore(uint64_t inst_id, bool doStats) {
+  if (max_ckpts == 0) {
+    return;
+  }
+
+  auto it = std::find_if(ckpts.begin(), ckpts.end(), [inst_id](const History_ckpt &c) { return c.id == inst_id; });
+  if (it == ckpts.end()) {
+    nHistNoCkpt.inc(doStats);
+    return;
+  }
+  nHistRestore.inc(doStats);
+
+  const auto &state = it->state;
+  size_t      pos   = ras->restore_history(state, 0);
+  pos               = pred1->restore_history(state, pos);
+  if (pred2) {
+    pos = pred2->restore_history(state, pos);
+  }
+  if (pred3) {
+    pos = pred3->restore_history(state, pos);
+  }
+  I(pos == state.size());
+
+  for (auto i = it; i != ckpts.end(); ++i) {
+    spare_states.emplace_back(std::move(i->state));
+  }
+  ckpts.erase(it, ckpts.end());
+}
+
 void BPredictor::dump(const std::string &str) const {
   (void)str;
   // nothing?
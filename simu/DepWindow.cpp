@@ -10,7 +10,11 @@
 #include "tracer.hpp"
 
 DepWindow::DepWindow(uint32_t cpuid, int src_id, const std::string &clusterName, uint32_t pos)
-    : src_cluster_id(src_id), inter_cluster_fwd(fmt::format("P({})_{}{}_inter_cluster_fwd", cpuid, clusterName, pos)) {
+    : src_cluster_id(src_id)
+    , inter_cluster_fwd(fmt::format("P({})_{}{}_inter_cluster_fwd", cpuid, clusterName, pos))
+    , wheel_overflow(fmt::format("P({})_{}{}_sched_wheel_overflow", cpuid, clusterName, pos))
+    , matrix_full(fmt::format("P({})_{}{}_sched_matrix_full", cpuid, clusterName, pos))
+    , tickCB(this) {
   auto cadena    = fmt::format("P(P{}_{}{}_sched", cpuid, clusterName, pos);
   auto sched_num = Config::get_integer(clusterName, "sched_num");
   auto sched_occ = Config::get_integer(clusterName, "sched_occ");
@@ -18,6 +22,14 @@ DepWindow::DepWindow(uint32_t cpuid, int src_id, const std::string &clusterName,
 
   sched_lat         = Config::get_integer(clusterName, "sched_lat", 0, 32);
   inter_cluster_lat = Config::get_integer("soc", "core", cpuid, "inter_cluster_lat");
+
+  sched_width  = sched_num;
+  tick_pending = false;
+  if (Config::has_entry(clusterName, "sched_matrix") && Config::get_bool(clusterName, "sched_matrix")) {
+    auto win_size = Config::get_integer(clusterName, "win_size", 1, 512);
+    matrix        = std::make_unique<Sched_matrix>(win_size);
+    wheel         = std::make_unique<Sched_wheel>(WHEEL_DEPTH);
+  }
 }
 
 DepWindow::~DepWindow() {}
@@ -48,16 +60,88 @@ void DepWindow::preSelect(Dinst *dinst) {
 }
 
 void DepWindow::select(Dinst *dinst) {
+  if (matrix) {
+    I(src_cluster_id == dinst->getCluster()->get_id());
+    if (!matrix_wait.empty() || !matrix->insert(dinst)) {
+      matrix_full.inc(dinst->has_stats());
+      matrix_wait.push_back(dinst);
+    }
+    wake_tick();
+    return;
+  }
+
   Time_t schedTime = schedPort->nextSlot(dinst->has_stats());
   if (dinst->hasInterCluster()) {
     schedTime += inter_cluster_lat;
   } else {
     schedTime += sched_lat;
   }
+  schedTime += dinst->getGProc()->reg_read_delay(dinst, schedTime);
 
   I(src_cluster_id == dinst->getCluster()->get_id());
 
-  Resource::executingCB::scheduleAbs(schedTime, dinst->getClusterResource().get(), dinst);  // NASTY to avoid callback ptr
+  Resource::executingCB::scheduleAbs(schedTime, dinst->getClusterResource(), dinst);
+}
+
+void DepWindow::schedule_executed(Time_t when, Resource *res, Dinst *dinst) {
+  if (!wheel || !wheel->fits(when)) {
+    wheel_overflow.inc(wheel && dinst->has_stats());
+    Resource::executedCB::scheduleAbs(when, res, dinst);
+    return;
+  }
+
+  wheel->push(when, {res, dinst, false});
+  wake_tick();
+}
+
+void DepWindow::wake_tick() {
+  if (tick_pending) {
+    return;
+  }
+  tick_pending = true;
+  tickCB.schedule(1);
+}
+
+void DepWindow::tick() {
+  tick_pending = false;
+
+  // The select stage takes this cycle, the wakeup happened at least one cycle before
+  for (int32_t n = 0; n < sched_width; n++) {
+    Dinst *dinst = matrix->select();
+    if (dinst == nullptr) {
+      break;
+    }
+
+    TimeDelta_t lat  = dinst->hasInterCluster() ? inter_cluster_lat : sched_lat;
+    Time_t      when = globalClock + (lat ? lat - 1 : 0);
+    when += dinst->getGProc()->reg_read_delay(dinst, when);
+    if (wheel->fits(when)) {
+      wheel->push(when, {dinst->getClusterResource(), dinst, true});
+    } else {
+      wheel_overflow.inc(dinst->has_stats());
+      Resource::executingCB::scheduleAbs(when, dinst->getClusterResource(), dinst);
+    }
+  }
+
+  // Slots freed by the select take the woken instructions that found it full
+  while (!matrix_wait.empty() && matrix->insert(matrix_wait.front())) {
+    matrix_wait.pop_front();
+  }
+
+  auto &cur = wheel->current();
+  for (size_t i = 0; i < cur.size(); i++) {
+    auto ev = cur[i];  // handlers may push to this bucket
+    if (ev.execute) {
+      ev.res->doExecuting(ev.dinst);
+    } else {
+      ev.res->doExecuted(ev.dinst);
+    }
+  }
+  wheel->done();
+
+  if (!matrix->empty() || !matrix_wait.empty() || !wheel->empty()) {
+    wake_tick();
+  }
 }
 
 // Called when dinst finished execution. Look for dependent to wakeUp
@@ -5,17 +5,75 @@
 #include "config.hpp"
 #include "fmt/format.h"
 #include "gprocessor.hpp"
+#include "snippets.hpp"
 
-LSQFull::LSQFull(Hartid_t hid, int32_t size)
+LSQFull::Queue::Queue(int32_t size)
+    : entries(roundUpPower2(size)), mask(entries.size() - 1), capacity(size), head(0), tail(0) {
+  for (auto &e : entries) {
+    e.dinst = 0;
+    e.word  = 0;
+  }
+}
+
+void LSQFull::Queue::push(Dinst *dinst, Addr_t word) {
+  I(!full());
+
+  at(tail) = {dinst, word};
+  tail++;
+}
+
+bool LSQFull::Queue::remove(Dinst *dinst, Addr_t &word) {
+  for (uint32_t i = head; i != tail; i++) {
+    if (at(i).dinst != dinst) {
+      continue;
+    }
+
+    word = at(i).word;
+    if (i == head) {
+      at(i).dinst = 0;
+      head++;
+      return true;
+    }
+    for (uint32_t j = i + 1; j != tail; j++) {
+      at(j - 1) = at(j);
+    }
+    tail--;
+    at(tail).dinst = 0;
+    return true;
+  }
+
+  return false;
+}
+
+LSQFull::LSQFull(Hartid_t hid, int32_t ldq_size, int32_t stq_size)
     /* constructor {{{1 */
-    : LSQ(size), stldForwarding(fmt::format("P({}):stldForwarding", hid)) {}
+    : LSQ(ldq_size + stq_size)
+    , stldForwarding(fmt::format("P({}):stldForwarding", hid))
+    , ldq(ldq_size)
+    , stq(stq_size)
+    , ldFilter(FILTER_SIZE, 0)
+    , stFilter(FILTER_SIZE, 0) {}
 /* }}} */
 
 bool LSQFull::insert(Dinst *dinst)
 /* Insert dinst in LSQ (in-order) {{{1 */
 {
   I(dinst->getAddr());
-  instMap.insert(std::pair<Addr_t, Dinst *>(calcWord(dinst), dinst));
+
+  Addr_t word = calcWord(dinst);
+  if (dinst->getInst()->isStore()) {
+    if (stq.full()) {
+      return false;
+    }
+    stq.push(dinst, word);
+    stFilter[calcFilter(word)]++;
+  } else {
+    if (ldq.full()) {
+      return false;
+    }
+    ldq.push(dinst, word);
+    ldFilter[calcFilter(word)]++;
+  }
 
   return true;
 }
@@ -26,52 +84,39 @@ Dinst *LSQFull::executing(Dinst *dinst)
 {
   I(dinst->getAddr());
 
-  Addr_t tag = calcWord(dinst);
+  Addr_t word = calcWord(dinst);
 
   const Instruction *inst   = dinst->getInst();
   Dinst             *faulty = 0;
 
-#if 0
-  AddrDinstQMap::const_iterator instIt = instMap.begin();
-  I(instIt != instMap.end());
-
-  I(!dinst->isExecuted());
-
-  while(instIt != instMap.end()) {
-    if (instIt->first != tag){
-      instIt++;
-      continue;
-    }
-#endif
-  std::pair<AddrDinstQMap::iterator, AddrDinstQMap::iterator> ret;
-  ret = instMap.equal_range(tag);
-  for (AddrDinstQMap::iterator instIt = ret.first; instIt != ret.second; ++instIt) {
-    I(instIt->first == tag);
-
-    // inst->dump("Executed");
-    Dinst *qdinst = instIt->second;
-    if (qdinst == dinst) {
-      continue;
-    }
-
-    const Instruction *qinst = qdinst->getInst();
-
-    // bool beforeInst = qdinst->getID() < dinst->getID();
-    bool oooExecuted = qdinst->getID() > dinst->getID();
-    if (oooExecuted) {
-      if (qdinst->isExecuted() && qdinst->getPC() != dinst->getPC()) {
-        if (inst->isStore() && qinst->isLoad()) {
-          if (faulty == 0) {
-            faulty = qdinst;
-          } else if (faulty->getID() < qdinst->getID()) {
+  if (inst->isStore()) {
+    // Younger loads to the same word that already executed read stale data
+    if (ldFilter[calcFilter(word)]) {
+      for (uint32_t i = ldq.getHead(); i != ldq.getTail(); i++) {
+        const auto &e = ldq.at(i);
+        if (e.word != word) {
+          continue;
+        }
+        Dinst *qdinst = e.dinst;
+        if (qdinst->getID() > dinst->getID() && qdinst->isExecuted() && qdinst->getPC() != dinst->getPC()
+            && qdinst->getInst()->isLoad()) {
+          if (faulty == 0 || faulty->getID() < qdinst->getID()) {
             faulty = qdinst;
           }
         }
       }
-    } else {
-      if (!dinst->isLoadForwarded() && inst->isLoad() && qinst->isStore() && qdinst->isExecuted()) {
+    }
+  } else if (inst->isLoad() && !dinst->isLoadForwarded() && stFilter[calcFilter(word)]) {
+    // Any older executed store to the same word forwards
+    for (uint32_t i = stq.getTail(); i != stq.getHead(); i--) {
+      const auto &e = stq.at(i - 1);
+      if (e.word != word) {
+        continue;
+      }
+      if (e.dinst->getID() < dinst->getID() && e.dinst->isExecuted()) {
         dinst->setLoadForwarded();
         stldForwarding.inc(dinst->has_stats());
+        break;
       }
     }
   }
@@ -87,19 +132,15 @@ void LSQFull::remove(Dinst *dinst)
 {
   I(dinst->getAddr());
 
-  // const Instruction *inst = dinst->getInst();
-
-  std::pair<AddrDinstQMap::iterator, AddrDinstQMap::iterator> rangeIt;
-  // rangeIt = instMap.equal_range(calcWord(dinst));
-  AddrDinstQMap::iterator instIt = instMap.begin();
-
-  // for(AddrDinstQMap::iterator it = rangeIt.first; it != rangeIt.second ; it++) {
-  while (instIt != instMap.end()) {
-    if (instIt->second == dinst) {
-      instMap.erase(instIt);
-      return;
+  Addr_t word;
+  if (dinst->getInst()->isStore()) {
+    if (stq.remove(dinst, word)) {
+      I(stFilter[calcFilter(word)]);
+      stFilter[calcFilter(word)]--;
     }
-    instIt++;
+  } else if (ldq.remove(dinst, word)) {
+    I(ldFilter[calcFilter(word)]);
+    ldFilter[calcFilter(word)]--;
   }
 }
 /* }}} */
@@ -144,7 +185,11 @@ Dinst *LSQNone::executing(Dinst *dinst)
 void LSQNone::remove(Dinst *dinst)
 /* Remove from the LSQ {{{1 (in-order) */
 {
-  (void)dinst;
+  // Already out unless squashed before executing
+  int i = getEntry(dinst->getAddr());
+  if (addrTable[i] == dinst) {
+    addrTable[i] = 0;
+  }
 }
 /* }}} */
 
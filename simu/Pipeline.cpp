@@ -5,7 +5,7 @@
 #include "config.hpp"
 
 IBucket::IBucket(size_t size, Pipeline *p, bool clean)
-    : FastQueue<Dinst *>(size), cleanItem(clean), pipeLine(p), markFetchedCB(this) {}
+    : FastQueue<Dinst *>(size), cleanItem(clean), bypass(0), pipeLine(p), markFetchedCB(this) {}
 
 void IBucket::markFetched() {
 #ifndef NDEBUG
@@ -106,7 +106,8 @@ void Pipeline::clearItems() {
 void Pipeline::doneItem(IBucket *b) {
   I(b->getPipelineId() < minItemCntr);
   I(b->empty());
-  b->clock = 0;
+  b->clock  = 0;
+  b->bypass = 0;
 
   bucketPool.push_back(b);
 }
@@ -122,7 +123,7 @@ IBucket *Pipeline::nextItem() {
       return 0;
     }
 
-    if (((buffer.top())->getClock() + PipeLength) > globalClock) {
+    if (((buffer.top())->getClock() + PipeLength - (buffer.top())->bypass) > globalClock) {
 #if 0
       fprintf(stderr,"1 @%lld Buffer[%p] .top.ID (%d) ->getClock(@%lld) to be issued after %d cycles\n"
           ,(long long int) globalClock
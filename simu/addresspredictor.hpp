@@ -159,6 +159,7 @@ public:
 
   void allocate();
   void select(Addr_t t, int b);
+  void select_tag(bool tag_hit, int b);  // tag compare done by the caller
   bool conf_steal();
   void conf_force_steal(int delta);
   void conf_update(int ndelta);
@@ -270,8 +271,11 @@ protected:
   int    *m;     // [NHIST + 1]; // history lengths
   int    *TB;    //[NHIST + 1];   // tag width for the different tagged tables
   int    *logg;  // [NHIST + 1];  // log of number entries of the different tagged tables
-  Addr_t *GI;    //[NHIST + 1];   // indexes to the different tables are computed only once
-  Addr_t *GTAG;  //[NHIST + 1];    // tags for the different tables are computed only once
+  uint32_t *GI;         //[NHIST + 1];   // indexes to the different tables are computed only once
+  uint32_t *GTAG;       //[NHIST + 1];    // tags for the different tables are computed only once
+  uint32_t *tag_shift;  //[NHIST + 1];   // GTAG hash shift (logg / 2)
+  uint32_t *tag_mask;   //[NHIST + 1];   // GTAG width mask
+  uint32_t *tag_read;   //[NHIST + 1];   // tags of the selected entries
 
   Addr_t lastBoundaryPC;  // last PC that fetchBoundary was called
   int    TICK;            // for reset of u counter
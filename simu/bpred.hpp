@@ -19,6 +19,7 @@
 #include <map>
 #include <vector>
 
+#include "btb_l2.hpp"
 #include "cachecore.hpp"
 #include "dinst.hpp"
 #include "dolc.hpp"
@@ -34,6 +35,7 @@ enum BrOpType { BEQ = 0, BNE = 1, BLT = 4, BGE = 5, BLTU = 6, BGEU = 7, ILLEGAL_
 enum class Outcome { Correct, None, NoBTB, Miss };
 
 class MemObj;
+class BPBTB;
 
 class BPred {
 public:
@@ -57,6 +59,9 @@ public:
 protected:
   const int32_t id;
 
+  // The BTB of the predictors without a history of their own
+  virtual BPBTB *history_btb() { return nullptr; }
+
   Stats_cntr nHit;   // N.B. predictors should not update these counters directly
   Stats_cntr nMiss;  // in their predict() function.
 
@@ -71,6 +76,16 @@ public:
   virtual void    fetchBoundaryBegin(Dinst *dinst);  // If the branch predictor support fetch boundary model, do it
   virtual void    fetchBoundaryEnd();                // If the branch predictor support fetch boundary model, do it
 
+  // Speculative history. save_history appends the history registers (not
+  // the tables) to ck, restore_history reads them back from ck[pos] and
+  // returns the position past them. speculate shifts a wrong path control
+  // instruction (taken is its evaluated direction, dinst->isTaken() is not
+  // known there) into the history registers without training any table.
+  // By default the history is the one of history_btb (none without it)
+  virtual void   save_history(std::vector<uint64_t> &ck) const;
+  virtual size_t restore_history(const std::vector<uint64_t> &ck, size_t pos);
+  virtual void   speculate(Dinst *dinst, bool taken);
+
   Outcome doPredict(Dinst *dinst, bool doStats = true) {
     Outcome pred = predict(dinst, true, doStats);
     if (pred == Outcome::None) {
@@ -104,6 +119,11 @@ public:
   ~BPRas();
   Outcome predict(Dinst *dinst, bool doUpdate, bool doStats);
 
+  // Top of stack pointer and entry
+  void   save_history(std::vector<uint64_t> &ck) const;
+  size_t restore_history(const std::vector<uint64_t> &ck, size_t pos);
+  void   speculate(Dinst *dinst, bool taken);
+
   void tryPrefetch(MemObj *il1, bool doStats, int degree);
 };
 
@@ -137,6 +157,11 @@ public:
 
   Outcome predict(Dinst *dinst, bool doUpdate, bool doStats);
   void    updateOnly(Dinst *dinst);
+
+  // The DOLC history of the btb_history_size index, if any
+  void   save_history(std::vector<uint64_t> &ck) const;
+  size_t restore_history(const std::vector<uint64_t> &ck, size_t pos);
+  void   speculate(Dinst *dinst, bool taken);
 };
 
 class BPOracle : public BPred {
@@ -149,6 +174,8 @@ public:
       : BPred(i, section, sname, "Oracle"), btb(i, section, sname) {}
 
   Outcome predict(Dinst *dinst, bool doUpdate, bool doStats);
+
+  BPBTB *history_btb() { return &btb; }
 };
 
 class BPNotTaken : public BPred {
@@ -163,6 +190,8 @@ public:
   }
 
   Outcome predict(Dinst *dinst, bool doUpdate, bool doStats);
+
+  BPBTB *history_btb() { return &btb; }
 };
 
 class BPMiss : public BPred {
@@ -188,6 +217,8 @@ public:
   }
 
   Outcome predict(Dinst *dinst, bool doUpdate, bool doStats);
+
+  BPBTB *history_btb() { return &btb; }
 };
 
 class BPTaken : public BPred {
@@ -202,6 +233,8 @@ public:
   }
 
   Outcome predict(Dinst *dinst, bool doUpdate, bool doStats);
+
+  BPBTB *history_btb() { return &btb; }
 };
 
 class BP2bit : public BPred {
@@ -215,6 +248,8 @@ public:
   BP2bit(int32_t i, const std::string &section, const std::string &sname);
 
   Outcome predict(Dinst *dinst, bool doUpdate, bool doStats);
+
+  BPBTB *history_btb() { return &btb; }
 };
 
 class IMLIBest;
@@ -234,6 +269,34 @@ public:
   void    fetchBoundaryBegin(Dinst *dinst);
   void    fetchBoundaryEnd();
   Outcome predict(Dinst *dinst, bool doUpdate, bool doStats);
+
+  void   save_history(std::vector<uint64_t> &ck) const;
+  size_t restore_history(const std::vector<uint64_t> &ck, size_t pos);
+  void   speculate(Dinst *dinst, bool taken);
+};
+
+class Ittage_predictor;
+
+// Indirect target level: predicts the register jumps/calls and returns
+// Outcome::None for the other control instructions, so it goes after a
+// direction predictor level.
+class BPITTAGE : public BPred {
+private:
+  std::unique_ptr<Ittage_predictor> ittage;
+
+  Stats_cntr nIndirectHit;
+  Stats_cntr nIndirectMiss;
+
+protected:
+public:
+  BPITTAGE(int32_t i, const std::string &section, const std::string &sname);
+  ~BPITTAGE();
+
+  Outcome predict(Dinst *dinst, bool doUpdate, bool doStats);
+
+  void   save_history(std::vector<uint64_t> &ck) const;
+  size_t restore_history(const std::vector<uint64_t> &ck, size_t pos);
+  void   speculate(Dinst *dinst, bool taken);
 };
 
 class BP2level : public BPred {
@@ -258,6 +321,11 @@ public:
   ~BP2level();
 
   Outcome predict(Dinst *dinst, bool doUpdate, bool doStats);
+
+  // The path (DOLC) history, the per branch historyTable is not repaired
+  void   save_history(std::vector<uint64_t> &ck) const;
+  size_t restore_history(const std::vector<uint64_t> &ck, size_t pos);
+  void   speculate(Dinst *dinst, bool taken);
 };
 
 class BPHybrid : public BPred {
@@ -280,6 +348,10 @@ public:
   ~BPHybrid();
 
   Outcome predict(Dinst *dinst, bool doUpdate, bool doStats);
+
+  void   save_history(std::vector<uint64_t> &ck) const;
+  size_t restore_history(const std::vector<uint64_t> &ck, size_t pos);
+  void   speculate(Dinst *dinst, bool taken);
 };
 
 class BP2BcgSkew : public BPred {
@@ -308,6 +380,10 @@ public:
   ~BP2BcgSkew();
 
   Outcome predict(Dinst *dinst, bool doUpdate, bool doStats);
+
+  void   save_history(std::vector<uint64_t> &ck) const;
+  size_t restore_history(const std::vector<uint64_t> &ck, size_t pos);
+  void   speculate(Dinst *dinst, bool taken);
 };
 
 class BPyags : public BPred {
@@ -337,6 +413,10 @@ public:
   ~BPyags();
 
   Outcome predict(Dinst *dinst, bool doUpdate, bool doStats);
+
+  void   save_history(std::vector<uint64_t> &ck) const;
+  size_t restore_history(const std::vector<uint64_t> &ck, size_t pos);
+  void   speculate(Dinst *dinst, bool taken);
 };
 
 class BPOgehl : public BPred {
@@ -379,6 +459,10 @@ public:
   ~BPOgehl();
 
   Outcome predict(Dinst *dinst, bool doUpdate, bool doStats);
+
+  void   save_history(std::vector<uint64_t> &ck) const;
+  size_t restore_history(const std::vector<uint64_t> &ck, size_t pos);
+  void   speculate(Dinst *dinst, bool taken);
 };
 
 class LoopPredictor {
@@ -434,6 +518,8 @@ public:
   ~BPTData() {}
 
   Outcome predict(Dinst *dinst, bool doUpdate, bool doStats);
+
+  BPBTB *history_btb() { return &btb; }
 };
 
 /*LOAD BRANCH PREDICTOR (LDBP)*/
@@ -466,6 +552,8 @@ public:
   bool     outcome_calculator(BrOpType br_op, Data_t br_data1, Data_t br_data2);
   BrOpType branch_type(Addr_t brpc);
 
+  BPBTB *history_btb() { return &btb; }
+
   struct data_outcome_correlator {
     data_outcome_correlator() {
       tag    = 0;
@@ -558,6 +646,8 @@ private:
   std::shared_ptr<BPred> pred2;
   std::shared_ptr<BPred> pred3;
 
+  std::shared_ptr<Btb_l2> btb2;  // optional L2 BTB behind the pred1 BTB
+
   int32_t FetchWidth;
   int32_t bpredDelay1;
   int32_t bpredDelay2;
@@ -587,6 +677,23 @@ private:
   Stats_cntr nUnFixes;
   Stats_cntr nAgree3;
 
+  Stats_cntr nIndirect;
+  Stats_cntr nIndirectMiss;  // not fixed by any level
+
+  // Speculative history checkpoints (bpred_checkpoints), taken after each
+  // predicted control instruction. Ordered by increasing instruction ID,
+  // the oldest is recycled when all are in use
+  struct History_ckpt {
+    uint64_t              id;
+    std::vector<uint64_t> state;  // ras, pred1, pred2, pred3 save_history
+  };
+  const size_t                       max_ckpts;
+  std::deque<History_ckpt>           ckpts;
+  std::vector<std::vector<uint64_t>> spare_states;
+
+  Stats_cntr nHistRestore;
+  Stats_cntr nHistNoCkpt;  // redirects whose checkpoint was recycled
+
 protected:
   Outcome predict1(Dinst *dinst);
   Outcome predict2(Dinst *dinst);
@@ -611,4 +718,29 @@ public:
   }
 
   bool get_Miss_Pred_Bool_Val() { return Miss_Pred_Bool; }
+
+  // Per level counters, for tools that drive the predictor without a core
+  uint64_t get_nbranches(int level) const {
+    return level == 1 ? nBranches.get() : (level == 2 ? nBranches2.get() : nBranches3.get());
+  }
+  uint64_t get_nmiss(int level) const { return level == 1 ? nMiss.get() : (level == 2 ? nMiss2.get() : nMiss3.get()); }
+  bool     has_level(int level) const { return level == 1 || (level == 2 ? pred2 != nullptr : pred3 != nullptr); }
+  uint64_t get_nindirect() const { return nIndirect.get(); }
+  bool     has_btb_prefetch() const { return btb2 && btb2->has_prefetch(); }
+  void     btb_prefetch(Addr_t addr, int line_size, bool doStats) { btb2->prefetch(addr, line_size, doStats); }
+  uint64_t get_nindirect_miss() const { return nIndirectMiss.get(); }
+
+  // History checkpoint of the levels after predicting instruction inst_id. A
+  // redirect (misprediction or a later level override) restores it and drops
+  // it and the younger ones. All the levels predict in the same cycle, so the
+  // fetch past a level 1 prediction that level 2 overrides is not modeled
+  void   checkpoint(uint64_t inst_id);
+  void   restore(uint64_t inst_id, bool doStats);
+  size_t get_ncheckpoints() const { return ckpts.size(); }
+  void   save_history(std::vector<uint64_t> &state) const;
+
+  // Wrong path control instruction and the direction evaluated down the
+  // wrong path: shifts it into the speculative history of the levels (no
+  // table is trained), the restore at the redirect undoes it
+  void speculate(Dinst *dinst, bool taken);
 };
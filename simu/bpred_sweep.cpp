@@ -0,0 +1,271 @@
+// See LICENSE for details.
+
+// Trace driven branch predictor evaluation.
+//
+//   bpred_sweep record <desesc.toml> <trace>
+//     runs the dromajo emul of the configuration (rabbit/detail/time) and
+//     records the control instructions with their resolved outcome.
+//
+//   bpred_sweep [-j N] <trace> <conf.toml>...
+//     replays the trace through the core 0 bpred of each configuration, N
+//     configurations at a time, and reports the MPKI of each level and the
+//     indirect jump/call MPKI (misses not fixed by any level).
+//
+// Each configuration runs in a forked process: Config, the stats registry,
+// the Dinst pool and some predictors (IMLI) are process wide, so threads
+// could not hold different configurations. The trace is mmap'd before the
+// fork, so all the workers share the same pages.
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bpred.hpp"
+#include "branch_trace.hpp"
+#include "config.hpp"
+#include "dinst.hpp"
+#include "emul_dromajo.hpp"
+#include "fmt/format.h"
+#include "instruction.hpp"
+
+struct Sweep_result {
+  uint64_t nbranches[3];
+  uint64_t nmiss[3];
+  bool     level[3];
+  uint64_t nindirect;
+  uint64_t nindirect_miss;  // not fixed by any level
+};
+
+static int record(const std::string &conf, const std::string &fname) {
+  Config::init(conf);
+
+  Emul_dromajo emul;
+
+  Branch_trace_writer out(fname);
+  if (!out.is_open()) {
+    fmt::print("ERROR: could not create trace {}\n", fname);
+    return 1;
+  }
+
+  while (true) {
+    Dinst *dinst = emul.peek(0);
+    if (dinst == nullptr) {
+      break;
+    }
+    emul.execute(0);
+    out.add_inst(dinst->has_stats());
+
+    const Instruction *inst = dinst->getInst();
+    if (inst->isControl()) {
+      Addr_t next  = emul.get_pc(0);
+      bool   taken = !inst->isBranch() || next == dinst->getAddr();
+
+      Branch_record rec{};
+      rec.pc     = dinst->getPC();
+      rec.target = taken ? next : 0;
+      rec.opcode = inst->getOpcode();
+      rec.src1   = inst->getSrc1();
+      rec.src2   = inst->getSrc2();
+      rec.dst1   = inst->getDst1();
+      rec.stats  = dinst->has_stats();
+      out.add(rec);
+    }
+
+    dinst->scrap();
+  }
+
+  out.close();
+  emul.destroy_machine();
+
+  return 0;
+}
+
+static Sweep_result replay(const Branch_trace &trace, const std::string &conf) {
+  Config::init(conf);
+
+  BPredictor bpred(0, nullptr, nullptr);
+  Config::exit_on_error();
+
+  globalClock = 1;
+
+  bool block_begin = true;
+  for (uint64_t i = 0; i < trace.size(); ++i) {
+    const auto &rec = trace[i];
+
+    Dinst *dinst = Dinst::create(Instruction(static_cast<Opcode>(rec.opcode),
+                                             static_cast<RegType>(rec.src1),
+                                             static_cast<RegType>(rec.src2),
+                                             static_cast<RegType>(rec.dst1),
+                                             LREG_InvalidOutput),
+                                 rec.pc,
+                                 rec.target,
+                                 0,
+                                 rec.stats);
+    if (block_begin) {
+      bpred.fetchBoundaryBegin(dinst);
+    }
+
+    bool fastfix;
+    bpred.predict(dinst, &fastfix);
+
+    block_begin = dinst->isTaken();
+    if (block_begin) {
+      bpred.fetchBoundaryEnd();
+    }
+
+    dinst->scrap();
+    globalClock++;
+  }
+
+  Sweep_result res{};
+  for (int l = 0; l < 3; ++l) {
+    res.level[l]     = bpred.has_level(l + 1);
+    res.nbranches[l] = bpred.get_nbranches(l + 1);
+    res.nmiss[l]     = bpred.get_nmiss(l + 1);
+  }
+  res.nindirect      = bpred.get_nindirect();
+  res.nindirect_miss = bpred.get_nindirect_miss();
+
+  return res;
+}
+
+static void report(const std::string &conf, const Sweep_result &res, double kinst) {
+  std::string line = fmt::format("{:<32} {:>12}", conf, res.nbranches[0]);
+  for (int l = 0; l < 3; ++l) {
+    if (res.level[l]) {
+      line += fmt::format(" {:>12} {:>8.3f}", res.nmiss[l], res.nmiss[l] / kinst);
+    } else {
+      line += fmt::format(" {:>12} {:>8}", "-", "-");
+    }
+  }
+  line += fmt::format(" {:>12} {:>12} {:>8.3f}", res.nindirect, res.nindirect_miss, res.nindirect_miss / kinst);
+  fmt::print("{}\n", line);
+}
+
+static int sweep(const std::string &fname, const std::vector<std::string> &confs, unsigned njobs) {
+  Branch_trace trace(fname);
+  if (!trace.is_valid()) {
+    fmt::print("ERROR: could not open trace {}\n", fname);
+    return 1;
+  }
+
+  uint64_t ninst = trace.get_ninst_stats() ? trace.get_ninst_stats() : trace.get_ninst();
+  double   kinst = ninst ? ninst / 1000.0 : 1.0;
+
+  struct Worker {
+    pid_t pid;
+    int   fd;
+  };
+  std::vector<Worker>       workers(confs.size(), Worker{-1, -1});
+  std::vector<Sweep_result> results(confs.size());
+  std::vector<bool>         ok(confs.size(), false);
+
+  size_t next    = 0;
+  size_t running = 0;
+  while (next < confs.size() || running) {
+    if (next < confs.size() && running < njobs) {
+      int p[2];
+      if (pipe(p) != 0) {
+        fmt::print("ERROR: could not create a pipe\n");
+        return 1;
+      }
+
+      pid_t pid = fork();
+      if (pid == 0) {
+        ::close(p[0]);
+        auto res = replay(trace, confs[next]);
+        // a single write below PIPE_BUF, never partial
+        bool done = write(p[1], &res, sizeof(res)) == sizeof(res);
+        _exit(done ? 0 : 1);
+      }
+      ::close(p[1]);
+      if (pid < 0) {
+        ::close(p[0]);
+        fmt::print("ERROR: could not fork for {}\n", confs[next]);
+        return 1;
+      }
+
+      workers[next] = Worker{pid, p[0]};
+      ++next;
+      ++running;
+      continue;
+    }
+
+    int   status;
+    pid_t pid = wait(&status);
+    if (pid < 0) {
+      break;
+    }
+    for (size_t i = 0; i < workers.size(); ++i) {
+      if (workers[i].pid != pid) {
+        continue;
+      }
+      ok[i] = WIFEXITED(status) && WEXITSTATUS(status) == 0
+              && read(workers[i].fd, &results[i], sizeof(Sweep_result)) == sizeof(Sweep_result);
+      ::close(workers[i].fd);
+      workers[i].pid = -1;
+      --running;
+    }
+  }
+
+  fmt::print("trace {} inst={} stats_inst={} branches={}\n", fname, trace.get_ninst(), trace.get_ninst_stats(), trace.size());
+  fmt::print("{:<32} {:>12} {:>12} {:>8} {:>12} {:>8} {:>12} {:>8} {:>12} {:>12} {:>8}\n",
+             "config",
+             "nBranches",
+             "nMiss",
+             "MPKI",
+             "nMiss2",
+             "MPKI2",
+             "nMiss3",
+             "MPKI3",
+             "nIndirect",
+             "nIndMiss",
+             "iMPKI");
+
+  int errors = 0;
+  for (size_t i = 0; i < confs.size(); ++i) {
+    if (!ok[i]) {
+      fmt::print("{:<32} failed\n", confs[i]);
+      ++errors;
+      continue;
+    }
+    report(confs[i], results[i], kinst);
+  }
+
+  return errors ? 1 : 0;
+}
+
+static void usage() {
+  fmt::print("usage: bpred_sweep record <desesc.toml> <trace>\n");
+  fmt::print("       bpred_sweep [-j N] <trace> <conf.toml>...\n");
+}
+
+int main(int argc, const char **argv) {
+  unsetenv("DESESCCONF");  // the configurations are explicit arguments
+
+  std::vector<std::string> args(argv + 1, argv + argc);
+
+  if (args.size() == 3 && args[0] == "record") {
+    return record(args[1], args[2]);
+  }
+
+  unsigned njobs = std::thread::hardware_concurrency();
+  if (args.size() >= 2 && args[0] == "-j") {
+    njobs = std::atoi(args[1].c_str());
+    args.erase(args.begin(), args.begin() + 2);
+  }
+  if (njobs == 0) {
+    njobs = 1;
+  }
+
+  if (args.size() < 2) {
+    usage();
+    return 1;
+  }
+
+  return sweep(args[0], std::vector<std::string>(args.begin() + 1, args.end()), njobs);
+}
@@ -0,0 +1,215 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include "bpred.hpp"
+
+#include <fstream>
+#include <random>
+
+#include "config.hpp"
+#include "gtest/gtest.h"
+#include "imlibest.hpp"
+
+class BPred_test : public ::testing::Test {
+protected:
+  void SetUp() override {
+    std::ofstream file;
+
+    file.open("bpred_test.toml");
+    file << "[soc]\n";
+    file << "core = [\"c0\", \"c0\", \"c0\", \"c0\", \"c0\"]\n";
+    file << "[c0]\n";
+    file << "fetch_width       = 4\n";
+    file << "bpred             = [\"bp0\", \"bp1\"]\n";
+    file << "bpred_checkpoints = 8\n";
+
+    for (const auto *sec : {"bp0", "bp1"}) {
+      file << "[" << sec << "]\n";
+      file << "bp_addr_shift    = 0\n";
+      file << "ras_size         = 8\n";
+      file << "ras_prefetch     = false\n";
+      file << "btb_history_size = 4\n";
+      file << "btb_split_il1    = false\n";
+      file << "btb_size         = 256\n";
+      file << "btb_line_size    = 1\n";
+      file << "btb_assoc        = 4\n";
+      file << "btb_repl_policy  = \"LRU\"\n";
+    }
+    file << "[bp0]\n";
+    file << "type         = \"hybrid\"\n";
+    file << "delay        = 1\n";
+    file << "history_size = 8\n";
+    file << "global_size  = 1024\n";
+    file << "global_width = 2\n";
+    file << "local_size   = 1024\n";
+    file << "local_width  = 2\n";
+    file << "meta_size    = 1024\n";
+    file << "meta_width   = 2\n";
+    file << "[bp1]\n";
+    file << "type          = \"imli\"\n";
+    file << "delay         = 3\n";
+    file << "fetch_predict = false\n";
+    file << "bimodal_size  = 1024\n";
+    file << "bimodal_width = 2\n";
+    file << "nhist         = 8\n";
+    file << "statcorrector = false\n";
+    file.close();
+
+    Config::init("bpred_test.toml");
+  }
+};
+
+static Dinst *create_ctrl(Opcode op, Addr_t pc, Addr_t target) {
+  return Dinst::create(Instruction(op, LREG_R1, LREG_R2, LREG_InvalidOutput, LREG_InvalidOutput), pc, target, 0, true);
+}
+
+// Predicts the branch and returns the delay, and the instruction ID in id
+static TimeDelta_t predict(BPredictor &bpred, Addr_t pc, bool taken, uint64_t &id) {
+  Dinst *dinst = create_ctrl(iBALU_LBRANCH, pc, taken ? pc - 0x40 : 0);
+  id           = dinst->getID();
+
+  bool        fastfix;
+  TimeDelta_t delay = bpred.predict(dinst, &fastfix);
+  dinst->scrap();
+
+  return delay;
+}
+
+TEST_F(BPred_test, history_restore) {
+  BPredictor pred(0, nullptr, nullptr);
+  BPredictor ref(1, nullptr, nullptr);
+  BPredictor nofix(2, nullptr, nullptr);
+  Config::exit_on_error();
+
+  // A loop of 5 iterations in a loop of 3: the history decides the inner exit
+  std::vector<std::pair<Addr_t, bool>> trace;
+  for (int i = 0; i < 600; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      for (int k = 0; k < 5; ++k) {
+        trace.emplace_back(0x1080, k != 4);
+      }
+      trace.emplace_back(0x1100, j != 2);
+    }
+  }
+
+  uint64_t id;
+  size_t   n = 0;
+  for (; n < trace.size() / 2; ++n) {
+    predict(pred, trace[n].first, trace[n].second, id);
+    predict(ref, trace[n].first, trace[n].second, id);
+    predict(nofix, trace[n].first, trace[n].second, id);
+  }
+  EXPECT_EQ(pred.get_ncheckpoints(), 8);
+
+  // The branch is mispredicted, the history of its checkpoint is the good one
+  uint64_t miss_id;
+  predict(pred, trace[n].first, trace[n].second, miss_id);
+  predict(ref, trace[n].first, trace[n].second, id);
+  predict(nofix, trace[n].first, trace[n].second, id);
+  ++n;
+
+  std::vector<uint64_t> good;
+  pred.save_history(good);
+
+  // Wrong path control instructions move the history, calls and returns the
+  // RAS. As decoded by the emulator, the address is the target of the branch
+  // whatever its evaluated direction
+  std::mt19937 rng(1);
+  for (int i = 0; i < 40; ++i) {
+    Addr_t pc    = 0x8000 + 4 * (rng() & 63);
+    Opcode op    = (i % 10 == 3) ? iBALU_LCALL : ((i % 10 == 7) ? iBALU_RET : iBALU_LBRANCH);
+    bool   taken = op != iBALU_LBRANCH || (rng() & 1);
+    for (auto *bp : {&pred, &nofix}) {
+      Dinst *dinst = create_ctrl(op, pc, pc + 0x100);
+      bp->speculate(dinst, taken);
+      dinst->scrap();
+    }
+  }
+
+  std::vector<uint64_t> wrong;
+  pred.save_history(wrong);
+  EXPECT_NE(wrong, good);
+
+  pred.restore(miss_id, false);
+  std::vector<uint64_t> restored;
+  pred.save_history(restored);
+  EXPECT_EQ(restored, good);
+  EXPECT_EQ(pred.get_ncheckpoints(), 7);
+
+  // No table was trained: with the history back, the predictions are the same
+  int diff_nofix = 0;
+  for (; n < trace.size(); ++n) {
+    auto d_pred  = predict(pred, trace[n].first, trace[n].second, id);
+    auto d_ref   = predict(ref, trace[n].first, trace[n].second, id);
+    auto d_nofix = predict(nofix, trace[n].first, trace[n].second, id);
+    EXPECT_EQ(d_pred, d_ref);
+    diff_nofix += d_nofix != d_ref ? 1 : 0;
+  }
+  EXPECT_GT(diff_nofix, 0);
+}
+
+// The evaluated direction moves the history, not the decoded target
+TEST_F(BPred_test, speculate_direction) {
+  BPredictor nt(3, nullptr, nullptr);
+  BPredictor tk(4, nullptr, nullptr);
+  Config::exit_on_error();
+
+  std::vector<uint64_t> h_nt;
+  std::vector<uint64_t> h_tk;
+  nt.save_history(h_nt);
+  tk.save_history(h_tk);
+  EXPECT_EQ(h_nt, h_tk);
+
+  for (Addr_t pc = 0x2000; pc < 0x2100; pc += 4) {
+    Dinst *dinst = create_ctrl(iBALU_LBRANCH, pc, pc - 0x40);
+    nt.speculate(dinst, false);
+    tk.speculate(dinst, true);
+    dinst->scrap();
+  }
+
+  h_nt.clear();
+  h_tk.clear();
+  nt.save_history(h_nt);
+  tk.save_history(h_tk);
+  EXPECT_NE(h_nt, h_tk);
+}
+
+// The specialized IMLI predictors behave like the runtime geometry one
+template <Imli_geometry G>
+static void imli_fixed_matches_runtime() {
+  IMLIBest_impl<true, G> fixed(10, 2, 2, G);
+  IMLIBest_impl<false>   runtime(10, 2, 2, G);
+
+  std::mt19937 rng(7);
+  for (int i = 0; i < 100000; ++i) {
+    Addr_t pc     = 0x10000 + ((rng() % 512) << 2);
+    bool   taken  = (pc & 0x30) ? (i % 7) != 0 : (rng() & 1);
+    Addr_t target = (pc & 4) ? pc - 64 : pc + 128;
+
+    bool     bias_f, bias_r;
+    uint32_t sign_f, sign_r;
+    fixed.fetchBoundaryBegin(pc);
+    runtime.fetchBoundaryBegin(pc);
+    bool pred_f = fixed.getPrediction(pc, bias_f, sign_f);
+    bool pred_r = runtime.getPrediction(pc, bias_r, sign_r);
+    ASSERT_EQ(pred_f, pred_r);
+    ASSERT_EQ(bias_f, bias_r);
+    ASSERT_EQ(sign_f, sign_r);
+
+    fixed.updatePredictor(pc, taken, pred_f, target, true);
+    runtime.updatePredictor(pc, taken, pred_r, target, true);
+    fixed.fetchBoundaryEnd();
+    runtime.fetchBoundaryEnd();
+  }
+}
+
+TEST(BPred_imli_test, fixed_geometry) {
+  using Imli_256k   = IMLIBest_impl<true, IMLI_GEO_256K>;
+  using Imli_tage_l = IMLIBest_impl<true, IMLI_GEO_TAGE_L>;
+
+  EXPECT_TRUE(Imli_256k::matches(Imli_geometry{}));
+  EXPECT_TRUE(Imli_tage_l::matches(IMLI_GEO_TAGE_L));
+  EXPECT_FALSE(Imli_256k::matches(IMLI_GEO_TAGE_L));
+
+  imli_fixed_matches_runtime<IMLI_GEO_256K>();
+  imli_fixed_matches_runtime<IMLI_GEO_TAGE_L>();
+}
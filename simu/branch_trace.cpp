@@ -0,0 +1,76 @@
+// See LICENSE for details.
+
+#include "branch_trace.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+Branch_trace_writer::Branch_trace_writer(const std::string &fname) : header{} {
+  header.magic   = Branch_trace_header::MAGIC;
+  header.version = Branch_trace_header::VERSION;
+
+  fp = fopen(fname.c_str(), "wb");
+  if (fp) {
+    fwrite(&header, sizeof(header), 1, fp);  // placeholder, rewritten by close
+  }
+}
+
+Branch_trace_writer::~Branch_trace_writer() { close(); }
+
+void Branch_trace_writer::add(const Branch_record &rec) {
+  I(fp);
+  fwrite(&rec, sizeof(rec), 1, fp);
+  header.nrecords++;
+}
+
+void Branch_trace_writer::close() {
+  if (fp == nullptr) {
+    return;
+  }
+
+  fseek(fp, 0, SEEK_SET);
+  fwrite(&header, sizeof(header), 1, fp);
+  fclose(fp);
+  fp = nullptr;
+}
+
+Branch_trace::Branch_trace(const std::string &fname) : header(nullptr), records(nullptr), map_size(0) {
+  int fd = open(fname.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(Branch_trace_header)) {
+    ::close(fd);
+    return;
+  }
+
+  void *base = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (base == MAP_FAILED) {
+    return;
+  }
+  map_size = st.st_size;
+
+  auto *h = static_cast<const Branch_trace_header *>(base);
+  if (h->magic != Branch_trace_header::MAGIC || h->version != Branch_trace_header::VERSION
+      || sizeof(Branch_trace_header) + h->nrecords * sizeof(Branch_record) > map_size) {
+    munmap(base, map_size);
+    map_size = 0;
+    return;
+  }
+
+  madvise(base, map_size, MADV_SEQUENTIAL);
+
+  header  = h;
+  records = reinterpret_cast<const Branch_record *>(h + 1);
+}
+
+Branch_trace::~Branch_trace() {
+  if (header) {
+    munmap(const_cast<Branch_trace_header *>(header), map_size);
+  }
+}
@@ -0,0 +1,80 @@
+// See LICENSE for details.
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include "iassert.hpp"
+#include "opcode.hpp"
+
+// Compact trace of the control instructions of a run, so that branch
+// predictor configurations can be evaluated without a timing simulation.
+struct Branch_record {
+  Addr_t  pc;
+  Addr_t  target;  // 0 when not taken
+  uint8_t opcode;
+  uint8_t src1;
+  uint8_t src2;
+  uint8_t dst1;
+  uint8_t stats;  // instruction counted in the stats (not in the detail warmup)
+  uint8_t pad[3];
+};
+static_assert(sizeof(Branch_record) == 24, "Branch_record is a file format");
+
+struct Branch_trace_header {
+  static constexpr uint32_t MAGIC   = 0x54524244;  // "DBRT"
+  static constexpr uint32_t VERSION = 1;
+
+  uint32_t magic;
+  uint32_t version;
+  uint64_t ninst;        // instructions executed, branches or not
+  uint64_t ninst_stats;  // instructions with stats (MPKI denominator)
+  uint64_t nrecords;
+};
+
+class Branch_trace_writer {
+private:
+  FILE               *fp;
+  Branch_trace_header header;
+
+public:
+  explicit Branch_trace_writer(const std::string &fname);
+  ~Branch_trace_writer();
+
+  bool is_open() const { return fp != nullptr; }
+
+  void add_inst(bool stats) {
+    header.ninst++;
+    header.ninst_stats += stats ? 1 : 0;
+  }
+  void add(const Branch_record &rec);
+
+  // Writes the final header, called by the destructor too
+  void close();
+};
+
+// Read-only mmap of a trace file. The mapping is shared by the processes
+// forked after opening it.
+class Branch_trace {
+private:
+  const Branch_trace_header *header;
+  const Branch_record       *records;
+  size_t                     map_size;
+
+public:
+  explicit Branch_trace(const std::string &fname);
+  ~Branch_trace();
+
+  bool is_valid() const { return header != nullptr; }
+
+  uint64_t get_ninst() const { return header->ninst; }
+  uint64_t get_ninst_stats() const { return header->ninst_stats; }
+  uint64_t size() const { return header->nrecords; }
+
+  const Branch_record &operator[](uint64_t i) const {
+    I(i < size());
+    return records[i];
+  }
+};
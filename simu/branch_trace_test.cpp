@@ -0,0 +1,62 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include "branch_trace.hpp"
+
+#include <cstdio>
+
+#include "gtest/gtest.h"
+
+TEST(Branch_trace_test, round_trip) {
+  const std::string fname = "branch_trace_test.trace";
+
+  {
+    Branch_trace_writer out(fname);
+    ASSERT_TRUE(out.is_open());
+
+    for (int i = 0; i < 1000; ++i) {
+      out.add_inst(i >= 100);
+      if (i % 5 == 0) {
+        Branch_record rec{};
+        rec.pc     = 0x1000 + i * 4;
+        rec.target = (i % 10 == 0) ? 0x2000 + i : 0;
+        rec.opcode = iBALU_LBRANCH;
+        rec.src1   = LREG_R1;
+        rec.stats  = i >= 100;
+        out.add(rec);
+      }
+    }
+  }
+
+  Branch_trace trace(fname);
+  ASSERT_TRUE(trace.is_valid());
+  EXPECT_EQ(trace.get_ninst(), 1000);
+  EXPECT_EQ(trace.get_ninst_stats(), 900);
+  ASSERT_EQ(trace.size(), 200);
+
+  for (uint64_t i = 0; i < trace.size(); ++i) {
+    const auto &rec = trace[i];
+    EXPECT_EQ(rec.pc, 0x1000 + i * 5 * 4);
+    EXPECT_EQ(rec.target, (i % 2 == 0) ? 0x2000 + i * 5 : 0);
+    EXPECT_EQ(rec.opcode, iBALU_LBRANCH);
+    EXPECT_EQ(rec.src1, LREG_R1);
+    EXPECT_EQ(rec.stats, i * 5 >= 100);
+  }
+
+  std::remove(fname.c_str());
+}
+
+TEST(Branch_trace_test, invalid) {
+  Branch_trace missing("branch_trace_test.missing");
+  EXPECT_FALSE(missing.is_valid());
+
+  const std::string fname = "branch_trace_test.bad";
+  FILE             *fp    = fopen(fname.c_str(), "wb");
+  ASSERT_NE(fp, nullptr);
+  fprintf(fp, "not a branch trace, but long enough for a header");
+  fclose(fp);
+
+  Branch_trace bad(fname);
+  EXPECT_FALSE(bad.is_valid());
+
+  std::remove(fname.c_str());
+}
@@ -0,0 +1,116 @@
+// See LICENSE for details.
+
+#include "btb_l2.hpp"
+
+#include "config.hpp"
+#include "fmt/format.h"
+
+Btb_l2::Btb_l2(Hartid_t id, const std::string &section)
+    : delay(Config::get_integer(section, "btb_delay", 0, 64))
+    , region_bits(Config::has_entry(section, "region_bits") ? Config::get_integer(section, "region_bits", 0, 48) : 0)
+    , prefetch_size(Config::has_entry(section, "prefetch_size") ? Config::get_integer(section, "prefetch_size", 0, 4096) : 0)
+    , nHit(fmt::format("P({})_BPred_BTB2:nHit", id))
+    , nMiss(fmt::format("P({})_BPred_BTB2:nMiss", id))
+    , nPrefetchHit(fmt::format("P({})_BPred_BTB2:nPrefetchHit", id))
+    , nPrefetch(fmt::format("P({})_BPred_BTB2:nPrefetch", id))
+    , nRegionMiss(fmt::format("P({})_BPred_BTB2:nRegionMiss", id)) {
+  data = BTBCache::create(section, "btb", fmt::format("P({})_BPred_BTB2:", id));
+  I(data);
+
+  if (region_bits) {
+    regions.resize(Config::get_power2(section, "regions", 1, 1 << 16), 0);
+  }
+  region_next = 0;
+
+  pbuffer.reserve(prefetch_size);
+}
+
+Btb_l2::~Btb_l2() { data->destroy(); }
+
+Addr_t Btb_l2::encode(Addr_t target, uint16_t &region, bool doStats) {
+  region = 0;
+  if (region_bits == 0) {
+    return target;
+  }
+
+  Addr_t upper = target >> region_bits;
+  for (size_t i = 0; i < regions.size(); ++i) {
+    if (regions[i] == upper) {
+      region = i;
+      return target & ((Addr_t(1) << region_bits) - 1);
+    }
+  }
+
+  // The entries still pointing to the replaced region decode a wrong target
+  nRegionMiss.inc(doStats);
+  region               = region_next;
+  regions[region_next] = upper;
+  region_next          = (region_next + 1) % regions.size();
+
+  return target & ((Addr_t(1) << region_bits) - 1);
+}
+
+Addr_t Btb_l2::decode(uint16_t region, Addr_t target) const {
+  if (region_bits == 0) {
+    return target;
+  }
+
+  return (regions[region] << region_bits) | target;
+}
+
+bool Btb_l2::predict(Addr_t pc, Addr_t target, bool doStats, TimeDelta_t &extra) {
+  extra = 0;
+
+  auto it = pbuffer.find(pc);
+  if (it != pbuffer.end() && it->second == target) {
+    nPrefetchHit.inc(doStats);
+    return true;
+  }
+
+  BTBCache::CacheLine *cl = data->readLine(key(pc));
+  if (cl && decode(cl->region, cl->target) == target) {
+    nHit.inc(doStats);
+    extra = delay;
+    return true;
+  }
+
+  nMiss.inc(doStats);
+  return false;
+}
+
+void Btb_l2::update(Addr_t pc, Addr_t target, bool doStats) {
+  BTBCache::CacheLine *cl = data->fillLine(key(pc), 0xdeaddead);
+  I(cl);
+
+  cl->target = encode(target, cl->region, doStats);
+
+  auto it = pbuffer.find(pc);
+  if (it != pbuffer.end()) {
+    it->second = target;
+  }
+}
+
+void Btb_l2::prefetch(Addr_t addr, int line_size, bool doStats) {
+  if (prefetch_size == 0) {
+    return;
+  }
+
+  Addr_t line = addr & ~(Addr_t(line_size) - 1);
+  for (Addr_t pc = line; pc < line + line_size; pc += 2) {
+    BTBCache::CacheLine *cl = data->findLineNoEffect(key(pc));
+    if (cl == nullptr) {
+      continue;
+    }
+
+    if (!pbuffer.try_emplace(pc, decode(cl->region, cl->target)).second) {
+      continue;
+    }
+
+    nPrefetch.inc(doStats);
+    pfifo.push_back(pc);
+    if (pfifo.size() > prefetch_size) {
+      pbuffer.erase(pfifo.front());
+      pfifo.pop_front();
+    }
+  }
+}
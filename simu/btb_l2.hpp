@@ -0,0 +1,75 @@
+// See LICENSE for details.
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "cachecore.hpp"
+#include "dinst.hpp"
+#include "iassert.hpp"
+#include "stats.hpp"
+
+// Second level BTB behind the BTB of the first bpred level. A hit costs
+// btb_delay extra cycles. Targets can be stored region compressed (a small
+// region table holds the upper target bits, entries keep an index and the
+// low region_bits bits). IL1 fills can prefetch the entries of the filled
+// line into a prefetch buffer that hits like the first level BTB.
+class Btb_l2 {
+private:
+  class Btb_state : public StateGeneric<Addr_t> {
+  public:
+    Btb_state(int32_t lineSize) {
+      (void)lineSize;
+      region = 0;
+      target = 0;
+    }
+
+    uint16_t region;  // region table index (region compression only)
+    Addr_t   target;  // full target, or offset in the region
+
+    bool operator==(Btb_state s) const { return region == s.region && target == s.target; }
+  };
+
+  typedef CacheGeneric<Btb_state, Addr_t> BTBCache;
+
+  BTBCache *data;
+
+  const TimeDelta_t delay;
+  const int32_t     region_bits;  // 0 stores full targets
+  const size_t      prefetch_size;
+
+  std::vector<Addr_t> regions;  // region table, replaced round robin
+  size_t              region_next;
+
+  absl::flat_hash_map<Addr_t, Addr_t> pbuffer;  // prefetch buffer, pc to target
+  std::deque<Addr_t>                  pfifo;    // pbuffer pcs, oldest first
+
+  Stats_cntr nHit;
+  Stats_cntr nMiss;
+  Stats_cntr nPrefetchHit;
+  Stats_cntr nPrefetch;  // entries moved to the prefetch buffer
+  Stats_cntr nRegionMiss;
+
+  Addr_t encode(Addr_t target, uint16_t &region, bool doStats);
+  Addr_t decode(uint16_t region, Addr_t target) const;
+
+  static Addr_t key(Addr_t pc) { return pc >> 1; }
+
+public:
+  Btb_l2(Hartid_t id, const std::string &section);
+  ~Btb_l2();
+
+  bool has_prefetch() const { return prefetch_size > 0; }
+
+  // True when the prefetch buffer or the L2 BTB have the taken branch
+  // target. extra is set to the cycles on top of a first level BTB hit.
+  bool predict(Addr_t pc, Addr_t target, bool doStats, TimeDelta_t &extra);
+  void update(Addr_t pc, Addr_t target, bool doStats);
+
+  // The IL1 line at addr is being filled, prefetch its branches
+  void prefetch(Addr_t addr, int line_size, bool doStats);
+};
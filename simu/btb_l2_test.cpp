@@ -0,0 +1,119 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include "btb_l2.hpp"
+
+#include <fstream>
+
+#include "config.hpp"
+#include "gtest/gtest.h"
+
+class Btb_l2_test : public ::testing::Test {
+protected:
+  void SetUp() override {
+    std::ofstream file;
+
+    file.open("btb_l2_test.toml");
+    file << "[btb2]\n";
+    file << "btb_size        = 256\n";
+    file << "btb_line_size   = 1\n";
+    file << "btb_assoc       = 4\n";
+    file << "btb_repl_policy = \"LRU\"\n";
+    file << "btb_delay       = 3\n";
+    file << "prefetch_size   = 4\n";
+    file << "[btb2_region]\n";
+    file << "btb_size        = 256\n";
+    file << "btb_line_size   = 1\n";
+    file << "btb_assoc       = 4\n";
+    file << "btb_repl_policy = \"LRU\"\n";
+    file << "btb_delay       = 3\n";
+    file << "region_bits     = 12\n";
+    file << "regions         = 2\n";
+    file.close();
+
+    Config::init("btb_l2_test.toml");
+  }
+};
+
+TEST_F(Btb_l2_test, hit_delay) {
+  Btb_l2      btb(0, "btb2");
+  TimeDelta_t extra;
+
+  EXPECT_FALSE(btb.predict(0x1000, 0x2000, true, extra));
+
+  btb.update(0x1000, 0x2000, true);
+  EXPECT_TRUE(btb.predict(0x1000, 0x2000, true, extra));
+  EXPECT_EQ(extra, 3);
+
+  // Wrong target
+  EXPECT_FALSE(btb.predict(0x1000, 0x3000, true, extra));
+}
+
+TEST_F(Btb_l2_test, prefetch) {
+  Btb_l2      btb(0, "btb2");
+  TimeDelta_t extra;
+
+  EXPECT_TRUE(btb.has_prefetch());
+
+  btb.update(0x1004, 0x5000, true);
+  btb.update(0x1020, 0x6000, true);
+  btb.update(0x2000, 0x7000, true);  // other line
+
+  btb.prefetch(0x1010, 64, true);
+
+  EXPECT_TRUE(btb.predict(0x1004, 0x5000, true, extra));
+  EXPECT_EQ(extra, 0);
+  EXPECT_TRUE(btb.predict(0x1020, 0x6000, true, extra));
+  EXPECT_EQ(extra, 0);
+  EXPECT_TRUE(btb.predict(0x2000, 0x7000, true, extra));
+  EXPECT_EQ(extra, 3);
+}
+
+TEST_F(Btb_l2_test, prefetch_fifo) {
+  Btb_l2      btb(0, "btb2");
+  TimeDelta_t extra;
+
+  btb.update(0x1004, 0x5000, true);
+  btb.update(0x1020, 0x5100, true);
+  btb.update(0x2008, 0x6000, true);
+  btb.update(0x2030, 0x6100, true);
+  btb.update(0x3000, 0x7000, true);
+
+  btb.prefetch(0x1000, 64, true);
+  btb.prefetch(0x2000, 64, true);
+  btb.prefetch(0x1000, 64, true);  // already buffered, keeps its age
+
+  // Buffer full (4 entries), the oldest one is replaced
+  btb.prefetch(0x3000, 64, true);
+
+  EXPECT_TRUE(btb.predict(0x1004, 0x5000, true, extra));
+  EXPECT_EQ(extra, 3);
+  EXPECT_TRUE(btb.predict(0x1020, 0x5100, true, extra));
+  EXPECT_EQ(extra, 0);
+  EXPECT_TRUE(btb.predict(0x2030, 0x6100, true, extra));
+  EXPECT_EQ(extra, 0);
+  EXPECT_TRUE(btb.predict(0x3000, 0x7000, true, extra));
+  EXPECT_EQ(extra, 0);
+
+  // Updates reach the buffered entry
+  btb.update(0x2008, 0x6800, true);
+  EXPECT_TRUE(btb.predict(0x2008, 0x6800, true, extra));
+  EXPECT_EQ(extra, 0);
+}
+
+TEST_F(Btb_l2_test, region_compression) {
+  Btb_l2      btb(0, "btb2_region");
+  TimeDelta_t extra;
+
+  EXPECT_FALSE(btb.has_prefetch());
+
+  btb.update(0x1000, 0x10008, true);
+  btb.update(0x1004, 0x20008, true);
+  EXPECT_TRUE(btb.predict(0x1000, 0x10008, true, extra));
+  EXPECT_TRUE(btb.predict(0x1004, 0x20008, true, extra));
+
+  // A third region replaces the first one, its entries decode a wrong target
+  btb.update(0x1008, 0x30008, true);
+  EXPECT_TRUE(btb.predict(0x1008, 0x30008, true, extra));
+  EXPECT_FALSE(btb.predict(0x1000, 0x10008, true, extra));
+  EXPECT_TRUE(btb.predict(0x1004, 0x20008, true, extra));
+}
@@ -242,6 +242,19 @@ void Cluster::add_inst(Dinst *dinst) {
   window.add_inst(dinst);
 }
 
+void Cluster::squash_common(Dinst *dinst) {
+  dinst->getClusterResource()->squash(dinst);
+
+  if (dinst->isIssued() && !dinst->isExecuting()) {
+    nready--;
+  }
+
+  if (dinst->getInst()->hasDstRegister() && (!lateAlloc || dinst->isExecuting())) {
+    regPool++;
+    I(regPool <= nRegs);
+  }
+}
+
 //************ Executing Cluster
 
 void ExecutingCluster::executing(Dinst *dinst) {
@@ -281,6 +294,14 @@ bool ExecutingCluster::retire(Dinst *dinst, bool reply) {
   return true;
 }
 
+void ExecutingCluster::squash(Dinst *dinst) {
+  squash_common(dinst);
+
+  if (!dinst->isExecuting()) {
+    delEntry();
+  }
+}
+
 //************ Executed Cluster
 
 void ExecutedCluster::executing(Dinst *dinst) {
@@ -320,6 +341,14 @@ bool ExecutedCluster::retire(Dinst *dinst, bool reply) {
   return true;
 }
 
+void ExecutedCluster::squash(Dinst *dinst) {
+  squash_common(dinst);
+
+  if (!dinst->isExecuted()) {
+    delEntry();
+  }
+}
+
 //************ RetiredCluster
 
 void RetiredCluster::executing(Dinst *dinst) {
@@ -358,3 +387,9 @@ bool RetiredCluster::retire(Dinst *dinst, bool reply) {
 
   return true;
 }
+
+void RetiredCluster::squash(Dinst *dinst) {
+  squash_common(dinst);
+
+  delEntry();
+}
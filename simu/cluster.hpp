@@ -66,6 +66,10 @@ protected:
 
   Cluster(const std::string &clusterName, uint32_t pos, uint32_t cpuid);
 
+  // Resource, registers and ready count of an instruction squashed before
+  // retire. The window entry depends on the recycle point
+  void squash_common(Dinst *dinst);
+
 public:
   virtual ~Cluster();
 
@@ -76,10 +80,12 @@ public:
   }
 
   void select(Dinst *dinst);
+  void schedule_executed(Time_t when, Resource *res, Dinst *dinst) { window.schedule_executed(when, res, dinst); }
 
   virtual void executing(Dinst *dinst)           = 0;
   virtual void executed(Dinst *dinst)            = 0;
   virtual bool retire(Dinst *dinst, bool replay) = 0;
+  virtual void squash(Dinst *dinst)              = 0;
 
   static std::pair<std::shared_ptr<Cluster>, std::array<std::shared_ptr<Resource>, iMAX>> create(const std::string &clusterName,
                                                                                                  uint32_t           pos,
@@ -111,6 +117,7 @@ public:
   void executing(Dinst *dinst);
   void executed(Dinst *dinst);
   bool retire(Dinst *dinst, bool replay);
+  void squash(Dinst *dinst);
 };
 
 class ExecutedCluster : public Cluster {
@@ -122,6 +129,7 @@ public:
   void executing(Dinst *dinst);
   void executed(Dinst *dinst);
   bool retire(Dinst *dinst, bool replay);
+  void squash(Dinst *dinst);
 };
 
 class RetiredCluster : public Cluster {
@@ -132,4 +140,5 @@ public:
   void executing(Dinst *dinst);
   void executed(Dinst *dinst);
   bool retire(Dinst *dinst, bool replay);
+  void squash(Dinst *dinst);
 };
@@ -21,7 +21,7 @@ ClusterManager::ClusterManager(std::shared_ptr<Gmemory_system> ms, uint32_t cpui
 
     for (int32_t t = 0; t < iMAX; t++) {
       if (new_res[t]) {
-        res[t].push_back(new_res[t]);
+        res[t].push_back(new_res[t].get());
       }
     }
   }
@@ -18,5 +18,5 @@ protected:
 public:
   ClusterManager(std::shared_ptr<Gmemory_system> gms, uint32_t cpuid, GProcessor *gproc);
 
-  std::shared_ptr<Resource> getResource(Dinst *dinst) const { return scheduler->getResource(dinst); }
+  Resource *getResource(Dinst *dinst) const { return scheduler->getResource(dinst); }
 };
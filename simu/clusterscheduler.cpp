@@ -23,7 +23,7 @@ RoundRobinClusterScheduler::RoundRobinClusterScheduler(const ResourcesPoolType &
 
 RoundRobinClusterScheduler::~RoundRobinClusterScheduler() {}
 
-std::shared_ptr<Resource> RoundRobinClusterScheduler::getResource(Dinst *dinst) {
+Resource *RoundRobinClusterScheduler::getResource(Dinst *dinst) {
   const Instruction *inst = dinst->getInst();
   Opcode             type = inst->getOpcode();
 
@@ -44,11 +44,11 @@ LRUClusterScheduler::LRUClusterScheduler(const ResourcesPoolType &ores) : Cluste
 
 LRUClusterScheduler::~LRUClusterScheduler() {}
 
-std::shared_ptr<Resource> LRUClusterScheduler::getResource(Dinst *dinst) {
+Resource *LRUClusterScheduler::getResource(Dinst *dinst) {
   const Instruction *inst = dinst->getInst();
   Opcode             type = inst->getOpcode();
 
-  std::shared_ptr<Resource> touse = res[type][0];
+  Resource *touse = res[type][0];
 
   for (size_t i = 1; i < res[type].size(); i++) {
     if (touse->getUsedTime() > res[type][i]->getUsedTime()) {
@@ -74,7 +74,7 @@ UseClusterScheduler::UseClusterScheduler(const ResourcesPoolType &ores) : Cluste
 
 UseClusterScheduler::~UseClusterScheduler() {}
 
-std::shared_ptr<Resource> UseClusterScheduler::getResource(Dinst *dinst) {
+Resource *UseClusterScheduler::getResource(Dinst *dinst) {
   const Instruction *inst = dinst->getInst();
   Opcode             type = inst->getOpcode();
 
@@ -86,7 +86,7 @@ std::shared_ptr<Resource> UseClusterScheduler::getResource(Dinst *dinst) {
     pos[type]++;
   }
 
-  std::shared_ptr<Resource> touse = res[type][p];
+  Resource *touse = res[type][p];
 
   int touse_nintra = (cused[inst->getSrc1()] && cused[inst->getSrc1()]->get_id() != res[type][p]->getCluster()->get_id());
   touse_nintra += (cused[inst->getSrc2()] && cused[inst->getSrc2()]->get_id() != res[type][p]->getCluster()->get_id());
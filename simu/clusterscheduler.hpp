@@ -7,7 +7,8 @@
 #include "dinst.hpp"
 #include "resource.hpp"
 
-using ResourcesPoolType = std::array<std::vector<std::shared_ptr<Resource>>, iMAX>;
+// Non-owning, the resources live in Cluster::resourceMap for the whole simulation
+using ResourcesPoolType = std::array<std::vector<Resource *>, iMAX>;
 
 class ClusterScheduler {
 private:
@@ -18,7 +19,7 @@ public:
   ClusterScheduler(const ResourcesPoolType &ores);
   virtual ~ClusterScheduler();
 
-  virtual std::shared_ptr<Resource> getResource(Dinst *dinst) = 0;
+  virtual Resource *getResource(Dinst *dinst) = 0;
 };
 
 class RoundRobinClusterScheduler : public ClusterScheduler {
@@ -30,7 +31,7 @@ public:
   RoundRobinClusterScheduler(const ResourcesPoolType &res);
   ~RoundRobinClusterScheduler();
 
-  std::shared_ptr<Resource> getResource(Dinst *dinst);
+  Resource *getResource(Dinst *dinst);
 };
 
 class LRUClusterScheduler : public ClusterScheduler {
@@ -39,18 +40,18 @@ public:
   LRUClusterScheduler(const ResourcesPoolType &res);
   ~LRUClusterScheduler();
 
-  std::shared_ptr<Resource> getResource(Dinst *dinst);
+  Resource *getResource(Dinst *dinst);
 };
 
 class UseClusterScheduler : public ClusterScheduler {
 private:
-  std::vector<unsigned int>                      nres;
-  std::vector<unsigned int>                      pos;
-  std::array<std::shared_ptr<Cluster>, LREG_MAX> cused;
+  std::vector<unsigned int>       nres;
+  std::vector<unsigned int>       pos;
+  std::array<Cluster *, LREG_MAX> cused;
 
 public:
   UseClusterScheduler(const ResourcesPoolType &res);
   ~UseClusterScheduler();
 
-  std::shared_ptr<Resource> getResource(Dinst *dinst);
+  Resource *getResource(Dinst *dinst);
 };
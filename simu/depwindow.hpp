@@ -2,9 +2,14 @@
 
 #pragma once
 
+#include <deque>
+#include <memory>
+
+#include "callback.hpp"
 #include "iassert.hpp"
 #include "port.hpp"
 #include "resource.hpp"
+#include "sched_matrix.hpp"
 #include "stats.hpp"
 
 class Dinst;
@@ -21,6 +26,28 @@ private:
 
   PortGeneric *schedPort;
 
+  // Matrix scheduler (sched_matrix = true): only the select is an age
+  // matrix. Wakeup still walks the consumer lists of the producer and sets a
+  // ready slot, and a per-cycle tick selects the oldest sched_num entries
+  // (sched_occ and the sched port are not used) and drains the wheel. A
+  // woken instruction that finds the matrix full (squashed entries still
+  // hold slots until selected) waits in matrix_wait for the next tick.
+  static constexpr uint32_t WHEEL_DEPTH = 64;
+
+  std::unique_ptr<Sched_matrix> matrix;
+  std::unique_ptr<Sched_wheel>  wheel;
+  std::deque<Dinst *>           matrix_wait;
+  int32_t                       sched_width;
+  bool                          tick_pending;
+
+  Stats_cntr wheel_overflow;
+  Stats_cntr matrix_full;
+
+  void tick();
+  void wake_tick();
+
+  StaticCallbackMember0<DepWindow, &DepWindow::tick> tickCB;
+
 protected:
   void preSelect(Dinst *dinst);
 
@@ -29,6 +56,7 @@ public:
   DepWindow(uint32_t cpuid, int _src_cluster_id, const std::string &clusterName, uint32_t pos);
 
   void select(Dinst *dinst);
+  void schedule_executed(Time_t when, Resource *res, Dinst *dinst);
 
   StallCause canIssue(Dinst *dinst) const;
   void       add_inst(Dinst *dinst);
@@ -2,6 +2,9 @@
 #ifndef DOLC_H
 #define DOLC_H
 
+#include <cstdint>
+#include <vector>
+
 // #define DOLC_RLE
 
 class DOLC {
@@ -160,6 +163,24 @@ public:
 
   void setPhase(uint64_t addr) { phase = addr; }
 
+  // Speculative history checkpoint (see BPred::save_history)
+  void save(std::vector<uint64_t> &ck) const {
+    ck.insert(ck.end(), hist, hist + depth);
+    ck.push_back(phase);
+    ck.push_back((uint64_t(rl1) << 32) | (uint64_t(rl2) << 16) | rl3);
+  }
+
+  size_t restore(const std::vector<uint64_t> &ck, size_t pos) {
+    for (uint64_t i = 0; i < depth; i++) {
+      hist[i] = ck[pos++];
+    }
+    phase   = ck[pos++];
+    rl1     = ck[pos] >> 32;
+    rl2     = ck[pos] >> 16;
+    rl3     = ck[pos];
+    return pos + 1;
+  }
+
   uint64_t getSign(uint16_t bits, uint16_t m) const {
     uint16_t nbits = 0;
     uint64_t sign  = 0;
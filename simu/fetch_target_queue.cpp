@@ -0,0 +1,15 @@
+// See LICENSE for details.
+
+#include "fetch_target_queue.hpp"
+
+Fetch_target_queue::Fetch_target_queue(uint32_t size, size_t width) {
+  I(size > 0);
+
+  ring.reserve(size);
+  for (uint32_t i = 0; i < size; i++) {
+    ring.emplace_back(width);
+  }
+
+  head  = 0;
+  count = 0;
+}
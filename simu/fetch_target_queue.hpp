@@ -0,0 +1,56 @@
+// See LICENSE for details.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "dinst.hpp"
+#include "fastqueue.hpp"
+#include "iassert.hpp"
+
+// Fetch target queue of a decoupled front end. The branch predictor runs
+// ahead and appends fetch blocks, fetch consumes them in order. Entries
+// (and their instruction buffers) are reused, nothing is allocated after
+// construction.
+class Fetch_target_queue {
+public:
+  struct Block {
+    FastQueue<Dinst *> insts;
+    Time_t             predicted;  // cycle the predictor produced it
+
+    explicit Block(size_t width) : insts(width), predicted(0) {}
+  };
+
+private:
+  std::vector<Block> ring;
+  uint32_t           head;
+  uint32_t           count;
+
+public:
+  Fetch_target_queue(uint32_t size, size_t width);
+
+  bool     empty() const { return count == 0; }
+  bool     full() const { return count == ring.size(); }
+  uint32_t size() const { return count; }
+
+  // Tail entry, empty. It is not in the queue until push_back
+  Block &next() {
+    I(!full());
+    return ring[(head + count) % ring.size()];
+  }
+  void push_back() {
+    I(!full());
+    count++;
+  }
+
+  Block &front() {
+    I(!empty());
+    return ring[head];
+  }
+  void pop_front() {
+    I(!empty() && front().insts.empty());
+    head = (head + 1) % ring.size();
+    count--;
+  }
+};
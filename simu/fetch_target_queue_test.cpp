@@ -0,0 +1,43 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include "fetch_target_queue.hpp"
+
+#include "gtest/gtest.h"
+
+static Dinst *fake(uintptr_t i) { return reinterpret_cast<Dinst *>(i * 64); }
+
+TEST(Fetch_target_queue_test, fifo_wraps) {
+  Fetch_target_queue ftq(3, 5);
+
+  EXPECT_TRUE(ftq.empty());
+
+  uintptr_t produced = 1;
+  uintptr_t consumed = 1;
+  for (int round = 0; round < 10; round++) {
+    while (!ftq.full()) {
+      auto &b = ftq.next();
+      EXPECT_TRUE(b.insts.empty());  // reused entries come back drained
+      b.insts.push(fake(produced++));
+      b.insts.push(fake(produced++));
+      b.predicted = round;
+      ftq.push_back();
+    }
+    EXPECT_EQ(ftq.size(), 3);
+
+    auto &b = ftq.front();
+    while (!b.insts.empty()) {
+      EXPECT_EQ(b.insts.top(), fake(consumed++));
+      b.insts.pop();
+    }
+    ftq.pop_front();
+  }
+}
+
+TEST(Fetch_target_queue_test, next_is_not_queued) {
+  Fetch_target_queue ftq(2, 4);
+
+  ftq.next().insts.push(fake(1));
+  EXPECT_TRUE(ftq.empty());
+  ftq.push_back();
+  EXPECT_EQ(ftq.front().insts.top(), fake(1));
+}
@@ -36,6 +36,13 @@ FetchEngine::FetchEngine(Hartid_t id, std::shared_ptr<Gmemory_system> gms_, std:
     , nDelayInst3(fmt::format("({})_FetchEngine:nDelayInst3", id))
     , nBTAC(fmt::format("({})_FetchEngine:nBTAC", id))  // BTAC corrections to BTB
     , zeroDinst(fmt::format("({})_zeroDinst:nBTAC", id))
+    , avgFTQOccupancy(fmt::format("({})_FetchEngine_avgFTQOccupancy", id))
+    , nFTQPrefetch(fmt::format("({})_FetchEngine:nFTQPrefetch", id))
+    , nFTQEmpty(fmt::format("({})_FetchEngine:nFTQEmpty", id))
+    , nWrongPath(fmt::format("({})_FetchEngine:nWrongPath", id))
+    , nWrongPathLoad(fmt::format("({})_FetchEngine:nWrongPathLoad", id))
+    , nWrongPathRename(fmt::format("({})_FetchEngine:nWrongPathRename", id))
+    , nWrongPathSquash(fmt::format("({})_FetchEngine:nWrongPathSquash", id))
 #ifdef ESESC_TRACE_DATA
     , dataHist(fmt::format("({})_dataHist", id))
     , dataSignHist(fmt::format("({})_dataSignHist", id))
@@ -90,6 +97,28 @@ FetchEngine::FetchEngine(Hartid_t id, std::shared_ptr<Gmemory_system> gms_, std:
 
   lastMissTime = 0;
 
+  fdip_l2 = false;
+  if (Config::has_entry("soc", "core", id, "fdip") && Config::get_bool("soc", "core", id, "fdip")) {
+    ftq     = std::make_unique<Fetch_target_queue>(Config::get_integer("soc", "core", id, "ftq_size", 1, 64), fetch_width + 1);
+    fdip_l2 = Config::has_entry("soc", "core", id, "fdip_l2") && Config::get_bool("soc", "core", id, "fdip_l2");
+  }
+
+  decode_delay     = Config::get_integer("soc", "core", id, "decode_delay");
+  uop_switch_until = 0;
+  if (Config::has_entry("soc", "core", id, "uop_cache")) {
+    uop = std::make_unique<Uop_cache>(id, Config::get_string("soc", "core", id, "uop_cache"));
+  }
+
+  wrong_path_size = 0;
+  if (Config::has_entry("soc", "core", id, "wrong_path_size")) {
+    wrong_path_size = Config::get_integer("soc", "core", id, "wrong_path_size", 0, 4096);
+  }
+  wrong_path_delay = decode_delay + Config::get_integer("soc", "core", id, "rename_delay");
+  wp_rename        = false;
+  wp_branch        = nullptr;
+  wp_fetched       = 0;
+  wp_last_line     = 0;
+
 #ifdef ENABLE_LDBP
   DL1            = gms->getDL1();
   dep_pc         = 0;
@@ -178,7 +207,7 @@ void FetchEngine::chainLoadDone(Dinst *dinst) {
 #endif
 }
 
-void FetchEngine::realfetch(IBucket *bucket, std::shared_ptr<Emul_base> eint, Hartid_t fid, int32_t n2Fetch) {
+void FetchEngine::realfetch(FastQueue<Dinst *> *bucket, std::shared_ptr<Emul_base> eint, Hartid_t fid, int32_t n2Fetch) {
   Addr_t lastpc = 0;
 
 #ifdef USE_FUSE
@@ -642,8 +671,10 @@ void FetchEngine::realfetch(IBucket *bucket, std::shared_ptr<Emul_base> eint, Ha
     lastpc = dinst->getPC();
 
     eint->execute(fid);
-    Tracer::stage(dinst, "IF");
-    dinst->setFetchTime();
+    if (!ftq) {  // otherwise when fetch consumes the block
+      Tracer::stage(dinst, "IF");
+      dinst->setFetchTime();
+    }
     bucket->push(dinst);
 
 #ifdef USE_FUSE
@@ -665,6 +696,10 @@ void FetchEngine::realfetch(IBucket *bucket, std::shared_ptr<Emul_base> eint, Ha
 
     if (dinst->getInst()->isControl()) {
       bool stall_fetch = processBranch(dinst, n2Fetch);
+      if (stall_fetch && (dinst->isBranchMiss() || dinst->isBranchMiss_level1())) {
+        // Resolved at execute, or the first level path until a later level overrides it
+        start_wrong_path(eint, fid, dinst);
+      }
       if (stall_fetch) {
 #ifdef FETCH_TRACE
         if (dinst->isBiasBranch() && dinst->getFetchEngine()) {
@@ -704,9 +739,25 @@ void FetchEngine::realfetch(IBucket *bucket, std::shared_ptr<Emul_base> eint, Ha
   } while (n2Fetch > 0);
 
   bpred->fetchBoundaryEnd();
+}
+
+void FetchEngine::send_il1(IBucket *bucket) {
+  if (uop && !bucket->empty()) {
+    TimeDelta_t penalty = 0;
+    auto        src     = uop->access(*bucket, penalty);
+    if (penalty) {
+      uop_switch_until = globalClock + penalty;
+    }
+    if (src != Uop_cache::Source::Decode) {
+      bucket->set_bypass(decode_delay);
+      bucket->markFetchedCB.schedule(1);
+      return;
+    }
+  }
 
   if (il1_enable && !bucket->empty()) {
     avgFetched.sample(bucket->size(), bucket->top()->has_stats());
+    prefetch_btb(bucket->top()->getPC(), bucket->top()->has_stats());
     MemRequest::sendReqRead(gms->getIL1(),
                             bucket->top()->has_stats(),
                             bucket->top()->getPC(),
@@ -808,9 +859,193 @@ void FetchEngine::fetch(IBucket *bucket, std::shared_ptr<Emul_base> eint, Hartid
   // Reset the max number of BB to fetch in this cycle (decreased in processBranch)
   maxBB = max_bb_cycle;
 
+  if (ftq) {
+    fetch_ftq(bucket);
+    return;
+  }
+
   // You pass maxBB because there may be many fetches calls to realfetch in one cycle
   // (thanks to the callbacks)
   realfetch(bucket, eint, fid, fetch_width);
+  send_il1(bucket);
+}
+
+void FetchEngine::predict(std::shared_ptr<Emul_base> eint, Hartid_t fid) {
+  if (!ftq) {
+    return;
+  }
+
+  avgFTQOccupancy.sample(ftq->size(), true);
+
+  // One fetch block per cycle, stop at a misprediction (no wrong path)
+  if (missInst || ftq->full()) {
+    return;
+  }
+
+  maxBB = max_bb_cycle;
+
+  auto &block = ftq->next();
+  realfetch(&block.insts, eint, fid, fetch_width);
+  if (block.insts.empty()) {
+    return;
+  }
+
+  block.predicted = globalClock;
+  prefetch_block(block.insts, block.insts.top()->has_stats());
+  ftq->push_back();
+}
+
+void FetchEngine::start_wrong_path(std::shared_ptr<Emul_base> eint, Hartid_t fid, Dinst *dinst) {
+  if (wrong_path_size == 0) {
+    return;
+  }
+
+  I(wp_insts.empty());
+  wp_branch    = dinst;
+  wp_fetched   = 0;
+  wp_last_line = 0;
+  if (!eint->fork_wrong_path(fid, dinst, wp_ctx)) {
+    wp_ctx.done = true;
+  }
+}
+
+bool FetchEngine::wrong_path_renames() const {
+  return wp_rename && wp_branch && wp_branch->isBranchMiss() && wp_branch->isRenamed() && wp_branch->hasCheckpoint();
+}
+
+Dinst *FetchEngine::wrong_path_next() const {
+  if (wp_insts.empty() || wp_insts.front().ready > globalClock || !wrong_path_renames()) {
+    return nullptr;
+  }
+  return wp_insts.front().dinst;
+}
+
+void FetchEngine::wrong_path_renamed() {
+  nWrongPathRename.inc(wp_insts.front().dinst->has_stats());
+  wp_insts.pop_front();
+}
+
+void FetchEngine::fetch_wrong_path(std::shared_ptr<Emul_base> eint, Hartid_t fid) {
+  // Instructions that went through decode. A miss that renames its wrong
+  // path keeps them for rename, otherwise only the loads reach the DL1
+  while (!wp_insts.empty() && wp_insts.front().ready <= globalClock) {
+    if (wp_rename && wp_branch->isBranchMiss() && (!wp_branch->isRenamed() || wp_branch->hasCheckpoint())) {
+      break;  // wait for the branch to rename, then for wrong_path_next
+    }
+    auto e = wp_insts.front();
+    wp_insts.pop_front();
+
+    if (e.dinst->getInst()->isLoad() && e.addr_known) {
+      nWrongPathLoad.inc(e.dinst->has_stats());
+      MemRequest::sendReqRead(gms->getDL1(), e.dinst->has_stats(), e.dinst->getAddr(), e.dinst->getPC());
+    }
+    e.dinst->scrap();
+  }
+
+  if (wp_ctx.done || !missInst) {
+    return;
+  }
+
+  for (int i = 0; i < fetch_width && wp_fetched < wrong_path_size; ++i) {
+    Dinst *dinst = eint->peek_wrong_path(fid, wp_ctx);
+    if (dinst == nullptr) {
+      return;
+    }
+    Addr_t pc       = wp_ctx.pc;
+    Addr_t fallthru = pc + ((wp_ctx.insn & 0x3) == 0x3 ? 4 : 2);
+    eint->execute_wrong_path(fid, wp_ctx);
+    wp_fetched++;
+    nWrongPath.inc(dinst->has_stats());
+
+    Addr_t line = dinst->getPC() >> il1_line_bits;
+    if (il1_enable && line != wp_last_line) {
+      wp_last_line = line;
+      MemRequest::sendReqRead(gms->getIL1(), dinst->has_stats(), dinst->getPC(), 0xdeaddead);
+    }
+
+    // The decoded address is the branch target whatever the direction, the
+    // wrong path evaluation gives the direction (unknown if the path ended on it)
+    bool resolved = !wp_ctx.done || wp_ctx.pc != pc;
+    if (dinst->getInst()->isControl() && resolved) {
+      bpred->speculate(dinst, wp_ctx.pc != fallthru);  // undone by the restore in clearMissInst
+    }
+
+    if (wp_rename) {
+      if (dinst->getInst()->isMemory() && !wp_ctx.addr_known) {
+        dinst->scrap();  // it can not enter the LSQ, the path ends here
+        wp_ctx.done = true;
+        return;
+      }
+      dinst->setFetchTime();
+      wp_insts.push_back({dinst, globalClock + wrong_path_delay, wp_ctx.addr_known});
+    } else if (dinst->getInst()->isLoad() && wp_ctx.addr_known) {
+      wp_insts.push_back({dinst, globalClock + wrong_path_delay, true});
+    } else {
+      dinst->scrap();
+    }
+
+    if (wp_ctx.done) {
+      return;
+    }
+  }
+}
+
+void FetchEngine::squash_wrong_path() {
+  wp_ctx.done = true;
+  wp_branch   = nullptr;
+  for (auto &e : wp_insts) {
+    nWrongPathSquash.inc(e.dinst->has_stats());
+    e.dinst->scrap();
+  }
+  wp_insts.clear();
+}
+
+void FetchEngine::prefetch_block(const FastQueue<Dinst *> &insts, bool doStats) {
+  Addr_t last_line = 0;
+  for (uint32_t id = insts.getIDFromTop(0); !insts.isEnd(id); id = insts.getNextId(id)) {
+    Addr_t pc   = insts.getData(id)->getPC();
+    Addr_t line = pc >> il1_line_bits;
+    if (line == last_line) {
+      continue;
+    }
+    last_line = line;
+
+    nFTQPrefetch.inc(doStats);
+    prefetch_btb(pc, doStats);
+    if (fdip_l2) {
+      gms->getIL1()->getRouter()->tryPrefetch(line << il1_line_bits, doStats, 1, PSIGN_FDIP, pc);
+    }
+    gms->getIL1()->tryPrefetch(line << il1_line_bits, doStats, 1, PSIGN_FDIP, pc);
+  }
+}
+
+// IL1 fills bring the L2 BTB entries of the line closer (btb_l2 prefetch_size)
+void FetchEngine::prefetch_btb(Addr_t addr, bool doStats) {
+  if (!bpred->has_btb_prefetch() || !gms->getIL1()->Invalid(addr)) {
+    return;
+  }
+
+  bpred->btb_prefetch(addr, il1_line_size, doStats);
+}
+
+void FetchEngine::fetch_ftq(IBucket *bucket) {
+  if (ftq->empty()) {
+    nFTQEmpty.inc(true);
+    return;
+  }
+
+  auto &block = ftq->front();
+  while (!block.insts.empty()) {
+    Dinst *dinst = block.insts.top();
+    block.insts.pop();
+
+    Tracer::stage(dinst, "IF");
+    dinst->setFetchTime();
+    bucket->push(dinst);
+  }
+  ftq->pop_front();
+
+  send_il1(bucket);
 }
 
 void FetchEngine::dump(const std::string &str) const { bpred->dump(str + "_FE"); }
@@ -842,9 +1077,12 @@ void FetchEngine::unBlockFetch(Dinst *dinst, Time_t missFetchTime) {
 }
 
 void FetchEngine::clearMissInst(Dinst *dinst, Time_t missFetchTime) {
-  (void)dinst;
   (void)missFetchTime;
 
+  // Fetch restarts after dinst, repair the history from its checkpoint
+  bpred->restore(dinst->getID(), dinst->has_stats());
+  squash_wrong_path();
+
   I(missInst);
   missInst = false;
 
@@ -5,6 +5,8 @@
 #include "addresspredictor.hpp"
 #include "bpred.hpp"
 #include "emul_base.hpp"
+#include "fetch_target_queue.hpp"
+#include "uop_cache.hpp"
 #include "gmemory_system.hpp"
 #include "iassert.hpp"
 #include "stats.hpp"
@@ -116,6 +118,57 @@ private:
 
   bool il1_enable;
 
+  // Decoupled front end (fdip): predict fills ftq ahead of fetch, and each
+  // predicted block prefetches its IL1 lines (and L2 with fdip_l2)
+  std::unique_ptr<Fetch_target_queue> ftq;
+  bool                                fdip_l2;
+
+  // Optional uop cache and loop buffer (uop_cache section)
+  std::unique_ptr<Uop_cache> uop;
+  TimeDelta_t                decode_delay;
+  Time_t                     uop_switch_until;
+
+  // Wrong path (wrong_path_size): while an unfixed conditional branch
+  // misprediction waits to resolve, or while a later bpred level overrides
+  // the first one, up to wrong_path_size instructions are fetched down the
+  // other direction and the IL1 sees their lines. They are ready for rename
+  // after the decode and rename delay.
+  //
+  // With wp_rename (an OoO core with branch checkpoints), once the missed
+  // branch renamed with a checkpoint the core renames them: they take ROB,
+  // window, LSQ and register entries, execute, and their loads reach the
+  // DL1 and the MSHRs until the branch squashes them. The path ends at a
+  // memory access with an unknown address. Otherwise (a level 1 override, no
+  // checkpoint left, in-order or SMT cores) only the cache pollution is
+  // modeled: the loads are sent to the DL1 and nothing enters rename.
+  //
+  // The wrong path Dinsts take IDs like any other. Fetch is stopped behind
+  // the missed branch (predict stops at it too), so their IDs are above the
+  // branch and below the correct path that restarts after it: the ROB, the
+  // checkpoints and the LSQ still see IDs in program order.
+  struct Wrong_path_inst {
+    Dinst *dinst;
+    Time_t ready;
+    bool   addr_known;
+  };
+  int32_t                     wrong_path_size;
+  TimeDelta_t                 wrong_path_delay;
+  bool                        wp_rename;
+  Wrong_path_context          wp_ctx;
+  Dinst                      *wp_branch;
+  int32_t                     wp_fetched;
+  Addr_t                      wp_last_line;
+  std::deque<Wrong_path_inst> wp_insts;
+
+  void start_wrong_path(std::shared_ptr<Emul_base> eint, Hartid_t fid, Dinst *dinst);
+  void squash_wrong_path();
+  bool wrong_path_renames() const;
+
+  void prefetch_block(const FastQueue<Dinst *> &insts, bool doStats);
+  void prefetch_btb(Addr_t addr, bool doStats);
+  void fetch_ftq(IBucket *bucket);
+  void send_il1(IBucket *bucket);
+
 protected:
   // bool processBranch(Dinst *dinst, uint16_t n2Fetched);
   bool processBranch(Dinst *dinst, uint16_t n2Fetchedi);
@@ -131,6 +184,13 @@ protected:
   Stats_cntr nDelayInst3;
   Stats_cntr nBTAC;
   Stats_cntr zeroDinst;
+  Stats_avg  avgFTQOccupancy;
+  Stats_cntr nFTQPrefetch;
+  Stats_cntr nFTQEmpty;
+  Stats_cntr nWrongPath;
+  Stats_cntr nWrongPathLoad;
+  Stats_cntr nWrongPathRename;
+  Stats_cntr nWrongPathSquash;
 #ifdef ESESC_TRACE_DATA
   Stats_hist dataHist;
   Stats_hist dataSignHist;
@@ -166,7 +226,19 @@ public:
 
   typedef CallbackMember3<FetchEngine, IBucket *, std::shared_ptr<Emul_base>, Hartid_t, &FetchEngine::fetch> fetchCB;
 
-  void realfetch(IBucket *buffer, std::shared_ptr<Emul_base> eint, Hartid_t fid, int32_t n2Fetched);
+  void realfetch(FastQueue<Dinst *> *buffer, std::shared_ptr<Emul_base> eint, Hartid_t fid, int32_t n2Fetched);
+
+  // Branch prediction stage of the decoupled front end, called every cycle
+  // even when fetch stalls
+  void predict(std::shared_ptr<Emul_base> eint, Hartid_t fid);
+
+  // Wrong path fetch and load issue (wrong_path_size), called every cycle
+  void fetch_wrong_path(std::shared_ptr<Emul_base> eint, Hartid_t fid);
+
+  // Wrong path rename: the core renames them past a checkpointed miss
+  void   enable_wrong_path_rename() { wp_rename = wrong_path_size > 0; }
+  Dinst *wrong_path_next() const;  // ready for rename, or nullptr
+  void   wrong_path_renamed();     // pops wrong_path_next()
 
   void chainPrefDone(Addr_t pc, int distance, Addr_t addr);
   void chainLoadDone(Dinst *dinst);
@@ -188,7 +260,16 @@ public:
 
   void dump(const std::string &str) const;
 
-  bool isBlocked() const { return missInst; }
+  // Nothing to fetch this cycle
+  bool isBlocked() const {
+    if (uop_switch_until > globalClock) {
+      return true;
+    }
+    if (ftq) {
+      return ftq->empty() || ftq->front().predicted >= globalClock;
+    }
+    return missInst;
+  }
 #ifndef NDEBUG
   Dinst *getMissDinst() const { return missDinst; }
 #endif
@@ -43,6 +43,10 @@ void GProcessor::fetch() {
   I(eint);
   I(is_power_up());
 
+  // The decoupled front end predicts ahead even when fetch stalls
+  smt_fetch.fe[smt_fetch.smt_turn]->predict(eint, hid);
+  smt_fetch.fe[smt_fetch.smt_turn]->fetch_wrong_path(eint, hid);
+
   if (spaceInInstQueue < FetchWidth) {
     return;
   }
@@ -131,6 +135,25 @@ void GProcessor::buildInstStats(const std::string &txt) {
   }
 }
 
+int32_t GProcessor::add_inst_group(IBucket *bucket, int32_t max, StallCause &stall) {
+  int32_t n = 0;
+
+  while (n < max && !bucket->empty()) {
+    Dinst *dinst = bucket->top();
+
+    dinst->setGProc(this);
+    stall = add_inst(dinst);
+    if (stall != NoStall) {
+      return n;
+    }
+    n++;
+
+    bucket->pop();
+  }
+
+  return n;
+}
+
 int32_t GProcessor::issue() {
   int32_t i = 0;  // Instructions executed counter
 
@@ -138,29 +161,22 @@ int32_t GProcessor::issue() {
 
   do {
     IBucket *bucket = pipeQ.instQueue.top();
-    do {
-      I(!bucket->empty());
-      if (i >= IssueWidth) {
-        return i;
-      }
-
-      I(!bucket->empty());
-
-      Dinst *dinst = bucket->top();
+    I(!bucket->empty());
+    if (i >= IssueWidth) {
+      return i;
+    }
 
-      StallCause c = add_inst(dinst);
-      if (c != NoStall) {
-        if (i < RealisticWidth) {
-          nStall[c]->add(RealisticWidth - i, dinst->has_stats());
-        }
-        return i;
+    StallCause c = NoStall;
+    i += add_inst_group(bucket, IssueWidth - i, c);
+    if (c != NoStall) {
+      if (i < RealisticWidth) {
+        nStall[c]->add(RealisticWidth - i, bucket->top()->has_stats());
       }
-      dinst->setGProc(this);
-      i++;
-
-      bucket->pop();
-
-    } while (!bucket->empty());
+      return i;
+    }
+    if (!bucket->empty()) {
+      return i;  // IssueWidth reached
+    }
 
     pipeQ.pipeLine.doneItem(bucket);
     pipeQ.instQueue.pop();
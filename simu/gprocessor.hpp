@@ -102,6 +102,9 @@ protected:
   void    fetch();
 
   virtual StallCause add_inst(Dinst *dinst) = 0;
+  // Renames up to max instructions from the head of bucket and pops them.
+  // Returns how many were renamed; stall is set if it stopped at a stall.
+  virtual int32_t add_inst_group(IBucket *bucket, int32_t max, StallCause &stall);
 
   bool use_stats;  // Stats mode to use when dinst->has_stats() is not available
 
@@ -129,6 +132,13 @@ public:
 
   virtual void replay(Dinst *target) { (void)target; };  // = 0;
 
+  // Extra cycles to read the source registers of dinst at cycle when
+  virtual TimeDelta_t reg_read_delay(Dinst *dinst, Time_t when) {
+    (void)dinst;
+    (void)when;
+    return 0;
+  }
+
   bool isROBEmpty() const { return (ROB.empty() && rROB.empty()); }
   int  getROBsize() const { return (ROB.size() + rROB.size()); }
   bool isROBEmptyOnly() const { return ROB.empty(); }
@@ -24,8 +24,8 @@
 // #define STRICTSIZE
 //  uncomment to get the 256 Kbits record predictor mentioned in the paper achieves 2.228 MPKI
 
-// #define POSTPREDICT
-//  uncomment to get a realistic predictor around 256 Kbits , with 12 1024 entries tagged tables in the TAGE predictor, and a global
+// post_predict = true in the bpred section
+//  to get a realistic predictor around 256 Kbits , with 12 1024 entries tagged tables in the TAGE predictor, and a global
 //  history and single local history GEHL statistical corrector total misprediction numbers TAGE-SC-L : 2.435 MPKI TAGE-SC-L  +
 //  IMLI: 2.294 MPKI TAGE-GSC + IMLI: 2.370 MPKI TAGE-GSC : 2.531 MPKI TAGE alone: 2.602 MPKI
 
@@ -34,117 +34,44 @@
 #include <inttypes.h>
 #include <math.h>
 
+#include <algorithm>
+#include <memory>
 #include <vector>
 
 #include "dinst.hpp"  // Addr_t and Opcode
 #include "dolc.hpp"
-
-// #define MEDIUM_TAGE 1
-// #define IMLI_150K 1
-#define IMLI_256K 1
-// #define MEGA_IMLI 1
-
-#if defined(MEGA_IMLI) && defined(MEDIUM_TAGE)
-#error "Pick one"
-#endif
+#include "tage_history.hpp"
 
 #define SIMPLER_DOLC_PATH
 
-#ifdef MEDIUM_TAGE
-// #define LOOPPREDICTOR //  use loop  predictor
-// #define LOCALH			// use local histories
-// #define IMLI			// using IMLI component
-// #define IMLISIC            //use IMLI-SIC
-// #define IMLIOH		//use IMLI-OH
-#define LOGG  10 /* logsize of the  tagged TAGE tables*/
-#define TBITS 13 /* minimum tag width*/
-// #define USE_DOLC 1
-
-#elif MEGA_IMLI        // 1M IMLI
-// nhist = 9
-#define LOOPPREDICTOR  //  use loop  predictor
-#define LOCALH         // use local histories
-#define IMLI           // using IMLI component
-#define IMLISIC        // use IMLI-SIC
-#define IMLIOH         // use IMLI-OH
-#define LOGG    12     // logsize of the  tagged TAGE tables
-#define TBITS   22     // minimum tag width
-#define MAXHIST 400
-#define MINHIST 5
-
-#elif IMLI_256K
-// nhist = 6
-#define LOOPPREDICTOR  //  use loop  predictor
-#define LOCALH         // use local histories
-#define IMLI           // using IMLI component
-#define IMLISIC        // use IMLI-SIC
-#define IMLIOH         // use IMLI-OH
-#define LOGG    11     // logsize of the  tagged TAGE tables
-#define TBITS   16     // minimum tag width
-#define MAXHIST 200
-#define MINHIST 5
-
-#elif IMLI_150K
-// nhist = 4
-#define LOOPPREDICTOR  //  use loop  predictor
-#define LOCALH         // use local histories
-#define IMLI           // using IMLI component
-#define IMLISIC        // use IMLI-SIC
-#define IMLIOH         // use IMLI-OH
-#define LOGG    11     // 11       // logsize of the  tagged TAGE tables
-#define TBITS   13     // 16      // minimum tag width
-#define MAXHIST 160
-#define MINHIST 5
-#else
-// nhist = 7, glength
-#define LOOPPREDICTOR  //  use loop  predictor
-#define LOCALH         // use local histories
-#define IMLI           // using IMLI component
-#define IMLISIC        // use IMLI-SIC
-#define IMLIOH         // use IMLI-OH
-#define LOGG    12     /* logsize of the  tagged TAGE tables*/
-#define TBITS   13     /* minimum tag width*/
-#define MAXHIST 200    // 200
-#define MINHIST 5
-#endif
-
-/*
-#ifdef MEGA_IMLI
-// use 20 tables (nhist = 20)
-#define LOOPPREDICTOR //  use loop  predictor
-#define LOCALH        // use local histories
-#define IMLI          // using IMLI component
-#define IMLISIC       // use IMLI-SIC
-#define IMLIOH        // use IMLI-OH
-#define LOGG 13       // logsize of the  tagged TAGE tables
-#define TBITS 14      // minimum tag width
-#define MAXHIST 400
-#define MINHIST 5
-#endif
-*/
-// To get the predictor storage budget on stderr  uncomment the next line
+// Geometry and optional components of the predictor, read from the bpred
+// section (see BPIMLI). The defaults are the 256Kbits TAGE-SC-L + IMLI.
+// Other budgets of the paper:
+//   medium TAGE: logg=10 tbits=13 minhist=1 maxhist=71, no loop/local/imli
+//   150Kbits:    logg=11 tbits=13 minhist=5 maxhist=160
+//   1Mbits:      logg=12 tbits=22 minhist=5 maxhist=400
+struct Imli_geometry {
+  int  nhist       = 6;
+  int  logg        = 11;   // log2 entries of each tagged TAGE table
+  int  tbits       = 16;   // minimum tag width
+  int  minhist     = 5;    // shortest history length
+  int  maxhist     = 200;  // longest history length
+  bool sc          = true;  // statistical corrector
+  bool loop        = true;  // loop predictor
+  bool local       = true;  // local history in the statistical corrector
+  bool imli        = true;  // IMLI counter
+  bool imli_sic    = true;  // IMLI-SIC component (needs imli)
+  bool imli_oh     = true;  // IMLI-OH component (needs imli)
+  bool postpredict = false;
+};
 
 #define SUBENTRIES 1
 
 #define UWIDTH 1
 #define CWIDTH 3
 
-// use geometric history length
-#ifndef MAXHIST
 #ifdef USE_DOLC
-#define MAXHIST 71
-#define MINHIST 5
-#else
-// #define MINHIST 7
-// #define MAXHIST 1000
-#define MINHIST 1
-#define MAXHIST 71
-#endif
-#endif
-// probably not the best history length, but nice
-
-#ifdef USE_DOLC
-DOLC idolc(MAXHIST, 1, 6, 18);
+DOLC idolc(71, 1, 6, 18);
 #endif
 
 #ifndef STRICTSIZE
@@ -152,93 +79,51 @@ DOLC idolc(MAXHIST, 1, 6, 18);
 #else
 #define PERCWIDTH 7  // appears as a reasonably efficient way to use the last available bits
 #endif
-// The statistical corrector components from CBP4
+// The statistical corrector components from CBP4. The table shapes are
+// fixed, the tables are IMLIBest members.
 
 // global branch GEHL
 #ifdef LARGE_SC
 #define LOGGNB 9
+#define GNB    4
+#define GM     {27, 22, 17, 14}
 #else
 #define LOGGNB 10
-#endif
-
-#ifdef IMLI
-#ifdef STRICTSIZE
-#define GNB 2
-int Gm[GNB] = {17, 14};
-#else
-#ifdef LARGE_SC
-#define GNB 4
-int Gm[GNB] = {27, 22, 17, 14};
-#else
-#define GNB 2
-int Gm[GNB] = {17, 14};
-#endif
-#endif
-#else
-#ifdef LARGE_SC
-#define GNB 4
-int Gm[GNB] = {27, 22, 17, 14};
-#else
-#define GNB 2
-int Gm[GNB] = {17, 14};
-#endif
-
+#define GNB    2
+#define GM     {17, 14}
 #endif
 /*effective length is  -11,  we use (GHIST<<11)+IMLIcount; we force the IMLIcount zero when IMLI is not used*/
 
-int8_t  GGEHLA[GNB][(1 << LOGGNB)];
-int8_t *GGEHL[GNB];
-
 // large local history
 #define LOGLOCAL 8
 #define NLOCAL   (1 << LOGLOCAL)
 #define INDLOCAL (PC & (NLOCAL - 1))
 #ifdef LARGE_SC
 // three different local histories (just completely crazy :-)
-
 #define LOGLNB 10
 #define LNB    3
-int     Lm[LNB] = {11, 6, 3};
-int8_t  LGEHLA[LNB][(1 << LOGLNB)];
-int8_t *LGEHL[LNB];
+#define LM     {11, 6, 3}
 #else
 // only one local history
 #define LOGLNB 10
 #define LNB    4
-int     Lm[LNB] = {16, 11, 6, 3};
-int8_t  LGEHLA[LNB][(1 << LOGLNB)];
-int8_t *LGEHL[LNB];
+#define LM     {16, 11, 6, 3}
 #endif
 
-// small local history
-#define LOGSECLOCAL 4
-#define NSECLOCAL   (1 << LOGSECLOCAL)  // Number of second local histories
-#define INDSLOCAL   (((PC ^ (PC >> 5))) & (NSECLOCAL - 1))
-#define LOGSNB      9
-#define SNB         4
-int     Sm[SNB] = {16, 11, 6, 3};
-int8_t  SGEHLA[SNB][(1 << LOGSNB)];
-int8_t *SGEHL[SNB];
-
-// third local history
-#define LOGTNB 9
+// small and third local histories (only in the storage budget)
+#define NSECLOCAL (1 << 4)
+#define LOGSNB    9
+#define SNB       4
+#define SM0       16
+#define LOGTNB    9
 #ifdef STRICTSIZE
 #define TNB 2
-int Tm[TNB] = {17, 14};
+#define TM0 17
 #else
 #define TNB 3
-int     Tm[TNB] = {22, 17, 14};
+#define TM0 22
 #endif
-// effective local history size +11: we use IMLIcount + (LH) << 11
-int8_t  TGEHLA[TNB][(1 << LOGTNB)];
-int8_t *TGEHL[TNB];
-#define INDTLOCAL (((PC ^ (PC >> 3))) & (NSECLOCAL - 1))  // different hash for the 3rd history
-
-long long L_shist[NLOCAL];
-long long S_slhist[NSECLOCAL];
-long long T_slhist[NSECLOCAL];
-long long HSTACK[16];
-int       pthstack;
+
 #ifdef LARGE_SC
 // return-stack associated history component
 #ifdef STRICTSIZE
@@ -247,17 +132,12 @@ int       pthstack;
 #define LOGPNB 9
 #endif
 #define PNB 4
-int     Pm[PNB] = {16, 11, 6, 3};
-int8_t  PGEHLA[PNB][(1 << LOGPNB)];
-int8_t *PGEHL[PNB];
+#define PM  {16, 11, 6, 3}
 #else
-// in this case we dont use the call stack
+// in this case we don't use the call stack
 #define PNB    2
 #define LOGPNB 11
-int Pm[PNB] = {16, 11};
-
-int8_t  PGEHLA[PNB][(1 << LOGPNB)];
-int8_t *PGEHL[PNB];
+#define PM     {16, 11}
 #endif
 
 // parameters of the loop predictor
@@ -267,16 +147,11 @@ int8_t *PGEHL[PNB];
 
 // update threshold for the statistical corrector
 #define LOGSIZEUP 0
-int Pupdatethreshold[(1 << LOGSIZEUP)];  // size is fixed by LOGSIZEUP
-#define INDUPD (PC & ((1 << LOGSIZEUP) - 1))
+#define INDUPD    (PC & ((1 << LOGSIZEUP) - 1))
 
-// The three counters used to choose between TAGE ang SC on High Conf TAGE/Low Conf SC
-int8_t FirstH, SecondH, ThirdH;
 #define CONFWIDTH  7   // for the counters in the choser
 #define PHISTWIDTH 27  // width of the path history used in TAGE
 
-#define HISTBUFFERLENGTH 4096  // we use a 4K entries history buffer to store the branch history
-
 // the counter(s) to chose between longest match and alternate prediction on TAGE when weak counters
 // #define LOGSIZEUSEALT 0
 #define LOGSIZEUSEALT 2
@@ -313,7 +188,6 @@ public:
   void mix(unsigned c) { comp ^= (c) & ((1 << CLENGTH) - 1); }
 };
 
-#ifdef LOOPPREDICTOR
 class lentry {
 public:
   uint16_t NbIter;       // 10 bits
@@ -334,7 +208,6 @@ public:
     dir         = false;
   }
 };
-#endif
 
 class Bimodal {
 private:
@@ -400,11 +273,14 @@ public:
 
 // TODO: Convert this class to GTable class that includes subtables inside
 class gentry {
+public:
+  static constexpr int MAXSUB = 4;
+
 private:
-  int                   nsub;
-  std::vector<int8_t>   ctr;
-  std::vector<int8_t>   u;
-  std::vector<uint16_t> boff;  // Signature per branch in the entry
+  int      nsub;
+  int8_t   ctr[MAXSUB + 1];  // +1, last means unused
+  int8_t   u[MAXSUB + 1];
+  uint16_t boff[MAXSUB + 1];  // Signature per branch in the entry
 
 public:
   uint32_t tag;
@@ -419,11 +295,18 @@ public:
 #ifndef SUBENTRIES
     n = 1;
 #endif
+    I(n <= MAXSUB);
     nsub = n;
-    ctr.resize(n + 1, 0);  // +1, last means unused
-    u.resize(n + 1, 0);
-    boff.resize(n + 1, 0xFFFF);
-    tag = 0;
+    for (int i = 0; i <= n; i++) {
+      ctr[i]  = 0;
+      u[i]    = 0;
+      boff[i] = 0xFFFF;
+    }
+    tag       = 0;
+    pos       = 0;
+    last_boff = 0;
+    thit      = false;
+    hit       = false;
   }
 
   void dump() {
@@ -436,11 +319,14 @@ public:
   bool isHit() const { return hit; }
   bool isTagHit() const { return thit; }
 
-  void select(Addr_t t, int b) {
+  void select(Addr_t t, int b) { select_tag(t == tag, b); }
+
+  // select with the tag compare already done (packed across the tables)
+  void select_tag(bool tag_hit, int b) {
     b = b >> 1;  // Drop lower bit
 
     last_boff = b;
-    if (t != tag) {
+    if (!tag_hit) {
       hit  = false;
       thit = false;
       return;
@@ -661,7 +547,56 @@ public:
   void u_clear() { u[0] = 0; }
 };
 
+// A GEHL component of the statistical corrector: nbr tables of 2^logs
+// counters, indexed with m[i] bits of history, in one flat array
+class gehl_table {
+public:
+  std::vector<int>    m;
+  std::vector<int8_t> ctr;
+  int                 nbr  = 0;
+  int                 logs = 0;
+
+  void init(std::vector<int> lengths, int _logs) {
+    m    = std::move(lengths);
+    nbr  = m.size();
+    logs = _logs;
+
+    ctr.assign(nbr << logs, 0);
+    for (int i = 0; i < nbr; i++) {
+      for (int j = 0; j < ((1 << logs) - 1); j++) {
+        if (!(j & 1)) {
+          ctr[(i << logs) + j] = -1;
+        }
+      }
+    }
+  }
+
+  int8_t *tab(int i) { return &ctr[i << logs]; }
+};
+
+// Predictor interface of BPIMLI. IMLIBest::create picks a specialized
+// IMLIBest_impl when the geometry is one of the common budgets below.
 class IMLIBest {
+public:
+  virtual ~IMLIBest() = default;
+
+  virtual void   fetchBoundaryBegin(Addr_t PC)                                                              = 0;
+  virtual void   fetchBoundaryEnd()                                                                         = 0;
+  virtual void   TrackOtherInst(Addr_t PC, Opcode opType, Addr_t branchTarget)                              = 0;
+  virtual bool   getPrediction(Addr_t PC, bool &bias, uint32_t &sign)                                       = 0;
+  virtual void   updatePredictor(Addr_t PC, bool resolveDir, bool predDir, Addr_t branchTarget, bool no_alloc) = 0;
+  virtual void   save_history(std::vector<uint64_t> &ck) const                                              = 0;
+  virtual size_t restore_history(const std::vector<uint64_t> &ck, size_t pos)                               = 0;
+  virtual void   speculate(Addr_t PC, Opcode brtype, bool taken, Addr_t target)                             = 0;
+
+  static std::unique_ptr<IMLIBest> create(int blogb, int log2fetchwidth, int bwidth, const Imli_geometry &geo);
+};
+
+// FIXED instances take the table count and the components from G at compile
+// time, so the per branch loops have constant trip counts and the disabled
+// components fold away. Other instances read them from the runtime geometry.
+template <bool FIXED, Imli_geometry G = Imli_geometry{}>
+class IMLIBest_impl final : public IMLIBest {
 public:
   Bimodal    bimodal;  // (BLOGB,LOG2FETCHWIDTH,BWIDTH);
   const int  blogb;
@@ -670,14 +605,30 @@ public:
   const int  nhist;
   const bool sc;
 
-#ifdef POSTPREDICT
+  const Imli_geometry geo;
+
+  int  n_hist() const { return FIXED ? G.nhist : nhist; }
+  bool use_sc() const { return FIXED ? G.sc : sc; }
+  bool use_loop() const { return FIXED ? G.loop : geo.loop; }
+  bool use_local() const { return FIXED ? G.local : geo.local; }
+  bool use_imli() const { return FIXED ? G.imli : geo.imli; }
+  bool use_imli_sic() const { return FIXED ? G.imli && G.imli_sic : geo.imli && geo.imli_sic; }
+  bool use_imli_oh() const { return FIXED ? G.imli && G.imli_oh : geo.imli && geo.imli_oh; }
+  bool use_postpredict() const { return FIXED ? G.postpredict : geo.postpredict; }
+
+  // Table count and components of g are the ones of G
+  static bool matches(const Imli_geometry &g) {
+    return std::min(g.nhist, g.maxhist) == G.nhist && g.sc == G.sc && g.loop == G.loop && g.local == G.local && g.imli == G.imli
+           && g.imli_sic == G.imli_sic && g.imli_oh == G.imli_oh && g.postpredict == G.postpredict;
+  }
+
 #define POSTPEXTRA 2
 #define POSTPBITS  5
 #define CTRBITS    3  // Chop 2 bits
 
-  uint32_t postpsize;
-  int8_t  *postp;
-  uint32_t ppi;
+  uint32_t            postpsize;
+  std::vector<int8_t> postp;
+  uint32_t            ppi;
 
   uint32_t postp_index(uint32_t a, uint32_t b, uint32_t c) {
     int ctr[POSTPEXTRA + 1];
@@ -714,22 +665,15 @@ public:
     v &= postpsize - 1;
     return v;
   }
-#endif
 
   // IMLI related data declaration
   long long IMLIcount;
 #define MAXIMLIcount 1023
-#ifdef IMLI
-#ifdef IMLISIC
 // IMLI-SIC related data declaration
 #define LOGINB 10  // (LOG of IMLI-SIC table size +1)
 #define INB    1
-  int     Im[INB];
-  int8_t  IGEHLA[INB][(1 << LOGINB)];
-  int8_t *IGEHL[INB];
-#endif
+  gehl_table IGEHL;
 // IMLI-OH related data declaration
-#ifdef IMLIOH
   long long localoh;   // intermediate data to recover the two bits needed from the past outer iteration
 #define SHIFTFUTURE 6  // (PC<<6) +IMLIcount to index the Outer History table
 #define PASTSIZE    16
@@ -742,18 +686,22 @@ public:
 #define LOGFNB 9  // 256 entries
 #endif
 #define FNB 1
-  int     Fm[FNB];
-  int8_t  FGEHLA[FNB][(1 << LOGFNB)];
-  int8_t *FGEHL[FNB];
-#endif
-#endif
+  gehl_table FGEHL;
+
+  // statistical corrector GEHL components
+  gehl_table GGEHL;
+  gehl_table LGEHL;
+  gehl_table PGEHL;
+
+  long long L_shist[NLOCAL];
+  int       Pupdatethreshold[(1 << LOGSIZEUP)];  // size is fixed by LOGSIZEUP
+
+  // The three counters used to choose between TAGE ang SC on High Conf TAGE/Low Conf SC
+  int8_t FirstH, SecondH, ThirdH;
 
-#ifndef POSTPREDICT
   int8_t use_alt_on_na[SIZEUSEALT][2];
-#endif
 
   long long GHIST;
-  long long phist;  // path history
 
 // The two BIAS tables in the SC component
 #define LOGBIAS 7
@@ -768,18 +716,24 @@ public:
 
   int TICK;  // for the reset of the u counter
 
-  uint8_t                     ghist[HISTBUFFERLENGTH];
-  int                         ptghist;
-  std::vector<folded_history> ch_i;     // [NHIST + 1];	//utility for computing TAGE indices
-  std::vector<folded_history> ch_t[2];  // [NHIST + 1];	//utility for computing TAGE tags
+  // Global/path history. Its folded histories are nhist index folds, then
+  // two sets of nhist tag folds (lane bank - 1 of each set)
+  Tage_global_history ghistory;
+
+  uint32_t ch_i(int bank) const { return ghistory.fold.get(bank - 1); }
+  uint32_t ch_t(int n, int bank) const { return ghistory.fold.get((1 + n) * n_hist() + bank - 1); }
 
-  std::vector<std::vector<gentry>> gtable;  // [NHIST + 1];	// tagged TAGE tables
+  std::vector<gentry>   gstore;  // all the tagged TAGE tables, one after the other
+  std::vector<gentry *> gtable;  // [NHIST + 1];	// tagged TAGE tables (gstore slices)
 
   std::vector<int>  m;           // [NHIST + 1];	// history lengths
   std::vector<int>  TB;          //[NHIST + 1]; 	// tag width for the different tagged tables
   std::vector<int>  logg;        // [NHIST + 1];	// log of number entries of the different tagged tables
-  std::vector<int>  GI;          //[NHIST + 1];		// indexes to the different tables are computed only once
-  std::vector<uint> GTAG;        //[NHIST + 1];		// tags for the different tables are computed only once
+  std::vector<uint32_t> GI;       //[NHIST + 1];		// indexes to the different tables are computed only once
+  std::vector<uint32_t> GTAG;     //[NHIST + 1];		// tags for the different tables are computed only once
+  std::vector<uint32_t> tag_shift;  // [NHIST + 1]; GTAG hash shift (logg / 2)
+  std::vector<uint32_t> tag_mask;   // [NHIST + 1]; GTAG width mask
+  std::vector<uint32_t> tag_read;   // [NHIST + 1]; tags of the selected entries
   bool              pred_taken;  // prediction
   bool              alttaken;    // alternate  TAGEprediction
   bool              tage_pred;   // TAGE prediction
@@ -793,7 +747,6 @@ public:
 
   bool pred_inter;
 
-#ifdef LOOPPREDICTOR
   std::vector<lentry> ltable;  // loop predictor table
   // variables for the loop predictor
   bool   predloop;  // loop predictor prediction
@@ -803,18 +756,17 @@ public:
   int    LTAG;      // tag on the loop predictor
   bool   LVALID;    // validity of the loop predictor prediction
   int8_t WITHLOOP;  // counter to monitor whether or not loop prediction is beneficial
-#endif
 
-  IMLIBest(int _blogb, int _log2fetchwidth, int _bwidth, int _nhist, bool _sc)
+  IMLIBest_impl(int _blogb, int _log2fetchwidth, int _bwidth, const Imli_geometry &_geo)
       : bimodal(_blogb, _log2fetchwidth, _bwidth)
       , blogb(_blogb)
       , log2fetchwidth(_log2fetchwidth)
       , bwidth(_bwidth)
-      , nhist(_nhist >= MAXHIST ? MAXHIST : _nhist)
-      , sc(_sc) {
-    ch_i.resize(nhist + 1);
-    ch_t[0].resize(nhist + 1);
-    ch_t[1].resize(nhist + 1);
+      , nhist(_geo.nhist >= _geo.maxhist ? _geo.maxhist : _geo.nhist)
+      , sc(_geo.sc)
+      , geo(_geo) {
+    I(!FIXED || matches(_geo));
+    ghistory.fold.resize(3 * nhist);
 
     gtable.resize(nhist + 1);
     m.resize(nhist + 1);
@@ -822,6 +774,9 @@ public:
     logg.resize(nhist + 1);
     GI.resize(nhist + 1);
     GTAG.resize(nhist + 1);
+    tag_shift.resize(nhist + 1);
+    tag_mask.resize(nhist + 1);
+    tag_read.resize(nhist + 1);
 
     reinit();
     predictorsize();
@@ -852,13 +807,13 @@ public:
 
     fprintf(stderr, " (TAGE %d) ", STORAGESIZE);
 
-#ifdef LOOPPREDICTOR
-    inter = (1 << LOGL) * (2 * WIDTHNBITERLOOP + LOOPTAG + 4 + 4 + 1);
-    fprintf(stderr, " (LOOP %d) ", inter);
-    STORAGESIZE += inter;
-#endif
+    if (use_loop()) {
+      inter = (1 << LOGL) * (2 * WIDTHNBITERLOOP + LOOPTAG + 4 + 4 + 1);
+      fprintf(stderr, " (LOOP %d) ", inter);
+      STORAGESIZE += inter;
+    }
 
-    if (sc) {
+    if (use_sc()) {
       inter = 0;
 
       inter += 16;                   // global histories for SC
@@ -868,41 +823,37 @@ public:
 
       inter += (PNB - 2) * (1 << (LOGPNB)) * (PERCWIDTH - 1) + (1 << (LOGPNB - 1)) * (2 * PERCWIDTH - 1);
 
-#ifdef LOCALH
-      inter += (LNB - 2) * (1 << (LOGLNB)) * (PERCWIDTH - 1) + (1 << (LOGLNB - 1)) * (2 * PERCWIDTH - 1);
-      inter += NLOCAL * Lm[0];
+      if (use_local()) {
+        inter += (LNB - 2) * (1 << (LOGLNB)) * (PERCWIDTH - 1) + (1 << (LOGLNB - 1)) * (2 * PERCWIDTH - 1);
+        inter += NLOCAL * LGEHL.m[0];
 
-      inter += (SNB - 2) * (1 << (LOGSNB)) * (PERCWIDTH - 1) + (1 << (LOGSNB - 1)) * (2 * PERCWIDTH - 1);
-      inter += (TNB - 2) * (1 << (LOGTNB)) * (PERCWIDTH - 1) + (1 << (LOGTNB - 1)) * (2 * PERCWIDTH - 1);
-      inter += 16 * 16;  // the history stack
-      inter += 4;        // the history stack pointer
+        inter += (SNB - 2) * (1 << (LOGSNB)) * (PERCWIDTH - 1) + (1 << (LOGSNB - 1)) * (2 * PERCWIDTH - 1);
+        inter += (TNB - 2) * (1 << (LOGTNB)) * (PERCWIDTH - 1) + (1 << (LOGTNB - 1)) * (2 * PERCWIDTH - 1);
+        inter += 16 * 16;  // the history stack
+        inter += 4;        // the history stack pointer
 
-      inter += NSECLOCAL * Sm[0];
-      inter += NSECLOCAL * (Tm[0] - 11);
-      /* Tm[0] is artificially increased by 11 to accomodate IMLI*/
-
-#endif
-
-#ifdef IMLI
-#ifdef IMLIOH
-      inter += OHHISTTABLESIZE;
-      inter += PASTSIZE;
-      /*the PIPE table*/
-      // in cases you add extra tables to IMLI OH, the formula is correct
-      switch (FNB) {
-        case 1: inter += (1 << (LOGFNB - 1)) * PERCWIDTH; break;
-        default: inter += (FNB - 2) * (1 << (LOGFNB)) * (PERCWIDTH - 1) + (1 << (LOGFNB - 1)) * (2 * PERCWIDTH - 1);
+        inter += NSECLOCAL * SM0;
+        inter += NSECLOCAL * (TM0 - 11);
+        /* Tm[0] is artificially increased by 11 to accomodate IMLI*/
       }
-#endif
-#ifdef IMLISIC  // in cases you add extra tables to IMLI SIC, the formula is correct
-      switch (INB) {
-        case 1: inter += (1 << (LOGINB - 1)) * PERCWIDTH; break;
 
-        default: inter += (INB - 2) * (1 << (LOGINB)) * (PERCWIDTH - 1) + (1 << (LOGINB - 1)) * (2 * PERCWIDTH - 1);
+      if (use_imli_oh()) {
+        inter += OHHISTTABLESIZE;
+        inter += PASTSIZE;
+        /*the PIPE table*/
+        // in cases you add extra tables to IMLI OH, the formula is correct
+        switch (FNB) {
+          case 1: inter += (1 << (LOGFNB - 1)) * PERCWIDTH; break;
+          default: inter += (FNB - 2) * (1 << (LOGFNB)) * (PERCWIDTH - 1) + (1 << (LOGFNB - 1)) * (2 * PERCWIDTH - 1);
+        }
       }
-#endif
+      if (use_imli_sic()) {  // in cases you add extra tables to IMLI SIC, the formula is correct
+        switch (INB) {
+          case 1: inter += (1 << (LOGINB - 1)) * PERCWIDTH; break;
 
-#endif
+          default: inter += (INB - 2) * (1 << (LOGINB)) * (PERCWIDTH - 1) + (1 << (LOGINB - 1)) * (2 * PERCWIDTH - 1);
+        }
+      }
 
       inter += 3 * CONFWIDTH;  // the 3 counters in the choser
       STORAGESIZE += inter;
@@ -916,52 +867,55 @@ public:
   }
 
   void reinit() {
-#ifdef POSTPREDICT
-    postpsize = 1 << ((1 + POSTPEXTRA) * CTRBITS + 1);
-    postp     = new int8_t[postpsize];
-    for (int i = 0; i < postpsize; i++) {
-      postp[i] = -(((i >> 1) >> (CTRBITS - 1)) & 1);
-    }
-#endif
-
-#ifdef IMLISIC
-    for (int i = 0; i < INB; i++) {
-      Im[i] = 10;  // the IMLIcounter is limited to 10 bits
+    if (use_postpredict()) {
+      postpsize = 1 << ((1 + POSTPEXTRA) * CTRBITS + 1);
+      postp.resize(postpsize);
+      for (uint32_t i = 0; i < postpsize; i++) {
+        postp[i] = -(((i >> 1) >> (CTRBITS - 1)) & 1);
+      }
     }
-#endif
 
-#ifdef IMLIOH
-    for (int i = 0; i < FNB; i++) {
-      Fm[i] = 2;
-    }
-#endif
+    IGEHL.init({10}, LOGINB);  // the IMLIcounter is limited to 10 bits
+    FGEHL.init({2}, LOGFNB);
+    GGEHL.init(GM, LOGGNB);
+    LGEHL.init(LM, LOGLNB);
+    PGEHL.init(PM, LOGPNB);
 
-    m[1]     = MINHIST;
-    m[nhist] = MAXHIST;
+    m[1]     = geo.minhist;
+    m[nhist] = geo.maxhist;
     for (int i = 2; i <= nhist; i++) {
-      if (MAXHIST <= nhist) {
+      if (geo.maxhist <= nhist) {
         m[i] = i;
       } else {
-        m[i] = (int)(((double)MINHIST * pow((double)(MAXHIST) / (double)MINHIST, (double)(i - 1) / (double)((nhist - 1)))) + 0.5);
+        m[i] = (int)(((double)geo.minhist * pow((double)(geo.maxhist) / (double)geo.minhist, (double)(i - 1) / (double)((nhist - 1))))
+                     + 0.5);
       }
     }
 
     for (int i = 1; i <= nhist; i++) {
-      TB[i]   = TBITS + (i / 2);
-      logg[i] = LOGG;
+      TB[i]   = geo.tbits + (i / 2);
+      logg[i] = geo.logg;
     }
 
-#ifdef LOOPPREDICTOR
-    ltable.resize(1 << (LOGL));
-#endif
+    if (use_loop()) {
+      ltable.resize(1 << (LOGL));
+    }
 
     // int galloc[]= {0, 6, 6, 5, 5, 4, 4, 3, 3, 2, 2};
     // int ngalloc =9;
     int galloc[] = {0, 1, 1, 1, 1};
     int ngalloc  = 3;
 
+    size_t gsize = 0;
+    for (int i = 1; i <= nhist; i++) {
+      gsize += 1 << logg[i];
+    }
+    gstore.resize(gsize);
+
+    gsize = 0;
     for (int i = 1; i <= nhist; i++) {
-      gtable[i].resize(1 << (logg[i]));
+      gtable[i] = &gstore[gsize];
+      gsize += 1 << logg[i];
       for (int j = 0; j < (1 << logg[i]); j++) {
         int s;
         if (i >= ngalloc) {
@@ -974,87 +928,37 @@ public:
     }
 
     for (int i = 1; i <= nhist; i++) {
-      ch_i[i].init(m[i], (logg[i]));
-      ch_t[0][i].init(ch_i[i].OLENGTH, TB[i]);
-      ch_t[1][i].init(ch_i[i].OLENGTH, TB[i] - 1);
+      ghistory.fold.init(i - 1, m[i], (logg[i]));
+      ghistory.fold.init(nhist + i - 1, m[i], TB[i]);
+      ghistory.fold.init(2 * nhist + i - 1, m[i], TB[i] - 1);
+
+      tag_shift[i] = logg[i] / 2;
+      tag_mask[i]  = (1 << TB[i]) - 1;
     }
-#ifdef LOOPPREDICTOR
     LVALID   = false;
     WITHLOOP = -1;
-#endif
-    Seed = 0;
+    Seed     = 0;
 
-    TICK  = 0;
-    phist = 0;
-    Seed  = 0;
+    TICK = 0;
+    Seed = 0;
 
-    for (int i = 0; i < HISTBUFFERLENGTH; i++) {
-      ghist[0] = 0;
-    }
-    ptghist = 0;
+    ghistory.clear();
 
     for (int i = 0; i < (1 << LOGSIZEUP); i++) {
       Pupdatethreshold[i] = 35;
     }
+    FirstH  = 0;
+    SecondH = 0;
+    ThirdH  = 0;
 
-    for (int i = 0; i < GNB; i++) {
-      GGEHL[i] = &GGEHLA[i][0];
-    }
-    for (int i = 0; i < LNB; i++) {
-      LGEHL[i] = &LGEHLA[i][0];
-    }
-
-    for (int i = 0; i < GNB; i++) {
-      for (int j = 0; j < ((1 << LOGGNB) - 1); j++) {
-        if (!(j & 1)) {
-          GGEHL[i][j] = -1;
-        }
-      }
-    }
-    for (int i = 0; i < LNB; i++) {
-      for (int j = 0; j < ((1 << LOGLNB) - 1); j++) {
-        if (!(j & 1)) {
-          LGEHL[i][j] = -1;
-        }
-      }
-    }
-    for (int i = 0; i < PNB; i++) {
-      PGEHL[i] = &PGEHLA[i][0];
-    }
-    for (int i = 0; i < PNB; i++) {
-      for (int j = 0; j < ((1 << LOGPNB) - 1); j++) {
-        if (!(j & 1)) {
-          PGEHL[i][j] = -1;
-        }
-      }
-    }
-
-#ifdef IMLI
-#ifdef IMLIOH
-    for (int i = 0; i < FNB; i++) {
-      FGEHL[i] = &FGEHLA[i][0];
-    }
-    for (int i = 0; i < FNB; i++) {
-      for (int j = 0; j < ((1 << LOGFNB) - 1); j++) {
-        if (!(j & 1)) {
-          FGEHL[i][j] = -1;
-        }
-      }
-    }
-#endif
-#ifdef IMLISIC
-    for (int i = 0; i < INB; i++) {
-      IGEHL[i] = &IGEHLA[i][0];
+    IMLIcount = 0;
+    localoh   = 0;
+    for (int i = 0; i < PASTSIZE; i++) {
+      PIPE[i] = 0;
     }
-    for (int i = 0; i < INB; i++) {
-      for (int j = 0; j < ((1 << LOGINB) - 1); j++) {
-        if (!(j & 1)) {
-          IGEHL[i][j] = -1;
-        }
-      }
+    for (int i = 0; i < OHHISTTABLESIZE; i++) {
+      ohhisttable[i] = 0;
     }
-#endif
-#endif
 
     for (int j = 0; j < (1 << (LOGBIAS + 1)); j++) {
       Bias[j] = (j & 1) ? 15 : -16;
@@ -1067,21 +971,14 @@ public:
       L_shist[i] = 0;
     }
 
-    for (int i = 0; i < NSECLOCAL; i++) {
-      S_slhist[i] = 0;
-    }
     GHIST = 0;
 
-#ifndef POSTPREDICT
     for (int i = 0; i < SIZEUSEALT; i++) {
       use_alt_on_na[i][0] = 0;
       use_alt_on_na[i][1] = 0;
     }
-#endif
 
-    TICK    = 0;
-    ptghist = 0;
-    phist   = 0;
+    TICK = 0;
   }
   // index function for the bimodal table
 
@@ -1109,14 +1006,14 @@ public:
     index          = PC ^ (PC >> (bank + 1)) ^ (sign1);
 #else
     int M = (m[bank] > PHISTWIDTH) ? PHISTWIDTH : m[bank];
-    index = PC ^ (PC >> (abs(logg[bank] - bank) + 1)) ^ ch_i[bank].comp ^ F(hist, M, bank);
+    index = PC ^ (PC >> (abs(logg[bank] - bank) + 1)) ^ ch_i(bank) ^ F(hist, M, bank);
 #endif
     return (index & ((1 << (logg[bank])) - 1));
   }
 
   //  tag computation
-  uint16_t gtag(unsigned int PC, int bank, folded_history *ch0, folded_history *ch1) {
-    int tag = PC ^ ch0[bank].comp ^ (ch1[bank].comp << 1);
+  uint16_t gtag(unsigned int PC, int bank) {
+    int tag = PC ^ ch_t(0, bank) ^ (ch_t(1, bank) << 1);
     return (tag & ((1 << TB[bank]) - 1));
   }
 
@@ -1133,7 +1030,6 @@ public:
     }
   }
 
-#ifdef LOOPPREDICTOR
   int lindex(Addr_t PC) { return ((PC & ((1 << (LOGL - 2)) - 1)) << 2); }
 
 // loop prediction: only used if high confidence
@@ -1251,13 +1147,12 @@ public:
       }
     }
   }
-#endif
 
   // just a simple pseudo random number generator: use available information
   // to allocate entries  in the loop predictor
   int MYRANDOM() {
     Seed++;
-    Seed ^= phist;
+    Seed ^= ghistory.phist;
     Seed = (Seed >> 21) + (Seed << 11);
 
     return Seed;
@@ -1268,10 +1163,11 @@ public:
     AltBank = 0;
 
     GI[0] = lastBoundaryPC >> 2;  // Remove 2 lower useless bits
-    for (int i = 1; i <= nhist; i++) {
-      GI[i]   = gindex(pcSign(lastBoundaryPC, i), i, phist);
-      GTAG[i] = ((GI[i - 1] << (logg[i] / 2)) ^ GI[i - 1]) & ((1 << TB[i]) - 1);
+    for (int i = 1; i <= n_hist(); i++) {
+      GI[i] = gindex(pcSign(lastBoundaryPC, i), i, ghistory.phist);
     }
+    // GTAG[i] = ((GI[i - 1] << (logg[i] / 2)) ^ GI[i - 1]) & ((1 << TB[i]) - 1)
+    tage_tag_hash(&GI[0], &tag_shift[1], &tag_mask[1], &GTAG[1], n_hist());
   }
 
   uint64_t pcSign(uint64_t pc, int deg = 0) const {
@@ -1283,7 +1179,7 @@ public:
   void setTAGEPred() {
     HitBank = 0;
     AltBank = 0;
-    for (int i = 1; i <= nhist; i++) {
+    for (int i = 1; i <= n_hist(); i++) {
       if (gtable[i][GI[i]].isHit()) {
         LongestMatchPred = (gtable[i][GI[i]].ctr_isTaken());
         HitBank          = i;
@@ -1297,26 +1193,33 @@ public:
       }
     }
 
-#ifdef POSTPREDICT
-    int WeakBank = 0;
-    for (int i = AltBank - 1; i > 0; i--) {
-      if (gtable[i][GI[i]].isHit()) {
-        WeakBank = i;
-        break;
+    if (use_postpredict()) {
+      int WeakBank = 0;
+      for (int i = AltBank - 1; i > 0; i--) {
+        if (gtable[i][GI[i]].isHit()) {
+          WeakBank = i;
+          break;
+        }
       }
-    }
 
-    if (HitBank > 0) {
-      if (AltBank > 0) {
-        alttaken = (gtable[AltBank][GI[AltBank]].ctr_isTaken());
+      if (HitBank > 0) {
+        if (AltBank > 0) {
+          alttaken = (gtable[AltBank][GI[AltBank]].ctr_isTaken());
+        } else {
+          alttaken = bimodal.predict();
+        }
       } else {
-        alttaken = bimodal.predict();
+        alttaken         = bimodal.predict();
+        LongestMatchPred = alttaken;
       }
-    } else {
-      alttaken         = bimodal.predict();
-      LongestMatchPred = alttaken;
+
+      ppi = postp_index(HitBank, AltBank, WeakBank);
+      I(ppi < postpsize);
+      // printf("postp[%d]=%d\n", ppi, postp[ppi]);
+      tage_pred = (postp[ppi] >= 0);
+      return;
     }
-#else
+
     // computes the prediction and the alternate prediction
     if (HitBank > 0) {
       if (AltBank > 0) {
@@ -1328,7 +1231,7 @@ public:
       // if the entry is recognized as a newly allocated entry and
       // USE_ALT_ON_NA is positive  use the alternate prediction
       int  index          = INDUSEALT ^ LongestMatchPred;
-      bool Huse_alt_on_na = (use_alt_on_na[index][HitBank > (nhist / 3)] >= 0);
+      bool Huse_alt_on_na = (use_alt_on_na[index][HitBank > (n_hist() / 3)] >= 0);
 
       if (!Huse_alt_on_na || !gtable[HitBank][GI[HitBank]].ctr_weak()) {
         tage_pred = LongestMatchPred;
@@ -1362,19 +1265,11 @@ public:
     if ((conta_h&0xFFFF)==0) {
       printf("High conf %d, low conf %d\n", conta_h, conta_l);
     }
-#endif
-#endif
-
-#ifdef POSTPREDICT
-    ppi = postp_index(HitBank, AltBank, WeakBank);
-    I(ppi < postpsize);
-    // printf("postp[%d]=%d\n", ppi, postp[ppi]);
-    tage_pred = (postp[ppi] >= 0);
 #endif
   }
   // compute the prediction
 
-  void fetchBoundaryBegin(Addr_t PC) {
+  void fetchBoundaryBegin(Addr_t PC) override {
     lastBoundaryPC = PC;
 #ifdef SIMPLER_DOLC_PATH
     lastBoundarySign = pcSign(PC);
@@ -1386,7 +1281,7 @@ public:
     setTAGEIndex();
   }
 
-  void fetchBoundaryEnd() {
+  void fetchBoundaryEnd() override {
 #ifdef USE_DOLC
     if (lastBoundaryCtrl) {
       idolc.update(lastBoundarySign);
@@ -1394,6 +1289,39 @@ public:
 #endif
   }
 
+  // Speculative history: the global/path history, GHIST and the IMLI
+  // counter. The local and outer history tables are not repaired
+  void save_history(std::vector<uint64_t> &ck) const override {
+    ghistory.save(ck);
+    ck.push_back(GHIST);
+    ck.push_back(IMLIcount);
+  }
+
+  size_t restore_history(const std::vector<uint64_t> &ck, size_t pos) override {
+    pos       = ghistory.restore(ck, pos);
+    GHIST     = ck[pos++];
+    IMLIcount = ck[pos++];
+    return pos;
+  }
+
+  // Wrong path branch: the HistoryUpdate of the speculative history only,
+  // no table, local or outer history update
+  void speculate(Addr_t PC, Opcode brtype, bool taken, Addr_t target) override {
+    if (use_imli() && brtype == iBALU_LBRANCH && target < PC) {
+      if (!taken) {
+        IMLIcount = 0;
+      } else if (IMLIcount < (MAXIMLIcount)) {
+        IMLIcount++;
+      }
+    }
+
+    if (brtype == iBALU_LBRANCH) {
+      GHIST = (GHIST << 1) + taken;
+    }
+
+    ghistory.update(PC, brtype == iBALU_LBRANCH, taken);
+  }
+
   uint32_t dohash(uint32_t addr, uint16_t offset) {
     uint32_t sign = (addr << 1) ^ offset;
 
@@ -1419,12 +1347,19 @@ public:
     // bimodal.select(GI[0],boff);
     bimodal.select(PC);
 
-    for (int i = 1; i <= nhist; i++) {
-      gtable[i][GI[i]].select(GTAG[i], boff);
+    for (int i = 1; i <= n_hist(); i++) {
+      tag_read[i] = gtable[i][GI[i]].tag;
+    }
+    uint64_t thit = tage_tag_match(&tag_read[1], &GTAG[1], n_hist());
+    for (int i = 1; i <= n_hist(); i++) {
+      gtable[i][GI[i]].select_tag((thit >> (i - 1)) & 1, boff);
     }
   }
 
-  bool getPrediction(Addr_t PC, bool &bias, uint32_t &sign) {
+  // IMLIcount as seen by the global GEHL (only mixed in with IMLI-SIC)
+  long long sic_count() const { return use_imli_sic() ? IMLIcount : 0; }
+
+  bool getPrediction(Addr_t PC, bool &bias, uint32_t &sign) override {
     fetchBoundaryOffsetBranch(PC);
     setTAGEPred();
 
@@ -1437,17 +1372,17 @@ public:
 #endif
     sign = GI[1];
 
-#ifdef LOOPPREDICTOR
-    predloop   = getloop(PC);  // loop prediction
-    pred_taken = ((WITHLOOP >= 0) && (LVALID)) ? predloop : pred_taken;
-    if ((WITHLOOP >= 0) && (LVALID)) {
-      bias = true;
+    if (use_loop()) {
+      predloop   = getloop(PC);  // loop prediction
+      pred_taken = ((WITHLOOP >= 0) && (LVALID)) ? predloop : pred_taken;
+      if ((WITHLOOP >= 0) && (LVALID)) {
+        bias = true;
+      }
     }
-#endif
 
     pred_inter = pred_taken;
 
-    if (!sc) {
+    if (!use_sc()) {
       return (pred_taken);
     }
 
@@ -1460,12 +1395,12 @@ public:
 
     LSUM += (2 * PNB);
 
-#ifdef LOCALH
-    LSUM += (2 * LNB);
-#endif
-#ifdef IMLI
-    LSUM += 8;
-#endif
+    if (use_local()) {
+      LSUM += (2 * LNB);
+    }
+    if (use_imli()) {
+      LSUM += 8;
+    }
 
     if (!pred_inter) {
       LSUM = -LSUM;
@@ -1477,45 +1412,30 @@ public:
     ctr = BiasSK[INDBIASSK];
     LSUM += (2 * ctr + 1);
 
-// integrate the GEHL predictions
-#ifdef IMLI
-#ifdef IMLIOH
-    localoh = 0;
-    localoh = PIPE[(PC ^ (PC >> 4)) & (PASTSIZE - 1)] + (localoh << 1);
-    for (int i = 0; i >= 0; i--) {
-      localoh = ohhisttable[(((PC ^ (PC >> 4)) << SHIFTFUTURE) + IMLIcount + i) & (OHHISTTABLESIZE - 1)] + (localoh << 1);
-    }
+    // integrate the GEHL predictions
+    if (use_imli_oh()) {
+      localoh = 0;
+      localoh = PIPE[(PC ^ (PC >> 4)) & (PASTSIZE - 1)] + (localoh << 1);
+      for (int i = 0; i >= 0; i--) {
+        localoh = ohhisttable[(((PC ^ (PC >> 4)) << SHIFTFUTURE) + IMLIcount + i) & (OHHISTTABLESIZE - 1)] + (localoh << 1);
+      }
 
-    if (IMLIcount >= 2) {
-      LSUM += 2 * Gpredict((PC << 2), localoh, Fm, FGEHL, FNB, LOGFNB);
+      if (IMLIcount >= 2) {
+        LSUM += 2 * Gpredict((PC << 2), localoh, FGEHL);
+      }
     }
-#endif
-
-#ifdef IMLISIC
-    LSUM += 2 * Gpredict(PC, IMLIcount, Im, IGEHL, INB, LOGINB);
-#else
-    long long interIMLIcount = IMLIcount;
-    /* just a trick to disable IMLIcount*/
-    IMLIcount = 0;
-#endif
-#endif
 
-#ifndef IMLI
-    IMLIcount = 0;
-#endif
+    if (use_imli_sic()) {
+      LSUM += 2 * Gpredict(PC, IMLIcount, IGEHL);
+    }
 
-    LSUM += Gpredict((PC << 1) + pred_inter /*PC*/, (GHIST << 11) + IMLIcount, Gm, GGEHL, GNB, LOGGNB);
+    LSUM += Gpredict((PC << 1) + pred_inter /*PC*/, (GHIST << 11) + sic_count(), GGEHL);
 
-#ifdef LOCALH
-    LSUM += Gpredict(PC, L_shist[INDLOCAL], Lm, LGEHL, LNB, LOGLNB);
-#endif
-#ifdef IMLI
-#ifndef IMLISIC
-    IMLIcount = interIMLIcount;
-#endif
-#endif
+    if (use_local()) {
+      LSUM += Gpredict(PC, L_shist[INDLOCAL], LGEHL);
+    }
 
-    LSUM += Gpredict(PC, GHIST, Pm, PGEHL, PNB, LOGPNB);
+    LSUM += Gpredict(PC, GHIST, PGEHL);
 
     bool SCPRED = (LSUM >= 0);
 
@@ -1544,20 +1464,10 @@ public:
     return pred_taken;
   }
 
-  void HistoryUpdate(Addr_t PC, Opcode brtype, bool taken, Addr_t target, long long &X, int &Y, std::vector<folded_history> &H,
-                     std::vector<folded_history> &G, std::vector<folded_history> &J, long long &LH, long long &GBRHIST) {
-    // special treatment for unconditional branchs;
-    int maxt;
-    if (brtype == iBALU_LBRANCH) {
-      maxt = 1;
-    } else {
-      maxt = 4;
-    }
-
+  void HistoryUpdate(Addr_t PC, Opcode brtype, bool taken, Addr_t target, long long &LH, long long &GBRHIST) {
     // the return stack associated history
 
-#ifdef IMLI
-    if (brtype == iBALU_LBRANCH) {
+    if (use_imli() && brtype == iBALU_LBRANCH) {
       if (target < PC) {
         // This branch is a branch "loop"
         if (!taken) {
@@ -1571,18 +1481,17 @@ public:
         }
       }
     }
-#ifdef IMLIOH
-    if (IMLIcount >= 1) {
-      if (brtype == iBALU_LBRANCH) {
-        if (target >= PC) {
-          PIPE[(PC ^ (PC >> 4)) & (PASTSIZE - 1)]
-              = ohhisttable[(((PC ^ (PC >> 4)) << SHIFTFUTURE) + IMLIcount) & (OHHISTTABLESIZE - 1)];
-          ohhisttable[(((PC ^ (PC >> 4)) << SHIFTFUTURE) + IMLIcount) & (OHHISTTABLESIZE - 1)] = taken;
+    if (use_imli_oh()) {
+      if (IMLIcount >= 1) {
+        if (brtype == iBALU_LBRANCH) {
+          if (target >= PC) {
+            PIPE[(PC ^ (PC >> 4)) & (PASTSIZE - 1)]
+                = ohhisttable[(((PC ^ (PC >> 4)) << SHIFTFUTURE) + IMLIcount) & (OHHISTTABLESIZE - 1)];
+            ohhisttable[(((PC ^ (PC >> 4)) << SHIFTFUTURE) + IMLIcount) & (OHHISTTABLESIZE - 1)] = taken;
+          }
         }
       }
     }
-#endif
-#endif
 
     if (brtype == iBALU_LBRANCH) {
       GBRHIST = (GBRHIST << 1) + taken;
@@ -1590,59 +1499,36 @@ public:
     }
 
 #ifdef USE_DOLC
-    for (int i = 1; i <= nhist; i++) {
+    for (int i = 1; i <= n_hist(); i++) {
       uint64_t sign1 = 0;  // dolc.getSignInt(pcSign(PC), logg[i], m[i]);
       uint64_t sign2 = 0;  // dolc.getSign(TB[i]  , m[i]);
-      H[i].set(sign1);
-      G[i].set(sign2);  // Not used in DOLC
-      J[i].set(sign2);  // Not used in DOLC
+      ghistory.fold.set(i - 1, sign1);
+      ghistory.fold.set(n_hist() + i - 1, sign2);      // Not used in DOLC
+      ghistory.fold.set(2 * n_hist() + i - 1, sign2);  // Not used in DOLC
     }
-#else
-    int T            = ((PC) << 1) + taken;
-    int PATH         = PC;
 #endif
 
-    for (int t = 0; t < maxt; t++) {
-#ifdef USE_DOLC
-      ghist[Y & (HISTBUFFERLENGTH - 1)] = 0;
-      X                                 = 0;
-      Y--;
-#else
-      bool DIR = (T & 1);
-      T >>= 1;
-      int PATHBIT = (PATH & 127);
-      PATH >>= 1;
-      // update  history
-      Y--;
-      ghist[Y & (HISTBUFFERLENGTH - 1)] = DIR;
-      X                                 = (X << 1) ^ PATHBIT;
-      for (int i = 1; i <= nhist; i++) {
-        H[i].update(ghist, Y);
-        G[i].update(ghist, Y);
-        J[i].update(ghist, Y);
-      }
-#endif
-    }
+    ghistory.update(PC, brtype == iBALU_LBRANCH, taken);
 
     // END UPDATE  HISTORIES
   }
 
   // PREDICTOR UPDATE
 
-  void updatePredictor(Addr_t PC, bool resolveDir, bool predDir, Addr_t branchTarget, bool no_alloc) {
+  void updatePredictor(Addr_t PC, bool resolveDir, bool predDir, Addr_t branchTarget, bool no_alloc) override {
     (void)predDir;
 
-#ifdef LOOPPREDICTOR
-    if (LVALID) {
-      if (pred_taken != predloop) {
-        ctrupdate(WITHLOOP, (predloop == resolveDir), 7);
+    if (use_loop()) {
+      if (LVALID) {
+        if (pred_taken != predloop) {
+          ctrupdate(WITHLOOP, (predloop == resolveDir), 7);
+        }
       }
-    }
 
-    loopupdate(resolveDir, (pred_taken != resolveDir));
-#endif
+      loopupdate(resolveDir, (pred_taken != resolveDir));
+    }
 
-    if (sc) {
+    if (use_sc()) {
       bool SCPRED = (LSUM >= 0);
       if (HighConf) {
         if (pred_inter != SCPRED) {
@@ -1675,39 +1561,29 @@ public:
 
         ctrupdate(Bias[INDBIAS], resolveDir, PERCWIDTH);
         ctrupdate(BiasSK[INDBIASSK], resolveDir, PERCWIDTH);
-#ifdef IMLI
-#ifndef IMLISIC
-        long long interIMLIcount = IMLIcount;
-        /* just a trick to disable IMLIcount*/
-        IMLIcount = 0;
-#endif
-#endif
-        Gupdate((PC << 1) + pred_inter /*PC*/, resolveDir, (GHIST << 11) + IMLIcount, Gm, GGEHL, GNB, LOGGNB);
-        Gupdate(PC, resolveDir, L_shist[INDLOCAL], Lm, LGEHL, LNB, LOGLNB);
-
-        Gupdate(PC, resolveDir, GHIST, Pm, PGEHL, PNB, LOGPNB);
+        Gupdate((PC << 1) + pred_inter /*PC*/, resolveDir, (GHIST << 11) + sic_count(), GGEHL);
+        if (use_local()) {
+          Gupdate(PC, resolveDir, L_shist[INDLOCAL], LGEHL);
+        }
 
-#ifdef IMLI
-#ifdef IMLISIC
-        Gupdate(PC, resolveDir, IMLIcount, Im, IGEHL, INB, LOGINB);
-#else
-        IMLIcount = interIMLIcount;
-#endif
+        Gupdate(PC, resolveDir, GHIST, PGEHL);
 
-#ifdef IMLIOH
-        if (IMLIcount >= 2) {
-          Gupdate((PC << 2), resolveDir, localoh, Fm, FGEHL, FNB, LOGFNB);
+        if (use_imli_sic()) {
+          Gupdate(PC, resolveDir, IMLIcount, IGEHL);
         }
-#endif
 
-#endif
+        if (use_imli_oh()) {
+          if (IMLIcount >= 2) {
+            Gupdate((PC << 2), resolveDir, localoh, FGEHL);
+          }
+        }
       }
       // ends update of the SC states
     }
 
     // TAGE UPDATE
     if (true) {
-      bool ALLOC = ((tage_pred != resolveDir) & (HitBank < nhist));
+      bool ALLOC = ((tage_pred != resolveDir) & (HitBank < n_hist()));
       if (pred_taken == resolveDir) {
         if ((MYRANDOM() & 31) != 0) {
           ALLOC = false;
@@ -1726,13 +1602,11 @@ public:
 
           // if it was delivering the correct prediction, no need to allocate a new entry
           // even if the overall prediction was false
-#ifndef POSTPREDICT
           // FIXME: Have a PC (or T1 history) based use_alt table
-          if (LongestMatchPred != alttaken) {
+          if (!use_postpredict() && LongestMatchPred != alttaken) {
             int index = (INDUSEALT) ^ LongestMatchPred;
-            ctrupdate(use_alt_on_na[index][HitBank > (nhist / 3)], (alttaken == resolveDir), 4);
+            ctrupdate(use_alt_on_na[index][HitBank > (n_hist() / 3)], (alttaken == resolveDir), 4);
           }
-#endif
         }
       }
 
@@ -1743,7 +1617,7 @@ public:
         int T = 1;  // nhist; // Seznec has 1
 
         int A = 1;
-        if ((MYRANDOM() & 127) < 32 && nhist > 8) {
+        if ((MYRANDOM() & 127) < 32 && n_hist() > 8) {
           A = 2;
         }
 
@@ -1752,10 +1626,10 @@ public:
 
         int weakBank = HitBank + A;
 #ifdef SUBENTRIES
-        std::vector<bool> skip(nhist + 1, false);
+        uint64_t skip = 0;  // banks already stolen, n_hist() <= 64
 
         // First try tag (but not offset hit)
-        for (int i = weakBank; i <= nhist; i += 1) {
+        for (int i = weakBank; i <= n_hist(); i += 1) {
           if (gtable[i][GI[i]].isTagHit()) {
             weakBank = i;
 
@@ -1763,7 +1637,7 @@ public:
               continue;
             }
 
-            skip[i] = true;
+            skip |= uint64_t(1) << (i - 1);
             // gtable[i][GI[i]].dump(); printf(" alloc pc=%x\n",PC);
 
             NA++;
@@ -1778,8 +1652,8 @@ public:
         // Then allocate a new tag if still not good enough
         if (T > 0) {
           weakBank = HitBank + A;
-          for (int i = weakBank; i <= nhist; i += 1) {
-            if (skip[i]) {
+          for (int i = weakBank; i <= n_hist(); i += 1) {
+            if ((skip >> (i - 1)) & 1) {
               continue;
             }
 
@@ -1823,7 +1697,7 @@ public:
         }
         if (T) {
           if (TICK > 0) {
-            for (int i = HitBank + 1; i <= nhist; i += 1) {
+            for (int i = HitBank + 1; i <= n_hist(); i += 1) {
               int idx1 = GI[i];
 
               gtable[i][idx1].u_dec();
@@ -1841,7 +1715,7 @@ public:
           TICK = 0;
         }
         if (TICK > 1023) {
-          for (int i = 1; i <= nhist; i++) {
+          for (int i = 1; i <= n_hist(); i++) {
             for (int j = 0; j <= (1 << logg[i]) - 1; j++) {
               gtable[i][j].u_dec();
             }
@@ -1879,13 +1753,13 @@ public:
         bimodal.update(resolveDir);
       }
     }
-#ifdef POSTPREDICT
-    I(ppi < postpsize);
-    ctrupdate(postp[ppi], resolveDir, POSTPBITS);
-#endif
+    if (use_postpredict()) {
+      I(ppi < postpsize);
+      ctrupdate(postp[ppi], resolveDir, POSTPBITS);
+    }
     // END TAGE UPDATE
 
-    HistoryUpdate(PC, iBALU_LBRANCH, resolveDir, branchTarget, phist, ptghist, ch_i, ch_t[0], ch_t[1], L_shist[INDLOCAL], GHIST);
+    HistoryUpdate(PC, iBALU_LBRANCH, resolveDir, branchTarget, L_shist[INDLOCAL], GHIST);
     // END PREDICTOR UPDATE
   }
 
@@ -1894,25 +1768,29 @@ public:
    ^ (bhist >> (40 - 4 * i)))                                                                                                 \
       & ((1 << (logs - (i >= (NBR - 2)))) - 1)
 
-  int Gpredict(Addr_t PC, long long BHIST, int *length, int8_t **tab, int NBR, int logs) {
-    int PERCSUM = 0;
+  int Gpredict(Addr_t PC, long long BHIST, gehl_table &g) {
+    const int NBR     = g.nbr;
+    const int logs    = g.logs;
+    int       PERCSUM = 0;
     for (int i = 0; i < NBR; i++) {
-      long long bhist = BHIST & ((long long)((1 << length[i]) - 1));
-      int16_t   ctr   = tab[i][GINDEX];
+      long long bhist = BHIST & ((long long)((1 << g.m[i]) - 1));
+      int16_t   ctr   = g.tab(i)[GINDEX];
       PERCSUM += (2 * ctr + 1);
     }
 
     return PERCSUM;
   }
 
-  void Gupdate(Addr_t PC, bool taken, long long BHIST, int *length, int8_t **tab, int NBR, int logs) {
+  void Gupdate(Addr_t PC, bool taken, long long BHIST, gehl_table &g) {
+    const int NBR  = g.nbr;
+    const int logs = g.logs;
     for (int i = 0; i < NBR; i++) {
-      long long bhist = BHIST & ((long long)((1 << length[i]) - 1));
-      ctrupdate(tab[i][GINDEX], taken, PERCWIDTH - (i < (NBR - 1)));
+      long long bhist = BHIST & ((long long)((1 << g.m[i]) - 1));
+      ctrupdate(g.tab(i)[GINDEX], taken, PERCWIDTH - (i < (NBR - 1)));
     }
   }
 
-  void TrackOtherInst(Addr_t PC, Opcode opType, Addr_t branchTarget) {
+  void TrackOtherInst(Addr_t PC, Opcode opType, Addr_t branchTarget) override {
     fetchBoundaryOffsetOthers(PC);
 
     bool taken = true;
@@ -1921,11 +1799,6 @@ public:
                   opType,
                   taken,
                   branchTarget,
-                  phist,
-                  ptghist,
-                  ch_i,
-                  ch_t[0],
-                  ch_t[1],
                   L_shist[INDLOCAL],
                   // S_slhist[INDSLOCAL],
                   // T_slhist[INDTLOCAL],
@@ -1933,3 +1806,19 @@ public:
                   GHIST);
   }
 };
+
+// Common budgets with a specialized predictor: the default 256Kbits TAGE-SC-L
+// + IMLI, and the TAGE-L + IMLI of conf/desesc.toml
+inline constexpr Imli_geometry IMLI_GEO_256K{};
+inline constexpr Imli_geometry IMLI_GEO_TAGE_L{.nhist = 8, .sc = false};
+
+inline std::unique_ptr<IMLIBest> IMLIBest::create(int blogb, int log2fetchwidth, int bwidth, const Imli_geometry &geo) {
+  if (IMLIBest_impl<true, IMLI_GEO_256K>::matches(geo)) {
+    return std::make_unique<IMLIBest_impl<true, IMLI_GEO_256K>>(blogb, log2fetchwidth, bwidth, geo);
+  }
+  if (IMLIBest_impl<true, IMLI_GEO_TAGE_L>::matches(geo)) {
+    return std::make_unique<IMLIBest_impl<true, IMLI_GEO_TAGE_L>>(blogb, log2fetchwidth, bwidth, geo);
+  }
+
+  return std::make_unique<IMLIBest_impl<false>>(blogb, log2fetchwidth, bwidth, geo);
+}
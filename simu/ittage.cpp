@@ -0,0 +1,245 @@
+// See LICENSE for details.
+
+#include "ittage.hpp"
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "iassert.hpp"
+
+Multi_target_btb::Multi_target_btb(int _log_size, int _ntargets) : log_size(_log_size), ntargets(_ntargets) {
+  I(ntargets > 0);
+
+  tag.assign(1 << log_size, 0);
+  target.assign((1 << log_size) * ntargets, 0);
+  conf.assign((1 << log_size) * ntargets, 0);
+}
+
+Addr_t Multi_target_btb::predict(Addr_t pc) const {
+  int idx = index(pc);
+  if (tag[idx] != pc) {
+    return 0;
+  }
+
+  const Addr_t  *t    = &target[idx * ntargets];
+  const uint8_t *c    = &conf[idx * ntargets];
+  int            best = 0;
+  for (int i = 1; i < ntargets; ++i) {
+    if (c[i] > c[best]) {
+      best = i;
+    }
+  }
+
+  return t[best];
+}
+
+void Multi_target_btb::update(Addr_t pc, Addr_t resolved) {
+  int      idx = index(pc);
+  Addr_t  *t   = &target[idx * ntargets];
+  uint8_t *c   = &conf[idx * ntargets];
+
+  if (tag[idx] != pc) {
+    tag[idx] = pc;
+    for (int i = 0; i < ntargets; ++i) {
+      t[i] = 0;
+      c[i] = 0;
+    }
+    t[0] = resolved;
+    c[0] = 1;
+    return;
+  }
+
+  for (int i = 0; i < ntargets; ++i) {
+    if (t[i] == resolved) {
+      if (c[i] < MAX_CONF) {
+        c[i]++;
+      }
+      return;
+    }
+  }
+
+  // New target: take a free slot, otherwise age the others and replace one
+  // that dropped to zero
+  for (int i = 0; i < ntargets; ++i) {
+    if (c[i] > 0) {
+      c[i]--;
+    }
+  }
+  for (int i = 0; i < ntargets; ++i) {
+    if (t[i] == 0 || c[i] == 0) {
+      t[i] = resolved;
+      c[i] = 1;
+      return;
+    }
+  }
+}
+
+Ittage_predictor::Ittage_predictor(const Ittage_geometry &_geo) : geo(_geo), btb(_geo.log_btb, _geo.btb_targets) {
+  const int nhist = geo.nhist;
+  I(nhist > 0 && nhist <= 64);
+
+  m.resize(nhist + 1);
+  TB.resize(nhist + 1);
+  GI.resize(nhist + 1);
+  GTAG.resize(nhist + 1);
+  tag_read.resize(nhist + 1);
+  gtable.resize(nhist + 1);
+
+  // geometric history lengths
+  m[0] = 0;
+  m[1] = geo.minhist;
+  for (int i = 2; i <= nhist; i++) {
+    m[i] = (int)(((double)geo.minhist * pow((double)geo.maxhist / (double)geo.minhist, (double)(i - 1) / (double)(nhist - 1)))
+                 + 0.5);
+  }
+
+  ghistory.fold.resize(3 * nhist);
+  for (int i = 1; i <= nhist; i++) {
+    TB[i] = geo.tbits + (i / 2);
+    if (TB[i] > 30) {
+      TB[i] = 30;
+    }
+
+    ghistory.fold.init(i - 1, m[i], geo.logg);
+    ghistory.fold.init(nhist + i - 1, m[i], TB[i]);
+    ghistory.fold.init(2 * nhist + i - 1, m[i], TB[i] - 1);
+  }
+
+  gstore.assign(nhist << geo.logg, Entry{0, 0, 0, 0});
+  gtable[0] = nullptr;
+  for (int i = 1; i <= nhist; i++) {
+    gtable[i] = &gstore[(i - 1) << geo.logg];
+  }
+
+  last_pc         = 0;
+  hit_bank        = 0;
+  alt_bank        = 0;
+  provider_target = 0;
+  alt_target      = 0;
+  pred_target     = 0;
+  tick            = 0;
+  seed            = 0;
+}
+
+void Ittage_predictor::compute(Addr_t pc) {
+  const int nhist = geo.nhist;
+  uint32_t  pcs   = pc >> 2;
+
+  for (int i = 1; i <= nhist; i++) {
+    uint32_t ci  = ghistory.fold.get(i - 1);
+    uint32_t ct0 = ghistory.fold.get(nhist + i - 1);
+    uint32_t ct1 = ghistory.fold.get(2 * nhist + i - 1);
+
+    GI[i]   = (pcs ^ (pcs >> (abs(geo.logg - i) + 1)) ^ ci) & ((1 << geo.logg) - 1);
+    GTAG[i] = (pcs ^ ct0 ^ (ct1 << 1)) & ((1 << TB[i]) - 1);
+  }
+}
+
+Addr_t Ittage_predictor::predict(Addr_t pc) {
+  const int nhist = geo.nhist;
+
+  compute(pc);
+  last_pc = pc;
+
+  for (int i = 1; i <= nhist; i++) {
+    tag_read[i] = gtable[i][GI[i]].tag;
+  }
+  uint64_t thit = tage_tag_match(&tag_read[1], &GTAG[1], nhist);
+
+  hit_bank = 0;
+  alt_bank = 0;
+  for (int i = nhist; i > 0; i--) {
+    if ((thit >> (i - 1)) & 1) {
+      if (hit_bank == 0) {
+        hit_bank = i;
+      } else {
+        alt_bank = i;
+        break;
+      }
+    }
+  }
+
+  Addr_t base     = btb.predict(pc);
+  provider_target = hit_bank ? gtable[hit_bank][GI[hit_bank]].target : base;
+  alt_target      = alt_bank ? gtable[alt_bank][GI[alt_bank]].target : base;
+
+  // A freshly allocated (or just replaced) target is not trusted yet
+  if (hit_bank && gtable[hit_bank][GI[hit_bank]].ctr == 0 && alt_target) {
+    pred_target = alt_target;
+  } else {
+    pred_target = provider_target;
+  }
+
+  return pred_target;
+}
+
+void Ittage_predictor::allocate(Addr_t resolved) {
+  const int nhist = geo.nhist;
+
+  // Skip a table sometimes so that the allocations do not always go to the
+  // same (shortest) history
+  seed     = (seed * 1103515245 + 12345) & 0x7fffffff;
+  int bank = hit_bank + 1 + ((seed >> 16) & 1);
+  if (bank > nhist) {
+    bank = hit_bank + 1;
+  }
+
+  bool found = false;
+
+  for (int i = bank; i <= nhist; i++) {
+    Entry &e = gtable[i][GI[i]];
+    if (e.u == 0) {
+      e.tag    = GTAG[i];
+      e.target = resolved;
+      e.ctr    = 0;
+      found    = true;
+      break;
+    }
+  }
+
+  if (!found) {
+    for (int i = bank; i <= nhist; i++) {
+      gtable[i][GI[i]].u = 0;
+    }
+  }
+}
+
+void Ittage_predictor::update(Addr_t pc, Addr_t resolved) {
+  I(pc == last_pc);
+
+  if (pred_target != resolved && hit_bank < geo.nhist) {
+    allocate(resolved);
+  }
+
+  if (hit_bank) {
+    Entry &e = gtable[hit_bank][GI[hit_bank]];
+
+    if (provider_target != alt_target) {
+      if (provider_target == resolved) {
+        e.u = 1;
+      } else if (alt_target == resolved) {
+        e.u = 0;
+      }
+    }
+
+    if (e.target == resolved) {
+      if (e.ctr < MAX_CTR) {
+        e.ctr++;
+      }
+    } else if (e.ctr > 0) {
+      e.ctr--;
+    } else {
+      e.target = resolved;
+    }
+  }
+
+  btb.update(pc, resolved);
+
+  // periodic reset of the useful bits
+  tick++;
+  if ((tick & ((1 << 18) - 1)) == 0) {
+    for (auto &e : gstore) {
+      e.u = 0;
+    }
+  }
+}
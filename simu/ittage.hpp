@@ -0,0 +1,104 @@
+// See LICENSE for details.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "dinst.hpp"  // Addr_t
+#include "tage_history.hpp"
+
+// Indirect branch target prediction: ITTAGE (A. Seznec, "A 64-Kbytes
+// ITTAGE indirect branch predictor", JWAC-2 2011) backed by a multi-target
+// BTB that also covers the sites with few dominant targets.
+
+// Direct mapped table indexed by PC and tagged with the full PC, a conflicting
+// branch replaces the entry. Each entry keeps several targets of the same
+// branch with a confidence counter, the most confident one is predicted.
+class Multi_target_btb {
+private:
+  const int log_size;
+  const int ntargets;
+
+  std::vector<Addr_t>  tag;
+  std::vector<Addr_t>  target;  // ntargets per entry
+  std::vector<uint8_t> conf;
+
+  int index(Addr_t pc) const { return (pc >> 2) & ((1 << log_size) - 1); }
+
+public:
+  static constexpr uint8_t MAX_CONF = 3;
+
+  Multi_target_btb(int log_size, int ntargets);
+
+  // 0 when the branch has no target
+  Addr_t predict(Addr_t pc) const;
+  void   update(Addr_t pc, Addr_t resolved);
+};
+
+struct Ittage_geometry {
+  int nhist   = 8;    // tagged tables
+  int logg    = 9;    // log2 entries per tagged table
+  int tbits   = 9;    // tag bits of the shortest history table
+  int minhist = 4;    // shortest history
+  int maxhist = 640;  // longest history
+
+  int log_btb     = 10;  // log2 entries of the multi-target BTB
+  int btb_targets = 4;   // targets per multi-target BTB entry
+};
+
+class Ittage_predictor {
+private:
+  struct Entry {
+    uint32_t tag;
+    Addr_t   target;
+    uint8_t  ctr;  // target confidence
+    uint8_t  u;    // useful
+  };
+  static constexpr uint8_t MAX_CTR = 3;
+
+  const Ittage_geometry geo;
+
+  Multi_target_btb btb;
+
+  // Global history of the control instructions, same update as IMLIBest.
+  // Folded histories: nhist index folds, then two sets of nhist tag folds
+  Tage_global_history ghistory;
+
+  std::vector<int>      m;       // [nhist + 1] history lengths
+  std::vector<int>      TB;      // [nhist + 1] tag widths
+  std::vector<Entry>    gstore;  // all the tagged tables, one after the other
+  std::vector<Entry *>  gtable;  // [nhist + 1]
+  std::vector<uint32_t> GI;      // [nhist + 1]
+  std::vector<uint32_t> GTAG;    // [nhist + 1]
+  std::vector<uint32_t> tag_read;
+
+  // State of the last predict(), used by update()
+  Addr_t last_pc;
+  int    hit_bank;
+  int    alt_bank;
+  Addr_t provider_target;
+  Addr_t alt_target;
+  Addr_t pred_target;
+
+  int tick;  // for the reset of the u bits
+  int seed;
+
+  void compute(Addr_t pc);
+  void allocate(Addr_t resolved);
+
+public:
+  explicit Ittage_predictor(const Ittage_geometry &geo);
+
+  // Predicted target of the indirect branch at pc, 0 when none
+  Addr_t predict(Addr_t pc);
+  // Train with the resolved target, must follow predict(pc)
+  void update(Addr_t pc, Addr_t resolved);
+  // Every control instruction (indirect ones after update) shifts the history
+  void track(Addr_t pc, bool conditional, bool taken) { ghistory.update(pc, conditional, taken); }
+
+  void   save_history(std::vector<uint64_t> &ck) const { ghistory.save(ck); }
+  size_t restore_history(const std::vector<uint64_t> &ck, size_t pos) { return ghistory.restore(ck, pos); }
+
+  int get_hit_bank() const { return hit_bank; }
+};
@@ -0,0 +1,100 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include "ittage.hpp"
+
+#include <random>
+
+#include "gtest/gtest.h"
+
+TEST(Ittage_test, multi_target_btb) {
+  Multi_target_btb btb(4, 2);
+
+  EXPECT_EQ(btb.predict(0x1000), 0);
+
+  btb.update(0x1000, 0x2000);
+  EXPECT_EQ(btb.predict(0x1000), 0x2000);
+
+  // A second target is kept, the dominant one is predicted
+  btb.update(0x1000, 0x3000);
+  btb.update(0x1000, 0x3000);
+  btb.update(0x1000, 0x3000);
+  EXPECT_EQ(btb.predict(0x1000), 0x3000);
+  btb.update(0x1000, 0x2000);
+  EXPECT_EQ(btb.predict(0x1000), 0x3000);
+
+  // Another branch in the same entry replaces it
+  btb.update(0x1000 + (16 << 2), 0x4000);
+  EXPECT_EQ(btb.predict(0x1000), 0);
+  EXPECT_EQ(btb.predict(0x1000 + (16 << 2)), 0x4000);
+}
+
+TEST(Ittage_test, history_correlated_targets) {
+  Ittage_geometry  geo;
+  Ittage_predictor pred(geo);
+
+  // The target of the indirect jump depends on the last two conditional
+  // branches (a dispatch on a value tested just before)
+  const Addr_t targets[4] = {0x10000, 0x20000, 0x30000, 0x40000};
+
+  std::mt19937 rng(1);
+  int          miss_warm = 0;
+  int          miss      = 0;
+  const int    n         = 20000;
+  for (int i = 0; i < n; ++i) {
+    bool d0 = rng() & 1;
+    bool d1 = rng() & 1;
+    pred.track(0x1000, true, d0);
+    pred.track(0x1010, true, d1);
+
+    Addr_t resolved = targets[(d0 << 1) | d1];
+    Addr_t target   = pred.predict(0x1100);
+    if (target != resolved) {
+      if (i < n / 2) {
+        ++miss_warm;
+      } else {
+        ++miss;
+      }
+    }
+    pred.update(0x1100, resolved);
+    pred.track(0x1100, false, true);
+  }
+
+  // A target BTB alone mispredicts 3/4 of these
+  EXPECT_LT(miss, n / 2 / 50);
+  EXPECT_LE(miss, miss_warm);
+}
+
+TEST(Ittage_test, history_restore) {
+  Ittage_geometry  geo;
+  Ittage_predictor pred(geo);
+  Ittage_predictor ref(geo);
+
+  std::mt19937 rng(2);
+  for (int i = 0; i < 1000; ++i) {
+    bool t = rng() & 1;
+    pred.track(0x1000 + 4 * (i & 15), true, t);
+    ref.track(0x1000 + 4 * (i & 15), true, t);
+  }
+
+  std::vector<uint64_t> ck;
+  pred.save_history(ck);
+
+  // Wrong path updates, undone by the restore
+  for (int i = 0; i < 50; ++i) {
+    pred.track(0x8000 + 4 * i, (i & 3) != 0, true);
+  }
+  EXPECT_EQ(pred.restore_history(ck, 0), ck.size());
+
+  for (int i = 0; i < 2000; ++i) {
+    Addr_t resolved = 0x10000 + ((rng() & 3) << 12);
+    EXPECT_EQ(pred.predict(0x1100), ref.predict(0x1100));
+    EXPECT_EQ(pred.get_hit_bank(), ref.get_hit_bank());
+    pred.update(0x1100, resolved);
+    ref.update(0x1100, resolved);
+    bool t = rng() & 1;
+    pred.track(0x1100, false, true);
+    ref.track(0x1100, false, true);
+    pred.track(0x1200, true, t);
+    ref.track(0x1200, true, t);
+  }
+}
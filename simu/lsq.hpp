@@ -34,21 +34,67 @@ public:
     unresolved++;
     freeEntries--;
   }
+  // dinst leaves without retiring (branch squash), executing or not
+  void squash(Dinst *dinst) {
+    if (!dinst->isExecuting()) {
+      unresolved--;
+    }
+    freeEntries++;
+    remove(dinst);
+  }
   bool hasFreeEntries() const { return freeEntries > 0; }
   bool hasPendingResolution() const { return unresolved > 0; }
 };
 
 class LSQFull : public LSQ {
 private:
-  typedef HASH_MULTIMAP<Addr_t, Dinst *> AddrDinstQMap;
+  struct Entry {
+    Dinst *dinst;
+    Addr_t word;
+  };
+
+  // Age-ordered circular queue of capacity entries. Entries leave at retire
+  // (the head) or at a squash (the tail); an out of order removal moves the
+  // younger entries down, so there are no holes and full() is exact.
+  class Queue {
+  private:
+    std::vector<Entry> entries;
+    uint32_t           mask;
+    uint32_t           capacity;
+    uint32_t           head;
+    uint32_t           tail;
+
+  public:
+    explicit Queue(int32_t size);
+
+    bool     full() const { return (tail - head) == capacity; }
+    uint32_t getHead() const { return head; }
+    uint32_t getTail() const { return tail; }
+
+    Entry       &at(uint32_t pos) { return entries[pos & mask]; }
+    const Entry &at(uint32_t pos) const { return entries[pos & mask]; }
+
+    void push(Dinst *dinst, Addr_t word);
+    bool remove(Dinst *dinst, Addr_t &word);
+  };
+
+  // Counting filter with the in-flight words of each queue. Most executing
+  // loads/stores have no match and skip the scan.
+  static constexpr uint32_t FILTER_SIZE = 1024;
+
+  Stats_cntr stldForwarding;
+
+  Queue ldq;
+  Queue stq;
 
-  Stats_cntr    stldForwarding;
-  AddrDinstQMap instMap;
+  std::vector<uint16_t> ldFilter;
+  std::vector<uint16_t> stFilter;
 
-  static Addr_t calcWord(const Dinst *dinst) { return (dinst->getAddr()) >> 3; }
+  static Addr_t   calcWord(const Dinst *dinst) { return (dinst->getAddr()) >> 3; }
+  static uint32_t calcFilter(Addr_t word) { return (word ^ (word >> 10)) & (FILTER_SIZE - 1); }
 
 public:
-  LSQFull(Hartid_t hid, int32_t size);
+  LSQFull(Hartid_t hid, int32_t ldq_size, int32_t stq_size);
   ~LSQFull() {}
 
   bool   insert(Dinst *dinst);
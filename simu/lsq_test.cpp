@@ -1,87 +1,288 @@
-/*
-   ESESC: Super ESCalar simulator
-   Copyright (C) 2009 University of California, Santa Cruz.
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
 
-   Contributed by Jose Renau
-                  Basilio Fraguela
-                  Milos Prvulovic
-                  Smruti Sarangi
+#include "lsq.hpp"
 
-This file is part of ESESC.
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <random>
+#include <vector>
 
-ESESC is free software; you can redistribute it and/or modify it under the terms
-of the GNU General Public License as published by the Free Software Foundation;
-either version 2, or (at your option) any later version.
+#include "dinst.hpp"
+#include "fmt/format.h"
+#include "gtest/gtest.h"
+#include "instruction.hpp"
+#include "snippets.hpp"
 
-ESESC is distributed in the  hope that it will be useful, but WITHOUT ANY
-WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
-PARTICULAR PURPOSE. See the GNU General Public License for more details.
+// The multimap LSQFull used before the circular queues. Kept as a reference
+// for the checks and the microbenchmark.
+class LSQ_multimap : public LSQ {
+private:
+  std::multimap<Addr_t, Dinst *> instMap;
 
-You should have received a copy of the GNU General Public License along with
-ESESC; see the file COPYING. If not, write to the Free Software Foundation, 59
-Temple Place - Suite 330, Boston, MA 02111-1307, USA.
-*/
+  static Addr_t calcWord(const Dinst *dinst) { return (dinst->getAddr()) >> 3; }
 
-/*
- * This launches the ESESC simulator environment with an ideal memory
- */
+public:
+  explicit LSQ_multimap(int32_t size) : LSQ(size) {}
 
-#include <signal.h>
-#include <sys/time.h>
-#include <sys/types.h>
+  bool insert(Dinst *dinst) override {
+    instMap.insert(std::pair<Addr_t, Dinst *>(calcWord(dinst), dinst));
+    return true;
+  }
 
-#include "Instruction.h"
-#include "dinst.hpp"
-#include "nanassert.h"
+  Dinst *executing(Dinst *dinst) override {
+    Dinst *faulty = 0;
+    auto   ret    = instMap.equal_range(calcWord(dinst));
+    for (auto it = ret.first; it != ret.second; ++it) {
+      Dinst *qdinst = it->second;
+      if (qdinst == dinst) {
+        continue;
+      }
+      if (qdinst->getID() > dinst->getID()) {
+        if (qdinst->isExecuted() && qdinst->getPC() != dinst->getPC() && dinst->getInst()->isStore()
+            && qdinst->getInst()->isLoad()) {
+          if (faulty == 0 || faulty->getID() < qdinst->getID()) {
+            faulty = qdinst;
+          }
+        }
+      } else if (!dinst->isLoadForwarded() && dinst->getInst()->isLoad() && qdinst->getInst()->isStore()
+                 && qdinst->isExecuted()) {
+        dinst->setLoadForwarded();
+      }
+    }
+    unresolved--;
+    return faulty;
+  }
 
-//*********** BEGIN CREATE FAKE PROCESSOR CLASS
-uint64_t nReplays = 0;
-#define GPROCESSOR_H 1
-class GProcessor {
-public:
-  void replay(Dinst *dinst) { nReplays++; }
+  void remove(Dinst *dinst) override {
+    for (auto it = instMap.begin(); it != instMap.end(); ++it) {
+      if (it->second == dinst) {
+        instMap.erase(it);
+        return;
+      }
+    }
+  }
 };
-//*********** END CREATE FAKE PROCESSOR CLASS
-#include "config.hpp"
-#include "lsq.hpp"
 
-long long instTotal = 0;
+class LSQ_test : public ::testing::Test {
+protected:
+  struct Result {
+    int64_t nViolations = 0;
+    int64_t nForwarded  = 0;
+  };
+
+  void SetUp() override { globalClock = 1; }
+
+  static Dinst *create_mem(bool store, Addr_t pc, Addr_t addr) {
+    if (store) {
+      return Dinst::create(Instruction(iSALU_ST, LREG_R1, LREG_R2, LREG_InvalidOutput, LREG_InvalidOutput), pc, addr, 0, false);
+    }
+    return Dinst::create(Instruction(iLALU_LD, LREG_R1, LREG_NoDependence, LREG_R3, LREG_InvalidOutput), pc, addr, 0, false);
+  }
+
+  static void do_execute(LSQ &lsq, Dinst *dinst, Result &res) {
+    dinst->markIssued();
+    if (lsq.executing(dinst)) {
+      res.nViolations++;
+    }
+    dinst->markExecuted();
+  }
+
+  // Window of in-flight memory ops executed out of order and retired in order
+  static Result run(LSQ &lsq, int32_t window, int64_t nops, uint32_t seed) {
+    std::mt19937         rnd(seed);
+    std::deque<Dinst *>  rob;
+    std::vector<Dinst *> ready;
+    Result               res;
+
+    for (int64_t n = 0; n < nops; n++) {
+      bool   store = (rnd() % 3) == 0;
+      Addr_t addr  = 0x1000 + (rnd() % 256) * 8;
+      auto  *dinst = create_mem(store, 0x400 + (rnd() % 64) * 4, addr);
+
+      EXPECT_TRUE(lsq.insert(dinst));
+      lsq.decFreeEntries();
+      rob.push_back(dinst);
+      ready.push_back(dinst);
+
+      if (ready.size() > 4) {
+        auto pos = rnd() % ready.size();
+        do_execute(lsq, ready[pos], res);
+        ready.erase(ready.begin() + pos);
+      }
+
+      if (static_cast<int32_t>(rob.size()) >= window) {
+        auto *head = rob.front();
+        if (!head->isExecuted()) {
+          do_execute(lsq, head, res);
+          ready.erase(std::find(ready.begin(), ready.end(), head));
+        }
+        if (head->isLoadForwarded()) {
+          res.nForwarded++;
+        }
+        lsq.remove(head);
+        lsq.incFreeEntries();
+        rob.pop_front();
+        head->destroy();
+      }
+    }
+
+    while (!rob.empty()) {
+      auto *head = rob.front();
+      if (!head->isExecuted()) {
+        do_execute(lsq, head, res);
+      }
+      if (head->isLoadForwarded()) {
+        res.nForwarded++;
+      }
+      lsq.remove(head);
+      rob.pop_front();
+      head->destroy();
+    }
 
-LSQ *lsq;
+    return res;
+  }
+};
+
+TEST_F(LSQ_test, forward_and_violation) {
+  LSQFull lsq(0, 16, 16);
+
+  auto *st  = create_mem(true, 0x100, 0x2000);
+  auto *ld  = create_mem(false, 0x104, 0x2004);  // same 8-byte word
+  auto *ld2 = create_mem(false, 0x108, 0x3000);
+  EXPECT_TRUE(lsq.insert(st));
+  EXPECT_TRUE(lsq.insert(ld));
+  EXPECT_TRUE(lsq.insert(ld2));
+
+  // The younger load executes first, the store finds the violation
+  ld->markIssued();
+  EXPECT_EQ(lsq.executing(ld), nullptr);
+  ld->markExecuted();
+  EXPECT_FALSE(ld->isLoadForwarded());
 
-void doTest() {
-#if 0
-  Instruction *ld    = Instruction::create(iLALU_LD, 0, 0, 0, 0, false );
-  Instruction *st    = Instruction::create(iSALU_ST, 0, 0, 0, 0, false );
-  Instruction *stadd = Instruction::create(iSALU_ADDR, 0, 0, 0, 0, false );
+  st->markIssued();
+  EXPECT_EQ(lsq.executing(st), ld);
+  st->markExecuted();
 
-  Dinst *dld1 = Dinst::create(ld, rinst1, 0);
-#endif
+  // Once the store executed, younger loads forward
+  ld2->markIssued();
+  EXPECT_EQ(lsq.executing(ld2), nullptr);
+  ld2->markExecuted();
+  EXPECT_FALSE(ld2->isLoadForwarded());
+
+  auto *ld3 = create_mem(false, 0x10c, 0x2000);
+  EXPECT_TRUE(lsq.insert(ld3));
+  ld3->markIssued();
+  lsq.executing(ld3);
+  ld3->markExecuted();
+  EXPECT_TRUE(ld3->isLoadForwarded());
+
+  for (auto *d : {st, ld, ld2, ld3}) {
+    lsq.remove(d);
+    d->destroy();
+  }
 }
 
-// FIXME: this is a broken test/benchmark, but it would be good to have one for the LSQ
+TEST_F(LSQ_test, out_of_order_remove) {
+  LSQFull lsq(0, 4, 4);
+
+  auto                *st = create_mem(true, 0x100, 0x1010);
+  std::vector<Dinst *> lds;
+  for (int i = 0; i < 4; i++) {
+    lds.push_back(create_mem(false, 0x104, 0x1000 + i * 8));
+  }
+  EXPECT_TRUE(lsq.insert(st));
+  for (auto *d : lds) {
+    EXPECT_TRUE(lsq.insert(d));
+  }
+  auto *ld = create_mem(false, 0x108, 0x2000);
+  EXPECT_FALSE(lsq.insert(ld));
+
+  // Removing from the middle frees a slot, the younger loads move down
+  lsq.remove(lds[1]);
+  EXPECT_TRUE(lsq.insert(ld));
+  auto *full = create_mem(false, 0x10c, 0x3000);
+  EXPECT_FALSE(lsq.insert(full));
 
-int main(int argc, const char **argv) {
-  Config::init();
+  // The moved load is still found by the older store
+  lds[2]->markIssued();
+  EXPECT_EQ(lsq.executing(lds[2]), nullptr);
+  lds[2]->markExecuted();
+  st->markIssued();
+  EXPECT_EQ(lsq.executing(st), lds[2]);
+  st->markExecuted();
 
-  GProcessor gproc;
-  // lsq = new LSQFull(&gproc,0);
-  lsq = new LSQFull(0);
+  lds.push_back(ld);
+  lds.push_back(full);
+  lds.push_back(st);
+  for (auto *d : lds) {
+    lsq.remove(d);
+    if (!d->isExecuted()) {
+      d->markIssued();
+      d->markExecuted();
+    }
+    d->destroy();
+  }
+}
+
+TEST_F(LSQ_test, split_sizes) {
+  LSQFull lsq(0, 2, 6);
+
+  std::vector<Dinst *> insts;
+  for (int i = 0; i < 6; i++) {
+    insts.push_back(create_mem(true, 0x200, 0x4000 + i * 8));
+    EXPECT_TRUE(lsq.insert(insts.back())) << "store " << i;
+  }
+  auto *st = create_mem(true, 0x200, 0x5000);
+  EXPECT_FALSE(lsq.insert(st));
+
+  for (int i = 0; i < 2; i++) {
+    insts.push_back(create_mem(false, 0x300, 0x6000 + i * 8));
+    EXPECT_TRUE(lsq.insert(insts.back())) << "load " << i;
+  }
+  auto *ld = create_mem(false, 0x300, 0x7000);
+  EXPECT_FALSE(lsq.insert(ld));
+
+  // The entry count covers both queues, 2 loads and 6 stores
+  EXPECT_TRUE(lsq.hasFreeEntries());
+  for (int i = 0; i < 8; i++) {
+    lsq.decFreeEntries();
+  }
+  EXPECT_FALSE(lsq.hasFreeEntries());
+
+  insts.push_back(st);
+  insts.push_back(ld);
+  for (auto *d : insts) {
+    lsq.remove(d);
+    d->markIssued();
+    d->markExecuted();
+    d->destroy();
+  }
+}
 
-  timeval startTime;
-  gettimeofday(&startTime, 0);
+TEST_F(LSQ_test, bench) {
+  const int32_t window = 160;  // 96 LDQ + 64 STQ
+  const int64_t nops   = 200000;
 
-  doTest();
+  LSQFull      lsq(0, window, window);
+  LSQ_multimap ref(window);
 
-  timeval endTime;
-  gettimeofday(&endTime, 0);
-  double msecs = (endTime.tv_sec - startTime.tv_sec) * 1000 + (endTime.tv_usec - startTime.tv_usec) / 1000;
+  auto start = std::chrono::steady_clock::now();
+  auto res   = run(lsq, window, nops, 7);
+  auto mid   = std::chrono::steady_clock::now();
+  auto rres  = run(ref, window, nops, 7);
+  auto end   = std::chrono::steady_clock::now();
 
-  long double res = instTotal / 1000;
-  res /= msecs;
-  MSG("------------------");
-  MSG("LSQ MIPS = %g secs = %g insts = %lld", (double)res, msecs / 1000, (long long)instTotal);
-  MSG("------------------");
+  EXPECT_EQ(res.nViolations, rres.nViolations);
+  EXPECT_EQ(res.nForwarded, rres.nForwarded);
 
-  return 0;
+  auto t_flat = std::chrono::duration_cast<std::chrono::microseconds>(mid - start).count();
+  auto t_ref  = std::chrono::duration_cast<std::chrono::microseconds>(end - mid).count();
+  fmt::print("lsq_test: {} ops, circular {}us multimap {}us ({} violations, {} forwarded)\n",
+             nops,
+             t_flat,
+             t_ref,
+             res.nViolations,
+             res.nForwarded);
 }
@@ -22,6 +22,8 @@ class MemRequest;
 #define PSIGN_INDIRECT   5
 #define PSIGN_CHASE      6
 #define PSIGN_MEGA       7
+#define PSIGN_CACHE      8  // Cache_prefetcher engines
+#define PSIGN_FDIP       9  // fetch target queue run ahead
 #define LDBUFF_SIZE      512
 #define CIR_QUEUE_WINDOW 512  // FIXME: need to change this to a conf variable
 
@@ -147,6 +147,7 @@ MemRequest *MemRequest::create(MemObj *mobj, Addr_t addr, bool keep_stats, Callb
   r->spec               = false;
   r->dropped            = false;
   r->retrying           = false;
+  r->mshrRetry          = false;
   r->needsDisp          = false;
   r->keep_stats         = keep_stats;
   r->warmup             = false;
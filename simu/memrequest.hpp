@@ -72,6 +72,7 @@ protected:
   bool notifyScbDirectly;
   bool dropped;
   bool retrying;
+  bool mshrRetry;  // woken from the MSHR overflow, its stall is already counted
   bool needsDisp;  // Once set, it keeps the value
   bool keep_stats;
   bool warmup;
@@ -569,6 +570,8 @@ public:
   bool isRetrying() const { return retrying; }
   void setRetrying() { retrying = true; }
   void clearRetrying() { retrying = false; }
+  bool isMSHRRetry() const { return mshrRetry; }
+  void setMSHRRetry() { mshrRetry = true; }
 
   void addPendingSetStateAck(MemRequest *mreq);
   bool hasPendingSetStateAck() const { return pendingSetStateAck > 0; }
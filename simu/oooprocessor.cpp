@@ -102,8 +102,24 @@ OoOProcessor::OoOProcessor(std::shared_ptr<Gmemory_system> gm, CPU_t i)
     , num_ldbr_others(fmt::format("P({})_num_ldbr_others", i))
 #endif
     , RetireDelay(Config::get_integer("soc", "core", i, "commit_delay"))
-    , lsq(i, Config::get_integer("soc", "core", i, "ldq_size", 1))
+    , lsq(i, Config::get_integer("soc", "core", i, "ldq_size", 1), Config::get_integer("soc", "core", i, "stq_size", 1))
     , retire_lock_checkCB(this)
+    , moveElim(Config::has_entry("soc", "core", i, "move_elim") && Config::get_bool("soc", "core", i, "move_elim"))
+    , idiomElim(Config::has_entry("soc", "core", i, "idiom_elim") && Config::get_bool("soc", "core", i, "idiom_elim"))
+    , nMoveElim(fmt::format("P({})_nMoveElim", i))
+    , nZeroIdiom(fmt::format("P({})_nZeroIdiom", i))
+    , nConstIdiom(fmt::format("P({})_nConstIdiom", i))
+    , prfOccupancy(fmt::format("P({})_prfOccupancy", i))
+    , nPrfBankConflict(fmt::format("P({})_nPrfBankConflict", i))
+    , nPrfEarly(fmt::format("P({})_nPrfEarly", i))
+    // A recovery squashes the ROB tail and rolls back the shared RAT, one hart only
+    , nBranchCkpt(smt_size == 1 && Config::has_entry("soc", "core", i, "branch_checkpoints")
+                      ? Config::get_integer("soc", "core", i, "branch_checkpoints", 0, 1024)
+                      : 0)
+    , nCkptRecover(fmt::format("P({})_nCkptRecover", i))
+    , nCkptDrain(fmt::format("P({})_nCkptDrain", i))
+    , nCkptFull(fmt::format("P({})_nCkptFull", i))
+    , nCkptSquash(fmt::format("P({})_nCkptSquash", i))
     , clusterManager(gm, i, this)
 #ifdef TRACK_TIMELEAK
     , avgPNRHitLoadSpec(fmt::format("P({})_avgPNRHitLoadSpec", i))
@@ -130,7 +146,30 @@ OoOProcessor::OoOProcessor(std::shared_ptr<Gmemory_system> gm, CPU_t i)
 
   codeProfile_trigger = 0;
 
-  nTotalRegs = Config::get_integer("soc", "core", gm->getCoreId(), "num_regs", 32);
+  nTotalRegs     = Config::get_integer("soc", "core", gm->getCoreId(), "num_regs", 32);
+  freeBranchCkpt = nBranchCkpt;
+  ratLogBase     = 0;
+  if (nBranchCkpt) {
+    for (auto &fe : smt_fetch.fe) {
+      fe->enable_wrong_path_rename();  // a miss recovers from its checkpoint
+    }
+  }
+
+  if (Config::has_entry("soc", "core", i, "prf_size")) {
+    auto prf_size = Config::get_integer("soc", "core", i, "prf_size", 0, 32767);
+    if (prf_size > 0) {
+      auto banks = Config::has_entry("soc", "core", i, "prf_banks") ? Config::get_integer("soc", "core", i, "prf_banks", 1, 64) : 1;
+      auto ports = Config::has_entry("soc", "core", i, "prf_read_ports")
+                       ? Config::get_integer("soc", "core", i, "prf_read_ports", 0, 64)
+                       : 0;
+      auto policy = Phys_regfile::Release::Retire;
+      if (Config::has_entry("soc", "core", i, "prf_release")
+          && Config::get_string("soc", "core", i, "prf_release", {"retire", "early"}) == "early") {
+        policy = Phys_regfile::Release::Early;
+      }
+      prf = std::make_unique<Phys_regfile>(prf_size, banks, ports, policy);
+    }
+  }
 
   flushing         = false;
   replayRecovering = false;
@@ -206,8 +245,11 @@ bool OoOProcessor::advance_clock_drain() {
   if (!pipeQ.instQueue.empty()) {
     auto n = issue();
     spaceInInstQueue += n;
-  } else if (ROB.empty() && rROB.empty() && !pipeQ.pipeLine.hasOutstandingItems()) {
-    return false;
+  } else {
+    rename_wrong_path();  // fetch is stopped behind a mispredicted branch
+    if (ROB.empty() && rROB.empty() && !pipeQ.pipeLine.hasOutstandingItems()) {
+      return false;
+    }
   }
 
   retire();
@@ -233,8 +275,15 @@ void OoOProcessor::executing(Dinst *dinst)
   dinst->markExecuting();
   Tracer::stage(dinst, "EX");
 
+  if (prf) {
+    auto nearly = prf->get_nearly();
+    prf->read(dinst->getPhysSrc1());
+    prf->read(dinst->getPhysSrc2());
+    nPrfEarly.add(prf->get_nearly() - nearly, dinst->has_stats());
+  }
+
 #ifdef LATE_ALLOC_REGISTER
-  if (dinst->getInst()->hasDstRegister()) {
+  if (dinst->getInst()->hasDstRegister() && !prf) {
     nTotalRegs--;
   }
 #endif
@@ -283,26 +332,124 @@ void OoOProcessor::executing(Dinst *dinst)
 // 1}}}
 //
 void OoOProcessor::executed([[maybe_unused]] Dinst *dinst) {
+  if (prf) {
+    auto nearly = prf->get_nearly();
+    prf->write(dinst->getPhysDst());  // writeback, the register can now be released early
+    nPrfEarly.add(prf->get_nearly() - nearly, dinst->has_stats());
+  }
+
+  if (dinst->hasCheckpoint()) {
+    freeBranchCkpt++;
+    if (dinst->isBranchMiss()) {
+      squash(dinst);  // drops the checkpoint and the younger ones
+      nCkptRecover.inc(dinst->has_stats());
+    } else {
+      rat_release(dinst->getID());
+      if (prf) {
+        prf->release_checkpoint(dinst->getID());
+      }
+    }
+  } else if (nBranchCkpt && dinst->isBranchMiss()) {
+    nCkptDrain.inc(dinst->has_stats());
+  }
+
+  if (!ratAliases.empty()) {
+    for (size_t i = 0; i < ratAliases.size();) {
+      auto [reg, producer] = ratAliases[i];
+      if (producer != dinst) {
+        i++;
+        continue;
+      }
+      if (RAT[reg] == dinst) {
+        RAT[reg] = 0;
+      }
+      ratAliases[i] = ratAliases.back();
+      ratAliases.pop_back();
+    }
+  }
 #ifdef TRACK_FORWARDING
   fwdDone[dinst->getInst()->getDst1()] = globalClock;
   fwdDone[dinst->getInst()->getDst2()] = globalClock;
 #endif
 }
 
+TimeDelta_t OoOProcessor::reg_read_delay(Dinst *dinst, Time_t when) {
+  if (!prf) {
+    return 0;
+  }
+
+  Phys_regfile::Preg srcs[2] = {dinst->getPhysSrc1(), dinst->getPhysSrc2()};
+  auto               delay   = prf->read_delay(srcs, 2, when);
+  nPrfBankConflict.inc(delay > 0 && dinst->has_stats());
+
+  return delay;
+}
+
 StallCause OoOProcessor::add_inst(Dinst *dinst) {
+  StallCause sc = can_rename(dinst, (ROB.size() + rROB.size()) < (MaxROBSize - 1));
+  if (sc == NoStall) {
+    rename(dinst);
+  }
+  return sc;
+}
+/* }}} */
+
+int32_t OoOProcessor::add_inst_group(IBucket *bucket, int32_t max, StallCause &stall) {
+  /* rename a fetch bucket in one pass {{{1 */
+
+  // The ROB space is checked once for the group, the RAT is read and
+  // updated in program order so intra-group dependences are resolved here.
+  const int32_t n        = std::min<int32_t>(max, bucket->size());
+  const int32_t rob_free = static_cast<int32_t>(MaxROBSize - 1) - static_cast<int32_t>(ROB.size() + rROB.size());
+
+  int32_t i = 0;
+  for (; i < n; i++) {
+    Dinst *dinst = bucket->top();
+
+    stall = can_rename(dinst, i < rob_free);
+    if (stall != NoStall) {
+      break;
+    }
+    dinst->setGProc(this);  // select reads the register file delay through it
+    rename(dinst);
+
+    bucket->pop();
+  }
+
+  return i;
+}
+/* }}} */
+
+void OoOProcessor::rename_wrong_path() {
+  /* rename the wrong path of a checkpointed miss {{{1 */
+  int32_t n = 0;
+  for (auto &fe : smt_fetch.fe) {
+    Dinst *dinst;
+    while (n < IssueWidth && (dinst = fe->wrong_path_next()) != nullptr) {
+      dinst->setGProc(this);
+      if (add_inst(dinst) != NoStall) {
+        return;
+      }
+      fe->wrong_path_renamed();
+      n++;
+    }
+  }
+}
+/* }}} */
+
+StallCause OoOProcessor::can_rename(Dinst *dinst, bool rob_space) {
+  /* resource checks before rename {{{1 */
   if (replayRecovering && dinst->getID() > replayID) {
     Tracer::stage(dinst, "Wrep");
     return ReplaysStall;
   }
 
-  if ((ROB.size() + rROB.size()) >= (MaxROBSize - 1)) {
+  if (!rob_space) {
     Tracer::stage(dinst, "Wrob");
     return SmallROBStall;
   }
 
-  const Instruction *inst = dinst->getInst();
-
-  if (nTotalRegs <= 0) {
+  if (prf ? !prf->has_free() : nTotalRegs <= 0) {
     Tracer::stage(dinst, "Wreg");
     return SmallREGStall;
   }
@@ -314,22 +461,55 @@ StallCause OoOProcessor::add_inst(Dinst *dinst) {
     dinst->set(cluster, res);
   }
 
+  if (can_eliminate(dinst)) {
+    return NoStall;  // no window entry
+  }
+
   StallCause sc = cluster->canIssue(dinst);
   if (sc != NoStall) {
     Tracer::stage(dinst, "Wcls");
     return sc;
   }
 
+  return NoStall;
+}
+/* }}} */
+
+void OoOProcessor::rename(Dinst *dinst) {
+  /* insert in the ROB, the window and the RAT {{{1 */
+  if (can_eliminate(dinst)) {
+    eliminate(dinst);
+    return;
+  }
+
+  const Instruction *inst = dinst->getInst();
+
   // if no stalls were detected do the following:
   //
   // BEGIN INSERTION (note that cluster already inserted in the window)
   // dinst->dump("");
 
 #ifndef LATE_ALLOC_REGISTER
-  if (inst->hasDstRegister()) {
+  if (inst->hasDstRegister() && !prf) {
     nTotalRegs--;
   }
 #endif
+  if (prf) {
+    prf_rename(dinst, prf_dst(inst) != LREG_InvalidOutput ? prf->alloc() : Phys_regfile::NONE);
+  }
+
+  // Direct jumps and calls can not mispredict at execute, no checkpoint
+  if (nBranchCkpt && inst->isControl() && !(inst->isJump() && !inst->isIndirect())) {
+    if (freeBranchCkpt > 0) {
+      freeBranchCkpt--;
+      dinst->markCheckpoint();
+      if (prf) {
+        prf->checkpoint(dinst->getID());
+      }
+    } else {
+      nCkptFull.inc(dinst->has_stats());
+    }
+  }
 
   if (!scooreMemory) {  // no dynamic serialization for tradcore
     if (serialize_for > 0 && !replayRecovering) {
@@ -440,8 +620,11 @@ StallCause OoOProcessor::add_inst(Dinst *dinst) {
   dinst->getCluster()->add_inst(dinst);
 
   if (!dinst->isExecuted()) {
-    RAT[inst->getDst1()] = dinst;
-    RAT[inst->getDst2()] = dinst;
+    rat_set(inst->getDst1(), dinst);
+    rat_set(inst->getDst2(), dinst);
+  }
+  if (dinst->hasCheckpoint()) {
+    ratCkpts.emplace_back(dinst->getID(), ratLogBase + ratLog.size());  // after its own writes
   }
 
   I(dinst->getCluster());
@@ -461,8 +644,251 @@ StallCause OoOProcessor::add_inst(Dinst *dinst) {
     }
   }
 #endif
+}
+/* }}} */
 
-  return NoStall;
+void OoOProcessor::eliminate(Dinst *dinst) {
+  /* move elimination and zero/constant idioms {{{1 */
+  const Instruction *inst = dinst->getInst();
+
+  nInst[inst->getOpcode()]->inc(dinst->has_stats());
+  ROB.push(dinst);
+
+  Dinst *producer = nullptr;
+  switch (dinst->getIdiom()) {
+    case Dinst_idiom::Move: {
+      RegType src = inst->getSrc1() != LREG_R0 ? inst->getSrc1() : inst->getSrc2();
+      if (prf) {
+        prf_rename(dinst, prf->get_map(src));
+      }
+      producer = RAT[src];
+      if (producer && !prf) {
+        auto it = elimRefs.find(producer->getID());
+        if (it == elimRefs.end()) {
+          elimRefs[producer->getID()] = 2;
+        } else {
+          it->second++;
+        }
+        elimOwner[dinst->getID()] = producer->getID();
+      }
+      if (producer) {
+        ratAliases.emplace_back(inst->getDst1(), producer);
+      }
+      nMoveElim.inc(dinst->has_stats());
+    } break;
+    case Dinst_idiom::Zero:
+      if (prf) {
+        prf_rename(dinst, Phys_regfile::NONE);
+      }
+      nZeroIdiom.inc(dinst->has_stats());
+      break;
+    case Dinst_idiom::Const:
+      // A register holds the immediate, written at rename
+      if (prf) {
+        auto p = prf_dst(inst) != LREG_InvalidOutput ? prf->alloc() : Phys_regfile::NONE;
+        prf_rename(dinst, p);
+        prf->write(p);
+      } else {
+        nTotalRegs--;
+      }
+      nConstIdiom.inc(dinst->has_stats());
+      break;
+    default: I(0);
+  }
+
+  rat_set(inst->getDst1(), producer);
+  I(inst->getDst2() == LREG_InvalidOutput);
+
+  dinst->markRenamed();
+  dinst->markEliminated();
+  Tracer::stage(dinst, "RN");
+}
+/* }}} */
+
+void OoOProcessor::release_dst(Dinst *dinst) {
+  /* free the destination register at retirement {{{1 */
+  if (!dinst->getInst()->hasDstRegister()) {
+    return;
+  }
+
+  if (prf) {
+    prf->retire_old(dinst->getPhysOld());
+    return;
+  }
+
+  Time_t owner = dinst->getID();
+  if (dinst->isEliminated() && dinst->getIdiom() != Dinst_idiom::Const) {
+    if (dinst->getIdiom() != Dinst_idiom::Move) {
+      return;
+    }
+    auto it = elimOwner.find(owner);
+    if (it == elimOwner.end()) {
+      return;  // the source was ready, nothing shared
+    }
+    owner = it->second;
+    elimOwner.erase(it);
+  }
+
+  if (!elimRefs.empty()) {
+    auto it = elimRefs.find(owner);
+    if (it != elimRefs.end()) {
+      if (--it->second > 0) {
+        return;
+      }
+      elimRefs.erase(it);
+    }
+  }
+
+  nTotalRegs++;
+}
+/* }}} */
+
+void OoOProcessor::rat_set(RegType reg, Dinst *dinst) {
+  if (!ratCkpts.empty() && reg != LREG_InvalidOutput) {
+    Dinst *prev = RAT[reg];
+    ratLog.push_back({reg, prev, prev ? prev->getID() : 0});
+  }
+  RAT[reg] = dinst;
+}
+
+void OoOProcessor::rat_trim() {
+  uint64_t keep = ratCkpts.empty() ? ratLogBase + ratLog.size() : ratCkpts.front().second;
+  while (ratLogBase < keep) {
+    ratLog.pop_front();
+    ratLogBase++;
+  }
+}
+
+void OoOProcessor::rat_release(Time_t id) {
+  auto it = std::find_if(ratCkpts.begin(), ratCkpts.end(), [id](const auto &c) { return c.first == id; });
+  if (it == ratCkpts.end()) {
+    return;
+  }
+  ratCkpts.erase(it);
+  rat_trim();
+}
+
+void OoOProcessor::rat_restore(Time_t id) {
+  /* undo the RAT writes after checkpoint id, newest first {{{1 */
+  auto it = std::find_if(ratCkpts.begin(), ratCkpts.end(), [id](const auto &c) { return c.first == id; });
+  if (it == ratCkpts.end()) {
+    return;
+  }
+
+  while (ratLogBase + ratLog.size() > it->second) {
+    auto e = ratLog.back();
+    ratLog.pop_back();
+
+    // An executed producer cleared its entry (a recycled one has a new ID)
+    bool live  = e.prev && e.prev->getID() == e.prev_id && !e.prev->isExecuted();
+    RAT[e.reg] = live ? e.prev : 0;
+  }
+
+  ratCkpts.erase(it, ratCkpts.end());
+  rat_trim();
+}
+/* }}} */
+
+void OoOProcessor::squash(Dinst *branch) {
+  /* recover a mispredicted branch from its checkpoint {{{1 */
+  I(branch->hasCheckpoint());
+
+  rat_restore(branch->getID());
+
+  // Youngest first, so a producer has no squashed consumer left when it goes
+  while (!ROB.empty() && ROB.back()->getID() > branch->getID()) {
+    Dinst *dinst = ROB.back();
+    ROB.pop_back();
+
+    nCkptSquash.inc(branch->has_stats());
+    squash_inst(dinst);
+  }
+
+  if (prf) {
+    prf->restore(branch->getID());
+  }
+}
+/* }}} */
+
+void OoOProcessor::squash_inst(Dinst *dinst) {
+  /* give back what one squashed instruction holds {{{1 */
+  dinst->markSquashed();
+  Tracer::event(dinst, "squash");
+
+  if (!dinst->isExecuted()) {
+    dinst->unlinkDeps();
+  }
+  I(!dinst->hasPending());
+
+  if (dinst->hasCheckpoint()) {
+    freeBranchCkpt++;  // dropped by the restore of the older branch
+  }
+  if (last_serialized == dinst) {
+    last_serialized = 0;
+  }
+  if (last_serializedST == dinst) {
+    last_serializedST = 0;
+  }
+  std::erase_if(ratAliases, [dinst](const auto &a) { return a.second == dinst; });
+
+  if (!dinst->isEliminated()) {
+    dinst->clearRATEntry();
+    dinst->getCluster()->squash(dinst);  // window entry, registers, LSQ, branch slot
+  }
+
+  if (prf) {
+    // The register map and the free list come back with prf->restore
+    if (!dinst->isEliminated() && !dinst->isExecuting()) {
+      prf->cancel_read(dinst->getPhysSrc1());
+      prf->cancel_read(dinst->getPhysSrc2());
+    }
+  } else {
+#ifdef LATE_ALLOC_REGISTER
+    if (dinst->isEliminated() || dinst->isExecuting())
+#endif
+      release_dst(dinst);
+  }
+
+  // An issued instruction still has an event pending, it is recycled there
+  if (!dinst->isIssued() || dinst->isExecuted()) {
+    dinst->scrap();
+  }
+}
+/* }}} */
+
+RegType OoOProcessor::prf_dst(const Instruction *inst) {
+  if (!inst->hasDstRegister()) {
+    return LREG_InvalidOutput;
+  }
+
+  RegType dst = inst->getDst1() != LREG_InvalidOutput ? inst->getDst1() : inst->getDst2();
+  return dst == LREG_R0 ? LREG_InvalidOutput : dst;
+}
+
+void OoOProcessor::prf_rename(Dinst *dinst, Phys_regfile::Preg p) {
+  /* map the destination to p in the physical register file {{{1 */
+  const Instruction *inst = dinst->getInst();
+
+  // Eliminated instructions do not read the register file
+  auto src1 = Phys_regfile::NONE;
+  auto src2 = Phys_regfile::NONE;
+  if (!can_eliminate(dinst)) {
+    src1 = prf->get_map(inst->getSrc1());
+    src2 = prf->get_map(inst->getSrc2());
+    prf->add_reader(src1);
+    prf->add_reader(src2);
+  }
+
+  auto old = Phys_regfile::NONE;
+  if (inst->hasDstRegister()) {
+    // R0 writes get no register (p is NONE), R0 reads never see the mapping
+    RegType dst = prf_dst(inst);
+    I(dst != LREG_InvalidOutput || p == Phys_regfile::NONE);
+    old = prf->rename(dst, p);
+  }
+
+  dinst->setPhysRegs(src1, src2, p, old);
+  prfOccupancy.sample(prf->get_size() - prf->get_nfree(), dinst->has_stats());
 }
 /* }}} */
 
@@ -1592,7 +2018,12 @@ void OoOProcessor::retire() {
 
     I(dinst->getCluster());
 
-    bool done = dinst->getCluster()->retire(dinst, flushing);
+    bool done;
+    if (dinst->isEliminated()) {
+      done = dinst->getClusterResource()->retire(dinst, flushing);  // never entered the cluster window
+    } else {
+      done = dinst->getCluster()->retire(dinst, flushing);
+    }
     if (!done) {
       break;
     }
@@ -1667,9 +2098,7 @@ void OoOProcessor::retire() {
       }
     }
 #endif
-    if (dinst->getInst()->hasDstRegister()) {
-      nTotalRegs++;
-    }
+    release_dst(dinst);
 
     if (!dinst->getInst()->isStore()) {  // Stores can perform after retirement
       I(dinst->isPerformed());
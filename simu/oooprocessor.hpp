@@ -3,6 +3,8 @@
 #pragma once
 
 #include <algorithm>
+#include <deque>
+#include <memory>
 #include <vector>
 
 #include "callback.hpp"
@@ -10,6 +12,7 @@
 #include "fetchengine.hpp"
 #include "gprocessor.hpp"
 #include "iassert.hpp"
+#include "phys_regfile.hpp"
 #include "pipeline.hpp"
 #include "stats.hpp"
 #include "stats_code.hpp"
@@ -73,6 +76,70 @@ private:
   bool                                                                  scooreMemory;
   StaticCallbackMember0<OoOProcessor, &OoOProcessor::retire_lock_check> retire_lock_checkCB;
 
+  // Rename-time elimination (move_elim, idiom_elim). A move shares the
+  // register of its in-flight producer, the register is released when the
+  // producer and all the moves sharing it have retired.
+  const bool moveElim;
+  const bool idiomElim;
+
+  absl::flat_hash_map<Time_t, int32_t>  elimRefs;    // producer ID -> holders
+  absl::flat_hash_map<Time_t, Time_t>   elimOwner;   // move ID -> producer ID
+  std::vector<std::pair<RegType, Dinst *>> ratAliases;  // RAT entries set by a move, cleared when the producer executes
+
+  Stats_cntr nMoveElim;
+  Stats_cntr nZeroIdiom;
+  Stats_cntr nConstIdiom;
+
+  bool can_eliminate(const Dinst *dinst) const {
+    auto idiom = dinst->getIdiom();
+    return (idiom == Dinst_idiom::Move && moveElim) || ((idiom == Dinst_idiom::Zero || idiom == Dinst_idiom::Const) && idiomElim);
+  }
+  void eliminate(Dinst *dinst);
+  void release_dst(Dinst *dinst);
+
+  // Explicit physical register file (prf_size), nTotalRegs is the counter
+  // model used otherwise
+  std::unique_ptr<Phys_regfile> prf;
+
+  Stats_avg  prfOccupancy;
+  Stats_cntr nPrfBankConflict;
+  Stats_cntr nPrfEarly;
+
+  // Destination mapped in the register file, LREG_InvalidOutput for none or R0
+  static RegType prf_dst(const Instruction *inst);
+  void           prf_rename(Dinst *dinst, Phys_regfile::Preg p);
+
+  // Rename checkpoints at branches (branch_checkpoints). A mispredicted
+  // branch holding one recovers when it executes: the instructions renamed
+  // after it are squashed, and the RAT and the register map go back to the
+  // branch. Without one it drains (drain_on_miss) or unblocks fetch at
+  // execute with nothing renamed past it.
+  const int32_t nBranchCkpt;
+  int32_t       freeBranchCkpt;
+
+  // RAT writes while checkpoints are live, a squash undoes the ones after
+  // the branch. An older producer is restored unless it executed meanwhile
+  struct Rat_undo {
+    RegType reg;
+    Dinst  *prev;
+    Time_t  prev_id;
+  };
+  std::deque<Rat_undo>                    ratLog;
+  uint64_t                                ratLogBase;  // ratLog[0] position
+  std::deque<std::pair<Time_t, uint64_t>> ratCkpts;    // branch ID, ratLog position
+
+  void rat_set(RegType reg, Dinst *dinst);
+  void rat_release(Time_t id);
+  void rat_restore(Time_t id);
+  void rat_trim();
+
+  void squash_inst(Dinst *dinst);
+
+  Stats_cntr nCkptRecover;
+  Stats_cntr nCkptDrain;
+  Stats_cntr nCkptFull;
+  Stats_cntr nCkptSquash;
+
 protected:
   ClusterManager clusterManager;
 
@@ -171,11 +238,23 @@ protected:
   Stats_cntr num_ldbr_others;
 #endif
 
+  StallCause can_rename(Dinst *dinst, bool rob_space);
+  void       rename(Dinst *dinst);
+
+  // Mispredicted branch with a checkpoint executed: drop everything renamed
+  // after it and restore the rename state
+  void squash(Dinst *branch);
+
+  // Renames the wrong path kept by the fetch engines (wrong_path_size) once
+  // their missed branch renamed with a checkpoint, squash removes it
+  void rename_wrong_path();
+
   // BEGIN VIRTUAL FUNCTIONS of GProcessor
   bool advance_clock_drain() override final;
   bool advance_clock() override final;
 
   StallCause add_inst(Dinst *dinst) override final;
+  int32_t    add_inst_group(IBucket *bucket, int32_t max, StallCause &stall) override final;
   void       retire();
 
   // END VIRTUAL FUNCTIONS of GProcessor
@@ -765,13 +844,15 @@ public:
 
 #endif
 
-  void   executing(Dinst *dinst) override final;
-  void   executed(Dinst *dinst) override final;
-  LSQ   *getLSQ() override final { return &lsq; }
-  void   replay(Dinst *target) override final;
-  bool   is_nuking() override final { return flushing; }
-  bool   isReplayRecovering() override final { return replayRecovering; }
-  Time_t getReplayID() override final { return replayID; }
+  void        executing(Dinst *dinst) override final;
+  void        executed(Dinst *dinst) override final;
+  TimeDelta_t reg_read_delay(Dinst *dinst, Time_t when) override final;
+  LSQ        *getLSQ() override final { return &lsq; }
+  const Phys_regfile *get_prf() const { return prf.get(); }
+  void        replay(Dinst *target) override final;
+  bool        is_nuking() override final { return flushing; }
+  bool        isReplayRecovering() override final { return replayRecovering; }
+  Time_t      getReplayID() override final { return replayID; }
 
   void dumpROB();
   bool loadIsSpec();
@@ -0,0 +1,267 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include "oooprocessor.hpp"
+
+#include <fstream>
+#include <memory>
+#include <vector>
+
+#include "config.hpp"
+#include "dinst.hpp"
+#include "gmemory_system.hpp"
+#include "gtest/gtest.h"
+#include "instruction.hpp"
+
+// Exposes rename (can_rename + rename) for the tests
+class OoOProcessor_rename : public OoOProcessor {
+public:
+  using OoOProcessor::OoOProcessor;
+
+  StallCause rename(Dinst *dinst) {
+    dinst->setGProc(this);
+    return add_inst(dinst);
+  }
+
+  using OoOProcessor::squash;
+};
+
+class OoOProcessor_test : public ::testing::Test {
+protected:
+  // Memory objects and stats are global, one processor for the suite
+  static inline std::shared_ptr<Gmemory_system>      gm;
+  static inline std::unique_ptr<OoOProcessor_rename> proc;
+
+  static void SetUpTestSuite() {
+    std::ofstream file;
+
+    file.open("oooprocessor_test.toml");
+    file << "[soc]\n";
+    file << "core = [\"c0\"]\n";
+    file << "[c0]\n";
+    file << "type          = \"ooo\"\n";
+    file << "frequency_mhz = 1000\n";
+    file << "bpred         = [\"bp0\"]\n";
+    file << "fetch_align   = true\n";
+    file << "trace_align   = false\n";
+    file << "max_bb_cycle  = 1\n";
+    file << "prefetcher    = \"pref0\"\n";
+    file << "smt           = 1\n";
+    file << "caches        = false\n";
+    file << "scb_size      = 16\n";
+    file << "memory_replay = false\n";
+    file << "st_fwd_delay  = 2\n";
+    file << "ldq_size      = 16\n";
+    file << "stq_size      = 16\n";
+    file << "stq_late_alloc = false\n";
+    file << "ldq_late_alloc = false\n";
+    file << "storeset_size = 128\n";
+    file << "il1           = \"il1_cache IL1\"\n";
+    file << "dl1           = \"dl1_cache DL1\"\n";
+    file << "scoore_serialize = false\n";
+    file << "decode_delay  = 2\n";
+    file << "rename_delay  = 1\n";
+    file << "ftq_size      = 8\n";
+    file << "instq_size    = 8\n";
+    file << "fetch_width   = 4\n";
+    file << "issue_width   = 4\n";
+    file << "retire_width  = 4\n";
+    file << "rob_size      = 32\n";
+    file << "cluster       = [\"aunit\", \"bunit\", \"cunit\", \"munit\"]\n";
+    file << "num_regs      = 64\n";
+    file << "inter_cluster_lat = 0\n";
+    file << "cluster_scheduler = \"RoundRobin\"\n";
+    file << "max_branches  = 8\n";
+    file << "drain_on_miss = false\n";
+    file << "commit_delay  = 1\n";
+    file << "replay_serialize_for = 0\n";
+    file << "move_elim     = true\n";
+    file << "idiom_elim    = true\n";
+    file << "prf_size      = 64\n";
+    file << "branch_checkpoints = 4\n";
+    file << "[bp0]\n";
+    file << "type             = \"oracle\"\n";
+    file << "bp_addr_shift    = 0\n";
+    file << "ras_size         = 4\n";
+    file << "ras_prefetch     = false\n";
+    file << "delay            = 1\n";
+    file << "btb_history_size = 0\n";
+    file << "btb_split_il1    = false\n";
+    file << "btb_size         = 32\n";
+    file << "btb_line_size    = 1\n";
+    file << "btb_assoc        = 4\n";
+    file << "btb_repl_policy  = \"LRU\"\n";
+    file << "[pref0]\n";
+    file << "type     = \"void\"\n";
+    file << "degree   = 1\n";
+    file << "distance = 0\n";
+    file << "[alu0]\nnum = 2\nlat = 1\nocc = 1\n";
+    file << "[balu]\nnum = 1\nlat = 1\nocc = 1\n";
+    file << "[calu]\nnum = 1\nlat = 4\nocc = 1\n";
+    file << "[lsu]\nnum = 1\nlat = 1\nocc = 1\n";
+    const char *units[][2] = {
+        {"aunit", "iAALU = \"alu0\"\niRALU = \"alu0\"\n"},
+        {"bunit",
+         "iBALU_LBRANCH = \"balu\"\niBALU_LJUMP = \"balu\"\niBALU_LCALL = \"balu\"\niBALU_RBRANCH = \"balu\"\n"
+         "iBALU_RJUMP = \"balu\"\niBALU_RCALL = \"balu\"\niBALU_RET = \"balu\"\n"},
+        {"cunit",
+         "iCALU_FPMULT = \"calu\"\niCALU_FPDIV = \"calu\"\niCALU_FPALU = \"calu\"\niCALU_MULT = \"calu\"\n"
+         "iCALU_DIV = \"calu\"\n"},
+        {"munit", "iLALU_LD = \"lsu\"\niSALU_ST = \"lsu\"\niSALU_LL = \"lsu\"\niSALU_SC = \"lsu\"\niSALU_ADDR = \"lsu\"\n"},
+    };
+    for (const auto &u : units) {
+      file << "[" << u[0] << "]\n";
+      file << "win_size   = 8\n";
+      file << "sched_num  = 2\n";
+      file << "sched_occ  = 1\n";
+      file << "sched_lat  = 0\n";
+      file << "recycle_at = \"executed\"\n";
+      file << "num_regs   = 32\n";
+      file << "late_alloc = false\n";
+      file << u[1];
+    }
+    for (const auto *c : {"il1_cache", "dl1_cache"}) {
+      file << "[" << c << "]\n";
+      file << "type      = \"cache\"\n";
+      file << "line_size = 64\n";
+      file << "delay     = 1\n";
+      file << "lower_level = \"\"\n";
+    }
+    file.close();
+
+    Config::init("oooprocessor_test.toml");
+    globalClock = 100;  // the store set timer needs a clock to schedule against
+
+    gm   = std::make_shared<Dummy_memory_system>(0);
+    proc = std::make_unique<OoOProcessor_rename>(gm, 0);
+  }
+
+  void SetUp() override { ASSERT_FALSE(Config::has_errors()); }
+
+  static Dinst *create(Opcode op, RegType src1, RegType dst, Dinst_idiom idiom = Dinst_idiom::None) {
+    auto *d = Dinst::create(Instruction(op, src1, LREG_NoDependence, dst, LREG_InvalidOutput), 0x1000, 0, 0, true);
+    d->setIdiom(idiom);
+    return d;
+  }
+};
+
+TEST_F(OoOProcessor_test, move_elimination) {
+  auto *mul = create(iCALU_MULT, LREG_R1, LREG_R5);
+  EXPECT_EQ(proc->rename(mul), NoStall);
+  EXPECT_NE(mul->getPhysDst(), Phys_regfile::NONE);
+
+  // r7 = mv r5 shares the multiply register and takes no window entry
+  auto *mv    = create(iAALU, LREG_R5, LREG_R7, Dinst_idiom::Move);
+  auto *add   = create(iAALU, LREG_R5, LREG_R8);
+  auto  space = [](Dinst *d) { return d->getCluster() ? d->getCluster()->getAvailSpace() : -1; };
+
+  EXPECT_EQ(proc->rename(mv), NoStall);
+  auto avail = space(mv);
+  EXPECT_TRUE(mv->isEliminated());
+  EXPECT_TRUE(mv->isExecuted());
+  EXPECT_EQ(mv->getPhysDst(), mul->getPhysDst());
+
+  EXPECT_EQ(proc->rename(add), NoStall);
+  EXPECT_FALSE(add->isEliminated());
+  EXPECT_NE(add->getPhysDst(), mul->getPhysDst());
+  EXPECT_EQ(space(add), avail - 1);
+
+  // A consumer of r7 reads the multiply register
+  auto *use = create(iAALU, LREG_R7, LREG_R9);
+  EXPECT_EQ(proc->rename(use), NoStall);
+  EXPECT_EQ(use->getPhysSrc1(), mul->getPhysDst());
+}
+
+TEST_F(OoOProcessor_test, zero_and_const_idioms) {
+  auto *zero = create(iAALU, LREG_R0, LREG_R10, Dinst_idiom::Zero);
+  EXPECT_EQ(proc->rename(zero), NoStall);
+  EXPECT_TRUE(zero->isEliminated());
+  EXPECT_EQ(zero->getPhysDst(), Phys_regfile::NONE);
+
+  auto *cst = create(iAALU, LREG_R0, LREG_R11, Dinst_idiom::Const);
+  EXPECT_EQ(proc->rename(cst), NoStall);
+  EXPECT_TRUE(cst->isEliminated());
+  EXPECT_NE(cst->getPhysDst(), Phys_regfile::NONE);
+
+  // Readers of the zeroed register wait on nothing
+  auto *use = create(iAALU, LREG_R10, LREG_R12);
+  EXPECT_EQ(proc->rename(use), NoStall);
+  EXPECT_EQ(use->getPhysSrc1(), Phys_regfile::NONE);
+}
+
+TEST_F(OoOProcessor_test, branch_checkpoints) {
+  auto *br = Dinst::create(Instruction(iBALU_LBRANCH, LREG_R1, LREG_R2, LREG_InvalidOutput, LREG_InvalidOutput), 0x1000, 0x2000, 0, true);
+  EXPECT_EQ(proc->rename(br), NoStall);
+  EXPECT_TRUE(br->hasCheckpoint());
+
+  // Direct jumps and calls resolve without a checkpoint
+  auto *jmp = Dinst::create(Instruction(iBALU_LJUMP, LREG_R0, LREG_R0, LREG_InvalidOutput, LREG_InvalidOutput), 0x1004, 0x3000, 0, true);
+  EXPECT_EQ(proc->rename(jmp), NoStall);
+  EXPECT_FALSE(jmp->hasCheckpoint());
+
+  auto *call = Dinst::create(Instruction(iBALU_LCALL, LREG_R0, LREG_R0, LREG_R1, LREG_InvalidOutput), 0x1008, 0x4000, 0, true);
+  EXPECT_EQ(proc->rename(call), NoStall);
+  EXPECT_FALSE(call->hasCheckpoint());
+
+  auto *ind = Dinst::create(Instruction(iBALU_RJUMP, LREG_R5, LREG_R0, LREG_InvalidOutput, LREG_InvalidOutput), 0x100c, 0x5000, 0, true);
+  EXPECT_EQ(proc->rename(ind), NoStall);
+  EXPECT_TRUE(ind->hasCheckpoint());
+}
+
+TEST_F(OoOProcessor_test, branch_recovery) {
+  const auto *prf   = proc->get_prf();
+  auto        space = [](Dinst *d) { return d->getCluster()->getAvailSpace(); };
+
+  auto *mul = create(iCALU_MULT, LREG_R1, LREG_R5);
+  auto *ld0 = Dinst::create(Instruction(iLALU_LD, LREG_R0, LREG_NoDependence, LREG_R11, LREG_InvalidOutput), 0x100c, 0x7000, 0, true);
+  EXPECT_EQ(proc->rename(mul), NoStall);
+  EXPECT_EQ(proc->rename(ld0), NoStall);
+
+  auto *br = Dinst::create(Instruction(iBALU_LBRANCH, LREG_R1, LREG_R2, LREG_InvalidOutput, LREG_InvalidOutput), 0x1010, 0x2000, 0, true);
+  EXPECT_EQ(proc->rename(br), NoStall);
+  ASSERT_TRUE(br->hasCheckpoint());
+
+  auto nfree  = prf->get_nfree();
+  auto nckpt  = prf->get_ncheckpoints();
+  auto r6     = prf->get_map(LREG_R6);
+  auto c_free = space(mul);
+  auto m_free = space(ld0);
+
+  // Wrong path: redefine r5, a chain of consumers, a load, a branch and an
+  // instruction with ready sources (issued, its execute event pending)
+  auto *mul2 = create(iCALU_MULT, LREG_R5, LREG_R5);
+  auto *add  = create(iAALU, LREG_R5, LREG_R6);
+  auto *ld   = Dinst::create(Instruction(iLALU_LD, LREG_R6, LREG_NoDependence, LREG_R7, LREG_InvalidOutput), 0x1014, 0x8000, 0, true);
+  auto *br2  = Dinst::create(Instruction(iBALU_LBRANCH, LREG_R7, LREG_R0, LREG_InvalidOutput, LREG_InvalidOutput), 0x1018, 0x3000, 0, true);
+  auto *li   = create(iAALU, LREG_R0, LREG_R8);
+  for (auto *d : {mul2, add, ld, br2, li}) {
+    EXPECT_EQ(proc->rename(d), NoStall);
+  }
+  EXPECT_TRUE(br2->hasCheckpoint());
+  EXPECT_TRUE(li->isIssued());
+  EXPECT_EQ(prf->get_nfree(), nfree - 4);
+  EXPECT_EQ(space(mul), c_free - 1);
+
+  proc->squash(br);
+
+  // The free list, the map and the windows are back to the branch
+  EXPECT_EQ(prf->get_nfree(), nfree);
+  EXPECT_EQ(prf->get_ncheckpoints(), nckpt - 1);
+  EXPECT_EQ(space(mul), c_free);
+  EXPECT_EQ(space(ld0), m_free);
+  EXPECT_TRUE(li->isSquashed());  // recycled by its pending event
+
+  // r5 readers wait on the older multiply again, r6 has its old register
+  auto *use5 = create(iAALU, LREG_R5, LREG_R9);
+  auto *use6 = create(iAALU, LREG_R6, LREG_R10);
+  EXPECT_EQ(proc->rename(use5), NoStall);
+  EXPECT_EQ(proc->rename(use6), NoStall);
+  EXPECT_EQ(use5->getParentSrc1(), mul);
+  EXPECT_EQ(use5->getPhysSrc1(), mul->getPhysDst());
+  EXPECT_EQ(use6->getParentSrc1(), nullptr);
+  EXPECT_EQ(use6->getPhysSrc1(), r6);
+
+  for (int i = 0; i < 20; ++i) {  // the squashed event drops the instruction
+    EventScheduler::advanceClock();
+  }
+}
+
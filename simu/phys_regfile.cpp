@@ -0,0 +1,244 @@
+// See LICENSE for details.
+
+#include "phys_regfile.hpp"
+
+#include <algorithm>
+
+Phys_regfile::Phys_regfile(int32_t _nregs, int32_t _nbanks, int32_t _read_ports, Release policy)
+    : nregs(_nregs), nbanks(_nbanks), read_ports(_read_ports), release_policy(policy), regs(_nregs), map(LREG_MAX, NONE), banks(_nbanks) {
+  I(nregs > 0 && nregs < 32768);
+  I(nbanks > 0);
+
+  for (Preg p = 0; p < nregs; p++) {
+    regs[p] = {0, 0, 0, 0, true, false, 0};
+    free_list.push_back(p);
+  }
+  for (auto &b : banks) {
+    b = {0, 0};
+  }
+
+  log_base = 0;
+  seq      = 0;
+  n_early  = 0;
+}
+
+void Phys_regfile::acquire(Preg p) {
+  regs[p].refs++;
+  regs[p].free = false;
+  if (!ckpts.empty()) {
+    log.push_back({p, false});
+  }
+}
+
+void Phys_regfile::drop(Preg p) {
+  I(regs[p].refs > 0);
+  regs[p].refs--;
+  if (regs[p].refs == 0) {
+    I(regs[p].pending == 0);
+    regs[p].free    = true;
+    regs[p].readers = 0;
+    free_list.push_back(p);
+  }
+}
+
+void Phys_regfile::check_early(Preg p) {
+  if (release_policy != Release::Early || regs[p].readers > 0 || regs[p].pending == 0) {
+    return;
+  }
+  // The producer is still in flight, the register is not free to reuse
+  if (!regs[p].written) {
+    return;
+  }
+  // A restore could map it again
+  if (!ckpts.empty() && regs[p].redefined >= ckpts.front().seq) {
+    return;
+  }
+
+  while (regs[p].pending > 0) {
+    regs[p].pending--;
+    regs[p].stale++;
+    n_early++;
+    drop(p);
+  }
+}
+
+Phys_regfile::Preg Phys_regfile::alloc() {
+  if (free_list.empty()) {
+    return NONE;
+  }
+
+  Preg p = free_list.front();
+  free_list.pop_front();
+  I(regs[p].free && regs[p].refs == 0);
+  regs[p].free    = false;
+  regs[p].written = false;
+
+  return p;
+}
+
+Phys_regfile::Preg Phys_regfile::rename(RegType r, Preg p) {
+  seq++;
+
+  Preg old = map[r];
+  map[r]   = p;
+  if (p != NONE) {
+    acquire(p);
+  }
+
+  if (old != NONE) {
+    regs[old].pending++;
+    regs[old].redefined = seq;
+    if (!ckpts.empty()) {
+      log.push_back({old, true});
+    }
+    check_early(old);
+  }
+
+  return old;
+}
+
+void Phys_regfile::add_reader(Preg p) {
+  if (p == NONE) {
+    return;
+  }
+  I(!regs[p].free);
+  regs[p].readers++;
+}
+
+void Phys_regfile::read(Preg p) {
+  if (p == NONE) {
+    return;
+  }
+  // A consumer woken by the writeback reads through the bypass, before write()
+  I(regs[p].readers > 0);
+  regs[p].readers--;
+  check_early(p);
+}
+
+void Phys_regfile::cancel_read(Preg p) {
+  if (p == NONE) {
+    return;
+  }
+  I(regs[p].readers > 0);
+  regs[p].readers--;
+  check_early(p);
+}
+
+void Phys_regfile::write(Preg p) {
+  if (p == NONE) {
+    return;
+  }
+  I(!regs[p].free);
+  regs[p].written = true;
+  check_early(p);
+}
+
+void Phys_regfile::retire_old(Preg old) {
+  if (old == NONE) {
+    return;
+  }
+  // Retires come in program order: the ones released early, maybe before a
+  // reallocation of old, come before the redefinitions of the new value
+  if (regs[old].stale > 0) {
+    regs[old].stale--;
+    return;
+  }
+
+  regs[old].pending--;
+  drop(old);
+}
+
+TimeDelta_t Phys_regfile::read_delay(const Preg *srcs, int n, Time_t when) {
+  if (read_ports == 0) {
+    return 0;
+  }
+
+  TimeDelta_t delay = 0;
+  for (int i = 0; i < n; i++) {
+    if (srcs[i] == NONE) {
+      continue;
+    }
+
+    auto &b = banks[srcs[i] % nbanks];
+    if (b.cycle < when) {
+      b.cycle = when;
+      b.used  = 0;
+    }
+    if (b.used >= read_ports) {
+      b.cycle++;
+      b.used = 0;
+    }
+    b.used++;
+
+    delay = std::max<TimeDelta_t>(delay, b.cycle - when);
+  }
+
+  return delay;
+}
+
+void Phys_regfile::checkpoint(uint64_t id) {
+  I(ckpts.empty() || ckpts.back().id < id);
+
+  std::vector<Preg> m;
+  if (!spare_maps.empty()) {
+    m = std::move(spare_maps.back());
+    spare_maps.pop_back();
+  }
+  m.assign(map.begin(), map.end());
+
+  ckpts.push_back({std::move(m), log_base + log.size(), seq, id});
+}
+
+void Phys_regfile::trim_log() {
+  uint64_t keep = ckpts.empty() ? log_base + log.size() : ckpts.front().log_pos;
+  while (log_base < keep) {
+    log.pop_front();
+    log_base++;
+  }
+}
+
+void Phys_regfile::release_checkpoint(uint64_t id) {
+  auto it = std::find_if(ckpts.begin(), ckpts.end(), [id](const Checkpoint &c) { return c.id == id; });
+  if (it == ckpts.end()) {
+    return;  // dropped by the restore of an older one
+  }
+
+  recycle(*it);
+  ckpts.erase(it);
+  trim_log();
+}
+
+bool Phys_regfile::renamed_since(uint64_t id) const {
+  auto it = std::find_if(ckpts.begin(), ckpts.end(), [id](const Checkpoint &c) { return c.id == id; });
+  if (it == ckpts.end()) {
+    return false;
+  }
+
+  return log_base + log.size() > it->log_pos;
+}
+
+void Phys_regfile::restore(uint64_t id) {
+  auto it = std::find_if(ckpts.begin(), ckpts.end(), [id](const Checkpoint &c) { return c.id == id; });
+  if (it == ckpts.end()) {
+    return;
+  }
+
+  // Undo the renames younger than the checkpoint, newest first
+  while (log_base + log.size() > it->log_pos) {
+    auto e = log.back();
+    log.pop_back();
+    if (e.pending) {
+      I(regs[e.p].pending > 0);
+      regs[e.p].pending--;
+    } else {
+      drop(e.p);
+    }
+  }
+
+  map = it->map;
+  for (auto i = it; i != ckpts.end(); ++i) {
+    recycle(*i);
+  }
+  ckpts.erase(it, ckpts.end());
+  trim_log();
+}
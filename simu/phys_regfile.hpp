@@ -0,0 +1,126 @@
+// See LICENSE for details.
+
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "iassert.hpp"
+#include "opcode.hpp"
+#include "snippets.hpp"
+
+// Physical register file with a free list, reference counts (a register can
+// be mapped by several architectural registers after move elimination), a
+// speculative rename map with checkpoints, and banked read ports.
+//
+// An architectural register that was never written maps to NONE: its reset
+// value is not charged to the physical register file.
+class Phys_regfile {
+public:
+  using Preg = int16_t;
+
+  static constexpr Preg NONE = -1;
+
+  enum class Release {
+    Retire,  // old mapping released when the redefining instruction retires
+    Early    // released once redefined and every renamed reader has read it
+  };
+
+private:
+  struct Reg {
+    int16_t  refs;     // mappings (rename map entries, in-flight or committed)
+    int16_t  readers;  // renamed readers that did not read the value yet
+    int16_t  pending;  // mappings redefined but not released yet
+    int16_t  stale;    // released early, the redefining instruction did not retire yet
+    bool     free;
+    bool     written;    // the producer wrote the value
+    uint64_t redefined;  // rename sequence of the last redefinition
+  };
+
+  struct Log_entry {
+    Preg p;
+    bool pending;  // a redefinition, otherwise a new mapping
+  };
+
+  struct Checkpoint {
+    std::vector<Preg> map;
+    uint64_t          log_pos;
+    uint64_t          seq;
+    uint64_t          id;
+  };
+
+  struct Bank_slot {
+    Time_t  cycle;
+    int32_t used;
+  };
+
+  const int32_t nregs;
+  const int32_t nbanks;
+  const int32_t read_ports;  // per bank and cycle, 0 is unlimited
+  const Release release_policy;
+
+  std::vector<Reg>  regs;
+  std::deque<Preg>  free_list;
+  std::vector<Preg> map;
+
+  // Mappings and redefinitions done while checkpoints are live, so that a
+  // restore can undo the ones of the squashed instructions
+  std::deque<Log_entry>  log;
+  uint64_t               log_base;  // log[0] position
+  uint64_t               seq;       // renames so far
+  std::deque<Checkpoint>          ckpts;
+  std::vector<std::vector<Preg>> spare_maps;  // storage of released checkpoints, reused
+
+  std::vector<Bank_slot> banks;
+
+  uint64_t n_early;
+
+  void acquire(Preg p);
+  void drop(Preg p);
+  void check_early(Preg p);
+  void trim_log();
+  void recycle(Checkpoint &c) { spare_maps.emplace_back(std::move(c.map)); }
+
+public:
+  Phys_regfile(int32_t nregs, int32_t nbanks = 1, int32_t read_ports = 0, Release policy = Release::Retire);
+
+  bool    has_free() const { return !free_list.empty(); }
+  int32_t get_nfree() const { return free_list.size(); }
+  int32_t get_size() const { return nregs; }
+  Preg    get_map(RegType r) const { return map[r]; }
+  int32_t get_refs(Preg p) const { return regs[p].refs; }
+  bool    is_free(Preg p) const { return regs[p].free; }
+
+  uint64_t get_nearly() const { return n_early; }
+
+  // Rename: allocate a register for a new value (NONE if none is free)
+  Preg alloc();
+  // Map r to p (p may be shared, or NONE for a hardwired zero). Returns the
+  // previous mapping, to be released through retire_old
+  Preg rename(RegType r, Preg p);
+  // A consumer of p renamed, and the consumer read p. NONE is ignored
+  void add_reader(Preg p);
+  void read(Preg p);
+  // A renamed consumer of p was squashed before reading it
+  void cancel_read(Preg p);
+  // The producer of p wrote it back. Until then p is not released early
+  void write(Preg p);
+  bool is_written(Preg p) const { return regs[p].written; }
+  // The redefining instruction of old retired
+  void retire_old(Preg old);
+
+  // Extra cycles to read srcs at cycle when (bank read port conflicts)
+  TimeDelta_t read_delay(const Preg *srcs, int n, Time_t when);
+
+  // Checkpoints of the rename map. Ids grow with program order (the
+  // instruction ID), unknown ids are ignored
+  void   checkpoint(uint64_t id);
+  // Drops id and the younger ones. Only for a squash: every instruction
+  // renamed after id must be gone, or its retire releases the undone renames
+  void   restore(uint64_t id);
+  void   release_checkpoint(uint64_t id);
+  // Some rename happened after checkpoint id
+  bool   renamed_since(uint64_t id) const;
+  size_t get_ncheckpoints() const { return ckpts.size(); }
+};
@@ -0,0 +1,281 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include "phys_regfile.hpp"
+
+#include <deque>
+#include <random>
+#include <set>
+
+#include "gtest/gtest.h"
+
+using Preg = Phys_regfile::Preg;
+
+TEST(Phys_regfile_test, alloc_release) {
+  Phys_regfile prf(4);
+
+  auto p0 = prf.alloc();
+  EXPECT_EQ(prf.rename(LREG_R1, p0), Phys_regfile::NONE);
+  auto p1 = prf.alloc();
+  auto old = prf.rename(LREG_R1, p1);
+  EXPECT_EQ(old, p0);
+  EXPECT_EQ(prf.get_nfree(), 2);
+
+  prf.retire_old(old);  // redefining instruction retired
+  EXPECT_EQ(prf.get_nfree(), 3);
+  EXPECT_TRUE(prf.is_free(p0));
+  EXPECT_FALSE(prf.is_free(p1));
+}
+
+TEST(Phys_regfile_test, shared_by_move) {
+  Phys_regfile prf(4);
+
+  auto p = prf.alloc();
+  prf.rename(LREG_R1, p);
+  prf.rename(LREG_R2, prf.get_map(LREG_R1));  // eliminated move
+  EXPECT_EQ(prf.get_refs(p), 2);
+
+  auto old1 = prf.rename(LREG_R1, prf.alloc());
+  prf.retire_old(old1);
+  EXPECT_FALSE(prf.is_free(p));
+
+  auto old2 = prf.rename(LREG_R2, Phys_regfile::NONE);  // zero idiom
+  prf.retire_old(old2);
+  EXPECT_TRUE(prf.is_free(p));
+}
+
+TEST(Phys_regfile_test, early_release) {
+  Phys_regfile prf(4, 1, 0, Phys_regfile::Release::Early);
+
+  auto p = prf.alloc();
+  prf.rename(LREG_R1, p);
+  prf.add_reader(p);  // a consumer renamed before the redefinition
+  prf.write(p);
+
+  auto old = prf.rename(LREG_R1, prf.alloc());
+  EXPECT_FALSE(prf.is_free(p));
+  prf.read(p);
+  EXPECT_TRUE(prf.is_free(p));
+  EXPECT_EQ(prf.get_nearly(), 1);
+
+  prf.retire_old(old);  // already released
+  EXPECT_EQ(prf.get_nfree(), 3);
+}
+
+// r1 = ld; r1 = add: the load register is not released before the load writes it
+TEST(Phys_regfile_test, early_release_in_flight) {
+  Phys_regfile prf(4, 1, 0, Phys_regfile::Release::Early);
+
+  auto ld = prf.alloc();
+  prf.rename(LREG_R1, ld);
+  auto add = prf.alloc();
+  auto old = prf.rename(LREG_R1, add);
+  EXPECT_EQ(old, ld);
+  EXPECT_FALSE(prf.is_free(ld));
+  EXPECT_FALSE(prf.is_written(ld));
+  EXPECT_EQ(prf.get_nfree(), 2);
+
+  prf.write(add);
+  EXPECT_FALSE(prf.is_free(ld));
+
+  prf.write(ld);  // the load completes
+  EXPECT_TRUE(prf.is_free(ld));
+  EXPECT_EQ(prf.get_nearly(), 1);
+
+  // Reallocated, the register starts unwritten again
+  EXPECT_EQ(prf.alloc(), 2);
+  EXPECT_EQ(prf.alloc(), 3);
+  auto again = prf.alloc();
+  EXPECT_EQ(again, ld);
+  EXPECT_FALSE(prf.is_written(again));
+}
+
+TEST(Phys_regfile_test, checkpoint_restore) {
+  Phys_regfile prf(8, 1, 0, Phys_regfile::Release::Early);
+
+  auto p1 = prf.alloc();
+  prf.rename(LREG_R1, p1);
+  prf.write(p1);
+  auto nfree = prf.get_nfree();
+
+  prf.checkpoint(10);
+  auto p2 = prf.alloc();
+  prf.rename(LREG_R1, p2);  // no early release past a live checkpoint
+  prf.rename(LREG_R2, prf.alloc());
+  prf.rename(LREG_R3, p2);
+  EXPECT_FALSE(prf.is_free(p1));
+
+  prf.restore(10);
+  EXPECT_EQ(prf.get_map(LREG_R1), p1);
+  EXPECT_EQ(prf.get_map(LREG_R2), Phys_regfile::NONE);
+  EXPECT_EQ(prf.get_map(LREG_R3), Phys_regfile::NONE);
+  EXPECT_EQ(prf.get_nfree(), nfree);
+  EXPECT_EQ(prf.get_ncheckpoints(), 0);
+
+  // The old mapping is live again, retiring its own producer frees nothing
+  auto old = prf.rename(LREG_R1, prf.alloc());
+  EXPECT_EQ(old, p1);
+  EXPECT_TRUE(prf.is_free(p1));  // no readers, released early
+}
+
+TEST(Phys_regfile_test, out_of_order_release) {
+  Phys_regfile prf(8);
+
+  auto p1 = prf.alloc();
+  prf.rename(LREG_R1, p1);
+  prf.checkpoint(10);
+  prf.rename(LREG_R2, prf.alloc());
+  prf.checkpoint(20);
+  auto p3 = prf.alloc();
+  prf.rename(LREG_R3, p3);
+
+  prf.release_checkpoint(10);  // older branch resolved first
+  EXPECT_EQ(prf.get_ncheckpoints(), 1);
+
+  prf.restore(20);
+  EXPECT_EQ(prf.get_map(LREG_R3), Phys_regfile::NONE);
+  EXPECT_TRUE(prf.is_free(p3));
+  EXPECT_NE(prf.get_map(LREG_R2), Phys_regfile::NONE);
+
+  prf.release_checkpoint(20);  // already dropped
+  EXPECT_EQ(prf.get_ncheckpoints(), 0);
+}
+
+TEST(Phys_regfile_test, release_without_younger_renames) {
+  Phys_regfile prf(8, 1, 0, Phys_regfile::Release::Early);
+
+  auto p1 = prf.alloc();
+  prf.rename(LREG_R1, p1);
+  prf.checkpoint(10);
+  EXPECT_FALSE(prf.renamed_since(10));
+
+  // A mispredicted branch with nothing renamed after it keeps the map
+  prf.release_checkpoint(10);
+  EXPECT_EQ(prf.get_map(LREG_R1), p1);
+  EXPECT_EQ(prf.get_ncheckpoints(), 0);
+
+  prf.checkpoint(20);
+  auto p2 = prf.alloc();
+  prf.rename(LREG_R2, p2);
+  EXPECT_TRUE(prf.renamed_since(20));
+  EXPECT_FALSE(prf.renamed_since(30));  // unknown ids
+
+  // Releasing keeps the younger rename, its retire frees it once
+  prf.release_checkpoint(20);
+  EXPECT_EQ(prf.get_map(LREG_R2), p2);
+  prf.write(p2);
+  prf.retire_old(prf.rename(LREG_R2, prf.alloc()));
+  EXPECT_TRUE(prf.is_free(p2));
+}
+
+TEST(Phys_regfile_test, bank_conflicts) {
+  Phys_regfile prf(8, 2, 1);
+
+  Preg srcs[2] = {0, 2};  // same bank
+  EXPECT_EQ(prf.read_delay(srcs, 2, 10), 1);
+
+  Preg other[2] = {1, 3};
+  EXPECT_EQ(prf.read_delay(other, 1, 10), 0);
+  EXPECT_EQ(prf.read_delay(other, 2, 20), 1);
+}
+
+// With registers released at retire, the PRF agrees with the counter model
+// once the architectural mappings are accounted for.
+TEST(Phys_regfile_test, matches_counter_model) {
+  const int32_t num_regs = 64;  // counter model (nTotalRegs)
+  const int32_t narch    = 32;
+
+  Phys_regfile prf(num_regs + narch);
+  int32_t      nTotalRegs = num_regs;
+
+  std::mt19937 rnd(3);
+  // Destination and old mapping of each in-flight instruction
+  std::deque<std::pair<RegType, Preg>> rob;
+  std::set<RegType>                    committed;  // architectural registers written
+
+  for (int i = 0; i < 100000; i++) {
+    bool can_rename = nTotalRegs > 0;
+    EXPECT_TRUE(!can_rename || prf.has_free());
+
+    if (can_rename && (rnd() % 2 || rob.empty())) {
+      auto dst = static_cast<RegType>(LREG_R1 + rnd() % narch);
+      rob.emplace_back(dst, prf.rename(dst, prf.alloc()));
+      nTotalRegs--;
+    } else if (!rob.empty()) {
+      prf.retire_old(rob.front().second);
+      committed.insert(rob.front().first);
+      rob.pop_front();
+      nTotalRegs++;
+    }
+
+    EXPECT_EQ(prf.get_nfree() - (narch - static_cast<int32_t>(committed.size())), nTotalRegs);
+  }
+}
+
+// With early release the PRF never has fewer free registers than the counter
+// model, and a register is not released before its producer writes it.
+TEST(Phys_regfile_test, matches_counter_model_early) {
+  const int32_t num_regs = 64;
+  const int32_t narch    = 32;
+
+  Phys_regfile prf(num_regs + narch, 1, 0, Phys_regfile::Release::Early);
+  int32_t      nTotalRegs = num_regs;
+
+  struct Inflight {
+    RegType dst;
+    Preg    p;
+    Preg    old;
+    Preg    src;
+    bool    executed;
+  };
+
+  std::mt19937         rnd(5);
+  std::deque<Inflight> rob;
+  size_t               nexec = 0;  // executed in order, retired later
+  std::set<RegType>    committed;
+
+  auto check = [&]() {
+    EXPECT_GE(prf.get_nfree() - (narch - static_cast<int32_t>(committed.size())), nTotalRegs);
+    for (size_t j = nexec; j < rob.size(); j++) {
+      EXPECT_FALSE(prf.is_free(rob[j].p));
+    }
+  };
+
+  for (int i = 0; i < 100000; i++) {
+    auto op = rnd() % 3;
+    if (op == 0 && nTotalRegs > 0) {
+      ASSERT_TRUE(prf.has_free());
+      auto src = prf.get_map(static_cast<RegType>(LREG_R1 + rnd() % narch));
+      prf.add_reader(src);
+      auto dst = static_cast<RegType>(LREG_R1 + rnd() % narch);
+      auto p   = prf.alloc();
+      rob.push_back({dst, p, prf.rename(dst, p), src, false});
+      nTotalRegs--;
+    } else if (op == 1 && nexec < rob.size()) {
+      auto &e = rob[nexec++];
+      prf.read(e.src);
+      prf.write(e.p);
+      e.executed = true;
+    } else if (op == 2 && !rob.empty() && rob.front().executed) {
+      prf.retire_old(rob.front().old);
+      committed.insert(rob.front().dst);
+      rob.pop_front();
+      nexec--;
+      nTotalRegs++;
+    }
+
+    check();
+  }
+  EXPECT_GT(prf.get_nearly(), 0);
+
+  // Drained, both models agree again
+  for (; nexec < rob.size(); nexec++) {
+    prf.read(rob[nexec].src);
+    prf.write(rob[nexec].p);
+  }
+  for (auto &e : rob) {
+    prf.retire_old(e.old);
+    committed.insert(e.dst);
+    nTotalRegs++;
+  }
+  EXPECT_EQ(prf.get_nfree() - (narch - static_cast<int32_t>(committed.size())), nTotalRegs);
+}
@@ -60,8 +60,9 @@ private:
 protected:
   const bool cleanItem;
 
-  Time_t pipeId;
-  Time_t clock;
+  Time_t      pipeId;
+  Time_t      clock;
+  TimeDelta_t bypass;  // pipeline stages skipped (decoded by the uop cache)
 
   friend class Pipeline;
   friend class PipeIBucketLess;
@@ -83,6 +84,8 @@ public:
   IBucket(size_t size, Pipeline *p, bool clean = false);
   virtual ~IBucket() {}
 
+  void set_bypass(TimeDelta_t n) { bypass = n; }
+
   StaticCallbackMember0<IBucket, &IBucket::markFetched> markFetchedCB;
 };
 
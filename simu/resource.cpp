@@ -69,6 +69,30 @@ void Resource::setStats(const Dinst *dinst) {
   avgRenameTime.sample(t, true);
 }
 
+void Resource::doExecuting(Dinst *dinst) {
+  if (dinst->isSquashed()) {
+    dinst->scrap();  // squash gave back its resources
+    return;
+  }
+  executing(dinst);
+}
+
+void Resource::doExecuted(Dinst *dinst) {
+  if (dinst->isSquashed()) {
+    dinst->scrap();
+    return;
+  }
+  executed(dinst);
+}
+
+void Resource::doPerformed(Dinst *dinst) {
+  if (dinst->isSquashed()) {
+    dinst->scrap();
+    return;
+  }
+  performed(dinst);
+}
+
 Resource::~Resource()
 /* destructor {{{1 */
 {
@@ -326,6 +350,11 @@ void FULoad::executing(Dinst *dinst) {
 void FULoad::cacheDispatched(Dinst *dinst) {
   /* cacheDispatched {{{1 */
 
+  if (dinst->isSquashed()) {
+    dinst->scrap();  // the load never reaches the cache
+    return;
+  }
+
   I(enableDcache);
   I(!dinst->isLoadForwarded());
 
@@ -433,6 +462,19 @@ void FULoad::performed(Dinst *dinst) {
 }
 /* }}} */
 
+void FULoad::squash(Dinst *dinst) {
+  /* squashed before retire {{{1 */
+  if (!dinst->isExecuted()) {
+    storeset->remove(dinst);
+  }
+  lsq->squash(dinst);
+
+  if (!LSQlateAlloc || dinst->isExecuting()) {
+    freeEntries++;
+  }
+}
+/* }}} */
+
 /***********************************************/
 
 FUStore::FUStore(uint8_t type, std::shared_ptr<Cluster> cls, PortGeneric *aGen, LSQ *_lsq, std::shared_ptr<StoreSet> ss,
@@ -573,6 +615,21 @@ void FUStore::performed(Dinst *dinst) {
 }
 /* }}} */
 
+void FUStore::squash(Dinst *dinst) {
+  /* squashed before retire {{{1 */
+  if (dinst->getInst()->isStoreAddress()) {
+    return;
+  }
+
+  if (!dinst->isExecuted()) {
+    storeset->remove(dinst);
+  }
+  lsq->squash(dinst);
+
+  freeEntries++;  // preretire never came
+}
+/* }}} */
+
 bool FUStore::retire(Dinst *dinst, bool flushing) {
   (void)flushing;
 
@@ -625,7 +682,7 @@ void FUGeneric::executing(Dinst *dinst) {
   }
 #endif
   cluster->executing(dinst);
-  executedCB::scheduleAbs(nlat, this, dinst);
+  cluster->schedule_executed(nlat, this, dinst);
 }
 /* }}} */
 
@@ -688,7 +745,7 @@ StallCause FUBranch::canIssue(Dinst *dinst) {
 void FUBranch::executing(Dinst *dinst) {
   /* executing {{{1 */
   cluster->executing(dinst);
-  executedCB::scheduleAbs(gen->nextSlot(dinst->has_stats()) + lat, this, dinst);
+  cluster->schedule_executed(gen->nextSlot(dinst->has_stats()) + lat, this, dinst);
 }
 /* }}} */
 
@@ -697,7 +754,7 @@ void FUBranch::executed(Dinst *dinst) {
   cluster->executed(dinst);
   dinst->markPerformed();
 
-  if (!drainOnMiss && dinst->isBranchMiss()) {
+  if ((!drainOnMiss || dinst->hasCheckpoint()) && dinst->isBranchMiss()) {
     (dinst->getFetchEngine())->unBlockFetch(dinst, dinst->getFetchTime());
   }
 
@@ -710,7 +767,7 @@ bool FUBranch::preretire(Dinst *dinst, bool flushing)
 /* preretire {{{1 */
 {
   (void)flushing;
-  if (drainOnMiss && dinst->isExecuted() && dinst->isBranchMiss()) {
+  if (drainOnMiss && !dinst->hasCheckpoint() && dinst->isExecuted() && dinst->isBranchMiss()) {
     (dinst->getFetchEngine())->unBlockFetch(dinst, dinst->getFetchTime());
   }
   return dinst->isExecuted();
@@ -732,6 +789,14 @@ void FUBranch::performed(Dinst *dinst) {
 }
 /* }}} */
 
+void FUBranch::squash(Dinst *dinst) {
+  /* squashed before retire {{{1 */
+  if (!dinst->isExecuted()) {
+    freeBranches++;
+  }
+}
+/* }}} */
+
 /***********************************************/
 
 FURALU::FURALU(uint8_t type, std::shared_ptr<Cluster> cls, PortGeneric *aGen, TimeDelta_t l, int32_t id)
@@ -784,7 +849,7 @@ void FURALU::executing(Dinst *dinst)
 /* executing {{{1 */
 {
   cluster->executing(dinst);
-  executedCB::scheduleAbs(gen->nextSlot(dinst->has_stats()) + lat, this, dinst);
+  cluster->schedule_executed(gen->nextSlot(dinst->has_stats()) + lat, this, dinst);
 
   // Recommended poweron the GPU threads and then poweroff the QEMU thread?
 }
@@ -60,8 +60,7 @@ protected:
 public:
   virtual ~Resource();
 
-  const std::shared_ptr<Cluster> getCluster() const { return cluster; }
-  std::shared_ptr<Cluster>       getCluster() { return cluster; }
+  Cluster *getCluster() const { return cluster.get(); }
 
   // Sequence:
   //
@@ -76,6 +75,10 @@ public:
   // called through Dinst::doAtExecuted
   //
   // 4th) When the instruction is retired from the ROB retire is called
+  //
+  // A branch recovery can squash it anywhere before retire. squash gives back
+  // what canIssue took, and a pending executing/executed/performed event
+  // recycles the instruction instead of running it
 
   virtual StallCause canIssue(Dinst *dinst)                 = 0;
   virtual void       executing(Dinst *dinst)                = 0;
@@ -83,10 +86,16 @@ public:
   virtual bool       preretire(Dinst *dinst, bool flushing) = 0;
   virtual bool       retire(Dinst *dinst, bool flushing)    = 0;
   virtual void       performed(Dinst *dinst)                = 0;
+  virtual void       squash(Dinst *dinst) { (void)dinst; }
+
+  // Event entry points, they drop squashed instructions
+  void doExecuting(Dinst *dinst);
+  void doExecuted(Dinst *dinst);
+  void doPerformed(Dinst *dinst);
 
-  typedef CallbackMember1<Resource, Dinst *, &Resource::executing> executingCB;
-  typedef CallbackMember1<Resource, Dinst *, &Resource::executed>  executedCB;
-  typedef CallbackMember1<Resource, Dinst *, &Resource::performed> performedCB;
+  typedef CallbackMember1<Resource, Dinst *, &Resource::doExecuting> executingCB;
+  typedef CallbackMember1<Resource, Dinst *, &Resource::doExecuted>  executedCB;
+  typedef CallbackMember1<Resource, Dinst *, &Resource::doPerformed> performedCB;
 
   Time_t getUsedTime() const { return usedTime; }
   void   setUsedTime() { usedTime = globalClock; }
@@ -158,6 +167,7 @@ public:
   bool       preretire(Dinst *dinst, bool flushing);
   bool       retire(Dinst *dinst, bool flushing);
   void       performed(Dinst *dinst);
+  void       squash(Dinst *dinst);
 };
 
 class FUStore : public MemResource {
@@ -176,6 +186,7 @@ public:
   bool       preretire(Dinst *dinst, bool flushing);
   bool       retire(Dinst *dinst, bool flushing);
   void       performed(Dinst *dinst);
+  void       squash(Dinst *dinst);
 };
 
 class FUGeneric : public Resource {
@@ -207,6 +218,7 @@ public:
   bool       preretire(Dinst *dinst, bool flushing);
   bool       retire(Dinst *dinst, bool flushing);
   void       performed(Dinst *dinst);
+  void       squash(Dinst *dinst);
 };
 
 class FURALU : public Resource {
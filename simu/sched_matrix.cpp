@@ -0,0 +1,93 @@
+// See LICENSE for details.
+
+#include "sched_matrix.hpp"
+
+#include "dinst.hpp"
+
+Sched_matrix::Sched_matrix(uint32_t _size)
+    : size(_size), nwords((_size + 63) / 64), ready(nwords, 0), age(_size * nwords, 0), slot(_size, nullptr), slot_id(_size, 0) {
+  I(size > 0);
+  nready = 0;
+}
+
+bool Sched_matrix::is_oldest(uint32_t i) const {
+  const uint64_t *row = &age[i * nwords];
+  for (uint32_t w = 0; w < nwords; w++) {
+    if (row[w] & ready[w]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Sched_matrix::insert(Dinst *dinst) {
+  if (nready >= size) {
+    return false;
+  }
+
+  uint32_t pos = size;
+  for (uint32_t w = 0; w < nwords; w++) {
+    if (~ready[w]) {
+      pos = w * 64 + __builtin_ctzll(~ready[w]);
+      break;
+    }
+  }
+  I(pos < size);
+
+  const Time_t   id   = dinst->getID();
+  const uint32_t pw   = pos / 64;
+  const uint64_t pbit = 1ULL << (pos % 64);
+
+  uint64_t *row = age_row(pos);
+  for (uint32_t w = 0; w < nwords; w++) {
+    row[w] = 0;
+    uint64_t bits = ready[w];
+    while (bits) {
+      uint32_t j = w * 64 + __builtin_ctzll(bits);
+      bits &= bits - 1;
+
+      if (slot_id[j] < id) {
+        row[w] |= 1ULL << (j % 64);
+        age_row(j)[pw] &= ~pbit;
+      } else {
+        age_row(j)[pw] |= pbit;
+      }
+    }
+  }
+
+  slot[pos]    = dinst;
+  slot_id[pos] = id;
+  ready[pw] |= pbit;
+  nready++;
+
+  return true;
+}
+
+Dinst *Sched_matrix::select() {
+  if (nready == 0) {
+    return nullptr;
+  }
+
+  for (uint32_t w = 0; w < nwords; w++) {
+    uint64_t bits = ready[w];
+    while (bits) {
+      uint32_t i = w * 64 + __builtin_ctzll(bits);
+      bits &= bits - 1;
+
+      if (is_oldest(i)) {
+        ready[w] &= ~(1ULL << (i % 64));
+        nready--;
+        return slot[i];
+      }
+    }
+  }
+
+  I(0);  // age matrix without an oldest entry
+  return nullptr;
+}
+
+Sched_wheel::Sched_wheel(uint32_t depth) : bucket(depth), mask(depth - 1) {
+  I(depth && (depth & (depth - 1)) == 0);
+  pending = 0;
+  drained = ~static_cast<Time_t>(0);
+}
@@ -0,0 +1,91 @@
+// See LICENSE for details.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "iassert.hpp"
+#include "snippets.hpp"
+
+class Dinst;
+class Resource;
+
+// Ready queue of the matrix scheduler. Woken up instructions take a slot, and
+// an age matrix (bit j of row i set when slot j is older than slot i) selects
+// the oldest ready entry with word-wide ANDs instead of sorting.
+class Sched_matrix {
+private:
+  const uint32_t size;
+  const uint32_t nwords;
+
+  std::vector<uint64_t> ready;
+  std::vector<uint64_t> age;
+  std::vector<Dinst *>  slot;
+  std::vector<Time_t>   slot_id;
+  uint32_t              nready;
+
+  uint64_t *age_row(uint32_t i) { return &age[i * nwords]; }
+  bool      is_oldest(uint32_t i) const;
+
+public:
+  explicit Sched_matrix(uint32_t size);
+
+  // false when all the slots are in use
+  bool   insert(Dinst *dinst);
+  // Oldest ready instruction (nullptr if none), the slot is released
+  Dinst *select();
+
+  bool     empty() const { return nready == 0; }
+  uint32_t get_nready() const { return nready; }
+  uint32_t get_size() const { return size; }
+};
+
+// Fixed-delay completion wheel. Bucket (when % depth) holds the work due at
+// cycle when, so a cluster with in-flight work needs a single tick per cycle
+// instead of one scheduled event per instruction.
+class Sched_wheel {
+public:
+  struct Event {
+    Resource *res;
+    Dinst    *dinst;
+    bool      execute;  // true: Resource::executing, false: Resource::executed
+  };
+
+private:
+  std::vector<std::vector<Event>> bucket;
+  const uint32_t                  mask;
+  uint32_t                        pending;
+  Time_t                          drained;  // last cycle whose bucket ran
+
+public:
+  explicit Sched_wheel(uint32_t depth);
+
+  // Work for this cycle fits until its bucket ran, after done() it would
+  // wait a whole revolution
+  bool fits(Time_t when) const {
+    if (when < globalClock || (when - globalClock) > mask) {
+      return false;
+    }
+    return when != globalClock || drained != globalClock;
+  }
+
+  void push(Time_t when, const Event &ev) {
+    I(fits(when));
+    bucket[when & mask].push_back(ev);
+    pending++;
+  }
+
+  // Work due this cycle. Handlers may push more work for this cycle, so
+  // iterate by index and call done() afterwards.
+  std::vector<Event> &current() { return bucket[globalClock & mask]; }
+  void                done() {
+    auto &b = current();
+    I(pending >= b.size());
+    pending -= b.size();
+    b.clear();
+    drained = globalClock;
+  }
+
+  bool empty() const { return pending == 0; }
+};
@@ -0,0 +1,115 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include "sched_matrix.hpp"
+
+#include <vector>
+
+#include "dinst.hpp"
+#include "gtest/gtest.h"
+#include "instruction.hpp"
+
+class Sched_matrix_test : public ::testing::Test {
+protected:
+  std::vector<Dinst *> dinsts;
+
+  void SetUp() override { globalClock = 1; }
+  void TearDown() override {
+    for (auto *d : dinsts) {
+      d->markIssued();
+      d->markExecuted();
+      d->destroy();
+    }
+  }
+
+  Dinst *create() {
+    auto *d = Dinst::create(Instruction(iAALU, LREG_R1, LREG_R2, LREG_R3, LREG_InvalidOutput), 0x100, 0, 0, false);
+    dinsts.push_back(d);
+    return d;
+  }
+};
+
+TEST_F(Sched_matrix_test, oldest_first) {
+  Sched_matrix m(130);  // several words per row
+
+  std::vector<Dinst *> d;
+  for (int i = 0; i < 130; i++) {
+    d.push_back(create());
+  }
+
+  // Insert out of age order
+  for (int i = 129; i >= 0; i -= 2) {
+    EXPECT_TRUE(m.insert(d[i]));
+  }
+  for (int i = 0; i < 130; i += 2) {
+    EXPECT_TRUE(m.insert(d[i]));
+  }
+  EXPECT_FALSE(m.insert(create()));
+
+  EXPECT_EQ(m.select(), d[0]);
+  EXPECT_EQ(m.select(), d[1]);
+
+  // Reused slots keep the age order
+  EXPECT_TRUE(m.insert(d[1]));
+  EXPECT_EQ(m.select(), d[1]);
+
+  for (int i = 2; i < 130; i++) {
+    EXPECT_EQ(m.select(), d[i]);
+  }
+  EXPECT_TRUE(m.empty());
+  EXPECT_EQ(m.select(), nullptr);
+}
+
+TEST_F(Sched_matrix_test, wheel) {
+  Sched_wheel w(8);
+
+  auto *a = create();
+  auto *b = create();
+
+  EXPECT_TRUE(w.fits(globalClock + 7));
+  EXPECT_FALSE(w.fits(globalClock + 8));
+
+  w.push(globalClock + 2, {nullptr, a, true});
+  w.push(globalClock + 2, {nullptr, b, false});
+  EXPECT_TRUE(w.current().empty());
+  w.done();
+
+  globalClock += 2;
+  ASSERT_EQ(w.current().size(), 2);
+  EXPECT_EQ(w.current()[0].dinst, a);
+  EXPECT_TRUE(w.current()[0].execute);
+  EXPECT_EQ(w.current()[1].dinst, b);
+  EXPECT_FALSE(w.empty());
+  w.done();
+  EXPECT_TRUE(w.empty());
+}
+
+// Work for the current cycle pushed after its bucket ran does not fit (it
+// would fire a revolution late), before that it runs this cycle
+TEST_F(Sched_matrix_test, wheel_same_cycle) {
+  Sched_wheel w(8);
+
+  auto *a = create();
+  auto *b = create();
+
+  EXPECT_TRUE(w.fits(globalClock));
+  w.push(globalClock, {nullptr, a, false});
+  ASSERT_EQ(w.current().size(), 1);
+
+  // A handler pushes more work for this cycle while the bucket runs
+  w.push(globalClock, {nullptr, b, false});
+  EXPECT_EQ(w.current().size(), 2);
+  w.done();
+  EXPECT_TRUE(w.empty());
+
+  EXPECT_FALSE(w.fits(globalClock));
+  EXPECT_TRUE(w.fits(globalClock + 1));
+
+  globalClock += 1;
+  EXPECT_TRUE(w.fits(globalClock));
+  EXPECT_TRUE(w.current().empty());
+  w.done();
+
+  // A full revolution later the bucket is still empty
+  globalClock += 8;
+  EXPECT_TRUE(w.current().empty());
+}
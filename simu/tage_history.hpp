@@ -0,0 +1,82 @@
+// See LICENSE for details.
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "dinst.hpp"  // Addr_t
+#include "tage_simd.hpp"
+
+#define HISTBUFFERLENGTH 4096  // we use a 4K entries history buffer to store the branch history
+
+// Global branch and path history of the TAGE style predictors (IMLIBest,
+// ITTAGE), with the folded histories of their tagged tables.
+class Tage_global_history {
+public:
+  uint8_t     ghist[HISTBUFFERLENGTH + 4];  // +4: Folded_bank gathers 32 bits
+  int         ptghist;
+  long long   phist;  // path history
+  Folded_bank fold;
+
+  Tage_global_history() { clear(); }
+
+  void clear() {
+    memset(ghist, 0, sizeof(ghist));
+    ptghist = 0;
+    phist   = 0;
+  }
+
+  // Speculative history checkpoint. Only the ring pointer is saved: the
+  // younger (wrong path) updates write below it and are rewritten after the
+  // restore
+  void save(std::vector<uint64_t> &ck) const {
+    ck.push_back(uint32_t(ptghist));
+    ck.push_back(phist);
+    for (int i = 0; i < fold.size(); i += 2) {  // lanes are padded to a multiple of 8
+      ck.push_back((uint64_t(fold.get(i + 1)) << 32) | fold.get(i));
+    }
+  }
+
+  size_t restore(const std::vector<uint64_t> &ck, size_t pos) {
+    ptghist = int32_t(ck[pos++]);
+    phist   = ck[pos++];
+    for (int i = 0; i < fold.size(); i += 2) {
+      fold.set(i, uint32_t(ck[pos]));
+      fold.set(i + 1, ck[pos] >> 32);
+      pos++;
+    }
+    return pos;
+  }
+
+  // Conditional branches shift one bit, the other control instructions
+  // four bits of PC/direction
+  void update(Addr_t PC, bool conditional, bool taken) {
+    int maxt = conditional ? 1 : 4;
+
+#ifdef USE_DOLC
+    (void)PC;
+    (void)taken;
+    for (int t = 0; t < maxt; t++) {
+      ghist[ptghist & (HISTBUFFERLENGTH - 1)] = 0;
+      phist                                   = 0;
+      ptghist--;
+    }
+#else
+    int T    = ((PC) << 1) + taken;
+    int PATH = PC;
+
+    for (int t = 0; t < maxt; t++) {
+      bool DIR = (T & 1);
+      T >>= 1;
+      int PATHBIT = (PATH & 127);
+      PATH >>= 1;
+      ptghist--;
+      ghist[ptghist & (HISTBUFFERLENGTH - 1)] = DIR;
+      phist                                   = (phist << 1) ^ PATHBIT;
+      fold.update(ghist, ptghist, HISTBUFFERLENGTH - 1);
+    }
+#endif
+  }
+};
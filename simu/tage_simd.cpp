@@ -0,0 +1,141 @@
+// See LICENSE for details.
+
+#include "tage_simd.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define TAGE_SIMD_X86 1
+#endif
+
+#ifdef TAGE_SIMD_X86
+static bool has_avx2() {
+  static const bool avx2 = __builtin_cpu_supports("avx2");
+  return avx2;
+}
+
+__attribute__((target("avx2"))) static void fold_avx2(uint32_t *comp, const uint32_t *olength, const uint32_t *clength,
+                                                       const uint32_t *outpoint, const uint32_t *mask, int n, const uint8_t *h,
+                                                       int PT, uint32_t hmask) {
+  const __m256i bit   = _mm256_set1_epi32(h[PT & hmask]);
+  const __m256i pt    = _mm256_set1_epi32(PT);
+  const __m256i hm    = _mm256_set1_epi32(hmask);
+  const __m256i byte0 = _mm256_set1_epi32(0xFF);
+
+  for (int i = 0; i < n; i += 8) {
+    __m256i c  = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(comp + i));
+    __m256i ol = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(olength + i));
+    __m256i cl = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(clength + i));
+    __m256i op = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(outpoint + i));
+    __m256i m  = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(mask + i));
+
+    __m256i idx = _mm256_and_si256(_mm256_add_epi32(pt, ol), hm);
+    __m256i old = _mm256_and_si256(_mm256_i32gather_epi32(reinterpret_cast<const int *>(h), idx, 1), byte0);
+
+    c = _mm256_xor_si256(_mm256_slli_epi32(c, 1), bit);
+    c = _mm256_xor_si256(c, _mm256_sllv_epi32(old, op));
+    c = _mm256_xor_si256(c, _mm256_srlv_epi32(c, cl));
+    c = _mm256_and_si256(c, m);
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(comp + i), c);
+  }
+}
+
+__attribute__((target("avx2"))) static uint64_t match_avx2(const uint32_t *a, const uint32_t *b, int n) {
+  uint64_t hit = 0;
+  int      i   = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+    __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+    uint32_t eq = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(va, vb)));
+    hit |= static_cast<uint64_t>(eq) << i;
+  }
+  return hit | (tage_tag_match_scalar(a + i, b + i, n - i) << i);
+}
+
+__attribute__((target("avx2"))) static void hash_avx2(const uint32_t *gi, const uint32_t *shift, const uint32_t *mask,
+                                                       uint32_t *tag, int n) {
+  int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    __m256i g = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(gi + i));
+    __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(shift + i));
+    __m256i m = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(mask + i));
+    __m256i t = _mm256_and_si256(_mm256_xor_si256(_mm256_sllv_epi32(g, s), g), m);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(tag + i), t);
+  }
+  tage_tag_hash_scalar(gi + i, shift + i, mask + i, tag + i, n - i);
+}
+#endif
+
+void Folded_bank::resize(int nlanes) {
+  int n = (nlanes + 7) & ~7;
+  comp.assign(n, 0);
+  olength.assign(n, 0);
+  clength.assign(n, 0);
+  outpoint.assign(n, 0);
+  mask.assign(n, 0);
+}
+
+void Folded_bank::init(int lane, int original_length, int compressed_length) {
+  I(lane < size());
+  I(compressed_length > 0 && compressed_length < 32);
+
+  comp[lane]     = 0;
+  olength[lane]  = original_length;
+  clength[lane]  = compressed_length;
+  outpoint[lane] = original_length % compressed_length;
+  mask[lane]     = (1u << compressed_length) - 1;
+}
+
+void Folded_bank::update_scalar(const uint8_t *h, int PT, uint32_t hmask) {
+  const uint32_t bit = h[PT & hmask];
+  for (size_t i = 0; i < comp.size(); i++) {
+    uint32_t c = (comp[i] << 1) ^ bit;
+    c ^= static_cast<uint32_t>(h[(PT + olength[i]) & hmask]) << outpoint[i];
+    c ^= c >> clength[i];
+    comp[i] = c & mask[i];
+  }
+}
+
+void Folded_bank::update(const uint8_t *h, int PT, uint32_t hmask) {
+#ifdef TAGE_SIMD_X86
+  if (has_avx2()) {
+    fold_avx2(comp.data(), olength.data(), clength.data(), outpoint.data(), mask.data(), comp.size(), h, PT, hmask);
+    return;
+  }
+#endif
+  update_scalar(h, PT, hmask);
+}
+
+uint64_t tage_tag_match_scalar(const uint32_t *a, const uint32_t *b, int n) {
+  uint64_t hit = 0;
+  for (int i = 0; i < n; i++) {
+    hit |= static_cast<uint64_t>(a[i] == b[i]) << i;
+  }
+  return hit;
+}
+
+uint64_t tage_tag_match(const uint32_t *a, const uint32_t *b, int n) {
+  I(n <= 64);
+#ifdef TAGE_SIMD_X86
+  if (has_avx2()) {
+    return match_avx2(a, b, n);
+  }
+#endif
+  return tage_tag_match_scalar(a, b, n);
+}
+
+void tage_tag_hash_scalar(const uint32_t *gi, const uint32_t *shift, const uint32_t *mask, uint32_t *tag, int n) {
+  for (int i = 0; i < n; i++) {
+    tag[i] = ((gi[i] << shift[i]) ^ gi[i]) & mask[i];
+  }
+}
+
+void tage_tag_hash(const uint32_t *gi, const uint32_t *shift, const uint32_t *mask, uint32_t *tag, int n) {
+#ifdef TAGE_SIMD_X86
+  if (has_avx2()) {
+    hash_avx2(gi, shift, mask, tag, n);
+    return;
+  }
+#endif
+  tage_tag_hash_scalar(gi, shift, mask, tag, n);
+}
@@ -0,0 +1,47 @@
+// See LICENSE for details.
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "iassert.hpp"
+
+// Vector helpers for the TAGE style predictors (IMLIBest, VTAGE). On x86 the
+// AVX2 versions are picked at run time, otherwise (or without AVX2) the
+// scalar loops compute the same values.
+
+// Folded (cyclic shift register) histories of several tables kept as
+// arrays, so that a history update touches every table at once. Same
+// semantics as folded_history in imlibest.hpp.
+class Folded_bank {
+private:
+  std::vector<uint32_t> comp;
+  std::vector<uint32_t> olength;
+  std::vector<uint32_t> clength;
+  std::vector<uint32_t> outpoint;
+  std::vector<uint32_t> mask;
+
+public:
+  // Lanes are padded to a multiple of 8, padding lanes fold nothing
+  void resize(int nlanes);
+  void init(int lane, int original_length, int compressed_length);
+
+  int      size() const { return comp.size(); }
+  uint32_t get(int lane) const { return comp[lane]; }
+  int      get_olength(int lane) const { return olength[lane]; }
+  void     set(int lane, uint32_t c) { comp[lane] = c & mask[lane]; }
+
+  // Shift in history h[PT]. h is a ring of hmask+1 entries that must be
+  // readable 3 bytes past the end (the AVX2 gather loads 32 bits)
+  void update(const uint8_t *h, int PT, uint32_t hmask);
+  void update_scalar(const uint8_t *h, int PT, uint32_t hmask);
+};
+
+// Bit i set when a[i] == b[i], n <= 64
+uint64_t tage_tag_match(const uint32_t *a, const uint32_t *b, int n);
+uint64_t tage_tag_match_scalar(const uint32_t *a, const uint32_t *b, int n);
+
+// tag[i] = ((gi[i] << shift[i]) ^ gi[i]) & mask[i]
+void tage_tag_hash(const uint32_t *gi, const uint32_t *shift, const uint32_t *mask, uint32_t *tag, int n);
+void tage_tag_hash_scalar(const uint32_t *gi, const uint32_t *shift, const uint32_t *mask, uint32_t *tag, int n);
@@ -0,0 +1,92 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include "tage_simd.hpp"
+
+#include <random>
+
+#include "gtest/gtest.h"
+#include "imlibest.hpp"
+
+TEST(Tage_simd_test, folded_bank) {
+  const int nlanes = 13;  // not a multiple of 8, exercises the padding lanes
+
+  std::vector<folded_history> ref(nlanes);
+  Folded_bank                 bank;
+  Folded_bank                 bank_scalar;
+  bank.resize(nlanes);
+  bank_scalar.resize(nlanes);
+
+  for (int i = 0; i < nlanes; ++i) {
+    int olen = 5 + i * 47;
+    int clen = 8 + i % 9;
+    ref[i].init(olen, clen);
+    bank.init(i, olen, clen);
+    bank_scalar.init(i, olen, clen);
+  }
+
+  uint8_t      ghist[HISTBUFFERLENGTH + 4] = {0};
+  std::mt19937 rng(42);
+  int          pt                          = 0;
+  for (int n = 0; n < 20000; ++n) {
+    pt--;
+    ghist[pt & (HISTBUFFERLENGTH - 1)] = rng() & 1;
+
+    bank.update(ghist, pt, HISTBUFFERLENGTH - 1);
+    bank_scalar.update_scalar(ghist, pt, HISTBUFFERLENGTH - 1);
+    for (int i = 0; i < nlanes; ++i) {
+      ref[i].update(ghist, pt);
+    }
+
+    for (int i = 0; i < nlanes; ++i) {
+      ASSERT_EQ(bank.get(i), ref[i].comp) << "lane " << i << " step " << n;
+      ASSERT_EQ(bank_scalar.get(i), ref[i].comp) << "lane " << i << " step " << n;
+    }
+    for (int i = nlanes; i < bank.size(); ++i) {
+      ASSERT_EQ(bank.get(i), 0);
+    }
+  }
+}
+
+TEST(Tage_simd_test, tag_match) {
+  std::mt19937 rng(7);
+
+  for (int n = 1; n <= 64; ++n) {
+    std::vector<uint32_t> a(n);
+    std::vector<uint32_t> b(n);
+    for (int i = 0; i < n; ++i) {
+      a[i] = rng() & 0xFFF;
+      b[i] = (rng() & 1) ? a[i] : (rng() & 0xFFF);
+    }
+
+    uint64_t hit = tage_tag_match(a.data(), b.data(), n);
+    EXPECT_EQ(hit, tage_tag_match_scalar(a.data(), b.data(), n));
+    for (int i = 0; i < n; ++i) {
+      EXPECT_EQ((hit >> i) & 1, a[i] == b[i]);
+    }
+  }
+}
+
+TEST(Tage_simd_test, tag_hash) {
+  std::mt19937 rng(3);
+
+  for (int n = 1; n <= 20; ++n) {
+    std::vector<uint32_t> gi(n);
+    std::vector<uint32_t> shift(n);
+    std::vector<uint32_t> mask(n);
+    for (int i = 0; i < n; ++i) {
+      gi[i]    = rng() & 0xFFFF;
+      shift[i] = 5 + i % 4;
+      mask[i]  = (1u << (9 + i / 2)) - 1;
+    }
+
+    std::vector<uint32_t> tag(n);
+    std::vector<uint32_t> tag_scalar(n);
+    tage_tag_hash(gi.data(), shift.data(), mask.data(), tag.data(), n);
+    tage_tag_hash_scalar(gi.data(), shift.data(), mask.data(), tag_scalar.data(), n);
+
+    for (int i = 0; i < n; ++i) {
+      EXPECT_EQ(tag[i], tag_scalar[i]);
+      EXPECT_EQ(tag[i], ((gi[i] << shift[i]) ^ gi[i]) & mask[i]);
+    }
+  }
+}
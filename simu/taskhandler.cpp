@@ -15,14 +15,14 @@
 void TaskHandler::report() {
   /* dump statistics to report file {{{1 */
 
-  Report::field(fmt::format("OSSim:nCPUs={}", simus.size()));
+  Report::meta("nCPUs", fmt::format("{}", simus.size()));
 
   for (size_t i = 0; i < emuls.size(); i++) {
-    Report::field(fmt::format("OSSim:P({})emul_type={}", i, emuls[i]->get_type()));
-    Report::field(fmt::format("OSSim:P({})simu_type={}", i, simus[i]->get_type()));
+    Report::meta(fmt::format("P({})emul_type", i), emuls[i]->get_type());
+    Report::meta(fmt::format("P({})simu_type", i), simus[i]->get_type());
   }
 
-  Report::field(fmt::format("OSSim:global_clock={}", globalClock));
+  Report::meta("global_clock", fmt::format("{}", globalClock));
 }
 /* }}} */
 
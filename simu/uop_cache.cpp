@@ -0,0 +1,124 @@
+// See LICENSE for details.
+
+#include "uop_cache.hpp"
+
+#include "config.hpp"
+#include "fmt/format.h"
+#include "instruction.hpp"
+
+Uop_cache::Uop_cache(Hartid_t id, const std::string &section)
+    : loop_size(Config::get_integer(section, "loop_size", 0, 1024))
+    , loop_threshold(Config::get_integer(section, "loop_threshold", 1, 1024))
+    , switch_penalty(Config::get_integer(section, "switch_penalty", 0, 32))
+    , nUopHit(fmt::format("P({})_uop_nHit", id))
+    , nUopMiss(fmt::format("P({})_uop_nMiss", id))
+    , nLoopHit(fmt::format("P({})_uop_nLoopHit", id))
+    , nSwitch(fmt::format("P({})_uop_nSwitch", id))
+    , nUopInst(fmt::format("P({})_uop_nUopInst", id))
+    , nLoopInst(fmt::format("P({})_uop_nLoopInst", id))
+    , nDecodeInst(fmt::format("P({})_uop_nDecodeInst", id)) {
+  cache = nullptr;
+  if (Config::get_integer(section, "uop_size") > 0) {
+    cache = UopCache::create(section, "uop", fmt::format("P({})_uop_cache:", id));
+  }
+
+  loop_pc     = 0;
+  loop_target = 0;
+  loop_iter   = 0;
+  last        = Source::Decode;
+}
+
+Uop_cache::~Uop_cache() {
+  if (cache) {
+    cache->destroy();
+  }
+}
+
+bool Uop_cache::in_loop(const FastQueue<Dinst *> &block) const {
+  if (loop_iter < loop_threshold) {
+    return false;
+  }
+
+  for (uint32_t i = block.getIDFromTop(0); !block.isEnd(i); i = block.getNextId(i)) {
+    Addr_t pc = block.getData(i)->getPC();
+    if (pc < loop_target || pc > loop_pc) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void Uop_cache::train_loop(const FastQueue<Dinst *> &block) {
+  if (loop_size == 0) {
+    return;
+  }
+
+  for (uint32_t i = block.getIDFromTop(0); !block.isEnd(i); i = block.getNextId(i)) {
+    const Dinst *dinst = block.getData(i);
+    if (!dinst->getInst()->isControl()) {
+      continue;
+    }
+
+    Addr_t pc = dinst->getPC();
+    if (pc == loop_pc && loop_iter > 0) {
+      if (dinst->isTaken() && dinst->getAddr() == loop_target) {
+        loop_iter++;
+      } else {
+        loop_iter = 0;  // loop exit
+      }
+      continue;
+    }
+
+    // A different taken backward branch starts a new candidate if the body
+    // fits (counted as compressed instructions, conservative)
+    bool backward = dinst->isTaken() && dinst->getAddr() < pc;
+    if (backward && (pc - dinst->getAddr()) / 2 < static_cast<Addr_t>(loop_size)) {
+      loop_pc     = pc;
+      loop_target = dinst->getAddr();
+      loop_iter   = 1;
+    } else if (dinst->isTaken() && (pc < loop_target || pc > loop_pc)) {
+      loop_iter = 0;  // left the loop body
+    }
+  }
+}
+
+Uop_cache::Source Uop_cache::access(const FastQueue<Dinst *> &block, TimeDelta_t &penalty) {
+  I(!block.empty());
+
+  const Dinst *head    = block.top();
+  bool         doStats = head->has_stats();
+  Source       src     = Source::Decode;
+
+  if (loop_size && in_loop(block)) {
+    src = Source::Loop;
+    nLoopHit.inc(doStats);
+    nLoopInst.add(block.size(), doStats);
+  } else if (cache) {
+    auto *cl = cache->readLine(head->getPC());
+    if (cl && cl->ninst >= block.size()) {
+      src = Source::Uop;
+      nUopHit.inc(doStats);
+      nUopInst.add(block.size(), doStats);
+    } else {
+      nUopMiss.inc(doStats);
+      cl        = cache->fillLine(head->getPC(), 0xdeaddead);
+      cl->ninst = block.size();
+    }
+  }
+
+  if (src == Source::Decode) {
+    nDecodeInst.add(block.size(), doStats);
+  }
+
+  train_loop(block);
+
+  // Uop cache and loop buffer share the decoded path
+  penalty = 0;
+  if ((src == Source::Decode) != (last == Source::Decode)) {
+    penalty = switch_penalty;
+    nSwitch.inc(doStats);
+  }
+  last = src;
+
+  return src;
+}
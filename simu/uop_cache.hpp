@@ -0,0 +1,68 @@
+// See LICENSE for details.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "cachecore.hpp"
+#include "dinst.hpp"
+#include "fastqueue.hpp"
+#include "iassert.hpp"
+#include "stats.hpp"
+
+// Decoded instruction cache indexed by fetch block PC, plus a loop stream
+// buffer. Blocks delivered by either one skip the IL1 access and the decode
+// stage. Switching between them and the legacy decoders costs switch_penalty
+// cycles of fetch.
+class Uop_cache {
+public:
+  enum class Source : uint8_t { Decode, Uop, Loop };
+
+private:
+  class Uop_state : public StateGeneric<Addr_t> {
+  public:
+    Uop_state(int32_t lineSize) {
+      (void)lineSize;
+      ninst = 0;
+    }
+
+    uint16_t ninst;  // instructions of the cached block
+
+    bool operator==(Uop_state s) const { return ninst == s.ninst; }
+  };
+
+  typedef CacheGeneric<Uop_state, Addr_t> UopCache;
+
+  UopCache *cache;  // nullptr when uop_size is 0 (loop buffer only)
+
+  const int32_t     loop_size;  // instructions, 0 disables the loop buffer
+  const int32_t     loop_threshold;
+  const TimeDelta_t switch_penalty;
+
+  // Loop being trained or streamed: backward taken branch and its target
+  Addr_t  loop_pc;
+  Addr_t  loop_target;
+  int32_t loop_iter;
+
+  Source last;
+
+  Stats_cntr nUopHit;
+  Stats_cntr nUopMiss;
+  Stats_cntr nLoopHit;
+  Stats_cntr nSwitch;
+  Stats_cntr nUopInst;     // coverage: instructions delivered by the uop cache
+  Stats_cntr nLoopInst;    // coverage: instructions delivered by the loop buffer
+  Stats_cntr nDecodeInst;  // power proxy: instructions through the IL1 and decoders
+
+  bool in_loop(const FastQueue<Dinst *> &block) const;
+  void train_loop(const FastQueue<Dinst *> &block);
+
+public:
+  Uop_cache(Hartid_t id, const std::string &section);
+  ~Uop_cache();
+
+  // Where block is delivered from, filling the uop cache on a miss. penalty
+  // is set to the fetch cycles lost when the source changes.
+  Source access(const FastQueue<Dinst *> &block, TimeDelta_t &penalty);
+};
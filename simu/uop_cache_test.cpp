@@ -0,0 +1,91 @@
+// This file is distributed under the BSD 3-Clause License. See LICENSE for details.
+
+#include "uop_cache.hpp"
+
+#include <fstream>
+#include <vector>
+
+#include "config.hpp"
+#include "gtest/gtest.h"
+#include "instruction.hpp"
+
+class Uop_cache_test : public ::testing::Test {
+protected:
+  std::vector<Dinst *> dinsts;
+
+  void SetUp() override {
+    std::ofstream file;
+
+    file.open("uop_cache_test.toml");
+    file << "[uop0]\n";
+    file << "uop_size        = 64\n";
+    file << "uop_line_size   = 1\n";
+    file << "uop_assoc       = 4\n";
+    file << "uop_repl_policy = \"LRU\"\n";
+    file << "loop_size       = 16\n";
+    file << "loop_threshold  = 2\n";
+    file << "switch_penalty  = 2\n";
+    file.close();
+
+    Config::init("uop_cache_test.toml");
+    globalClock = 1;
+  }
+
+  void TearDown() override {
+    for (auto *d : dinsts) {
+      d->markIssued();
+      d->markExecuted();
+      d->destroy();
+    }
+  }
+
+  // Fetch block of n instructions at pc, the last one optionally a branch to target
+  FastQueue<Dinst *> block(Addr_t pc, int n, Addr_t target = 0) {
+    FastQueue<Dinst *> b(16);
+    for (int i = 0; i < n; i++) {
+      Addr_t a = pc + 4 * i;
+      Dinst *d;
+      if (target && i == n - 1) {
+        d = Dinst::create(Instruction(iBALU_LBRANCH, LREG_R1, LREG_R2, LREG_R0, LREG_InvalidOutput), a, target, 0, true);
+      } else {
+        d = Dinst::create(Instruction(iAALU, LREG_R1, LREG_R2, LREG_R3, LREG_InvalidOutput), a, 0, 0, true);
+      }
+      dinsts.push_back(d);
+      b.push(d);
+    }
+    return b;
+  }
+};
+
+TEST_F(Uop_cache_test, hit_after_fill) {
+  Uop_cache uc(0, "uop0");
+
+  TimeDelta_t penalty;
+  auto        b = block(0x1000, 4);
+  EXPECT_EQ(uc.access(b, penalty), Uop_cache::Source::Decode);
+  EXPECT_EQ(penalty, 0);
+
+  EXPECT_EQ(uc.access(b, penalty), Uop_cache::Source::Uop);
+  EXPECT_EQ(penalty, 2);  // decoders to uop cache
+
+  // A longer block at the same PC is not fully cached
+  auto longer = block(0x1000, 6);
+  EXPECT_EQ(uc.access(longer, penalty), Uop_cache::Source::Decode);
+  EXPECT_EQ(penalty, 2);
+}
+
+TEST_F(Uop_cache_test, loop_buffer) {
+  Uop_cache uc(0, "uop0");
+
+  TimeDelta_t penalty;
+  auto        body = block(0x2000, 4, 0x2000);  // 4 instruction loop
+
+  EXPECT_EQ(uc.access(body, penalty), Uop_cache::Source::Decode);
+  EXPECT_NE(uc.access(body, penalty), Uop_cache::Source::Loop);  // one taken iteration so far
+  EXPECT_EQ(uc.access(body, penalty), Uop_cache::Source::Loop);
+  EXPECT_EQ(uc.access(body, penalty), Uop_cache::Source::Loop);
+
+  // Leaving the body stops streaming
+  auto after = block(0x3000, 4);
+  EXPECT_NE(uc.access(after, penalty), Uop_cache::Source::Loop);
+}